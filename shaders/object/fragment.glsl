@@ -1,20 +1,84 @@
 #version 300 es
 
 precision highp float;
+precision highp usampler2D;
 
 uniform sampler2D u_texture;
 
 uniform bool u_has_color;
 uniform vec3 u_color;
 
+// Alpha tested materials discard below the cutoff (0 keeps every fragment).
+uniform float u_alpha_cutoff;
+// Blended materials keep their alpha times u_alpha, the others are written opaque.
+uniform bool u_blend;
+uniform float u_alpha;
+
+// Clustered lighting (see src/system/lighting.hpp, the sizes must match Lighting).
+const int CLUSTERS_X = 16;
+const int CLUSTERS_Y = 9;
+const int CLUSTERS_Z = 24;
+const int INDEX_WIDTH = 1024;
+
+uniform bool u_lighting;
+uniform vec3 u_ambient;
+// Row 0: view position and radius. Row 1: color.
+uniform highp sampler2D u_lights;
+// Per cluster (offset, count) into u_light_indices.
+uniform usampler2D u_light_grid;
+uniform usampler2D u_light_indices;
+// Viewport in pixels (x, y, width, height).
+uniform vec4 u_cluster_viewport;
+// Near plane and log depth scale of the slices.
+uniform vec4 u_cluster_depth;
+
 in vec2 tex_coord;
+in vec3 view_position;
+in vec3 view_normal;
 
 out vec4 color;
 
+vec3 clustered_lighting(vec3 base) {
+    vec2 tile = (gl_FragCoord.xy - u_cluster_viewport.xy) / u_cluster_viewport.zw * vec2(CLUSTERS_X, CLUSTERS_Y);
+    int slice = int(log(max(-view_position.z, u_cluster_depth.x) / u_cluster_depth.x) * u_cluster_depth.y);
+
+    ivec3 cluster = clamp(ivec3(ivec2(tile), slice), ivec3(0), ivec3(CLUSTERS_X - 1, CLUSTERS_Y - 1, CLUSTERS_Z - 1));
+    uvec2 range = texelFetch(u_light_grid, ivec2(cluster.x + cluster.y * CLUSTERS_X, cluster.z), 0).rg;
+
+    vec3 normal = normalize(view_normal);
+    vec3 light = u_ambient;
+
+    for(uint i = range.x; i < range.x + range.y; i++) {
+        int index = int(texelFetch(u_light_indices, ivec2(int(i) % INDEX_WIDTH, int(i) / INDEX_WIDTH), 0).r);
+
+        vec4 sphere = texelFetch(u_lights, ivec2(index, 0), 0);
+        vec3 to_light = sphere.xyz - view_position;
+        float distance_squared = dot(to_light, to_light);
+
+        // Smooth falloff reaching 0 at the radius (the binning bound).
+        float falloff = clamp(1.0 - distance_squared / (sphere.w * sphere.w), 0.0, 1.0);
+        float diffuse = max(dot(normal, to_light * inversesqrt(max(distance_squared, 1e-6))), 0.0);
+
+        light += texelFetch(u_lights, ivec2(index, 1), 0).rgb * diffuse * falloff * falloff;
+    }
+
+    return base * light;
+}
+
 void main() {
     if(u_has_color) {
         color = vec4(u_color, 1.0);
     } else {
         color = texture(u_texture, tex_coord);
     }
+
+    if(color.a < u_alpha_cutoff) {
+        discard;
+    }
+
+    color.a = u_blend ? color.a * u_alpha : 1.0;
+
+    if(u_lighting) {
+        color.rgb = clustered_lighting(color.rgb);
+    }
 }
\ No newline at end of file
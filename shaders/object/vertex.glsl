@@ -11,8 +11,16 @@ uniform mat4 u_world;
 uniform mat4 u_view;
 
 out vec2 tex_coord;
+// View space, for clustered lighting.
+out vec3 view_position;
+out vec3 view_normal;
 
 void main() {
+    mat4 model_view = u_view * u_world;
+    vec4 position = model_view * vec4(a_position, 1.0);
+
     tex_coord = a_tex_coord;
-    gl_Position = u_projection * u_view * u_world * vec4(a_position, 1.0);
+    view_position = position.xyz;
+    view_normal = transpose(inverse(mat3(model_view))) * a_normal;
+    gl_Position = u_projection * position;
 }
\ No newline at end of file
@@ -0,0 +1,31 @@
+#version 300 es
+
+precision highp float;
+precision highp int;
+
+// One particle per instance, read straight from the pool arrays (see src/system/particles.hpp).
+layout(location=0) in float a_x;
+layout(location=1) in float a_y;
+layout(location=2) in float a_z;
+layout(location=3) in float a_size;
+
+uniform mat4 u_projection;
+uniform mat4 u_view;
+
+out vec2 tex_coord;
+// View space, for clustered lighting.
+out vec3 view_position;
+out vec3 view_normal;
+
+void main() {
+    // Corners of the triangle strip: (0, 0), (1, 0), (0, 1), (1, 1).
+    vec2 corner = vec2(float(gl_VertexID & 1), float(gl_VertexID >> 1));
+    vec4 center = u_view * vec4(a_x, a_y, a_z, 1.0);
+    vec4 position = center + vec4((corner - 0.5) * a_size, 0.0, 0.0);
+
+    tex_coord = corner;
+    view_position = position.xyz;
+    // Facing the camera.
+    view_normal = vec3(0.0, 0.0, 1.0);
+    gl_Position = u_projection * position;
+}
\ No newline at end of file
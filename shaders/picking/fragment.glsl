@@ -0,0 +1,12 @@
+#version 300 es
+
+precision highp float;
+precision highp int;
+
+uniform uint u_id;
+
+out uint id;
+
+void main() {
+    id = u_id;
+}
\ No newline at end of file
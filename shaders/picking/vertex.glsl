@@ -0,0 +1,13 @@
+#version 300 es
+
+precision highp float;
+
+layout(location=0) in vec3 a_position;
+
+uniform mat4 u_projection;
+uniform mat4 u_world;
+uniform mat4 u_view;
+
+void main() {
+    gl_Position = u_projection * u_view * u_world * vec4(a_position, 1.0);
+}
\ No newline at end of file
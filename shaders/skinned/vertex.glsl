@@ -0,0 +1,51 @@
+#version 300 es
+
+precision highp float;
+precision highp int;
+
+layout(location=0) in vec3 a_position;
+layout(location=1) in vec3 a_normal;
+layout(location=2) in vec2 a_tex_coord;
+// The 4 strongest joints of the vertex and their weights (normalized bytes summing to 1).
+layout(location=3) in uvec4 a_joints;
+layout(location=4) in vec4 a_weights;
+
+uniform mat4 u_projection;
+uniform mat4 u_view;
+
+// One row per instance: the world matrix, then the skinning palette (see src/system/skinning.hpp).
+// Every matrix is stored as its first 3 rows, one texel each.
+uniform sampler2D u_palette;
+// Row of the draw's first instance.
+uniform int u_first_instance;
+
+out vec2 tex_coord;
+// View space, for clustered lighting.
+out vec3 view_position;
+out vec3 view_normal;
+
+mat4 palette_matrix(int row, int index) {
+    vec4 r0 = texelFetch(u_palette, ivec2(index * 3, row), 0);
+    vec4 r1 = texelFetch(u_palette, ivec2(index * 3 + 1, row), 0);
+    vec4 r2 = texelFetch(u_palette, ivec2(index * 3 + 2, row), 0);
+
+    return transpose(mat4(r0, r1, r2, vec4(0.0, 0.0, 0.0, 1.0)));
+}
+
+void main() {
+    int row = u_first_instance + gl_InstanceID;
+
+    // The palette starts after the world matrix.
+    mat4 skin = a_weights.x * palette_matrix(row, int(a_joints.x) + 1)
+        + a_weights.y * palette_matrix(row, int(a_joints.y) + 1)
+        + a_weights.z * palette_matrix(row, int(a_joints.z) + 1)
+        + a_weights.w * palette_matrix(row, int(a_joints.w) + 1);
+
+    mat4 model_view = u_view * palette_matrix(row, 0) * skin;
+    vec4 position = model_view * vec4(a_position, 1.0);
+
+    tex_coord = a_tex_coord;
+    view_position = position.xyz;
+    view_normal = transpose(inverse(mat3(model_view))) * a_normal;
+    gl_Position = u_projection * position;
+}
\ No newline at end of file
@@ -0,0 +1,13 @@
+#version 300 es
+
+precision highp float;
+
+uniform sampler2D u_texture;
+
+in vec2 uv;
+
+out vec4 color;
+
+void main() {
+    color = texture(u_texture, uv);
+}
\ No newline at end of file
@@ -0,0 +1,16 @@
+#version 300 es
+
+precision highp float;
+
+// Rectangle of the scaled target to sample (UV offset, UV size).
+uniform vec4 u_source;
+
+out vec2 uv;
+
+void main() {
+    // One triangle covering the viewport, without vertex buffers.
+    vec2 corner = vec2(float((gl_VertexID << 1) & 2), float(gl_VertexID & 2));
+
+    uv = u_source.xy + corner * u_source.zw;
+    gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,170 @@
+#include "animator.hpp"
+
+#include "../system/memory.hpp"
+
+#include <cmath>
+
+Animator::Animator(std::shared_ptr<Rig> rig, std::shared_ptr<ExtraMaterial> material) :
+    Component("Animator"),
+    speed(1.0f),
+    time(0.0f),
+    playing(true),
+    loop(true),
+    __rig(rig),
+    __material(material),
+    __clip(rig->clips.empty() ? -1 : 0),
+    __evaluated(false),
+    __evaluated_time(0.0f),
+    __evaluated_clip(-1),
+    __accounted(false),
+    __memory(pepng::memory())
+{}
+
+// The pose is evaluated again and the Transform bound again by init().
+Animator::Animator(const Animator& animator) :
+    Component(animator),
+    speed(animator.speed),
+    time(animator.time),
+    playing(animator.playing),
+    loop(animator.loop),
+    __rig(animator.__rig),
+    __material(animator.__material),
+    __clip(animator.__clip),
+    __evaluated(false),
+    __evaluated_time(0.0f),
+    __evaluated_clip(-1),
+    __accounted(false),
+    __memory(pepng::memory())
+{}
+
+Animator::~Animator() {
+    if(auto memory = this->__memory.lock()) {
+        if(auto texture = this->__observed_texture.lock()) {
+            memory->release(texture);
+        }
+    }
+}
+
+Animator* Animator::clone_implementation() {
+    return new Animator(*this);
+}
+
+std::shared_ptr<Animator> Animator::make_animator(std::shared_ptr<Rig> rig, std::shared_ptr<ExtraMaterial> material) {
+    std::shared_ptr<Animator> animator(new Animator(rig, material));
+
+    return animator;
+}
+
+std::shared_ptr<Animator> pepng::make_animator(std::shared_ptr<Rig> rig, std::shared_ptr<ExtraMaterial> material) {
+    return Animator::make_animator(rig, material);
+}
+
+void Animator::play(const std::string& clip) {
+    this->__clip = this->__rig->clip(clip);
+    this->time = 0.0f;
+    this->playing = true;
+}
+
+void Animator::init(std::shared_ptr<WithComponents> parent) {
+    auto transform = parent->get_component<Transform>();
+
+    if(transform == nullptr) {
+        std::stringstream ss;
+
+        ss << *parent << " has no Transform which Animator requires." << std::endl;
+
+        throw std::runtime_error(ss.str());
+    }
+
+    this->__transform = transform;
+}
+
+void Animator::update(std::shared_ptr<WithComponents> parent) {
+    // A ParallelUpdate higher in the hierarchy already ran this frame's update.
+    if(this->scheduled()) {
+        return;
+    }
+
+    this->sample_delta_time();
+    this->parallel_update(parent);
+}
+
+void Animator::parallel_update(std::shared_ptr<WithComponents> parent) {
+    if(!this->active()) {
+        return;
+    }
+
+    // The replayed frame time keeps recorded runs showing the same poses.
+    if(this->playing) {
+        this->time += this->delta_time() * this->speed;
+    }
+
+    const AnimationClip* clip = this->__clip >= 0 ? &this->__rig->clips[this->__clip] : nullptr;
+
+    // Wrapped here too, so long runs keep their float precision.
+    if(clip != nullptr && this->loop && clip->duration > 0.0f && this->time >= clip->duration) {
+        this->time = std::fmod(this->time, clip->duration);
+    }
+
+    if(this->__evaluated && this->__evaluated_time == this->time && this->__evaluated_clip == this->__clip) {
+        return;
+    }
+
+    this->__rig->evaluate(clip, this->time, this->loop, this->__pose);
+
+    this->__evaluated = true;
+    this->__evaluated_time = this->time;
+    this->__evaluated_clip = this->__clip;
+}
+
+void Animator::render(std::shared_ptr<WithComponents> parent) {
+    // Not bound to a Transform until init().
+    if(!this->active() || !this->__evaluated || this->__transform == nullptr) {
+        return;
+    }
+
+    auto texture = this->__material->texture_handle != nullptr
+        ? this->__material->texture_handle->acquire(this->__material)
+        : this->__material->texture;
+
+    // Reports the texture once (the Rig tracks its own buffers).
+    if(!this->__accounted) {
+        this->__accounted = true;
+
+        auto object = std::dynamic_pointer_cast<Object>(parent);
+
+        pepng::memory()->observe(texture, object != nullptr ? object->name : "Animator");
+        this->__observed_texture = texture;
+    }
+
+    auto world = this->__transform->parent_matrix * this->__transform->world_matrix();
+
+    pepng::skinning()->submit(this->__rig, texture->gl_index(), this->__material->color, world, this->__pose);
+}
+
+void Animator::remap(const std::function<std::shared_ptr<Component>(const std::shared_ptr<Component>&)>& map) {
+    if(auto transform = std::dynamic_pointer_cast<Transform>(map(this->__transform))) {
+        this->__transform = transform;
+    }
+}
+
+#ifdef IMGUI
+void Animator::imgui() {
+    Component::imgui();
+
+    ImGui::Text("Rig: %s (%zu joints, %zu skinned)", this->__rig->name.c_str(), this->__rig->joint_names.size(), this->__rig->palette_joints.size());
+
+    if(this->__clip >= 0) {
+        auto& clip = this->__rig->clips[this->__clip];
+
+        ImGui::Text("Clip: %s (%.2f s, %zu frames)", clip.name.c_str(), clip.duration, clip.frame_count);
+        ImGui::SliderFloat("Time", &this->time, 0.0f, clip.duration);
+    } else {
+        ImGui::Text("Clip: rest pose");
+    }
+
+    ImGui::Checkbox("Playing", &this->playing);
+    ImGui::Checkbox("Loop", &this->loop);
+    ImGui::SliderFloat("Speed", &this->speed, 0.0f, 4.0f);
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <pepng.h>
+
+#include "extra_material.hpp"
+#include "parallel_update.hpp"
+#include "../object/prefab.hpp"
+#include "../system/memory.hpp"
+#include "../system/skinning.hpp"
+
+/**
+ * Component playing a clip of a Rig on its Object, drawn by Skinning.
+ *
+ * The pose is evaluated in parallel_update and only writes the Animator's own SkinPose, so characters under
+ * a ParallelUpdate animate on the JobSystem. Clones share the Rig and material.
+ */
+class Animator : public Component, public ParallelSafe, public PrefabLinked {
+    public:
+        static std::shared_ptr<Animator> make_animator(std::shared_ptr<Rig> rig, std::shared_ptr<ExtraMaterial> material);
+
+        virtual ~Animator();
+
+        float speed;
+        // Seconds into the clip.
+        float time;
+        bool playing;
+        bool loop;
+
+        // Plays a clip of the Rig from its start (the rest pose if it has no clip of that name).
+        void play(const std::string& clip);
+
+        virtual void init(std::shared_ptr<WithComponents> parent) override;
+        virtual void update(std::shared_ptr<WithComponents> parent) override;
+        virtual void parallel_update(std::shared_ptr<WithComponents> parent) override;
+        virtual void render(std::shared_ptr<WithComponents> parent) override;
+        // Prefab copies draw with their own Transform.
+        virtual void remap(const std::function<std::shared_ptr<Component>(const std::shared_ptr<Component>&)>& map) override;
+
+        #ifdef IMGUI
+        virtual void imgui() override;
+        #endif
+
+    protected:
+        virtual Animator* clone_implementation() override;
+
+    private:
+        Animator(std::shared_ptr<Rig> rig, std::shared_ptr<ExtraMaterial> material);
+        Animator(const Animator& animator);
+
+        std::shared_ptr<Rig> __rig;
+        std::shared_ptr<ExtraMaterial> __material;
+        // Index in Rig::clips or -1.
+        int __clip;
+
+        SkinPose __pose;
+        // Paused characters keep their palette instead of evaluating it again.
+        bool __evaluated;
+        float __evaluated_time;
+        int __evaluated_clip;
+
+        bool __accounted;
+        // The reported texture, released on destruction (weak, Animators may outlive the tracker during teardown).
+        std::weak_ptr<Texture> __observed_texture;
+        std::weak_ptr<MemoryTracker> __memory;
+
+        std::shared_ptr<Transform> __transform;
+};
+
+namespace pepng {
+    std::shared_ptr<Animator> make_animator(std::shared_ptr<Rig> rig, std::shared_ptr<ExtraMaterial> material);
+};
\ No newline at end of file
@@ -0,0 +1,131 @@
+#include "capture_camera.hpp"
+
+#include "../system/debug_ui.hpp"
+
+CaptureCamera::CaptureCamera() :
+    Component("CaptureCamera"),
+    __path("captures"),
+    __size(512, 512),
+    __count(36),
+    __turntable(true),
+    __center(0.0f),
+    __radius(40.0f),
+    __height(15.0f)
+{}
+
+CaptureCamera::CaptureCamera(const CaptureCamera& capture_camera) :
+    Component(capture_camera),
+    __path(capture_camera.__path),
+    __size(capture_camera.__size),
+    __count(capture_camera.__count),
+    __turntable(capture_camera.__turntable),
+    __center(capture_camera.__center),
+    __radius(capture_camera.__radius),
+    __height(capture_camera.__height)
+{}
+
+CaptureCamera* CaptureCamera::clone_implementation() {
+    return new CaptureCamera(*this);
+}
+
+std::shared_ptr<CaptureCamera> CaptureCamera::make_capture_camera() {
+    std::shared_ptr<CaptureCamera> capture_camera(new CaptureCamera());
+
+    return capture_camera;
+}
+
+std::shared_ptr<CaptureCamera> pepng::make_capture_camera() {
+    return CaptureCamera::make_capture_camera();
+}
+
+void CaptureCamera::init(std::shared_ptr<WithComponents> parent) {
+    auto transform = parent->get_component<Transform>();
+
+    if(transform == nullptr) {
+        std::stringstream ss;
+
+        ss << *parent << " has no Transform which CaptureCamera requires." << std::endl;
+
+        throw std::runtime_error(ss.str());
+    }
+
+    this->__transform = transform;
+}
+
+void CaptureCamera::update(std::shared_ptr<WithComponents> parent) {
+    pepng::capture()->pose(this->__transform);
+}
+
+void CaptureCamera::render(std::shared_ptr<WithComponents> parent) {
+    #ifdef IMGUI
+    pepng::debug_section("Offscreen Capture", [this]() {
+        this->__controls();
+    });
+    #endif
+}
+
+#ifdef IMGUI
+void CaptureCamera::__controls() {
+    auto capture = pepng::capture();
+
+    char path[256];
+    std::snprintf(path, sizeof(path), "%s", this->__path.c_str());
+
+    if(ImGui::InputText("Directory", path, sizeof(path))) {
+        this->__path = path;
+    }
+
+    ImGui::InputInt2("Size", glm::value_ptr(this->__size));
+    ImGui::InputInt("Images", &this->__count);
+    ImGui::Checkbox("Turntable", &this->__turntable);
+
+    if(this->__turntable) {
+        ImGui::InputFloat3("Center", glm::value_ptr(this->__center));
+        ImGui::InputFloat("Radius", &this->__radius);
+        ImGui::InputFloat("Height", &this->__height);
+    }
+
+    if(!capture->active()) {
+        if(ImGui::Button("Capture")) {
+            try {
+                size_t count = (size_t) std::max(this->__count, 0);
+
+                if(this->__turntable) {
+                    capture->start(this->__path, this->__size, pepng::turntable(this->__center, this->__radius, this->__height, count));
+                } else {
+                    capture->start(this->__path, this->__size, count);
+                }
+
+                this->__error.clear();
+            } catch(const std::exception& error) {
+                // Also catches std::filesystem errors creating the directory.
+                this->__error = error.what();
+            }
+        }
+    } else if(ImGui::Button("Stop")) {
+        capture->stop();
+    }
+
+    auto stats = capture->stats();
+
+    if(stats.shots > 0) {
+        ImGui::Text("Rendered %zu / %zu, read back %zu, written %zu", stats.rendered, stats.shots, stats.read_back, stats.written);
+        ImGui::Text("Read back %.2f ms, encode %.2f ms, stalls %zu", stats.read_ms, stats.encode_ms, stats.stalls);
+    }
+
+    if(stats.failed > 0) {
+        ImGui::Text("Failed: %zu", stats.failed);
+        ImGui::TextWrapped("%s", capture->error().c_str());
+    }
+
+    if(!this->__error.empty()) {
+        ImGui::TextWrapped("%s", this->__error.c_str());
+    }
+}
+
+void CaptureCamera::imgui() {
+    Component::imgui();
+
+    this->__controls();
+}
+#endif
\ No newline at end of file
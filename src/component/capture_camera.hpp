@@ -0,0 +1,49 @@
+#pragma once
+
+#include <pepng.h>
+
+#include "../system/offscreen_capture.hpp"
+
+/**
+ * Component posing its Object for the shots of pepng::capture(), with the capture controls (also in the Debug window).
+ *
+ * Attach it after whatever moves the Object (the FPS controller and InputReplay of the camera) so the shot pose wins.
+ */
+class CaptureCamera : public Component {
+    public:
+        static std::shared_ptr<CaptureCamera> make_capture_camera();
+
+        virtual void init(std::shared_ptr<WithComponents> parent) override;
+        virtual void update(std::shared_ptr<WithComponents> parent) override;
+        virtual void render(std::shared_ptr<WithComponents> parent) override;
+
+        #ifdef IMGUI
+        virtual void imgui() override;
+        #endif
+
+    protected:
+        virtual CaptureCamera* clone_implementation() override;
+
+    private:
+        CaptureCamera();
+        CaptureCamera(const CaptureCamera& capture_camera);
+
+        #ifdef IMGUI
+        void __controls();
+        #endif
+
+        std::shared_ptr<Transform> __transform;
+
+        std::string __path;
+        glm::ivec2 __size;
+        int __count;
+        bool __turntable;
+        glm::vec3 __center;
+        float __radius;
+        float __height;
+        std::string __error;
+};
+
+namespace pepng {
+    std::shared_ptr<CaptureCamera> make_capture_camera();
+};
\ No newline at end of file
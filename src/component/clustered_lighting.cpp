@@ -0,0 +1,56 @@
+#include "clustered_lighting.hpp"
+
+#include "../system/debug_ui.hpp"
+
+ClusteredLighting::ClusteredLighting(std::shared_ptr<Lighting> lighting) :
+    Component("ClusteredLighting"),
+    __lighting(lighting)
+{}
+
+ClusteredLighting::ClusteredLighting(const ClusteredLighting& clustered_lighting) :
+    Component(clustered_lighting),
+    __lighting(clustered_lighting.__lighting)
+{}
+
+ClusteredLighting* ClusteredLighting::clone_implementation() {
+    return new ClusteredLighting(*this);
+}
+
+std::shared_ptr<ClusteredLighting> ClusteredLighting::make_clustered_lighting(std::shared_ptr<Lighting> lighting) {
+    std::shared_ptr<ClusteredLighting> clustered_lighting(new ClusteredLighting(lighting));
+
+    return clustered_lighting;
+}
+
+std::shared_ptr<ClusteredLighting> pepng::make_clustered_lighting(std::shared_ptr<Lighting> lighting) {
+    return ClusteredLighting::make_clustered_lighting(lighting);
+}
+
+void ClusteredLighting::render(std::shared_ptr<WithComponents> parent) {
+    #ifdef IMGUI
+    pepng::debug_section("Lighting", [this]() {
+        this->__controls();
+    });
+    #endif
+}
+
+#ifdef IMGUI
+void ClusteredLighting::__controls() {
+    ImGui::Checkbox("Enabled", &this->__lighting->enabled);
+    ImGui::ColorEdit3("Ambient", glm::value_ptr(this->__lighting->ambient));
+
+    auto& stats = this->__lighting->stats();
+
+    ImGui::Text("Lights: %zu (%zu visible)", stats.lights, stats.visible_lights);
+    ImGui::Text("Clusters: %zu / %d occupied", stats.occupied_clusters, Lighting::CLUSTERS_X * Lighting::CLUSTERS_Y * Lighting::CLUSTERS_Z);
+    ImGui::Text("Max lights per cluster: %zu", stats.max_cluster_lights);
+    ImGui::Text("Indices: %zu (%zu dropped)", stats.indices, stats.overflow);
+    ImGui::Text("Binning: %.3f ms", stats.bin_ms);
+}
+
+void ClusteredLighting::imgui() {
+    Component::imgui();
+
+    this->__controls();
+}
+#endif
\ No newline at end of file
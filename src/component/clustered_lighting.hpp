@@ -0,0 +1,36 @@
+#pragma once
+
+#include <pepng.h>
+
+#include "../system/lighting.hpp"
+
+/**
+ * Component exposing a Lighting: toggle, ambient and binning statistics (also in the Debug window).
+ */
+class ClusteredLighting : public Component {
+    public:
+        static std::shared_ptr<ClusteredLighting> make_clustered_lighting(std::shared_ptr<Lighting> lighting);
+
+        virtual void render(std::shared_ptr<WithComponents> parent) override;
+
+        #ifdef IMGUI
+        virtual void imgui() override;
+        #endif
+
+    protected:
+        virtual ClusteredLighting* clone_implementation() override;
+
+    private:
+        ClusteredLighting(std::shared_ptr<Lighting> lighting);
+        ClusteredLighting(const ClusteredLighting& clustered_lighting);
+
+        #ifdef IMGUI
+        void __controls();
+        #endif
+
+        std::shared_ptr<Lighting> __lighting;
+};
+
+namespace pepng {
+    std::shared_ptr<ClusteredLighting> make_clustered_lighting(std::shared_ptr<Lighting> lighting = pepng::lighting());
+};
\ No newline at end of file
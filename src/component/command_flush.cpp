@@ -0,0 +1,85 @@
+#include "command_flush.hpp"
+
+#include "../system/debug_draw.hpp"
+#include "../system/dynamic_resolution.hpp"
+#include "../system/multi_view.hpp"
+#include "../system/offscreen_capture.hpp"
+#include "../system/redraw.hpp"
+#include "../system/skinning.hpp"
+
+CommandFlush::CommandFlush(std::shared_ptr<CommandQueue> queue) :
+    Component("CommandFlush"),
+    sort_draws(true),
+    __queue(queue)
+{}
+
+CommandFlush::CommandFlush(const CommandFlush& command_flush) :
+    Component(command_flush),
+    sort_draws(command_flush.sort_draws),
+    __queue(command_flush.__queue)
+{}
+
+CommandFlush* CommandFlush::clone_implementation() {
+    return new CommandFlush(*this);
+}
+
+std::shared_ptr<CommandFlush> CommandFlush::make_command_flush(std::shared_ptr<CommandQueue> queue) {
+    std::shared_ptr<CommandFlush> command_flush(new CommandFlush(queue));
+
+    return command_flush;
+}
+
+std::shared_ptr<CommandFlush> pepng::make_command_flush(std::shared_ptr<CommandQueue> queue) {
+    return CommandFlush::make_command_flush(queue);
+}
+
+void CommandFlush::render(std::shared_ptr<WithComponents> parent) {
+    // Renderers record whether or not the flush is active: the slot is still submitted and replayed as recorded.
+    if(!this->active()) {
+        this->__sort_stats = CommandList::SortStats();
+        this->__queue->submit();
+        this->__queue->replay(false);
+
+        return;
+    }
+
+    // Animated characters are instanced per Rig (before MultiView moves the viewport to the extra views).
+    pepng::skinning()->record(this->__queue->record());
+
+    // Moves the renderers' draws after the other opaque work: opaque front to back, then blended back to front.
+    if(this->sort_draws) {
+        this->__sort_stats = this->__queue->record().sort();
+    } else {
+        this->__sort_stats = CommandList::SortStats();
+    }
+
+    // Draws submitted for several views are culled and recorded once the whole frame is known.
+    pepng::multi_view()->record(this->__queue->record());
+    pepng::debug_draw()->record(this->__queue->record());
+
+    // Identical lists draw identical frames, which lets redraw-on-demand idle (hashing is skipped while it is off).
+    if(pepng::redraw()->enabled) {
+        pepng::redraw()->submitted(this->__queue->record());
+    }
+    pepng::capture()->submitted();
+
+    this->__queue->submit();
+
+    // The list just submitted. The scene is replayed into the dynamic resolution target and upscaled into the window (or into the capture target).
+    pepng::capture()->render([this]() {
+        this->__queue->replay(false);
+    });
+}
+
+#ifdef IMGUI
+void CommandFlush::imgui() {
+    Component::imgui();
+
+    ImGui::Text("Draws: %zu", this->__queue->last_draw_count());
+    ImGui::Text("Commands: %zu", this->__queue->last_command_count());
+
+    ImGui::Checkbox("Sort draws", &this->sort_draws);
+    ImGui::Text("Opaque: %zu, alpha tested: %zu, blended: %zu", this->__sort_stats.opaque, this->__sort_stats.alpha_tested, this->__sort_stats.blended);
+    ImGui::Text("Sort: %.3f ms, reorder: %.3f ms", this->__sort_stats.sort_ms, this->__sort_stats.reorder_ms);
+}
+#endif
\ No newline at end of file
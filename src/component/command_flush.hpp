@@ -0,0 +1,45 @@
+#pragma once
+
+#include <pepng.h>
+
+#include "../system/command_list.hpp"
+
+/**
+ * Component that submits the CommandList recorded during this render pass and replays it.
+ *
+ * Attach it to the last instantiated Object (and FrameStart to the first), so the list is drawn at the end of
+ * the pass that recorded it: no frame of latency, and in step with anything still drawn with direct GL.
+ * Objects instantiated after it (prefabs spawned at runtime, files whose load callback fires later) render after
+ * the flush, so they record into the next list and are drawn one frame late.
+ *
+ * Inactive, the list is replayed as recorded: no sorting, skinned characters, extra views, debug draws, capture
+ * or dynamic resolution.
+ */
+class CommandFlush : public Component {
+    public:
+        static std::shared_ptr<CommandFlush> make_command_flush(std::shared_ptr<CommandQueue> queue);
+
+        // Sorts the draws by blend mode and depth before submitting (see CommandList::sort).
+        bool sort_draws;
+
+        virtual void render(std::shared_ptr<WithComponents> parent) override;
+
+        #ifdef IMGUI
+        virtual void imgui() override;
+        #endif
+
+    protected:
+        virtual CommandFlush* clone_implementation() override;
+
+    private:
+        CommandFlush(std::shared_ptr<CommandQueue> queue);
+        CommandFlush(const CommandFlush& command_flush);
+
+        std::shared_ptr<CommandQueue> __queue;
+
+        CommandList::SortStats __sort_stats;
+};
+
+namespace pepng {
+    std::shared_ptr<CommandFlush> make_command_flush(std::shared_ptr<CommandQueue> queue = pepng::commands());
+};
\ No newline at end of file
@@ -6,4 +6,5 @@
 
 #pragma once
 
+#include "parallel_update.hpp"
 #include "rotation.hpp"
\ No newline at end of file
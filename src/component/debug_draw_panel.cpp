@@ -0,0 +1,91 @@
+#include "debug_draw_panel.hpp"
+
+#include "../system/debug_ui.hpp"
+#include "../system/mesh.hpp"
+#include "../system/model_info.hpp"
+#include "../system/picking.hpp"
+
+DebugDrawPanel::DebugDrawPanel(std::shared_ptr<DebugDraw> debug_draw) :
+    Component("DebugDrawPanel"),
+    picked_bounds(true),
+    __debug_draw(debug_draw)
+{}
+
+DebugDrawPanel::DebugDrawPanel(const DebugDrawPanel& debug_draw_panel) :
+    Component(debug_draw_panel),
+    picked_bounds(debug_draw_panel.picked_bounds),
+    __debug_draw(debug_draw_panel.__debug_draw)
+{}
+
+DebugDrawPanel* DebugDrawPanel::clone_implementation() {
+    return new DebugDrawPanel(*this);
+}
+
+std::shared_ptr<DebugDrawPanel> DebugDrawPanel::make_debug_draw_panel(std::shared_ptr<DebugDraw> debug_draw) {
+    std::shared_ptr<DebugDrawPanel> debug_draw_panel(new DebugDrawPanel(debug_draw));
+
+    return debug_draw_panel;
+}
+
+std::shared_ptr<DebugDrawPanel> pepng::make_debug_draw_panel(std::shared_ptr<DebugDraw> debug_draw) {
+    return DebugDrawPanel::make_debug_draw_panel(debug_draw);
+}
+
+void DebugDrawPanel::update(std::shared_ptr<WithComponents> parent) {
+    if(!this->active() || !this->picked_bounds) {
+        return;
+    }
+
+    auto picked = pepng::picking()->picked();
+
+    if(picked == nullptr) {
+        return;
+    }
+
+    auto transform = picked->get_component<Transform>();
+    auto renderer = picked->get_component<Renderer>();
+
+    if(transform == nullptr || renderer == nullptr) {
+        return;
+    }
+
+    auto mesh = pepng::read_mesh(renderer->model);
+    auto world = pepng::model_matrix(transform, renderer->model);
+
+    if(mesh != nullptr) {
+        this->__debug_draw->aabb(mesh->min, mesh->max, glm::vec4(1.0f, 0.8f, 0.0f, 1.0f), world);
+    }
+
+    this->__debug_draw->axes(world, 1.0f);
+    this->__debug_draw->marker(glm::vec3(world[3]), picked->name, glm::vec4(1.0f, 0.8f, 0.0f, 1.0f));
+}
+
+void DebugDrawPanel::render(std::shared_ptr<WithComponents> parent) {
+    #ifdef IMGUI
+    pepng::debug_section("Debug Draw", [this]() {
+        this->__controls();
+    });
+    #endif
+}
+
+#ifdef IMGUI
+void DebugDrawPanel::__controls() {
+    auto debug_draw = this->__debug_draw;
+
+    ImGui::Checkbox("Enabled", &debug_draw->enabled);
+    ImGui::Checkbox("Light ranges", &debug_draw->light_ranges);
+    ImGui::Checkbox("Picked bounds", &this->picked_bounds);
+
+    auto& stats = debug_draw->stats();
+
+    ImGui::Text("Vertices: %zu (%zu on top)", stats.vertices + stats.overlay_vertices, stats.overlay_vertices);
+    ImGui::Text("Markers: %zu", stats.markers);
+    ImGui::Text("Draws: %zu", stats.draws);
+}
+
+void DebugDrawPanel::imgui() {
+    Component::imgui();
+
+    this->__controls();
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <pepng.h>
+
+#include "../system/debug_draw.hpp"
+
+/**
+ * Component exposing a DebugDraw (toggles and batch statistics, also in the Debug window).
+ *
+ * Outlines the picked Object with its bounds, axes and name when enabled.
+ */
+class DebugDrawPanel : public Component {
+    public:
+        static std::shared_ptr<DebugDrawPanel> make_debug_draw_panel(std::shared_ptr<DebugDraw> debug_draw);
+
+        bool picked_bounds;
+
+        virtual void update(std::shared_ptr<WithComponents> parent) override;
+        virtual void render(std::shared_ptr<WithComponents> parent) override;
+
+        #ifdef IMGUI
+        virtual void imgui() override;
+        #endif
+
+    protected:
+        virtual DebugDrawPanel* clone_implementation() override;
+
+    private:
+        DebugDrawPanel(std::shared_ptr<DebugDraw> debug_draw);
+        DebugDrawPanel(const DebugDrawPanel& debug_draw_panel);
+
+        #ifdef IMGUI
+        void __controls();
+        #endif
+
+        std::shared_ptr<DebugDraw> __debug_draw;
+};
+
+namespace pepng {
+    std::shared_ptr<DebugDrawPanel> make_debug_draw_panel(std::shared_ptr<DebugDraw> debug_draw = pepng::debug_draw());
+};
\ No newline at end of file
@@ -2,17 +2,28 @@
 
 ExtraMaterial::ExtraMaterial(GLuint shaderProgram, std::shared_ptr<Texture> texture, glm::vec3 color) : 
     Material(shaderProgram, texture),
-    color(color)
+    color(color),
+    blend_mode(BlendMode::NONE),
+    alpha(1.0f),
+    alpha_cutoff(0.5f)
 {}
 
 ExtraMaterial::ExtraMaterial(const ExtraMaterial& material) :
     Material(material),
-    color(material.color)
+    color(material.color),
+    blend_mode(material.blend_mode),
+    alpha(material.alpha),
+    alpha_cutoff(material.alpha_cutoff),
+    texture_handle(material.texture_handle),
+    texture_stream(material.texture_stream)
 {}
 
 ExtraMaterial::ExtraMaterial(const Material& material, glm::vec3 color) :
     Material(material),
-    color(color)
+    color(color),
+    blend_mode(BlendMode::NONE),
+    alpha(1.0f),
+    alpha_cutoff(0.5f)
 {}
 
 ExtraMaterial* ExtraMaterial::clone_implementation() {
@@ -37,4 +48,17 @@ std::shared_ptr<ExtraMaterial> ExtraMaterial::make_extra_material(std::shared_pt
 
 std::shared_ptr<ExtraMaterial> pepng::make_extra_material(std::shared_ptr<Material> material, glm::vec3 color) {
     return ExtraMaterial::make_extra_material(material, color);
+}
+
+std::shared_ptr<ExtraMaterial> ExtraMaterial::make_extra_material(GLuint shaderProgram, std::shared_ptr<TextureHandle> texture_handle, glm::vec3 color) {
+    // Nothing is loaded yet: the first renderer that wants the texture acquires it (see AssetStreaming).
+    std::shared_ptr<ExtraMaterial> material(new ExtraMaterial(shaderProgram, pepng::resources()->placeholder(), color));
+
+    material->texture_handle = texture_handle;
+
+    return material;
+}
+
+std::shared_ptr<ExtraMaterial> pepng::make_extra_material(GLuint shaderProgram, std::shared_ptr<TextureHandle> texture_handle, glm::vec3 color) {
+    return ExtraMaterial::make_extra_material(shaderProgram, texture_handle, color);
 }
\ No newline at end of file
@@ -2,14 +2,32 @@
 
 #include <pepng.h>
 
+#include "../system/command_list.hpp"
+#include "../system/resources.hpp"
+#include "../system/texture_stream.hpp"
+
 class ExtraMaterial : public Material {
     public:
         glm::vec3 color;
 
+        BlendMode blend_mode;
+        // Multiplies the alpha of blended materials.
+        float alpha;
+        // Alpha under which alpha tested materials discard fragments.
+        float alpha_cutoff;
+
+        // When set, the texture follows the handle (see ResourceManager).
+        std::shared_ptr<TextureHandle> texture_handle;
+
+        // When set (and playing), its presented frame replaces the texture (see StreamedTexture).
+        std::shared_ptr<TextureStream> texture_stream;
+
         static std::shared_ptr<ExtraMaterial> make_extra_material(GLuint shaderProgram, std::shared_ptr<Texture> texture, glm::vec3 color);
 
         static std::shared_ptr<ExtraMaterial> make_extra_material(std::shared_ptr<Material> material, glm::vec3 color);
 
+        static std::shared_ptr<ExtraMaterial> make_extra_material(GLuint shaderProgram, std::shared_ptr<TextureHandle> texture_handle, glm::vec3 color);
+
     protected:
         virtual ExtraMaterial* clone_implementation() override;
 
@@ -22,4 +40,6 @@ namespace pepng {
     std::shared_ptr<ExtraMaterial> make_extra_material(GLuint shaderProgram, std::shared_ptr<Texture> texture, glm::vec3 color = glm::vec3(-1.0f));
 
     std::shared_ptr<ExtraMaterial> make_extra_material(std::shared_ptr<Material> material, glm::vec3 color = glm::vec3(-1.0f));
+
+    std::shared_ptr<ExtraMaterial> make_extra_material(GLuint shaderProgram, std::shared_ptr<TextureHandle> texture_handle, glm::vec3 color = glm::vec3(-1.0f));
 };
\ No newline at end of file
@@ -1,12 +1,37 @@
 #include "extra_renderer.hpp"
 
+#include "../system/asset_streaming.hpp"
+#include "../system/command_list.hpp"
+#include "../system/lighting.hpp"
+#include "../system/lod.hpp"
+#include "../system/memory.hpp"
+#include "../system/model_info.hpp"
+#include "../system/multi_view.hpp"
+#include "../system/occlusion.hpp"
+#include "../system/picking.hpp"
+#include "../system/render_mode.hpp"
+#include "../system/texture_info.hpp"
+#include "../system/view.hpp"
+
 ExtraRenderer::ExtraRenderer(std::shared_ptr<Model> model, std::shared_ptr<ExtraMaterial> material, GLenum render_mode) :
     Renderer(model, material, render_mode),
-    extra_material(material)
+    extra_material(material),
+    __render_mode(render_mode)
+{}
+
+ExtraRenderer::ExtraRenderer(std::shared_ptr<ModelHandle> model_handle, std::shared_ptr<ExtraMaterial> material, GLenum render_mode) :
+    Renderer(pepng::asset_streaming()->placeholder(), material, render_mode),
+    extra_material(material),
+    model_handle(model_handle),
+    __render_mode(render_mode)
 {}
 
 ExtraRenderer::ExtraRenderer(const ExtraRenderer& renderer) :
-    Renderer(renderer)
+    Renderer(renderer),
+    model_handle(renderer.model_handle),
+    __render_mode(renderer.__render_mode),
+    __classify(renderer.__classify),
+    __streamed(renderer.__streamed)
 {
     auto material = std::dynamic_pointer_cast<ExtraMaterial>(renderer.extra_material->clone());
 
@@ -15,12 +40,44 @@ ExtraRenderer::ExtraRenderer(const ExtraRenderer& renderer) :
 }
 
 ExtraRenderer::ExtraRenderer(const Renderer& renderer) :
-    Renderer(renderer)
+    Renderer(renderer),
+    __render_mode(GL_TRIANGLES),
+    __classify(true)
 {
     auto material = pepng::make_extra_material(renderer.material);
 
     this->extra_material = material;
     this->material = material;
+
+    // Converted right after the file is loaded: the texture is classified now if it is already uploaded.
+    this->__classify_texture();
+}
+
+ExtraRenderer::ExtraRenderer(const ExtraRenderer& renderer, std::shared_ptr<ExtraMaterial> material) :
+    Renderer(renderer),
+    extra_material(material),
+    model_handle(renderer.model_handle),
+    __render_mode(renderer.__render_mode),
+    __classify(renderer.__classify),
+    __streamed(renderer.__streamed)
+{
+    this->material = material;
+}
+
+ExtraRenderer::~ExtraRenderer() {
+    if(auto occlusion = this->__occlusion.lock()) {
+        occlusion->forget(this);
+    }
+
+    if(auto memory = this->__memory.lock()) {
+        if(auto model = this->__observed_model.lock()) {
+            memory->release(model);
+        }
+
+        if(auto texture = this->__observed_texture.lock()) {
+            memory->release(texture);
+        }
+    }
 }
 
 ExtraRenderer* ExtraRenderer::clone_implementation() {
@@ -28,23 +85,202 @@ ExtraRenderer* ExtraRenderer::clone_implementation() {
 }
 
 void ExtraRenderer::render(std::shared_ptr<WithComponents> parent) {
+    if(!this->model->is_init()) {
+        this->model->delayed_init();
+    }
+
+    if(this->model->vao() == (GLuint) -1 || !this->active()) {
+        return;
+    }
+
+    auto transform = parent->get_component<Transform>();
+
+    if(transform == nullptr) {
+        std::stringstream ss;
+
+        ss << *parent << " has no transform." << std::endl;
+
+        throw std::runtime_error(ss.str());
+    }
+
+    auto object = std::dynamic_pointer_cast<Object>(parent);
+
+    // Textures uploaded after the conversion are classified on their first draw (once).
+    this->__classify_texture();
+
     auto shaderProgram = this->material->shader_program();
 
-    glUseProgram(shaderProgram);
+    auto& view = pepng::current_view();
+    auto world_matrix = pepng::model_matrix(transform, this->model);
 
-    GLuint u_has_color = glGetUniformLocation(shaderProgram, "u_has_color");
+    auto& handle = this->model_handle;
+    auto& texture_handle = this->extra_material->texture_handle;
 
-    if(this->extra_material->color.x >= 0) {
-        glUniform1f(u_has_color, GL_TRUE);
+    // Handles only load what is in view (or soon will be) and near, see AssetStreaming.
+    bool wanted = true;
+
+    if(handle != nullptr) {
+        wanted = pepng::asset_streaming()->wanted(view, world_matrix, handle->min, handle->max);
+    } else if(texture_handle != nullptr && !texture_handle->resident()) {
+        auto bounds = pepng::read_mesh(this->model);
+
+        wanted = bounds == nullptr || pepng::asset_streaming()->wanted(view, world_matrix, bounds->min, bounds->max);
+    }
+
+    bool placeholder = false;
+
+    if(handle != nullptr && !this->__streamed) {
+        if(wanted) {
+            handle->request();
+        }
+
+        if(auto loaded = handle->model()) {
+            this->model = loaded;
+            this->__streamed = true;
+
+            world_matrix = pepng::model_matrix(transform, this->model);
+        } else {
+            // The placeholder box covers the bounds (a unit box until the file is parsed).
+            placeholder = true;
+            world_matrix = world_matrix * handle->box();
+        }
+    }
+
+    // Reports the resources once they are the real ones (the memory panel measures them on demand).
+    if(!this->__accounted && !placeholder && (texture_handle == nullptr || texture_handle->resident())) {
+        this->__accounted = true;
+
+        auto owner = object != nullptr ? object->name : "ExtraRenderer";
+
+        // Files are only known through handles (engine loaders don't keep their path).
+        pepng::memory()->observe(this->model, owner, handle != nullptr ? handle->path().string() : "");
+        pepng::memory()->observe(this->material->texture, owner, texture_handle != nullptr ? texture_handle->path().string() : "");
+
+        this->__observed_model = this->model;
+        this->__observed_texture = this->material->texture;
+    }
+
+    auto model = this->model;
+
+    if(auto lods = pepng::lod_group(this->model)) {
+        this->__lod = lods->select(view, world_matrix, this->__lod);
+
+        model = lods->level(this->__lod);
+
+        if(model == nullptr) {
+            model = this->model;
+        } else if(!model->is_init()) {
+            model->delayed_init();
+        }
+    }
+
+    if(this->__render_mode == GL_TRIANGLES) {
+        if(object != nullptr) {
+            pepng::picking()->add(object, world_matrix, model, pepng::read_mesh(this->model));
+        }
+    }
 
-        GLuint u_color = glGetUniformLocation(shaderProgram, "u_color");
+    auto multi_view = pepng::multi_view();
 
-        glUniform3fv(u_color, 1, glm::value_ptr(this->extra_material->color));
+    // Culled and recorded once per view by MultiView, which shares the bounds and world matrix between views.
+    if(multi_view->active()) {
+        auto texture = placeholder ? pepng::resources()->placeholder() : this->__texture(wanted);
+        auto bounds = pepng::read_mesh(this->model);
+
+        multi_view->submit(MultiView::Item {
+            shaderProgram,
+            world_matrix,
+            bounds != nullptr ? bounds->min : glm::vec3(-MultiView::UNBOUNDED),
+            bounds != nullptr ? bounds->max : glm::vec3(MultiView::UNBOUNDED),
+            model,
+            this->__render_mode,
+            this->__texture_name(texture),
+            this->extra_material->color
+        }, view);
+
+        return;
+    }
+
+    auto& list = pepng::commands()->record();
+    auto bounds = pepng::read_mesh(this->model);
+    auto blend_mode = this->extra_material->blend_mode;
+
+    // Sorted by the view space depth of the bounds' center.
+    glm::vec4 center = view.view * world_matrix * glm::vec4(bounds != nullptr ? bounds->center : glm::vec3(0.0f), 1.0f);
+
+    list.begin_item(blend_mode, -center.z);
+    list.use_program(shaderProgram);
+    list.uniform(pepng::uniform_location(shaderProgram, "u_projection"), view.projection);
+    list.uniform(pepng::uniform_location(shaderProgram, "u_view"), view.view);
+    pepng::lighting()->record(list, shaderProgram, view);
+
+    GLint u_has_color = pepng::uniform_location(shaderProgram, "u_has_color");
+
+    if(this->extra_material->color.x >= 0) {
+        list.uniform(u_has_color, (float) GL_TRUE);
+        list.uniform(pepng::uniform_location(shaderProgram, "u_color"), this->extra_material->color);
     } else {
-        glUniform1f(u_has_color, GL_FALSE);
+        list.uniform(u_has_color, (float) GL_FALSE);
     }
 
-    Renderer::render(parent);
+    list.uniform(pepng::uniform_location(shaderProgram, "u_alpha_cutoff"), blend_mode == BlendMode::ALPHA_TEST ? this->extra_material->alpha_cutoff : 0.0f);
+    list.uniform(pepng::uniform_location(shaderProgram, "u_blend"), (float) (blend_mode == BlendMode::ALPHA_BLEND));
+    list.uniform(pepng::uniform_location(shaderProgram, "u_alpha"), this->extra_material->alpha);
+
+    GLint u_world = pepng::uniform_location(shaderProgram, "u_world");
+
+    // LOD levels share the bounds of the original Model.
+    pepng::occlusion()->record(this, list, shaderProgram, view, world_matrix, bounds, [&]() {
+        // Only drawn textures count as visible for the ResourceManager (and are reloaded if evicted).
+        auto texture = placeholder ? pepng::resources()->placeholder() : this->__texture(wanted);
+
+        list.bind_texture(0, GL_TEXTURE_2D, this->__texture_name(texture));
+        list.uniform(u_world, world_matrix);
+        pepng::record_draw_override(list, model, this->__render_mode);
+    });
+
+    list.end_item();
+}
+
+void ExtraRenderer::__classify_texture() {
+    // Loaded materials only know their texture, whose alpha decides how they are drawn.
+    if(!this->__classify || this->extra_material->color.x >= 0 || this->material->texture->gl_index() == 0) {
+        return;
+    }
+
+    this->extra_material->blend_mode = pepng::texture_blend_mode(this->material->texture);
+    this->__classify = false;
+}
+
+GLuint ExtraRenderer::__texture_name(std::shared_ptr<Texture> texture) {
+    auto& stream = this->extra_material->texture_stream;
+
+    if(stream != nullptr && stream->texture() != 0) {
+        return stream->texture();
+    }
+
+    return texture->gl_index();
+}
+
+std::shared_ptr<Texture> ExtraRenderer::__texture(bool wanted) {
+    auto& handle = this->extra_material->texture_handle;
+
+    if(handle == nullptr) {
+        return this->material->texture;
+    }
+
+    if(!handle->resident()) {
+        if(wanted) {
+            pepng::asset_streaming()->prefetch(handle);
+        }
+
+        // The file is read on the loader thread first, so the upload does not wait on the disk.
+        if(!wanted || !handle->read() || !pepng::asset_streaming()->upload()) {
+            return pepng::resources()->placeholder();
+        }
+    }
+
+    return handle->acquire(this->material);
 }
 
 std::shared_ptr<ExtraRenderer> ExtraRenderer::make_extra_renderer(std::shared_ptr<Model> model, std::shared_ptr<ExtraMaterial> material, GLenum render_mode) {
@@ -57,6 +293,16 @@ std::shared_ptr<ExtraRenderer> pepng::make_extra_renderer(std::shared_ptr<Model>
     return ExtraRenderer::make_extra_renderer(model, material, render_mode);
 }
 
+std::shared_ptr<ExtraRenderer> ExtraRenderer::make_extra_renderer(std::shared_ptr<ModelHandle> model_handle, std::shared_ptr<ExtraMaterial> material, GLenum render_mode) {
+    std::shared_ptr<ExtraRenderer> renderer(new ExtraRenderer(model_handle, material, render_mode));
+
+    return renderer;
+}
+
+std::shared_ptr<ExtraRenderer> pepng::make_extra_renderer(std::shared_ptr<ModelHandle> model_handle, std::shared_ptr<ExtraMaterial> material, GLenum render_mode) {
+    return ExtraRenderer::make_extra_renderer(model_handle, material, render_mode);
+}
+
 std::shared_ptr<ExtraRenderer> ExtraRenderer::make_extra_renderer(std::shared_ptr<Renderer> renderer) {
     std::shared_ptr<ExtraRenderer> extra_renderer(new ExtraRenderer(*renderer));
 
@@ -67,8 +313,26 @@ std::shared_ptr<ExtraRenderer> pepng::make_extra_renderer(std::shared_ptr<Render
     return ExtraRenderer::make_extra_renderer(renderer);
 }
 
+std::shared_ptr<ExtraRenderer> ExtraRenderer::make_extra_renderer_instance(std::shared_ptr<ExtraRenderer> renderer) {
+    std::shared_ptr<ExtraRenderer> instance(new ExtraRenderer(*renderer, renderer->extra_material));
+
+    return instance;
+}
+
+std::shared_ptr<ExtraRenderer> pepng::make_extra_renderer_instance(std::shared_ptr<ExtraRenderer> renderer) {
+    return ExtraRenderer::make_extra_renderer_instance(renderer);
+}
+
 #ifdef IMGUI
 void ExtraRenderer::imgui() {
     Renderer::imgui();
+
+    if(this->model_handle != nullptr) {
+        ImGui::Text("Model: %s (%s)", this->model_handle->path().filename().string().c_str(), this->__streamed ? "resident" : (this->model_handle->pending() ? "loading" : "placeholder"));
+    }
+
+    if(auto lods = pepng::lod_group(this->model)) {
+        ImGui::Text("LOD: %zu / %zu (%zu triangles)", this->__lod, lods->level_count() - 1, lods->triangle_counts[this->__lod]);
+    }
 }
 #endif
\ No newline at end of file
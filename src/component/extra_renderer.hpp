@@ -2,14 +2,28 @@
 
 #include <pepng.h>
 #include "extra_material.hpp"
+#include "../system/asset_streaming.hpp"
+#include "../system/memory.hpp"
+#include "../system/occlusion.hpp"
 
 class ExtraRenderer : public Renderer {
     public:
         std::shared_ptr<ExtraMaterial> extra_material;
 
+        // When set, the Model is loaded once the object is wanted and the placeholder box is drawn until then (see AssetStreaming).
+        std::shared_ptr<ModelHandle> model_handle;
+
         static std::shared_ptr<ExtraRenderer> make_extra_renderer(std::shared_ptr<Model> model, std::shared_ptr<ExtraMaterial> material, GLenum render_mode);
+        static std::shared_ptr<ExtraRenderer> make_extra_renderer(std::shared_ptr<ModelHandle> model_handle, std::shared_ptr<ExtraMaterial> material, GLenum render_mode);
         static std::shared_ptr<ExtraRenderer> make_extra_renderer(std::shared_ptr<Renderer> renderer);
+        // Copy that shares the Model and ExtraMaterial (used by Prefab).
+        static std::shared_ptr<ExtraRenderer> make_extra_renderer_instance(std::shared_ptr<ExtraRenderer> renderer);
+
+        // Releases its occlusion query (if the Occlusion still exists).
+        virtual ~ExtraRenderer();
 
+        // Records the draw into pepng::commands() instead of issuing GL directly (unless occluded, see Occlusion),
+        // as an item CommandFlush sorts by the material's BlendMode and depth.
         virtual void render(std::shared_ptr<WithComponents> parent) override;
 
         #ifdef IMGUI
@@ -20,11 +34,47 @@ class ExtraRenderer : public Renderer {
         virtual ExtraRenderer* clone_implementation() override;
 
         ExtraRenderer(std::shared_ptr<Model> model, std::shared_ptr<ExtraMaterial> material, GLenum render_mode);
+        ExtraRenderer(std::shared_ptr<ModelHandle> model_handle, std::shared_ptr<ExtraMaterial> material, GLenum render_mode);
         ExtraRenderer(const ExtraRenderer& renderer);
         ExtraRenderer(const Renderer& renderer);
+        ExtraRenderer(const ExtraRenderer& renderer, std::shared_ptr<ExtraMaterial> material);
+
+    private:
+        // Sets the material's BlendMode from its texture's alpha, once the texture is uploaded (converted renderers only).
+        void __classify_texture();
+
+        // The streamed frame if the material plays a TextureStream, the texture otherwise.
+        GLuint __texture_name(std::shared_ptr<Texture> texture);
+
+        // The material's texture, or the placeholder while its handle is not resident and not wanted (or not read ahead yet, or over the upload budget).
+        std::shared_ptr<Texture> __texture(bool wanted);
+
+        // The base Renderer does not expose its mode, so it is kept here (GL_TRIANGLES when converted).
+        GLenum __render_mode;
+
+        // Level of detail drawn last frame (see LodGroup).
+        size_t __lod = 0;
+
+        // Owner of its occlusion query. Weak, so renderers destroyed during static teardown do not reach a destroyed Occlusion.
+        std::weak_ptr<Occlusion> __occlusion = pepng::occlusion();
+
+        // Whether the Model/Texture were reported to pepng::memory().
+        bool __accounted = false;
+        // What was reported, released on destruction (weak for the same reason as __occlusion).
+        std::weak_ptr<Model> __observed_model;
+        std::weak_ptr<Texture> __observed_texture;
+        std::weak_ptr<MemoryTracker> __memory = pepng::memory();
+
+        // Converted renderers pick their material's BlendMode from its texture once it is uploaded (see __classify_texture).
+        bool __classify = false;
+
+        // Whether the Model is model_handle's (and no longer the placeholder).
+        bool __streamed = false;
 };
 
 namespace pepng {
     std::shared_ptr<ExtraRenderer> make_extra_renderer(std::shared_ptr<Model> model, std::shared_ptr<ExtraMaterial> material, GLenum render_mode = GL_TRIANGLES);
+    std::shared_ptr<ExtraRenderer> make_extra_renderer(std::shared_ptr<ModelHandle> model_handle, std::shared_ptr<ExtraMaterial> material, GLenum render_mode = GL_TRIANGLES);
     std::shared_ptr<ExtraRenderer> make_extra_renderer(std::shared_ptr<Renderer> renderer);
+    std::shared_ptr<ExtraRenderer> make_extra_renderer_instance(std::shared_ptr<ExtraRenderer> renderer);
 };
\ No newline at end of file
@@ -0,0 +1,36 @@
+#include "frame_start.hpp"
+
+#include "../system/input_log.hpp"
+#include "../system/view.hpp"
+
+FrameStart::FrameStart(GLuint program) :
+    Component("FrameStart"),
+    __program(program)
+{}
+
+FrameStart::FrameStart(const FrameStart& frame_start) :
+    Component(frame_start),
+    __program(frame_start.__program)
+{}
+
+FrameStart* FrameStart::clone_implementation() {
+    return new FrameStart(*this);
+}
+
+std::shared_ptr<FrameStart> FrameStart::make_frame_start(GLuint program) {
+    std::shared_ptr<FrameStart> frame_start(new FrameStart(program));
+
+    return frame_start;
+}
+
+std::shared_ptr<FrameStart> pepng::make_frame_start(GLuint program) {
+    return FrameStart::make_frame_start(program);
+}
+
+void FrameStart::update(std::shared_ptr<WithComponents> parent) {
+    pepng::input_log()->begin_frame();
+}
+
+void FrameStart::render(std::shared_ptr<WithComponents> parent) {
+    pepng::read_view(this->__program);
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <pepng.h>
+
+/**
+ * Component that starts the frame: advances the InputLog before any update reads it, and reads this
+ * frame's View before any renderer records (see pepng::read_view).
+ *
+ * Attach it to the first instantiated Object, and CommandFlush to the last.
+ */
+class FrameStart : public Component {
+    public:
+        /**
+         * @param program A shader program declaring u_view and u_projection (the camera is read through it).
+         */
+        static std::shared_ptr<FrameStart> make_frame_start(GLuint program);
+
+        virtual void update(std::shared_ptr<WithComponents> parent) override;
+        virtual void render(std::shared_ptr<WithComponents> parent) override;
+
+    protected:
+        virtual FrameStart* clone_implementation() override;
+
+    private:
+        FrameStart(GLuint program);
+        FrameStart(const FrameStart& frame_start);
+
+        GLuint __program;
+};
+
+namespace pepng {
+    std::shared_ptr<FrameStart> make_frame_start(GLuint program);
+};
\ No newline at end of file
@@ -0,0 +1,118 @@
+#include "input_replay.hpp"
+
+#include "../system/debug_ui.hpp"
+
+InputReplay::InputReplay(const std::string& pose) :
+    Component("InputReplay"),
+    __slot(pepng::input_log()->track_pose(pose)),
+    __path("input.pepi")
+{}
+
+// Clones share the pose slot. init() binds the copy to its own Object's Transform.
+InputReplay::InputReplay(const InputReplay& input_replay) :
+    Component(input_replay),
+    __slot(input_replay.__slot),
+    __path(input_replay.__path)
+{}
+
+InputReplay* InputReplay::clone_implementation() {
+    return new InputReplay(*this);
+}
+
+std::shared_ptr<InputReplay> InputReplay::make_input_replay(const std::string& pose) {
+    std::shared_ptr<InputReplay> input_replay(new InputReplay(pose));
+
+    return input_replay;
+}
+
+std::shared_ptr<InputReplay> pepng::make_input_replay(const std::string& pose) {
+    return InputReplay::make_input_replay(pose);
+}
+
+void InputReplay::init(std::shared_ptr<WithComponents> parent) {
+    auto transform = parent->get_component<Transform>();
+
+    if(transform == nullptr) {
+        std::stringstream ss;
+
+        ss << *parent << " has no Transform which InputReplay requires." << std::endl;
+
+        throw std::runtime_error(ss.str());
+    }
+
+    this->__transform = transform;
+}
+
+void InputReplay::update(std::shared_ptr<WithComponents> parent) {
+    pepng::input_log()->pose(this->__slot, this->__transform);
+}
+
+void InputReplay::render(std::shared_ptr<WithComponents> parent) {
+    #ifdef IMGUI
+    pepng::debug_section("Input Replay", [this]() {
+        this->__controls();
+    });
+    #endif
+}
+
+#ifdef IMGUI
+void InputReplay::__controls() {
+    auto log = pepng::input_log();
+
+    char path[256];
+    std::snprintf(path, sizeof(path), "%s", this->__path.c_str());
+
+    if(ImGui::InputText("Log", path, sizeof(path))) {
+        this->__path = path;
+    }
+
+    auto mode = log->mode();
+
+    // Log errors (bad file, other labels) are shown instead of ending the app.
+    auto guarded = [this](const std::function<void()>& action) {
+        try {
+            action();
+            this->__error.clear();
+        } catch(const std::runtime_error& error) {
+            this->__error = error.what();
+        }
+    };
+
+    if(mode == InputLog::Mode::IDLE) {
+        if(ImGui::Button("Record")) {
+            guarded([&]() { log->record(this->__path); });
+        }
+
+        ImGui::SameLine();
+
+        if(ImGui::Button("Replay")) {
+            guarded([&]() { log->replay(this->__path); });
+        }
+    } else if(ImGui::Button("Stop")) {
+        guarded([&]() { log->stop(); });
+    }
+
+    if(mode == InputLog::Mode::RECORDING) {
+        ImGui::Text("Recording: %zu frames", log->frame_index());
+    } else if(mode == InputLog::Mode::REPLAYING) {
+        ImGui::Text("Replaying: %zu / %zu", log->frame_index(), log->frame_count());
+    }
+
+    auto& stats = log->last_replay();
+
+    if(stats.frames > 0) {
+        ImGui::Text("Last replay: %zu frames, avg %.2f ms, GPU %.2f ms", stats.frames, stats.average_ms, stats.gpu_ms);
+        ImGui::Text("p50 %.2f / p95 %.2f / p99 %.2f ms", stats.p50_ms, stats.p95_ms, stats.p99_ms);
+    }
+
+    if(!this->__error.empty()) {
+        ImGui::TextWrapped("%s", this->__error.c_str());
+    }
+}
+
+void InputReplay::imgui() {
+    Component::imgui();
+
+    this->__controls();
+}
+#endif
\ No newline at end of file
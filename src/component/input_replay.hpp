@@ -0,0 +1,47 @@
+#pragma once
+
+#include <pepng.h>
+
+#include "../system/input_log.hpp"
+
+/**
+ * Component recording/replaying its Object's pose through the InputLog, with the record/replay controls (also in the Debug window).
+ *
+ * Attach it after whatever moves the Object (the FPS controller of the camera) so the replayed pose wins.
+ */
+class InputReplay : public Component {
+    public:
+        static std::shared_ptr<InputReplay> make_input_replay(const std::string& pose);
+
+        virtual void init(std::shared_ptr<WithComponents> parent) override;
+        virtual void update(std::shared_ptr<WithComponents> parent) override;
+        virtual void render(std::shared_ptr<WithComponents> parent) override;
+
+        #ifdef IMGUI
+        virtual void imgui() override;
+        #endif
+
+    protected:
+        virtual InputReplay* clone_implementation() override;
+
+    private:
+        InputReplay(const std::string& pose);
+        InputReplay(const InputReplay& input_replay);
+
+        #ifdef IMGUI
+        void __controls();
+        #endif
+
+        size_t __slot;
+        std::shared_ptr<Transform> __transform;
+
+        std::string __path;
+        std::string __error;
+};
+
+namespace pepng {
+    /**
+     * @param pose Name of the pose slot (must be the same when recording and replaying).
+     */
+    std::shared_ptr<InputReplay> make_input_replay(const std::string& pose = "camera");
+};
\ No newline at end of file
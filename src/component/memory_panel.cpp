@@ -0,0 +1,161 @@
+#include "memory_panel.hpp"
+
+#include <map>
+
+#include "../system/debug_ui.hpp"
+#include "../system/resources.hpp"
+
+MemoryPanel::MemoryPanel(std::shared_ptr<MemoryTracker> memory_tracker, size_t top) :
+    Component("MemoryPanel"),
+    __memory_tracker(memory_tracker),
+    __top(top),
+    __frames_since_refresh(MemoryPanel::REFRESH_FRAMES)
+{}
+
+MemoryPanel::MemoryPanel(const MemoryPanel& memory_panel) :
+    Component(memory_panel),
+    __memory_tracker(memory_panel.__memory_tracker),
+    __top(memory_panel.__top),
+    __frames_since_refresh(MemoryPanel::REFRESH_FRAMES)
+{}
+
+MemoryPanel* MemoryPanel::clone_implementation() {
+    return new MemoryPanel(*this);
+}
+
+std::shared_ptr<MemoryPanel> MemoryPanel::make_memory_panel(std::shared_ptr<MemoryTracker> memory_tracker, size_t top) {
+    std::shared_ptr<MemoryPanel> memory_panel(new MemoryPanel(memory_tracker, top));
+
+    return memory_panel;
+}
+
+std::shared_ptr<MemoryPanel> pepng::make_memory_panel(std::shared_ptr<MemoryTracker> memory_tracker, size_t top) {
+    return MemoryPanel::make_memory_panel(memory_tracker, top);
+}
+
+void MemoryPanel::render(std::shared_ptr<WithComponents> parent) {
+    #ifdef IMGUI
+    pepng::debug_section("Memory", [this]() {
+        this->__controls();
+    });
+    #endif
+}
+
+#ifdef IMGUI
+namespace {
+    std::string format_bytes(size_t bytes) {
+        std::stringstream ss;
+
+        ss.precision(2);
+        ss << std::fixed;
+
+        if(bytes >= 1024 * 1024) {
+            ss << bytes / (1024.0 * 1024.0) << " MiB";
+        } else if(bytes >= 1024) {
+            ss << bytes / 1024.0 << " KiB";
+        } else {
+            ss << bytes << " B";
+        }
+
+        return ss.str();
+    }
+}
+
+void MemoryPanel::__controls() {
+    // Only measured while the panel is open. Hashing reads GL memory back, so it is on demand.
+    if(++this->__frames_since_refresh >= MemoryPanel::REFRESH_FRAMES) {
+        this->__records = this->__memory_tracker->snapshot(false);
+        this->__frames_since_refresh = 0;
+    }
+
+    if(ImGui::Button("Find duplicates")) {
+        this->__records = this->__memory_tracker->snapshot(true);
+        this->__duplicates = MemoryTracker::duplicates(this->__records);
+        this->__frames_since_refresh = 0;
+
+        std::stringstream ss;
+        ss << this->__duplicates.size() << " duplicate groups";
+        this->__status = ss.str();
+    }
+
+    ImGui::SameLine();
+
+    if(ImGui::Button("Dump JSON")) {
+        try {
+            this->__memory_tracker->dump("memory.json");
+            this->__status = "Wrote memory.json";
+        } catch(const std::runtime_error& error) {
+            this->__status = error.what();
+        }
+    }
+
+    if(!this->__status.empty()) {
+        ImGui::TextDisabled("%s", this->__status.c_str());
+    }
+
+    std::map<std::string, std::pair<size_t, size_t>> totals;
+    size_t gpu_bytes = 0, cpu_bytes = 0;
+
+    for(auto& record : this->__records) {
+        totals[record.tag].first += record.gpu_bytes;
+        totals[record.tag].second += record.cpu_bytes;
+        gpu_bytes += record.gpu_bytes;
+        cpu_bytes += record.cpu_bytes;
+    }
+
+    ImGui::Text("Total: GPU %s, CPU %s", format_bytes(gpu_bytes).c_str(), format_bytes(cpu_bytes).c_str());
+
+    auto resources = pepng::resources();
+
+    ImGui::Text("Resource textures: %zu, %s / %s budget, %zu evictions",
+        resources->texture_count(),
+        format_bytes(resources->resident_bytes()).c_str(),
+        format_bytes(resources->budget()).c_str(),
+        resources->eviction_count());
+
+    for(auto& [tag, total] : totals) {
+        ImGui::BulletText("%s: GPU %s, CPU %s", tag.c_str(), format_bytes(total.first).c_str(), format_bytes(total.second).c_str());
+    }
+
+    ImGui::Separator();
+    ImGui::Text("Largest");
+
+    for(size_t i = 0; i < this->__records.size() && i < this->__top; i++) {
+        auto& record = this->__records[i];
+
+        ImGui::BulletText("%s %s%s%s (x%zu): GPU %s, CPU %s",
+            record.tag.c_str(),
+            record.owner.c_str(),
+            record.source.empty() ? "" : " ",
+            record.source.c_str(),
+            record.users,
+            format_bytes(record.gpu_bytes).c_str(),
+            format_bytes(record.cpu_bytes).c_str());
+    }
+
+    if(!this->__duplicates.empty()) {
+        ImGui::Separator();
+        ImGui::Text("Duplicates");
+
+        for(auto& group : this->__duplicates) {
+            if(group.front() >= this->__records.size()) {
+                continue;
+            }
+
+            auto& first = this->__records[group.front()];
+
+            ImGui::BulletText("%zu x %s %s (%s wasted)",
+                group.size(),
+                first.tag.c_str(),
+                first.owner.c_str(),
+                format_bytes((first.gpu_bytes + first.cpu_bytes) * (group.size() - 1)).c_str());
+        }
+    }
+}
+
+void MemoryPanel::imgui() {
+    Component::imgui();
+
+    this->__controls();
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <pepng.h>
+
+#include "../system/memory.hpp"
+
+/**
+ * Component showing a MemoryTracker in the Debug window: totals per tag, largest resources and duplicates.
+ */
+class MemoryPanel : public Component {
+    public:
+        /**
+         * @param top Number of largest resources listed.
+         */
+        static std::shared_ptr<MemoryPanel> make_memory_panel(std::shared_ptr<MemoryTracker> memory_tracker, size_t top);
+
+        virtual void render(std::shared_ptr<WithComponents> parent) override;
+
+        #ifdef IMGUI
+        virtual void imgui() override;
+        #endif
+
+    protected:
+        virtual MemoryPanel* clone_implementation() override;
+
+    private:
+        MemoryPanel(std::shared_ptr<MemoryTracker> memory_tracker, size_t top);
+        MemoryPanel(const MemoryPanel& memory_panel);
+
+        #ifdef IMGUI
+        void __controls();
+        #endif
+
+        // Frames between two automatic (unhashed) snapshots while the panel is open.
+        static constexpr size_t REFRESH_FRAMES = 60;
+
+        std::shared_ptr<MemoryTracker> __memory_tracker;
+        size_t __top;
+
+        std::vector<MemoryRecord> __records;
+        std::vector<std::vector<size_t>> __duplicates;
+        size_t __frames_since_refresh;
+        std::string __status;
+};
+
+namespace pepng {
+    std::shared_ptr<MemoryPanel> make_memory_panel(std::shared_ptr<MemoryTracker> memory_tracker = pepng::memory(), size_t top = 10);
+};
\ No newline at end of file
@@ -0,0 +1,60 @@
+#include "multi_view_panel.hpp"
+
+#include "../system/debug_ui.hpp"
+
+MultiViewPanel::MultiViewPanel(std::shared_ptr<MultiView> multi_view) :
+    Component("MultiViewPanel"),
+    __multi_view(multi_view)
+{}
+
+MultiViewPanel::MultiViewPanel(const MultiViewPanel& multi_view_panel) :
+    Component(multi_view_panel),
+    __multi_view(multi_view_panel.__multi_view)
+{}
+
+MultiViewPanel* MultiViewPanel::clone_implementation() {
+    return new MultiViewPanel(*this);
+}
+
+std::shared_ptr<MultiViewPanel> MultiViewPanel::make_multi_view_panel(std::shared_ptr<MultiView> multi_view) {
+    std::shared_ptr<MultiViewPanel> multi_view_panel(new MultiViewPanel(multi_view));
+
+    return multi_view_panel;
+}
+
+std::shared_ptr<MultiViewPanel> pepng::make_multi_view_panel(std::shared_ptr<MultiView> multi_view) {
+    return MultiViewPanel::make_multi_view_panel(multi_view);
+}
+
+void MultiViewPanel::render(std::shared_ptr<WithComponents> parent) {
+    #ifdef IMGUI
+    pepng::debug_section("Multi View", [this]() {
+        this->__controls();
+    });
+    #endif
+}
+
+#ifdef IMGUI
+void MultiViewPanel::__controls() {
+    auto multi_view = this->__multi_view;
+
+    ImGui::Checkbox("Enabled", &multi_view->enabled);
+
+    auto& stats = multi_view->stats();
+
+    ImGui::Text("Views: %zu", stats.views);
+    ImGui::Text("Draws submitted: %zu", stats.items);
+    ImGui::Text("Shared bounds: %.3f ms", stats.bounds_ms);
+    ImGui::Text("Culling (parallel): %.3f ms", stats.cull_ms);
+
+    for(size_t v = 0; v < stats.drawn.size(); v++) {
+        ImGui::BulletText("%s: %zu drawn", v == 0 ? "Main" : "Extra", stats.drawn[v]);
+    }
+}
+
+void MultiViewPanel::imgui() {
+    Component::imgui();
+
+    this->__controls();
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <pepng.h>
+
+#include "../system/multi_view.hpp"
+
+/**
+ * Component exposing a MultiView: toggle, shared/culling timings and draws per view (also in the Debug window).
+ */
+class MultiViewPanel : public Component {
+    public:
+        static std::shared_ptr<MultiViewPanel> make_multi_view_panel(std::shared_ptr<MultiView> multi_view);
+
+        virtual void render(std::shared_ptr<WithComponents> parent) override;
+
+        #ifdef IMGUI
+        virtual void imgui() override;
+        #endif
+
+    protected:
+        virtual MultiViewPanel* clone_implementation() override;
+
+    private:
+        MultiViewPanel(std::shared_ptr<MultiView> multi_view);
+        MultiViewPanel(const MultiViewPanel& multi_view_panel);
+
+        #ifdef IMGUI
+        void __controls();
+        #endif
+
+        std::shared_ptr<MultiView> __multi_view;
+};
+
+namespace pepng {
+    std::shared_ptr<MultiViewPanel> make_multi_view_panel(std::shared_ptr<MultiView> multi_view = pepng::multi_view());
+};
\ No newline at end of file
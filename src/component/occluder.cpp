@@ -0,0 +1,66 @@
+#include "occluder.hpp"
+
+#include "../system/mesh.hpp"
+#include "../system/model_info.hpp"
+#include "../system/occlusion.hpp"
+
+Occluder::Occluder() :
+    Component("Occluder"),
+    __triangle_count(0)
+{}
+
+Occluder::Occluder(const Occluder& occluder) :
+    Component(occluder),
+    __triangle_count(0)
+{}
+
+Occluder* Occluder::clone_implementation() {
+    return new Occluder(*this);
+}
+
+std::shared_ptr<Occluder> Occluder::make_occluder() {
+    std::shared_ptr<Occluder> occluder(new Occluder());
+
+    return occluder;
+}
+
+std::shared_ptr<Occluder> pepng::make_occluder() {
+    return Occluder::make_occluder();
+}
+
+void Occluder::update(std::shared_ptr<WithComponents> parent) {
+    this->__triangle_count = 0;
+
+    if(!this->active()) {
+        return;
+    }
+
+    auto transform = parent->get_component<Transform>();
+    auto renderer = parent->get_component<Renderer>();
+
+    if(transform == nullptr || renderer == nullptr) {
+        std::stringstream ss;
+
+        ss << *parent << " needs a Transform and a Renderer to be an Occluder." << std::endl;
+
+        throw std::runtime_error(ss.str());
+    }
+
+    auto mesh = pepng::read_mesh(renderer->model);
+
+    if(mesh == nullptr) {
+        return;
+    }
+
+    this->__triangle_count = mesh->triangle_count();
+
+    pepng::occlusion()->add_occluder(pepng::model_matrix(transform, renderer->model), mesh);
+}
+
+#ifdef IMGUI
+void Occluder::imgui() {
+    Component::imgui();
+
+    ImGui::Text("Triangles: %zu", this->__triangle_count);
+}
+#endif
\ No newline at end of file
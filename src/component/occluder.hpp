@@ -0,0 +1,33 @@
+#pragma once
+
+#include <pepng.h>
+
+/**
+ * Component that designates its Object's Renderer as an occluder for Occlusion (CPU mode).
+ *
+ * Good occluders are large, closed and cheap: walls, floors, stage pieces.
+ */
+class Occluder : public Component {
+    public:
+        static std::shared_ptr<Occluder> make_occluder();
+
+        virtual void update(std::shared_ptr<WithComponents> parent) override;
+
+        #ifdef IMGUI
+        virtual void imgui() override;
+        #endif
+
+    protected:
+        virtual Occluder* clone_implementation() override;
+
+    private:
+        Occluder();
+        Occluder(const Occluder& occluder);
+
+        // Triangles registered last update (0 when the mesh is not readable).
+        size_t __triangle_count;
+};
+
+namespace pepng {
+    std::shared_ptr<Occluder> make_occluder();
+};
\ No newline at end of file
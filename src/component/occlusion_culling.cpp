@@ -0,0 +1,62 @@
+#include "occlusion_culling.hpp"
+
+#include "../system/debug_ui.hpp"
+
+OcclusionCulling::OcclusionCulling(std::shared_ptr<Occlusion> occlusion) :
+    Component("OcclusionCulling"),
+    __occlusion(occlusion)
+{}
+
+OcclusionCulling::OcclusionCulling(const OcclusionCulling& occlusion_culling) :
+    Component(occlusion_culling),
+    __occlusion(occlusion_culling.__occlusion)
+{}
+
+OcclusionCulling* OcclusionCulling::clone_implementation() {
+    return new OcclusionCulling(*this);
+}
+
+std::shared_ptr<OcclusionCulling> OcclusionCulling::make_occlusion_culling(std::shared_ptr<Occlusion> occlusion) {
+    std::shared_ptr<OcclusionCulling> occlusion_culling(new OcclusionCulling(occlusion));
+
+    return occlusion_culling;
+}
+
+std::shared_ptr<OcclusionCulling> pepng::make_occlusion_culling(std::shared_ptr<Occlusion> occlusion) {
+    return OcclusionCulling::make_occlusion_culling(occlusion);
+}
+
+void OcclusionCulling::render(std::shared_ptr<WithComponents> parent) {
+    #ifdef IMGUI
+    pepng::debug_section("Occlusion Culling", [this]() {
+        this->__controls();
+    });
+    #endif
+}
+
+#ifdef IMGUI
+void OcclusionCulling::__controls() {
+    int mode = (int) this->__occlusion->mode;
+
+    ImGui::RadioButton("None", &mode, (int) OcclusionMode::NONE);
+    ImGui::SameLine();
+    ImGui::RadioButton("CPU", &mode, (int) OcclusionMode::CPU);
+    ImGui::SameLine();
+    ImGui::RadioButton("GPU", &mode, (int) OcclusionMode::GPU);
+
+    this->__occlusion->mode = (OcclusionMode) mode;
+
+    auto& stats = this->__occlusion->stats();
+
+    ImGui::Text("Tested: %zu", stats.tested);
+    ImGui::Text("Culled: %zu", stats.culled);
+    ImGui::Text("Occluders: %zu (%zu triangles)", stats.occluders, stats.occluder_triangles);
+    ImGui::Text("Rasterize: %.3f ms", stats.rasterize_ms);
+}
+
+void OcclusionCulling::imgui() {
+    Component::imgui();
+
+    this->__controls();
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <pepng.h>
+
+#include "../system/occlusion.hpp"
+
+/**
+ * Component exposing an Occlusion: mode selection and culling statistics (also in the Debug window).
+ */
+class OcclusionCulling : public Component {
+    public:
+        static std::shared_ptr<OcclusionCulling> make_occlusion_culling(std::shared_ptr<Occlusion> occlusion);
+
+        virtual void render(std::shared_ptr<WithComponents> parent) override;
+
+        #ifdef IMGUI
+        virtual void imgui() override;
+        #endif
+
+    protected:
+        virtual OcclusionCulling* clone_implementation() override;
+
+    private:
+        OcclusionCulling(std::shared_ptr<Occlusion> occlusion);
+        OcclusionCulling(const OcclusionCulling& occlusion_culling);
+
+        #ifdef IMGUI
+        void __controls();
+        #endif
+
+        std::shared_ptr<Occlusion> __occlusion;
+};
+
+namespace pepng {
+    std::shared_ptr<OcclusionCulling> make_occlusion_culling(std::shared_ptr<Occlusion> occlusion = pepng::occlusion());
+};
\ No newline at end of file
@@ -0,0 +1,47 @@
+#include "outliner.hpp"
+
+Outliner::Outliner(std::shared_ptr<SceneTree> scene_tree) :
+    Component("Outliner"),
+    __scene_tree(scene_tree)
+{}
+
+Outliner::Outliner(const Outliner& outliner) :
+    Component(outliner),
+    __scene_tree(outliner.__scene_tree)
+{}
+
+Outliner* Outliner::clone_implementation() {
+    return new Outliner(*this);
+}
+
+std::shared_ptr<Outliner> Outliner::make_outliner(std::shared_ptr<SceneTree> scene_tree) {
+    std::shared_ptr<Outliner> outliner(new Outliner(scene_tree));
+
+    return outliner;
+}
+
+std::shared_ptr<Outliner> pepng::make_outliner(std::shared_ptr<SceneTree> scene_tree) {
+    return Outliner::make_outliner(scene_tree);
+}
+
+void Outliner::init(std::shared_ptr<WithComponents> parent) {
+    auto object = std::dynamic_pointer_cast<Object>(parent);
+
+    if(object == nullptr) {
+        std::stringstream ss;
+
+        ss << *parent << " is not an Object which Outliner requires." << std::endl;
+
+        throw std::runtime_error(ss.str());
+    }
+
+    this->__scene_tree->add_root(object);
+}
+
+void Outliner::render(std::shared_ptr<WithComponents> parent) {
+    if(!this->active()) {
+        return;
+    }
+
+    this->__scene_tree->draw();
+}
\ No newline at end of file
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <pepng.h>
+
+#include "../system/scene_tree.hpp"
+
+/**
+ * Component adding its Object's hierarchy to the Scene Tree and Scene Inspector windows.
+ *
+ * Can be attached to several Objects, the windows are drawn once per frame.
+ */
+class Outliner : public Component {
+    public:
+        static std::shared_ptr<Outliner> make_outliner(std::shared_ptr<SceneTree> scene_tree);
+
+        virtual void init(std::shared_ptr<WithComponents> parent) override;
+        virtual void render(std::shared_ptr<WithComponents> parent) override;
+
+    protected:
+        virtual Outliner* clone_implementation() override;
+
+    private:
+        Outliner(std::shared_ptr<SceneTree> scene_tree);
+        Outliner(const Outliner& outliner);
+
+        std::shared_ptr<SceneTree> __scene_tree;
+};
+
+namespace pepng {
+    std::shared_ptr<Outliner> make_outliner(std::shared_ptr<SceneTree> scene_tree = pepng::scene_tree());
+};
\ No newline at end of file
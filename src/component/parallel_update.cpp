@@ -0,0 +1,160 @@
+#include "parallel_update.hpp"
+
+#include <chrono>
+
+#include "../system/input_log.hpp"
+#include "../system/job_system.hpp"
+
+bool ParallelSafe::reads_parent() {
+    return false;
+}
+
+bool ParallelSafe::scheduled() {
+    return !this->__scheduler.expired();
+}
+
+float ParallelSafe::delta_time() {
+    return this->__delta_time;
+}
+
+void ParallelSafe::sample_delta_time() {
+    this->__delta_time = pepng::input_log()->delta_time();
+}
+
+ParallelUpdate::ParallelUpdate() :
+    Component("ParallelUpdate"),
+    __token(std::make_shared<bool>(true)),
+    __component_count(0),
+    __update_ms(0.0f)
+{}
+
+ParallelUpdate::ParallelUpdate(const ParallelUpdate& parallel_update) :
+    Component(parallel_update),
+    __token(std::make_shared<bool>(true)),
+    __component_count(0),
+    __update_ms(0.0f)
+{}
+
+ParallelUpdate* ParallelUpdate::clone_implementation() {
+    return new ParallelUpdate(*this);
+}
+
+std::shared_ptr<ParallelUpdate> ParallelUpdate::make_parallel_update() {
+    std::shared_ptr<ParallelUpdate> parallel_update(new ParallelUpdate());
+
+    return parallel_update;
+}
+
+std::shared_ptr<ParallelUpdate> pepng::make_parallel_update() {
+    return ParallelUpdate::make_parallel_update();
+}
+
+void ParallelUpdate::update(std::shared_ptr<WithComponents> parent) {
+    auto root = std::dynamic_pointer_cast<Object>(parent);
+
+    if(root == nullptr) {
+        std::stringstream ss;
+
+        ss << *parent << " is not an Object which ParallelUpdate requires." << std::endl;
+
+        throw std::runtime_error(ss.str());
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    // Only this frame's claims hold: the previous token expires here.
+    this->__token = std::make_shared<bool>(true);
+
+    // Workers only read the InputLog, so this frame's values are started here on the main thread.
+    pepng::input_log()->begin_frame();
+
+    float delta_time = pepng::input_log()->delta_time();
+
+    for(auto& wave : this->__waves) {
+        wave.clear();
+    }
+
+    this->__component_count = 0;
+
+    // Pairs of (object, wave of its parent).
+    std::vector<std::pair<std::shared_ptr<Object>, size_t>> stack;
+
+    for(auto it = root->children.rbegin(); it != root->children.rend(); it++) {
+        stack.push_back({ *it, 0 });
+    }
+
+    while(!stack.empty()) {
+        auto [object, parent_wave] = stack.back();
+        stack.pop_back();
+
+        Job job { object, {} };
+        bool reads_parent = false;
+
+        for(auto& component : object->components) {
+            auto parallel_safe = dynamic_cast<ParallelSafe*>(component.get());
+
+            if(parallel_safe == nullptr || !component->active()) {
+                continue;
+            }
+
+            parallel_safe->__scheduler = this->__token;
+            parallel_safe->__delta_time = delta_time;
+            reads_parent = reads_parent || parallel_safe->reads_parent();
+            job.components.push_back(parallel_safe);
+        }
+
+        size_t wave = parent_wave;
+
+        if(!job.components.empty()) {
+            wave = reads_parent ? parent_wave + 1 : 0;
+
+            if(this->__waves.size() <= wave) {
+                this->__waves.resize(wave + 1);
+            }
+
+            this->__component_count += job.components.size();
+            this->__waves[wave].push_back(std::move(job));
+        }
+
+        for(auto it = object->children.rbegin(); it != object->children.rend(); it++) {
+            stack.push_back({ *it, wave });
+        }
+    }
+
+    while(!this->__waves.empty() && this->__waves.back().empty()) {
+        this->__waves.pop_back();
+    }
+
+    auto jobs = pepng::jobs();
+
+    for(auto& wave : this->__waves) {
+        jobs->parallel_for(wave.size(), [&wave](size_t i) {
+            auto& job = wave[i];
+
+            for(auto component : job.components) {
+                component->parallel_update(job.object);
+            }
+        }, 16);
+    }
+
+    this->__update_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+#ifdef IMGUI
+void ParallelUpdate::imgui() {
+    Component::imgui();
+
+    auto jobs = pepng::jobs();
+
+    bool serial = jobs->serial();
+
+    if(ImGui::Checkbox("Serial (debug)", &serial)) {
+        jobs->set_serial(serial);
+    }
+
+    ImGui::Text("Workers: %u", jobs->worker_count());
+    ImGui::Text("Components: %zu", this->__component_count);
+    ImGui::Text("Waves: %zu", this->__waves.size());
+    ImGui::Text("Update: %.3f ms", this->__update_ms);
+}
+#endif
\ No newline at end of file
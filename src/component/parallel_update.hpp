@@ -0,0 +1,78 @@
+#pragma once
+
+#include <pepng.h>
+
+/**
+ * Interface for components whose update can run on a worker thread.
+ *
+ * parallel_update may only write to its own Object and read its ancestors.
+ * A component implementing it should return early from update() while scheduled() is true.
+ */
+class ParallelSafe {
+    public:
+        virtual ~ParallelSafe() = default;
+
+        // The update body, run by ParallelUpdate (or by update() when not scheduled).
+        virtual void parallel_update(std::shared_ptr<WithComponents> parent) = 0;
+
+        // Return true when the update reads state the parent Object writes in the same frame.
+        virtual bool reads_parent();
+
+        // True while a ParallelUpdate owns this component.
+        bool scheduled();
+
+        // Seconds of this frame (InputLog), sampled on the main thread before parallel_update runs.
+        float delta_time();
+
+    protected:
+        // Samples delta_time. For update() running parallel_update itself (ParallelUpdate samples it otherwise).
+        void sample_delta_time();
+
+    private:
+        friend class ParallelUpdate;
+
+        std::weak_ptr<bool> __scheduler;
+        float __delta_time = 0.0f;
+};
+
+/**
+ * Component that runs the ParallelSafe components of its Object's descendants on the JobSystem.
+ *
+ * Objects are grouped in waves: an Object reading its parent runs one wave after it.
+ * Everything else runs in the first wave.
+ */
+class ParallelUpdate : public Component {
+    public:
+        static std::shared_ptr<ParallelUpdate> make_parallel_update();
+
+        virtual void update(std::shared_ptr<WithComponents> parent) override;
+
+        #ifdef IMGUI
+        virtual void imgui() override;
+        #endif
+
+    protected:
+        virtual ParallelUpdate* clone_implementation() override;
+
+    private:
+        ParallelUpdate();
+        ParallelUpdate(const ParallelUpdate& parallel_update);
+
+        struct Job {
+            std::shared_ptr<Object> object;
+            std::vector<ParallelSafe*> components;
+        };
+
+        // Scheduled jobs per wave. Rebuilt every frame (keeps its capacity).
+        std::vector<std::vector<Job>> __waves;
+
+        // Claim token handed to scheduled components. Replaced every frame, so components that left the subtree see it expire.
+        std::shared_ptr<bool> __token;
+
+        size_t __component_count;
+        float __update_ms;
+};
+
+namespace pepng {
+    std::shared_ptr<ParallelUpdate> make_parallel_update();
+};
\ No newline at end of file
@@ -0,0 +1,256 @@
+#include "particle_emitter.hpp"
+
+#include "../system/command_list.hpp"
+#include "../system/input_log.hpp"
+#include "../system/lighting.hpp"
+#include "../system/memory.hpp"
+#include "../system/redraw.hpp"
+#include "../system/view.hpp"
+
+#include <chrono>
+#include <cmath>
+
+ParticleEmitter::ParticleEmitter(size_t capacity, std::shared_ptr<ExtraMaterial> material) :
+    Component("ParticleEmitter"),
+    rate(1000.0f),
+    speed(5.0f),
+    spread(15.0f),
+    life(2.0f),
+    life_variance(0.25f),
+    size(0.1f),
+    gravity(0.0f, -9.81f, 0.0f),
+    damping(0.9f),
+    threaded(true),
+    paused(false),
+    __pool(pepng::make_particle_pool(capacity)),
+    __material(material),
+    __pending(0.0f),
+    __seed(0x9e3779b9u),
+    __vao(0),
+    __buffer(0),
+    __upload_ms(0.0f)
+{}
+
+// The pool is not shared: the clone starts empty, with another random sequence.
+ParticleEmitter::ParticleEmitter(const ParticleEmitter& particle_emitter) :
+    Component(particle_emitter),
+    rate(particle_emitter.rate),
+    speed(particle_emitter.speed),
+    spread(particle_emitter.spread),
+    life(particle_emitter.life),
+    life_variance(particle_emitter.life_variance),
+    size(particle_emitter.size),
+    gravity(particle_emitter.gravity),
+    damping(particle_emitter.damping),
+    threaded(particle_emitter.threaded),
+    paused(particle_emitter.paused),
+    __pool(pepng::make_particle_pool(particle_emitter.__pool->capacity())),
+    __material(particle_emitter.__material),
+    __pending(0.0f),
+    __seed(particle_emitter.__seed * 747796405u + 2891336453u),
+    __vao(0),
+    __buffer(0),
+    __upload_ms(0.0f)
+{}
+
+ParticleEmitter::~ParticleEmitter() {
+    if(this->__vao != 0) {
+        glDeleteVertexArrays(1, &this->__vao);
+        glDeleteBuffers(1, &this->__buffer);
+
+        pepng::memory()->untrack(&this->__buffer);
+    }
+}
+
+ParticleEmitter* ParticleEmitter::clone_implementation() {
+    return new ParticleEmitter(*this);
+}
+
+std::shared_ptr<ParticleEmitter> ParticleEmitter::make_particle_emitter(size_t capacity, std::shared_ptr<ExtraMaterial> material) {
+    std::shared_ptr<ParticleEmitter> particle_emitter(new ParticleEmitter(capacity, material));
+
+    return particle_emitter;
+}
+
+std::shared_ptr<ParticleEmitter> pepng::make_particle_emitter(size_t capacity, std::shared_ptr<ExtraMaterial> material) {
+    return ParticleEmitter::make_particle_emitter(capacity, material);
+}
+
+std::shared_ptr<ParticlePool> ParticleEmitter::pool() {
+    return this->__pool;
+}
+
+void ParticleEmitter::init(std::shared_ptr<WithComponents> parent) {
+    auto transform = parent->get_component<Transform>();
+
+    if(transform == nullptr) {
+        std::stringstream ss;
+
+        ss << *parent << " has no Transform which ParticleEmitter requires." << std::endl;
+
+        throw std::runtime_error(ss.str());
+    }
+
+    this->__transform = transform;
+}
+
+float ParticleEmitter::__random() {
+    uint32_t seed = this->__seed;
+
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+
+    this->__seed = seed;
+
+    return (seed >> 8) * (1.0f / 16777216.0f);
+}
+
+void ParticleEmitter::update(std::shared_ptr<WithComponents> parent) {
+    if(!this->active() || this->paused) {
+        return;
+    }
+
+    // The replayed frame time keeps recorded runs emitting the same particles.
+    float dt = pepng::input_log()->delta_time();
+
+    // Particles spawned this frame start at the emitter, so they are simulated from the next one.
+    this->__pool->simulate(dt, this->gravity, std::pow(this->damping, dt), this->threaded);
+    this->__emit(dt);
+
+    if(this->__pool->count() > 0) {
+        pepng::request_redraw();
+    }
+}
+
+void ParticleEmitter::__emit(float dt) {
+    this->__pending += this->rate * dt;
+
+    size_t count = (size_t) this->__pending;
+
+    this->__pending -= (float) count;
+
+    auto world = this->__transform->parent_matrix * this->__transform->world_matrix();
+
+    glm::vec3 origin = glm::vec3(world[3]);
+    glm::vec3 axis_x = glm::normalize(glm::vec3(world[0]));
+    glm::vec3 axis_y = glm::normalize(glm::vec3(world[1]));
+    glm::vec3 axis_z = glm::normalize(glm::vec3(world[2]));
+
+    float cos_spread = std::cos(glm::radians(this->spread));
+
+    for(size_t i = 0; i < count; i++) {
+        // Uniform over the spherical cap around +y.
+        float cos_theta = 1.0f - this->__random() * (1.0f - cos_spread);
+        float sin_theta = std::sqrt(std::max(0.0f, 1.0f - cos_theta * cos_theta));
+        float phi = this->__random() * 6.2831853f;
+
+        glm::vec3 direction = axis_x * (sin_theta * std::cos(phi)) + axis_y * cos_theta + axis_z * (sin_theta * std::sin(phi));
+        float particle_life = this->life * (1.0f - this->life_variance * this->__random());
+
+        // A full pool drops the rest of this frame's particles.
+        if(!this->__pool->spawn(origin, direction * this->speed, particle_life, this->size)) {
+            this->__pending = 0.0f;
+
+            break;
+        }
+    }
+}
+
+void ParticleEmitter::__upload() {
+    auto start = std::chrono::steady_clock::now();
+
+    auto& pool = *this->__pool;
+    size_t stride = pool.x.size() * sizeof(float);
+
+    if(this->__vao == 0) {
+        glGenVertexArrays(1, &this->__vao);
+        glGenBuffers(1, &this->__buffer);
+
+        glBindVertexArray(this->__vao);
+        glBindBuffer(GL_ARRAY_BUFFER, this->__buffer);
+
+        // One float per instance from each array: x at 0, y at 1, z at 2, size at 3.
+        for(GLuint location = 0; location < 4; location++) {
+            glEnableVertexAttribArray(location);
+            glVertexAttribPointer(location, 1, GL_FLOAT, GL_FALSE, sizeof(float), (const void*) (location * stride));
+            glVertexAttribDivisor(location, 1);
+        }
+
+        glBindVertexArray(0);
+
+        pepng::memory()->track(&this->__buffer, MemoryRecord { "buffer", "", "particles", 1, stride * 4, 0 });
+    }
+
+    size_t bytes = pool.count() * sizeof(float);
+
+    glBindBuffer(GL_ARRAY_BUFFER, this->__buffer);
+
+    // Orphans the storage the previous draw may still read, then writes the live range of each array.
+    glBufferData(GL_ARRAY_BUFFER, stride * 4, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, pool.x.data());
+    glBufferSubData(GL_ARRAY_BUFFER, stride, bytes, pool.y.data());
+    glBufferSubData(GL_ARRAY_BUFFER, stride * 2, bytes, pool.z.data());
+    glBufferSubData(GL_ARRAY_BUFFER, stride * 3, bytes, pool.size.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    this->__upload_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void ParticleEmitter::render(std::shared_ptr<WithComponents> parent) {
+    if(!this->active() || this->__pool->count() == 0) {
+        return;
+    }
+
+    this->__upload();
+
+    auto program = this->__material->shader_program();
+    auto& view = pepng::current_view();
+    auto& list = pepng::commands()->record();
+
+    list.use_program(program);
+    list.uniform(pepng::uniform_location(program, "u_projection"), view.projection);
+    list.uniform(pepng::uniform_location(program, "u_view"), view.view);
+    pepng::lighting()->record(list, program, view);
+
+    GLint u_has_color = pepng::uniform_location(program, "u_has_color");
+
+    if(this->__material->color.x >= 0) {
+        list.uniform(u_has_color, (float) GL_TRUE);
+        list.uniform(pepng::uniform_location(program, "u_color"), this->__material->color);
+    } else {
+        list.uniform(u_has_color, (float) GL_FALSE);
+    }
+
+    list.bind_texture(0, GL_TEXTURE_2D, this->__material->texture->gl_index());
+    list.bind_vertex_array(this->__vao);
+    list.draw_arrays_instanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei) this->__pool->count());
+}
+
+#ifdef IMGUI
+void ParticleEmitter::imgui() {
+    Component::imgui();
+
+    ImGui::Checkbox("Paused", &this->paused);
+    ImGui::Checkbox("Threaded", &this->threaded);
+    ImGui::SliderFloat("Rate", &this->rate, 0.0f, 500000.0f, "%.0f");
+    ImGui::SliderFloat("Speed", &this->speed, 0.0f, 50.0f);
+    ImGui::SliderFloat("Spread", &this->spread, 0.0f, 180.0f);
+    ImGui::SliderFloat("Life", &this->life, 0.1f, 10.0f);
+    ImGui::SliderFloat("Size", &this->size, 0.01f, 1.0f);
+    ImGui::SliderFloat("Damping", &this->damping, 0.0f, 1.0f);
+    ImGui::InputFloat3("Gravity", &this->gravity.x);
+
+    if(ImGui::Button("Clear")) {
+        this->__pool->clear();
+    }
+
+    auto& pool = *this->__pool;
+    auto& stats = pool.stats();
+
+    ImGui::Text("Particles: %zu / %zu (%.1f MB)", pool.count(), pool.capacity(), pool.bytes() / (1024.0f * 1024.0f));
+    ImGui::Text("Spawned: %zu, died: %zu", stats.spawned, stats.died);
+    ImGui::Text("Integrate: %.2f ms (%zu chunks, %s)", stats.integrate_ms, stats.chunks, pepng::simd_level_name(pepng::simd_level()));
+    ImGui::Text("Compact: %.2f ms, upload: %.2f ms", stats.compact_ms, this->__upload_ms);
+}
+#endif
\ No newline at end of file
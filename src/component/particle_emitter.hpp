@@ -0,0 +1,76 @@
+#pragma once
+
+#include <pepng.h>
+
+#include "extra_material.hpp"
+#include "../system/particles.hpp"
+
+/**
+ * Component emitting particles from its Object into a ParticlePool, simulated in world space.
+ *
+ * Particles leave along the Object's +y inside a cone and are integrated with the SIMD kernels (on the
+ * JobSystem when threaded). All of them are drawn in one instanced draw of a camera facing quad: the pool
+ * arrays are uploaded as they are (one attribute per array), the material's shader expands the quads
+ * (see shaders/particle/vertex.glsl) and shades them like objects, with its texture or color.
+ *
+ * Clones get their own pool of the same capacity.
+ */
+class ParticleEmitter : public Component {
+    public:
+        static std::shared_ptr<ParticleEmitter> make_particle_emitter(size_t capacity, std::shared_ptr<ExtraMaterial> material);
+
+        // Particles per second.
+        float rate;
+        float speed;
+        // Half angle of the cone (degrees).
+        float spread;
+        // Seconds, each particle lives between life * (1 - life_variance) and life.
+        float life;
+        float life_variance;
+        // Quad width in world units.
+        float size;
+        glm::vec3 gravity;
+        // Velocity kept per second.
+        float damping;
+        bool threaded;
+        bool paused;
+
+        std::shared_ptr<ParticlePool> pool();
+
+        virtual void init(std::shared_ptr<WithComponents> parent) override;
+        virtual void update(std::shared_ptr<WithComponents> parent) override;
+        virtual void render(std::shared_ptr<WithComponents> parent) override;
+
+        #ifdef IMGUI
+        virtual void imgui() override;
+        #endif
+
+        ~ParticleEmitter();
+
+    protected:
+        virtual ParticleEmitter* clone_implementation() override;
+
+    private:
+        ParticleEmitter(size_t capacity, std::shared_ptr<ExtraMaterial> material);
+        ParticleEmitter(const ParticleEmitter& particle_emitter);
+
+        // Uniform in [0, 1) (xorshift, seeded per emitter so replays emit the same particles).
+        float __random();
+        void __emit(float dt);
+        void __upload();
+
+        std::shared_ptr<ParticlePool> __pool;
+        std::shared_ptr<ExtraMaterial> __material;
+        std::shared_ptr<Transform> __transform;
+
+        float __pending;
+        uint32_t __seed;
+
+        GLuint __vao;
+        GLuint __buffer;
+        float __upload_ms;
+};
+
+namespace pepng {
+    std::shared_ptr<ParticleEmitter> make_particle_emitter(size_t capacity, std::shared_ptr<ExtraMaterial> material);
+};
\ No newline at end of file
@@ -0,0 +1,105 @@
+#include "picker.hpp"
+
+#include "../system/debug_ui.hpp"
+#include "../system/input_log.hpp"
+#include "../system/redraw.hpp"
+
+Picker::Picker(GLuint program, std::shared_ptr<Picking> picking) :
+    Component("Picker"),
+    __program(program),
+    __picking(picking),
+    __held(false)
+{}
+
+Picker::Picker(const Picker& picker) :
+    Component(picker),
+    __program(picker.__program),
+    __picking(picker.__picking),
+    __held(false)
+{}
+
+Picker* Picker::clone_implementation() {
+    return new Picker(*this);
+}
+
+std::shared_ptr<Picker> Picker::make_picker(GLuint program, std::shared_ptr<Picking> picking) {
+    std::shared_ptr<Picker> picker(new Picker(program, picking));
+
+    return picker;
+}
+
+std::shared_ptr<Picker> pepng::make_picker(GLuint program, std::shared_ptr<Picking> picking) {
+    return Picker::make_picker(program, picking);
+}
+
+void Picker::render(std::shared_ptr<WithComponents> parent) {
+    if(!this->active()) {
+        return;
+    }
+
+    bool held = pepng::input_log()->axis("pick") != 0.0f;
+    bool pressed = held && !this->__held;
+
+    this->__held = held;
+
+    #ifdef IMGUI
+    // Clicks on the editor windows are not picks.
+    pressed = pressed && !pepng::input_log()->mouse_captured();
+    #endif
+
+    if(pressed) {
+        auto window = glfwGetCurrentContext();
+
+        auto cursor = pepng::input_log()->cursor();
+        double x = cursor.x, y = cursor.y;
+        int width, height, framebuffer_width, framebuffer_height;
+
+        glfwGetWindowSize(window, &width, &height);
+        glfwGetFramebufferSize(window, &framebuffer_width, &framebuffer_height);
+
+        if(width > 0 && height > 0) {
+            // Window coordinates (top left) to framebuffer pixels (bottom left).
+            float scale_x = (float) framebuffer_width / width;
+            float scale_y = (float) framebuffer_height / height;
+
+            this->__picking->request(glm::vec2((float) x * scale_x, framebuffer_height - (float) y * scale_y));
+        }
+    }
+
+    this->__picking->process(pepng::current_view(), this->__program);
+
+    // The GPU read back lands a few frames later, so redraw-on-demand must keep the loop going.
+    if(this->__picking->pending()) {
+        pepng::request_redraw();
+    }
+
+    #ifdef IMGUI
+    pepng::debug_section("Picking", [this]() {
+        this->__controls();
+    });
+    #endif
+}
+
+#ifdef IMGUI
+void Picker::__controls() {
+    int mode = (int) this->__picking->mode;
+
+    ImGui::RadioButton("GPU IDs", &mode, (int) PickingMode::GPU);
+    ImGui::SameLine();
+    ImGui::RadioButton("BVH", &mode, (int) PickingMode::BVH);
+
+    this->__picking->mode = (PickingMode) mode;
+
+    auto picked = this->__picking->picked();
+
+    ImGui::Text("Picked: %s", picked != nullptr ? picked->name.c_str() : "-");
+    ImGui::Text("Pick: %.3f ms%s", this->__picking->last_pick_ms(), this->__picking->pending() ? " (pending)" : "");
+    ImGui::Text("Scene BVH rebuilds: %zu", this->__picking->bvh_rebuilds());
+}
+
+void Picker::imgui() {
+    Component::imgui();
+
+    this->__controls();
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <pepng.h>
+
+#include "../system/picking.hpp"
+
+/**
+ * Component that requests a pick from Picking when "pick" is pressed over the scene, and resolves it.
+ *
+ * Attach it to the first instantiated Object, so picks resolve before renderers submit the next frame.
+ */
+class Picker : public Component {
+    public:
+        /**
+         * @param program The picking shader program (used by the GPU mode).
+         */
+        static std::shared_ptr<Picker> make_picker(GLuint program, std::shared_ptr<Picking> picking);
+
+        virtual void render(std::shared_ptr<WithComponents> parent) override;
+
+        #ifdef IMGUI
+        virtual void imgui() override;
+        #endif
+
+    protected:
+        virtual Picker* clone_implementation() override;
+
+    private:
+        Picker(GLuint program, std::shared_ptr<Picking> picking);
+        Picker(const Picker& picker);
+
+        #ifdef IMGUI
+        void __controls();
+        #endif
+
+        GLuint __program;
+        std::shared_ptr<Picking> __picking;
+
+        // "pick" was held last frame (picks on press only).
+        bool __held;
+};
+
+namespace pepng {
+    std::shared_ptr<Picker> make_picker(GLuint program, std::shared_ptr<Picking> picking = pepng::picking());
+};
\ No newline at end of file
@@ -0,0 +1,66 @@
+#include "point_light.hpp"
+
+#include "../system/debug_draw.hpp"
+#include "../system/lighting.hpp"
+
+PointLight::PointLight(glm::vec3 color, float intensity, float radius) :
+    Component("PointLight"),
+    color(color),
+    intensity(intensity),
+    radius(radius)
+{}
+
+PointLight::PointLight(const PointLight& point_light) :
+    Component(point_light),
+    color(point_light.color),
+    intensity(point_light.intensity),
+    radius(point_light.radius)
+{}
+
+PointLight* PointLight::clone_implementation() {
+    return new PointLight(*this);
+}
+
+std::shared_ptr<PointLight> PointLight::make_point_light(glm::vec3 color, float intensity, float radius) {
+    std::shared_ptr<PointLight> point_light(new PointLight(color, intensity, radius));
+
+    return point_light;
+}
+
+std::shared_ptr<PointLight> pepng::make_point_light(glm::vec3 color, float intensity, float radius) {
+    return PointLight::make_point_light(color, intensity, radius);
+}
+
+void PointLight::update(std::shared_ptr<WithComponents> parent) {
+    if(!this->active() || this->radius <= 0.0f) {
+        return;
+    }
+
+    auto transform = parent->get_component<Transform>();
+
+    if(transform == nullptr) {
+        std::stringstream ss;
+
+        ss << *parent << " has no Transform which PointLight requires." << std::endl;
+
+        throw std::runtime_error(ss.str());
+    }
+
+    glm::vec3 position = glm::vec3((transform->parent_matrix * transform->world_matrix())[3]);
+
+    pepng::lighting()->add_light(LightSource { position, this->radius, this->color * this->intensity });
+
+    if(pepng::debug_draw()->light_ranges) {
+        pepng::debug_draw()->sphere(position, this->radius, glm::vec4(this->color, 1.0f));
+    }
+}
+
+#ifdef IMGUI
+void PointLight::imgui() {
+    Component::imgui();
+
+    ImGui::ColorEdit3("Color", glm::value_ptr(this->color));
+    ImGui::DragFloat("Intensity", &this->intensity, 0.05f, 0.0f, 100.0f);
+    ImGui::DragFloat("Radius", &this->radius, 0.1f, 0.0f, 1000.0f);
+}
+#endif
\ No newline at end of file
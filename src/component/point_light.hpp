@@ -0,0 +1,37 @@
+#pragma once
+
+#include <pepng.h>
+
+/**
+ * Component registering a point light at its Object's position with Lighting every update.
+ */
+class PointLight : public Component {
+    public:
+        /**
+         * @param color Linear color of the light.
+         * @param intensity Multiplier of the color.
+         * @param radius Distance at which the light fades out (also its culling bound).
+         */
+        static std::shared_ptr<PointLight> make_point_light(glm::vec3 color, float intensity, float radius);
+
+        glm::vec3 color;
+        float intensity;
+        float radius;
+
+        virtual void update(std::shared_ptr<WithComponents> parent) override;
+
+        #ifdef IMGUI
+        virtual void imgui() override;
+        #endif
+
+    protected:
+        virtual PointLight* clone_implementation() override;
+
+    private:
+        PointLight(glm::vec3 color, float intensity, float radius);
+        PointLight(const PointLight& point_light);
+};
+
+namespace pepng {
+    std::shared_ptr<PointLight> make_point_light(glm::vec3 color = glm::vec3(1.0f), float intensity = 1.0f, float radius = 10.0f);
+};
\ No newline at end of file
@@ -0,0 +1,65 @@
+#include "redraw_on_demand.hpp"
+
+#include "../system/debug_ui.hpp"
+
+RedrawOnDemand::RedrawOnDemand(std::shared_ptr<RedrawScheduler> scheduler) :
+    Component("RedrawOnDemand"),
+    __scheduler(scheduler)
+{}
+
+RedrawOnDemand::RedrawOnDemand(const RedrawOnDemand& redraw_on_demand) :
+    Component(redraw_on_demand),
+    __scheduler(redraw_on_demand.__scheduler)
+{}
+
+RedrawOnDemand* RedrawOnDemand::clone_implementation() {
+    return new RedrawOnDemand(*this);
+}
+
+std::shared_ptr<RedrawOnDemand> RedrawOnDemand::make_redraw_on_demand(std::shared_ptr<RedrawScheduler> scheduler) {
+    std::shared_ptr<RedrawOnDemand> redraw_on_demand(new RedrawOnDemand(scheduler));
+
+    return redraw_on_demand;
+}
+
+std::shared_ptr<RedrawOnDemand> pepng::make_redraw_on_demand(std::shared_ptr<RedrawScheduler> scheduler) {
+    return RedrawOnDemand::make_redraw_on_demand(scheduler);
+}
+
+void RedrawOnDemand::update(std::shared_ptr<WithComponents> parent) {
+    if(!this->active()) {
+        return;
+    }
+
+    this->__scheduler->wait();
+}
+
+void RedrawOnDemand::render(std::shared_ptr<WithComponents> parent) {
+    #ifdef IMGUI
+    pepng::debug_section("Redraw On Demand", [this]() {
+        this->__controls();
+    });
+    #endif
+}
+
+#ifdef IMGUI
+void RedrawOnDemand::__controls() {
+    auto scheduler = this->__scheduler;
+
+    #ifdef __EMSCRIPTEN__
+    ImGui::Text("Not available on WebGL.");
+    #else
+    ImGui::Checkbox("Enabled", &scheduler->enabled);
+    ImGui::SliderFloat("Max wait (s)", &scheduler->timeout, 0.05f, 2.0f);
+    #endif
+
+    ImGui::Text("Frames/s: %.1f", scheduler->frames_per_second());
+    ImGui::Text("Idle waits: %zu", scheduler->idle_waits());
+}
+
+void RedrawOnDemand::imgui() {
+    Component::imgui();
+
+    this->__controls();
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <pepng.h>
+
+#include "../system/redraw.hpp"
+
+/**
+ * Component driving a RedrawScheduler: blocks the loop before the update while nothing changed (toggle also in the Debug window).
+ *
+ * Attach it to the first instantiated Object so it runs before everything else in the frame.
+ */
+class RedrawOnDemand : public Component {
+    public:
+        static std::shared_ptr<RedrawOnDemand> make_redraw_on_demand(std::shared_ptr<RedrawScheduler> scheduler);
+
+        virtual void update(std::shared_ptr<WithComponents> parent) override;
+        virtual void render(std::shared_ptr<WithComponents> parent) override;
+
+        #ifdef IMGUI
+        virtual void imgui() override;
+        #endif
+
+    protected:
+        virtual RedrawOnDemand* clone_implementation() override;
+
+    private:
+        RedrawOnDemand(std::shared_ptr<RedrawScheduler> scheduler);
+        RedrawOnDemand(const RedrawOnDemand& redraw_on_demand);
+
+        #ifdef IMGUI
+        void __controls();
+        #endif
+
+        std::shared_ptr<RedrawScheduler> __scheduler;
+};
+
+namespace pepng {
+    std::shared_ptr<RedrawOnDemand> make_redraw_on_demand(std::shared_ptr<RedrawScheduler> scheduler = pepng::redraw());
+};
\ No newline at end of file
@@ -0,0 +1,64 @@
+#include "render_mode_switch.hpp"
+
+#include "../system/input_log.hpp"
+#include "../system/render_mode.hpp"
+
+RenderModeSwitch::RenderModeSwitch() :
+    Component("RenderModeSwitch")
+{}
+
+RenderModeSwitch::RenderModeSwitch(const RenderModeSwitch& render_mode_switch) :
+    Component(render_mode_switch)
+{}
+
+RenderModeSwitch* RenderModeSwitch::clone_implementation() {
+    return new RenderModeSwitch(*this);
+}
+
+std::shared_ptr<RenderModeSwitch> RenderModeSwitch::make_render_mode_switch() {
+    std::shared_ptr<RenderModeSwitch> render_mode_switch(new RenderModeSwitch());
+
+    return render_mode_switch;
+}
+
+std::shared_ptr<RenderModeSwitch> pepng::make_render_mode_switch() {
+    return RenderModeSwitch::make_render_mode_switch();
+}
+
+void RenderModeSwitch::update(std::shared_ptr<WithComponents> parent) {
+    if(!this->active()) {
+        return;
+    }
+
+    auto input = pepng::input_log();
+
+    if(input->axis("render_triangles") != 0.0f) {
+        pepng::set_render_mode_override(std::nullopt);
+    } else if(input->axis("render_lines") != 0.0f) {
+        pepng::set_render_mode_override(GL_LINES);
+    } else if(input->axis("render_points") != 0.0f) {
+        pepng::set_render_mode_override(GL_POINTS);
+    }
+}
+
+#ifdef IMGUI
+void RenderModeSwitch::imgui() {
+    Component::imgui();
+
+    auto current = pepng::render_mode_override();
+
+    int mode = current.has_value() ? (int) current.value() : -1;
+
+    ImGui::RadioButton("Own", &mode, -1);
+    ImGui::SameLine();
+    ImGui::RadioButton("Lines", &mode, (int) GL_LINES);
+    ImGui::SameLine();
+    ImGui::RadioButton("Points", &mode, (int) GL_POINTS);
+
+    if(mode == -1) {
+        pepng::set_render_mode_override(std::nullopt);
+    } else {
+        pepng::set_render_mode_override((GLenum) mode);
+    }
+}
+#endif
\ No newline at end of file
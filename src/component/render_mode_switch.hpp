@@ -0,0 +1,30 @@
+#pragma once
+
+#include <pepng.h>
+
+/**
+ * Component that sets the scene-wide render mode override from input.
+ *
+ * "render_triangles" restores every renderer's own mode, "render_lines" and "render_points" override it.
+ */
+class RenderModeSwitch : public Component {
+    public:
+        static std::shared_ptr<RenderModeSwitch> make_render_mode_switch();
+
+        virtual void update(std::shared_ptr<WithComponents> parent) override;
+
+        #ifdef IMGUI
+        virtual void imgui() override;
+        #endif
+
+    protected:
+        virtual RenderModeSwitch* clone_implementation() override;
+
+    private:
+        RenderModeSwitch();
+        RenderModeSwitch(const RenderModeSwitch& render_mode_switch);
+};
+
+namespace pepng {
+    std::shared_ptr<RenderModeSwitch> make_render_mode_switch();
+};
\ No newline at end of file
@@ -0,0 +1,62 @@
+#include "resolution_scaling.hpp"
+
+#include "../system/debug_ui.hpp"
+
+ResolutionScaling::ResolutionScaling(std::shared_ptr<DynamicResolution> resolution) :
+    Component("ResolutionScaling"),
+    __resolution(resolution)
+{}
+
+ResolutionScaling::ResolutionScaling(const ResolutionScaling& resolution_scaling) :
+    Component(resolution_scaling),
+    __resolution(resolution_scaling.__resolution)
+{}
+
+ResolutionScaling* ResolutionScaling::clone_implementation() {
+    return new ResolutionScaling(*this);
+}
+
+std::shared_ptr<ResolutionScaling> ResolutionScaling::make_resolution_scaling(std::shared_ptr<DynamicResolution> resolution) {
+    std::shared_ptr<ResolutionScaling> resolution_scaling(new ResolutionScaling(resolution));
+
+    return resolution_scaling;
+}
+
+std::shared_ptr<ResolutionScaling> pepng::make_resolution_scaling(std::shared_ptr<DynamicResolution> resolution) {
+    return ResolutionScaling::make_resolution_scaling(resolution);
+}
+
+void ResolutionScaling::render(std::shared_ptr<WithComponents> parent) {
+    #ifdef IMGUI
+    pepng::debug_section("Dynamic Resolution", [this]() {
+        this->__controls();
+    });
+    #endif
+}
+
+#ifdef IMGUI
+void ResolutionScaling::__controls() {
+    auto resolution = this->__resolution;
+
+    ImGui::Checkbox("Enabled", &resolution->enabled);
+    ImGui::SliderFloat("Budget (ms)", &resolution->budget_ms, 1.0f, 50.0f);
+    ImGui::SliderFloat("Min scale", &resolution->min_scale, 0.25f, 1.0f);
+    ImGui::SliderFloat("Max scale", &resolution->max_scale, 0.25f, 1.0f);
+
+    auto size = resolution->target_size();
+    float scale = resolution->scale();
+
+    ImGui::Text("Scale: %.2f (%dx%d of %dx%d)", scale, (int) (size.x * scale), (int) (size.y * scale), size.x, size.y);
+    #ifdef __EMSCRIPTEN__
+    ImGui::Text("Frame: %.2f ms", resolution->frame_ms());
+    #else
+    ImGui::Text("Scene GPU: %.2f ms", resolution->frame_ms());
+    #endif
+}
+
+void ResolutionScaling::imgui() {
+    Component::imgui();
+
+    this->__controls();
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <pepng.h>
+
+#include "../system/dynamic_resolution.hpp"
+
+/**
+ * Component exposing a DynamicResolution: budget, scale range and the current scale (also in the Debug window).
+ */
+class ResolutionScaling : public Component {
+    public:
+        static std::shared_ptr<ResolutionScaling> make_resolution_scaling(std::shared_ptr<DynamicResolution> resolution);
+
+        virtual void render(std::shared_ptr<WithComponents> parent) override;
+
+        #ifdef IMGUI
+        virtual void imgui() override;
+        #endif
+
+    protected:
+        virtual ResolutionScaling* clone_implementation() override;
+
+    private:
+        ResolutionScaling(std::shared_ptr<DynamicResolution> resolution);
+        ResolutionScaling(const ResolutionScaling& resolution_scaling);
+
+        #ifdef IMGUI
+        void __controls();
+        #endif
+
+        std::shared_ptr<DynamicResolution> __resolution;
+};
+
+namespace pepng {
+    std::shared_ptr<ResolutionScaling> make_resolution_scaling(std::shared_ptr<DynamicResolution> resolution = pepng::resolution());
+};
\ No newline at end of file
@@ -3,6 +3,8 @@
  */
 #include "rotation.hpp"
 
+#include "../system/input_log.hpp"
+
 /**
  * CONSTRUCTORS
  * 
@@ -15,10 +17,11 @@ Rotation::Rotation(float speed) :
     __speed(speed)
 {}
 
+// Rotations not initialised yet have no Transform to clone, init() binds it.
 Rotation::Rotation(const Rotation& rotation) : 
     Component(rotation),
     __speed(rotation.__speed),
-    __transform(std::dynamic_pointer_cast<Transform>(rotation.__transform->clone()))
+    __transform(rotation.__transform != nullptr ? std::dynamic_pointer_cast<Transform>(rotation.__transform->clone()) : nullptr)
 {}
 
 /**
@@ -66,18 +69,39 @@ void Rotation::init(std::shared_ptr<WithComponents> parent) {
 }
 
 void Rotation::update(std::shared_ptr<WithComponents> parent) {
+    // A ParallelUpdate higher in the hierarchy already ran this frame's update.
+    if (this->scheduled()) {
+        return;
+    }
+
+    this->parallel_update(parent);
+}
+
+void Rotation::parallel_update(std::shared_ptr<WithComponents> parent) {
+    // Not bound to a Transform until init().
+    if (this->__transform == nullptr) {
+        return;
+    }
+
     // Using the internal delta_rotate and applies relative rotation.
-    // Gets the values of the input "x" and "y" label defined in main.cpp.
+    // Gets the values of the input "x" and "y" label defined in main.cpp (through the InputLog, so they can be replayed).
     this->__transform->delta_rotate(
         glm::vec3(this->__transform->rotation_matrix() * glm::vec4(
-            this->__speed * pepng::input()->axis("x"), 
-            this->__speed * pepng::input()->axis("y"),
+            this->__speed * pepng::input_log()->axis("x"), 
+            this->__speed * pepng::input_log()->axis("y"),
             0.0f,
             1.0f
         ))
     );
 }
 
+void Rotation::remap(const std::function<std::shared_ptr<Component>(const std::shared_ptr<Component>&)>& map) {
+    // A Transform outside the Prefab keeps its clone.
+    if (auto transform = std::dynamic_pointer_cast<Transform>(map(this->__transform))) {
+        this->__transform = transform;
+    }
+}
+
 // Given we do not use render, we can leave empty.
 // It would be better to simply not override this, but was included for clarity.
 void Rotation::render(std::shared_ptr<WithComponents> parent) {}
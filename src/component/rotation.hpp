@@ -7,10 +7,15 @@
 
 #include <pepng.h>
 
+#include "parallel_update.hpp"
+#include "../object/prefab.hpp"
+
 /**
  * Component that rotates Object's Transform by speed * "x", "y" input every frame. 
+ * 
+ * It only touches its own Transform, so it is ParallelSafe.
  */
-class Rotation : public Component {
+class Rotation : public Component, public ParallelSafe, public PrefabLinked {
     public:
         /**
          * OO METHODS
@@ -35,9 +40,15 @@ class Rotation : public Component {
         // This method is called during the update loop.
         virtual void update(std::shared_ptr<WithComponents> parent) override;
 
+        // This method is called by ParallelUpdate (possibly on a worker thread).
+        virtual void parallel_update(std::shared_ptr<WithComponents> parent) override;
+
         // This method is called during the render loops.
         virtual void render(std::shared_ptr<WithComponents> parent) override;
 
+        // This method is called by Prefab on its copies (binds the cloned Transform to the copy's).
+        virtual void remap(const std::function<std::shared_ptr<Component>(const std::shared_ptr<Component>&)>& map) override;
+
         /**
          * IMGUI
          * 
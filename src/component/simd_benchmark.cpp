@@ -0,0 +1,77 @@
+#include "simd_benchmark.hpp"
+
+#include "../system/debug_ui.hpp"
+
+SimdBenchmark::SimdBenchmark() :
+    Component("SimdBenchmark")
+{}
+
+SimdBenchmark::SimdBenchmark(const SimdBenchmark& simd_benchmark) :
+    Component(simd_benchmark)
+{}
+
+SimdBenchmark* SimdBenchmark::clone_implementation() {
+    return new SimdBenchmark(*this);
+}
+
+std::shared_ptr<SimdBenchmark> SimdBenchmark::make_simd_benchmark() {
+    std::shared_ptr<SimdBenchmark> simd_benchmark(new SimdBenchmark());
+
+    return simd_benchmark;
+}
+
+std::shared_ptr<SimdBenchmark> pepng::make_simd_benchmark() {
+    return SimdBenchmark::make_simd_benchmark();
+}
+
+void SimdBenchmark::render(std::shared_ptr<WithComponents> parent) {
+    #ifdef IMGUI
+    pepng::debug_section("SIMD Math", [this]() {
+        this->__controls();
+    });
+    #endif
+}
+
+#ifdef IMGUI
+void SimdBenchmark::__controls() {
+    int level = (int) pepng::simd_level();
+
+    ImGui::Text("Kernels:");
+
+    for(auto option : pepng::simd_levels()) {
+        ImGui::SameLine();
+        ImGui::RadioButton(pepng::simd_level_name(option), &level, (int) option);
+    }
+
+    if(level != (int) pepng::simd_level()) {
+        pepng::set_simd_level((SimdLevel) level);
+    }
+
+    if(ImGui::Button("Run benchmark")) {
+        this->__timings = pepng::benchmark_simd();
+    }
+
+    if(this->__timings.empty()) {
+        return;
+    }
+
+    ImGui::Text("4096 elements, ms per call:");
+
+    // Speedup relative to the glm loop of the same kernel (listed first).
+    float baseline = 0.0f;
+
+    for(auto& timing : this->__timings) {
+        if(timing.path == "glm") {
+            baseline = timing.ms;
+        }
+
+        ImGui::Text("%-18s %-13s %.4f (x%.1f)", timing.kernel.c_str(), timing.path.c_str(), timing.ms, timing.ms > 0.0f ? baseline / timing.ms : 0.0f);
+    }
+}
+
+void SimdBenchmark::imgui() {
+    Component::imgui();
+
+    this->__controls();
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <pepng.h>
+
+#include "../system/simd_math.hpp"
+
+/**
+ * Component selecting the SIMD level of the batch math kernels and timing them against glm (in the Debug window).
+ */
+class SimdBenchmark : public Component {
+    public:
+        static std::shared_ptr<SimdBenchmark> make_simd_benchmark();
+
+        virtual void render(std::shared_ptr<WithComponents> parent) override;
+
+        #ifdef IMGUI
+        virtual void imgui() override;
+        #endif
+
+    protected:
+        virtual SimdBenchmark* clone_implementation() override;
+
+    private:
+        SimdBenchmark();
+        SimdBenchmark(const SimdBenchmark& simd_benchmark);
+
+        #ifdef IMGUI
+        void __controls();
+        #endif
+
+        // Results of the last run (empty until the button is pressed, it takes a few frames worth of time).
+        std::vector<SimdTiming> __timings;
+};
+
+namespace pepng {
+    std::shared_ptr<SimdBenchmark> make_simd_benchmark();
+};
\ No newline at end of file
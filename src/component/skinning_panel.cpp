@@ -0,0 +1,55 @@
+#include "skinning_panel.hpp"
+
+#include "../system/debug_ui.hpp"
+
+SkinningPanel::SkinningPanel(std::shared_ptr<Skinning> skinning) :
+    Component("SkinningPanel"),
+    __skinning(skinning)
+{}
+
+SkinningPanel::SkinningPanel(const SkinningPanel& skinning_panel) :
+    Component(skinning_panel),
+    __skinning(skinning_panel.__skinning)
+{}
+
+SkinningPanel* SkinningPanel::clone_implementation() {
+    return new SkinningPanel(*this);
+}
+
+std::shared_ptr<SkinningPanel> SkinningPanel::make_skinning_panel(std::shared_ptr<Skinning> skinning) {
+    std::shared_ptr<SkinningPanel> skinning_panel(new SkinningPanel(skinning));
+
+    return skinning_panel;
+}
+
+std::shared_ptr<SkinningPanel> pepng::make_skinning_panel(std::shared_ptr<Skinning> skinning) {
+    return SkinningPanel::make_skinning_panel(skinning);
+}
+
+void SkinningPanel::render(std::shared_ptr<WithComponents> parent) {
+    #ifdef IMGUI
+    pepng::debug_section("Skinning", [this]() {
+        this->__controls();
+    });
+    #endif
+}
+
+#ifdef IMGUI
+void SkinningPanel::__controls() {
+    auto skinning = this->__skinning;
+
+    ImGui::Checkbox("Enabled", &skinning->enabled);
+
+    auto& stats = skinning->stats();
+
+    ImGui::Text("Characters: %zu (%zu visible, %zu dropped)", stats.instances, stats.visible, stats.dropped);
+    ImGui::Text("Draws: %zu", stats.draws);
+    ImGui::Text("Palettes: %.1f KB", stats.palette_bytes / 1024.0f);
+}
+
+void SkinningPanel::imgui() {
+    Component::imgui();
+
+    this->__controls();
+}
+#endif
\ No newline at end of file
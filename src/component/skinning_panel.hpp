@@ -0,0 +1,36 @@
+#pragma once
+
+#include <pepng.h>
+
+#include "../system/skinning.hpp"
+
+/**
+ * Component exposing Skinning (toggle and instancing statistics, also in the Debug window).
+ */
+class SkinningPanel : public Component {
+    public:
+        static std::shared_ptr<SkinningPanel> make_skinning_panel(std::shared_ptr<Skinning> skinning);
+
+        virtual void render(std::shared_ptr<WithComponents> parent) override;
+
+        #ifdef IMGUI
+        virtual void imgui() override;
+        #endif
+
+    protected:
+        virtual SkinningPanel* clone_implementation() override;
+
+    private:
+        SkinningPanel(std::shared_ptr<Skinning> skinning);
+        SkinningPanel(const SkinningPanel& skinning_panel);
+
+        #ifdef IMGUI
+        void __controls();
+        #endif
+
+        std::shared_ptr<Skinning> __skinning;
+};
+
+namespace pepng {
+    std::shared_ptr<SkinningPanel> make_skinning_panel(std::shared_ptr<Skinning> skinning = pepng::skinning());
+};
\ No newline at end of file
@@ -1,5 +1,10 @@
 #include "skybox.hpp"
 
+#include "../system/command_list.hpp"
+#include "../system/memory.hpp"
+#include "../system/model_info.hpp"
+#include "../system/view.hpp"
+
 Skybox::Skybox(std::shared_ptr<Material> material) 
 : Component("Skybox"), material(material)
 {}
@@ -29,18 +34,6 @@ void Skybox::render(std::shared_ptr<WithComponents> parent) {
 
     auto shaderProgram = this->material->shader_program();
 
-    glUseProgram(shaderProgram);
-
-    if(Camera::current_camera == nullptr) {
-        throw std::runtime_error("No current camera set.");
-    }
-
-    Camera::current_camera->render(shaderProgram);
-
-    glActiveTexture(GL_TEXTURE0);
-
-    glBindTexture(GL_TEXTURE_2D, this->material->texture->gl_index());
-
     std::shared_ptr<Transform> transform;
 
     try {
@@ -52,43 +45,22 @@ void Skybox::render(std::shared_ptr<WithComponents> parent) {
 
         throw std::runtime_error(ss.str());
     }
-    
-    GLuint uWorld = glGetUniformLocation(shaderProgram, "u_world");
-
-    if (uWorld >= 0) {
-        auto worldMatrix = transform->parent_matrix
-            * glm::translate(glm::mat4(1.0f), this->model->offset())
-            * transform->world_matrix()
-            * glm::translate(glm::mat4(1.0f), -this->model->offset());
-
-        glUniformMatrix4fv(
-            uWorld,
-            1,
-            GL_FALSE,
-            glm::value_ptr(worldMatrix)
-        );
-    }
-
-    GLuint uDisplayTexture = glGetUniformLocation(shaderProgram, "u_display_texture");
-
-    if(uDisplayTexture >= 0) {
-        glUniform1f(
-            uDisplayTexture,
-            GL_TRUE
-        );
-    }
 
-    glDepthMask(0);
+    auto& view = pepng::current_view();
+    auto& list = pepng::commands()->record();
 
-    glBindVertexArray(this->model->vao());
+    list.use_program(shaderProgram);
+    list.uniform(pepng::uniform_location(shaderProgram, "u_projection"), view.projection);
+    list.uniform(pepng::uniform_location(shaderProgram, "u_view"), view.view);
+    list.uniform(pepng::uniform_location(shaderProgram, "u_world"), pepng::model_matrix(transform, this->model));
+    list.uniform(pepng::uniform_location(shaderProgram, "u_display_texture"), (float) GL_TRUE);
 
-    glDrawArrays(
-        GL_TRIANGLES,
-        0,
-        this->model->count()
-    );
+    list.bind_texture(0, GL_TEXTURE_2D, this->material->texture->gl_index());
 
-    glDepthMask(1);
+    list.depth_mask(false);
+    list.bind_vertex_array(this->model->vao());
+    list.draw_arrays(GL_TRIANGLES, 0, this->model->count());
+    list.depth_mask(true);
 }
 
 void Skybox::init(std::shared_ptr<WithComponents> object) {
@@ -121,6 +93,12 @@ void Skybox::init(std::shared_ptr<WithComponents> object) {
     )
     ->set_count(36)
     ->set_name("Cube");
+
+    auto owner = std::dynamic_pointer_cast<Object>(object);
+    auto name = owner != nullptr ? owner->name : "Skybox";
+
+    pepng::memory()->observe(this->model, name);
+    pepng::memory()->observe(this->material->texture, name);
 }
 
 #ifdef IMGUI
@@ -0,0 +1,86 @@
+#include "streamed_texture.hpp"
+
+#include "extra_renderer.hpp"
+#include "../system/input_log.hpp"
+
+StreamedTexture::StreamedTexture(std::shared_ptr<TextureStream> stream) :
+    Component("StreamedTexture"),
+    __stream(stream)
+{}
+
+StreamedTexture::StreamedTexture(const StreamedTexture& streamed_texture) :
+    Component(streamed_texture),
+    __stream(streamed_texture.__stream)
+{}
+
+StreamedTexture* StreamedTexture::clone_implementation() {
+    return new StreamedTexture(*this);
+}
+
+std::shared_ptr<StreamedTexture> StreamedTexture::make_streamed_texture(std::shared_ptr<TextureStream> stream) {
+    std::shared_ptr<StreamedTexture> streamed_texture(new StreamedTexture(stream));
+
+    return streamed_texture;
+}
+
+std::shared_ptr<StreamedTexture> pepng::make_streamed_texture(std::shared_ptr<TextureStream> stream) {
+    return StreamedTexture::make_streamed_texture(stream);
+}
+
+std::shared_ptr<StreamedTexture> pepng::make_streamed_texture(std::shared_ptr<FrameSource> source) {
+    return StreamedTexture::make_streamed_texture(pepng::make_texture_stream(source));
+}
+
+void StreamedTexture::init(std::shared_ptr<WithComponents> parent) {
+    auto renderer = parent->get_component<ExtraRenderer>();
+
+    if(renderer == nullptr) {
+        std::stringstream ss;
+
+        ss << *parent << " has no ExtraRenderer which StreamedTexture requires." << std::endl;
+
+        throw std::runtime_error(ss.str());
+    }
+
+    // Prefab copies share their material: the stream goes on a copy of its own.
+    auto material = std::dynamic_pointer_cast<ExtraMaterial>(renderer->extra_material->clone());
+    material->texture_stream = this->__stream;
+
+    renderer->extra_material = material;
+    renderer->material = material;
+}
+
+void StreamedTexture::update(std::shared_ptr<WithComponents> parent) {
+    if(!this->active()) {
+        return;
+    }
+
+    // The replayed frame time keeps recorded runs showing the same frames.
+    this->__stream->advance(pepng::input_log()->delta_time());
+}
+
+#ifdef IMGUI
+void StreamedTexture::imgui() {
+    Component::imgui();
+
+    auto stream = this->__stream;
+
+    ImGui::Checkbox("Paused", &stream->paused);
+    ImGui::SliderFloat("Speed", &stream->speed, 0.0f, 4.0f);
+
+    bool loop = stream->loop();
+
+    if(ImGui::Checkbox("Loop", &loop)) {
+        stream->set_loop(loop);
+    }
+
+    auto stats = stream->stats();
+    auto size = stream->source()->size();
+
+    ImGui::Text("Frame: %zu (%dx%d at %.1f fps)", stream->frame(), size.x, size.y, stream->source()->fps());
+    ImGui::Text("Decoded: %zu, presented: %zu", stats.decoded, stats.presented);
+    ImGui::Text("Dropped: %zu, skipped: %zu, late: %zu, failed: %zu", stats.dropped, stats.skipped, stats.late, stats.failed);
+    ImGui::Text("Decode: %.2f ms, upload: %.2f ms", stats.decode_ms, stats.upload_ms);
+    ImGui::Text("Memory: %.1f MB", stats.bytes / (1024.0f * 1024.0f));
+}
+#endif
\ No newline at end of file
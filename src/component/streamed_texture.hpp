@@ -0,0 +1,40 @@
+#pragma once
+
+#include <pepng.h>
+
+#include "../system/texture_stream.hpp"
+
+/**
+ * Component playing a TextureStream on its Object's ExtraRenderer (in place of the material texture).
+ *
+ * Clones share the stream.
+ */
+class StreamedTexture : public Component {
+    public:
+        static std::shared_ptr<StreamedTexture> make_streamed_texture(std::shared_ptr<TextureStream> stream);
+
+        virtual void init(std::shared_ptr<WithComponents> parent) override;
+        virtual void update(std::shared_ptr<WithComponents> parent) override;
+
+        #ifdef IMGUI
+        virtual void imgui() override;
+        #endif
+
+    protected:
+        virtual StreamedTexture* clone_implementation() override;
+
+    private:
+        StreamedTexture(std::shared_ptr<TextureStream> stream);
+        StreamedTexture(const StreamedTexture& streamed_texture);
+
+        std::shared_ptr<TextureStream> __stream;
+};
+
+namespace pepng {
+    std::shared_ptr<StreamedTexture> make_streamed_texture(std::shared_ptr<TextureStream> stream);
+
+    /**
+     * Streams a FrameSource (6 frames decoded ahead).
+     */
+    std::shared_ptr<StreamedTexture> make_streamed_texture(std::shared_ptr<FrameSource> source);
+};
\ No newline at end of file
@@ -0,0 +1,65 @@
+#include "streaming_panel.hpp"
+
+#include "../system/debug_ui.hpp"
+#include "../system/resources.hpp"
+
+StreamingPanel::StreamingPanel(std::shared_ptr<AssetStreaming> streaming) :
+    Component("StreamingPanel"),
+    __streaming(streaming)
+{}
+
+StreamingPanel::StreamingPanel(const StreamingPanel& streaming_panel) :
+    Component(streaming_panel),
+    __streaming(streaming_panel.__streaming)
+{}
+
+StreamingPanel* StreamingPanel::clone_implementation() {
+    return new StreamingPanel(*this);
+}
+
+std::shared_ptr<StreamingPanel> StreamingPanel::make_streaming_panel(std::shared_ptr<AssetStreaming> streaming) {
+    std::shared_ptr<StreamingPanel> streaming_panel(new StreamingPanel(streaming));
+
+    return streaming_panel;
+}
+
+std::shared_ptr<StreamingPanel> pepng::make_streaming_panel(std::shared_ptr<AssetStreaming> streaming) {
+    return StreamingPanel::make_streaming_panel(streaming);
+}
+
+void StreamingPanel::render(std::shared_ptr<WithComponents> parent) {
+    #ifdef IMGUI
+    pepng::debug_section("Streaming", [this]() {
+        this->__controls();
+    });
+    #endif
+}
+
+#ifdef IMGUI
+void StreamingPanel::__controls() {
+    auto streaming = this->__streaming;
+
+    ImGui::Checkbox("Enabled", &streaming->enabled);
+    ImGui::SliderFloat("Load distance", &streaming->load_distance, 1.0f, 500.0f);
+    ImGui::SliderFloat("Prefetch (s)", &streaming->prefetch_time, 0.0f, 5.0f);
+
+    int uploads = (int) streaming->uploads_per_frame;
+
+    if(ImGui::SliderInt("Uploads per frame", &uploads, 1, 16)) {
+        streaming->uploads_per_frame = (size_t) uploads;
+    }
+
+    auto& stats = streaming->stats();
+
+    ImGui::Text("Models: %zu (%zu resident, %zu loading)", stats.models, stats.resident, stats.pending);
+    ImGui::Text("Uploads: %zu (%zu objects prefetched)", stats.uploads, stats.prefetched);
+    ImGui::Text("Camera speed: %.1f", stats.speed);
+    ImGui::Text("Textures: %.1f MB", pepng::resources()->resident_bytes() / (1024.0f * 1024.0f));
+}
+
+void StreamingPanel::imgui() {
+    Component::imgui();
+
+    this->__controls();
+}
+#endif
\ No newline at end of file
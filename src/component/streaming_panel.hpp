@@ -0,0 +1,36 @@
+#pragma once
+
+#include <pepng.h>
+
+#include "../system/asset_streaming.hpp"
+
+/**
+ * Component exposing AssetStreaming (settings and residency statistics, also in the Debug window).
+ */
+class StreamingPanel : public Component {
+    public:
+        static std::shared_ptr<StreamingPanel> make_streaming_panel(std::shared_ptr<AssetStreaming> streaming);
+
+        virtual void render(std::shared_ptr<WithComponents> parent) override;
+
+        #ifdef IMGUI
+        virtual void imgui() override;
+        #endif
+
+    protected:
+        virtual StreamingPanel* clone_implementation() override;
+
+    private:
+        StreamingPanel(std::shared_ptr<AssetStreaming> streaming);
+        StreamingPanel(const StreamingPanel& streaming_panel);
+
+        #ifdef IMGUI
+        void __controls();
+        #endif
+
+        std::shared_ptr<AssetStreaming> __streaming;
+};
+
+namespace pepng {
+    std::shared_ptr<StreamingPanel> make_streaming_panel(std::shared_ptr<AssetStreaming> streaming = pepng::asset_streaming());
+};
\ No newline at end of file
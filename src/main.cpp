@@ -15,9 +15,107 @@
 #include "./component/skybox.hpp"
 #include "./component/extra_material.hpp"
 #include "./component/extra_renderer.hpp"
-
-int main()
+#include "./component/command_flush.hpp"
+#include "./component/frame_start.hpp"
+#include "./component/occluder.hpp"
+#include "./component/occlusion_culling.hpp"
+#include "./component/render_mode_switch.hpp"
+#include "./component/picker.hpp"
+#include "./component/memory_panel.hpp"
+#include "./component/point_light.hpp"
+#include "./component/clustered_lighting.hpp"
+#include "./component/simd_benchmark.hpp"
+#include "./component/resolution_scaling.hpp"
+#include "./component/input_replay.hpp"
+#include "./component/redraw_on_demand.hpp"
+#include "./component/outliner.hpp"
+#include "./component/multi_view_panel.hpp"
+#include "./component/debug_draw_panel.hpp"
+#include "./component/streamed_texture.hpp"
+#include "./component/capture_camera.hpp"
+#include "./component/animator.hpp"
+#include "./component/skinning_panel.hpp"
+#include "./component/particle_emitter.hpp"
+#include "./component/streaming_panel.hpp"
+#include "./system/collada.hpp"
+#include "./system/debug_draw.hpp"
+#include "./system/lod.hpp"
+#include "./system/obj.hpp"
+#include "./system/offscreen_capture.hpp"
+#include "./system/resources.hpp"
+#include "./system/skinning.hpp"
+
+int main(int argc, char** argv)
 {
+    /**
+     * OPTIONS
+     *
+     * --capture <directory> writes images of the scene then quits (thumbnails on build servers).
+     * --size <width>x<height>, --turntable <count> (orbit around the stage) or --frames <count> (from the camera).
+     * --headless creates the context without a display.
+     */
+    std::filesystem::path capture_path;
+    glm::ivec2 capture_size(512, 512);
+    size_t capture_count = 36;
+    bool turntable = true;
+    bool headless = false;
+
+    auto usage = [&]() {
+        std::cout << "Usage: " << argv[0] << " [--capture <directory>] [--size <width>x<height>] [--turntable <count> | --frames <count>] [--headless]" << std::endl;
+
+        return 1;
+    };
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        bool has_value = i + 1 < argc;
+
+        if (argument == "--capture" && has_value)
+            capture_path = argv[++i];
+        else if (argument == "--size" && has_value)
+        {
+            char extra;
+
+            // Exactly <width>x<height>, both positive.
+            if (std::sscanf(argv[++i], "%dx%d%c", &capture_size.x, &capture_size.y, &extra) != 2 || capture_size.x <= 0 || capture_size.y <= 0)
+                return usage();
+        }
+        else if ((argument == "--turntable" || argument == "--frames") && has_value)
+        {
+            turntable = argument == "--turntable";
+
+            char* end = nullptr;
+            long count = std::strtol(argv[++i], &end, 10);
+
+            if (end == argv[i] || *end != '\0' || count <= 0)
+                return usage();
+
+            capture_count = (size_t) count;
+        }
+        else if (argument == "--headless")
+            headless = true;
+        else
+            return usage();
+    }
+
+    if (headless)
+    {
+        #ifdef GLFW_PLATFORM_NULL
+        // GLFW 3.4's null platform opens no window and has no native context API, so the context comes from EGL
+        // (surfaceless Mesa, llvmpipe without a GPU). GLFW is initialized here because glfwInit resets the window
+        // hints (pepng::init's own glfwInit then does nothing).
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+
+        if (!glfwInit())
+            return -1;
+
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+        #else
+        std::cout << "--headless needs GLFW 3.4, a window is opened instead." << std::endl;
+        #endif
+    }
+
     // Attempts to initialize GLFW and IMGUI (if included). If it fails, kill the program by returning -1.
     if (!pepng::init("PEPNG", 1920, 1080))
         return -1;
@@ -45,15 +143,9 @@ int main()
     // Binds missing texture. This NEEDS to be performed before loading any other texture.
     pepng::set_missing_texture(texture_path / "missing.jpg");
 
-    // Load screens for stage.
-    for (int i = 1; i <= 3; i++)
-    {
-        pepng::make_texture(model_path / "pa2" / "screens" / (std::to_string(i) + ".jpg"))->delayed_init();
-    }
-
-    //Binds the skybox texture
-    static auto skybox_texture = pepng::make_texture(texture_path / "skybox2.jpg");
-    skybox_texture->delayed_init();
+    // Binds the skybox texture. Always visible, so it is pinned against eviction.
+    auto skybox_texture = pepng::resources()->texture(texture_path / "skybox2.jpg");
+    skybox_texture->pin();
 
     // Sets the window icon (optional).
     pepng::set_window_icon(texture_path / "logo.png");
@@ -74,6 +166,9 @@ int main()
         pepng::make_shader(shader_path / "line" / "vertex.glsl", GL_VERTEX_SHADER),
         pepng::make_shader(shader_path / "line" / "fragment.glsl", GL_FRAGMENT_SHADER));
 
+    // Batched debug lines are drawn with the line shader.
+    pepng::debug_draw()->program = line_shader_program;
+
     auto shadow_shader_program = pepng::make_shader_program(
         pepng::make_shader(shader_path / "shadow" / "vertex330.glsl", GL_VERTEX_SHADER),
         pepng::make_shader(shader_path / "shadow" / "fragment330.glsl", GL_FRAGMENT_SHADER),
@@ -82,6 +177,29 @@ int main()
     // Sets the shadow shader for the object/scene loader (used later).
     pepng::set_shadow_shader(shadow_shader_program);
 
+    // Writes object IDs for GPU picking.
+    auto picking_shader_program = pepng::make_shader_program(
+        pepng::make_shader(shader_path / "picking" / "vertex.glsl", GL_VERTEX_SHADER),
+        pepng::make_shader(shader_path / "picking" / "fragment.glsl", GL_FRAGMENT_SHADER));
+
+    // Object shading with the vertices skinned by a palette texture.
+    auto skinned_shader_program = pepng::make_shader_program(
+        pepng::make_shader(shader_path / "skinned" / "vertex.glsl", GL_VERTEX_SHADER),
+        pepng::make_shader(shader_path / "object" / "fragment.glsl", GL_FRAGMENT_SHADER));
+
+    // Animated characters are drawn with the skinned shader.
+    pepng::skinning()->program = skinned_shader_program;
+
+    // Object shading of camera facing quads, one per particle instance.
+    auto particle_shader_program = pepng::make_shader_program(
+        pepng::make_shader(shader_path / "particle" / "vertex.glsl", GL_VERTEX_SHADER),
+        pepng::make_shader(shader_path / "object" / "fragment.glsl", GL_FRAGMENT_SHADER));
+
+    // Upscales the dynamic resolution target when it cannot be blitted into the window.
+    pepng::resolution()->program = pepng::make_shader_program(
+        pepng::make_shader(shader_path / "upscale" / "vertex.glsl", GL_VERTEX_SHADER),
+        pepng::make_shader(shader_path / "upscale" / "fragment.glsl", GL_FRAGMENT_SHADER));
+
     static auto skybox_shader_program = pepng::make_shader_program(
         pepng::make_shader(shader_path / "skybox" / "vertex.glsl", GL_VERTEX_SHADER),
         pepng::make_shader(shader_path / "skybox" / "fragment.glsl", GL_FRAGMENT_SHADER));
@@ -92,8 +210,8 @@ int main()
      * Binds GLFW input to PEPNG labels.
      * This allows for multiple binding to labels.
      * 
-     * The following binds Mouse X, Y and WASD to "x", "y".
-     * This is used in /component/rotation.cpp.
+     * The following binds I/K and N/M to "x", "y".
+     * This is used in /component/rotation.cpp (it spins the letters).
      */
 
     // Creates and attaches Mouse.
@@ -103,7 +221,8 @@ int main()
                      ->attach_unit(pepng::make_axis("zoom", AxisType::THIRD, 25.0f, true))
                      ->attach_unit(pepng::make_button("pan", GLFW_MOUSE_BUTTON_MIDDLE))
                      ->attach_unit(pepng::make_button("pan", GLFW_MOUSE_BUTTON_4))
-                     ->attach_unit(pepng::make_button("rotate", GLFW_MOUSE_BUTTON_RIGHT));
+                     ->attach_unit(pepng::make_button("rotate", GLFW_MOUSE_BUTTON_RIGHT))
+                     ->attach_unit(pepng::make_button("pick", GLFW_MOUSE_BUTTON_LEFT));
 
     pepng::attach_device(mouse);
 
@@ -120,14 +239,18 @@ int main()
                         ->attach_unit(pepng::make_button("yaw", GLFW_KEY_DOWN, -1.0f))
                         ->attach_unit(pepng::make_button("pitch", GLFW_KEY_LEFT))
                         ->attach_unit(pepng::make_button("pitch", GLFW_KEY_RIGHT, -1.0f))
-                        ->attach_unit(pepng::make_button("triangles", GLFW_KEY_T))
-                        ->attach_unit(pepng::make_button("points", GLFW_KEY_P))
-                        ->attach_unit(pepng::make_button("lines", GLFW_KEY_L))
+                        ->attach_unit(pepng::make_button("render_triangles", GLFW_KEY_T))
+                        ->attach_unit(pepng::make_button("render_points", GLFW_KEY_P))
+                        ->attach_unit(pepng::make_button("render_lines", GLFW_KEY_L))
                         ->attach_unit(pepng::make_button("recenter", GLFW_KEY_HOME))
                         ->attach_unit(pepng::make_button("shadow", GLFW_KEY_B))
                         ->attach_unit(pepng::make_button("texture", GLFW_KEY_X))
                         ->attach_unit(pepng::make_button("scale", GLFW_KEY_U))
-                        ->attach_unit(pepng::make_button("scale", GLFW_KEY_J, -1.0f));
+                        ->attach_unit(pepng::make_button("scale", GLFW_KEY_J, -1.0f))
+                        ->attach_unit(pepng::make_button("x", GLFW_KEY_I))
+                        ->attach_unit(pepng::make_button("x", GLFW_KEY_K, -1.0f))
+                        ->attach_unit(pepng::make_button("y", GLFW_KEY_N))
+                        ->attach_unit(pepng::make_button("y", GLFW_KEY_M, -1.0f));
 
     for (int i = 0; i < 10; i++)
     {
@@ -140,6 +263,23 @@ int main()
 
     pepng::attach_device(keyboard);
 
+    // Labels the app reads through the InputLog, recorded and replayed (Debug > Input Replay).
+    pepng::input_log()->track({ "pick", "x", "y", "render_triangles", "render_lines", "render_points" });
+
+    // Labels the engine reads itself: the camera is replayed through its pose, these only keep held keys redrawing.
+    std::vector<std::string> engine_labels = {
+        "mouseX", "mouseY", "zoom", "pan", "rotate",
+        "vertical", "horizontal", "svertical", "shorizontal", "yaw", "pitch",
+        "recenter", "scale", "shadow", "texture"
+    };
+
+    for (int i = 0; i < 10; i++)
+    {
+        engine_labels.push_back("object_" + std::to_string(i));
+    }
+
+    pepng::input_log()->watch(engine_labels);
+
     /**
      * OBJECTS
      * 
@@ -149,51 +289,50 @@ int main()
      * (COLLADA files are the most simple and effective.)
      */
 
-    // Primitives
-    std::shared_ptr<Model> cylinder_model;
-    std::shared_ptr<Model> sphere_model;
-    std::shared_ptr<Model> cube_model;
-    std::shared_ptr<Model> cone_model;
-
-    auto cylinder = pepng::make_model();
-    auto sphere = pepng::make_model();
-    auto cube = pepng::make_model();
-    auto cone = pepng::make_model();
-
-    pepng::extra::load_file_sync(
-        model_path / "primitives/cylinder.dae",
-        std::function([&](std::shared_ptr<Object> object) {
-            auto cylinder = object->children.at(0);
-            cylinder_model = cylinder->get_component<Renderer>()->model;
-        }),
-        pepng::make_transform());
+    // Reads the camera before anything records, and hosts the engine panels. Instantiated first so it renders first.
+    auto systems = pepng::make_object("Systems");
+    systems->attach_component(pepng::make_transform())
+        ->attach_component(pepng::make_frame_start(object_shader_program))
+        ->attach_component(pepng::make_occlusion_culling())
+        // T/L/P set a scene-wide render mode instead of editing every Renderer.
+        ->attach_component(pepng::make_render_mode_switch())
+        // Left click picks the Object under the cursor.
+        ->attach_component(pepng::make_picker(picking_shader_program))
+        ->attach_component(pepng::make_memory_panel())
+        ->attach_component(pepng::make_clustered_lighting())
+        ->attach_component(pepng::make_simd_benchmark())
+        // The scene is rendered at a resolution scale that holds the frame time budget.
+        ->attach_component(pepng::make_resolution_scaling())
+        // Opt-in: blocks on events while the frames would be identical.
+        ->attach_component(pepng::make_redraw_on_demand())
+        // Opt-in: the main camera plus the top view share one culling/recording pass.
+        ->attach_component(pepng::make_multi_view_panel())
+        // Batched debug lines (picked bounds, light ranges).
+        ->attach_component(pepng::make_debug_draw_panel())
+        // Instanced skinned characters.
+        ->attach_component(pepng::make_skinning_panel())
+        // Models and textures loaded as they come into view.
+        ->attach_component(pepng::make_streaming_panel());
+    pepng::instantiate(systems);
 
-    pepng::extra::load_file_sync(
-        model_path / "primitives/sphere.dae",
-        std::function([&](std::shared_ptr<Object> object) {
-            auto sphere = object->children.at(0);
-            sphere_model = sphere->get_component<Renderer>()->model;
-        }),
-        pepng::make_transform());
+    // Primitives
+    std::shared_ptr<ModelHandle> cylinder_model;
+    std::shared_ptr<ModelHandle> sphere_model;
+    std::shared_ptr<ModelHandle> cube_model;
+    std::shared_ptr<ModelHandle> cone_model;
 
-    pepng::extra::load_file_sync(
-        model_path / "primitives/cube.dae",
-        std::function([&](std::shared_ptr<Object> object) {
-            auto cube = object->children.at(0);
-            cube_model = cube->get_component<Renderer>()->model;
-        }),
-        pepng::make_transform());
+    // The primitives only need geometry, so they go through the streaming COLLADA loader, once their objects are in view.
+    auto load_primitive = [&](const std::string& name) {
+        return pepng::asset_streaming()->model(model_path / "primitives" / (name + ".dae"), true);
+    };
 
-    pepng::extra::load_file_sync(
-        model_path / "primitives/cone.dae",
-        std::function([&](std::shared_ptr<Object> object) {
-            auto cone = object->children.at(0);
-            cone_model = cone->get_component<Renderer>()->model;
-        }),
-        pepng::make_transform());
+    cylinder_model = load_primitive("cylinder");
+    sphere_model = load_primitive("sphere");
+    cube_model = load_primitive("cube");
+    cone_model = load_primitive("cone");
 
     // Axis
-    auto x_material = pepng::make_extra_material(object_shader_program, pepng::make_texture(texture_path / "texture.jpg"));
+    auto x_material = pepng::make_extra_material(object_shader_program, pepng::resources()->texture(texture_path / "texture.jpg"));
     auto y_material = pepng::make_extra_material(object_shader_program, pepng::make_texture(), glm::vec3(0.0f, 1.0f, 0.0f));
     auto z_material = pepng::make_extra_material(object_shader_program, pepng::make_texture(), glm::vec3(0.0f, 0.0f, 1.0f));
 
@@ -257,7 +396,7 @@ int main()
     pepng::instantiate(axis);
 
     // Letters
-    auto letters_material = pepng::make_extra_material(object_shader_program, pepng::make_texture(texture_path / "texture1.jpg"));
+    auto letters_material = pepng::make_extra_material(object_shader_program, pepng::resources()->texture(texture_path / "texture1.jpg"));
     // J
     auto letter_j1 = pepng::make_object("J1");
     letter_j1->attach_component(pepng::make_transform(glm::vec3(0.0f, 0.0f, 0.0f),
@@ -500,6 +639,14 @@ int main()
     letters->attach_child(letter_2a);
     letters->attach_child(letter_n);
     letters->attach_child(letter_p);
+    // Every letter spins on its own (Rotation is ParallelSafe), so they run on the job system.
+    for (auto& letter : letters->children)
+    {
+        letter->attach_component(pepng::make_rotation(2.0f));
+    }
+    letters->attach_component(pepng::make_parallel_update());
+    // Lists the hierarchy in the Scene Tree window.
+    letters->attach_component(pepng::make_outliner());
     pepng::instantiate(letters);
 
     // PA2 scne
@@ -510,29 +657,44 @@ int main()
                 glm::vec3(0.0f, 0.0f, 0.0f),
                 glm::vec3(128.0f, 128.0f, 128.0f)),
             line_shader_program,
-            129, glm::vec4(1.0f, 1.0f, 1.0f, 1.0f)));
+            129, glm::vec4(1.0f, 1.0f, 1.0f, 0.5f)));
+
+    // The screen images of the Display, loaded here on the GL thread (the stream only copies them).
+    auto screens = pepng::make_image_sequence(model_path / "pa2" / "screens");
 
     pepng::load_file(
         model_path / "pa2" / "scene.dae",
-        std::function([](std::shared_ptr<Object> object) {
+        std::function([screens](std::shared_ptr<Object> object) {
             object->attach_component(pepng::make_selector());
+            // Runs the ParallelSafe components of the scene on the job system.
+            object->attach_component(pepng::make_parallel_update());
+            object->attach_component(pepng::make_outliner());
 
             object->get_component<Transform>()->position = glm::vec3(0.0f, 0.0f, -25.0f);
 
             // Binds components to loaded objects.
-            object->for_each([](std::shared_ptr<Object> obj) {
+            object->for_each([screens](std::shared_ptr<Object> obj) {
                 obj->attach_component(pepng::make_transformer());
 
                 if (obj->has_component<Renderer>())
                 {
+                    // LOD levels are generated on first render.
+                    pepng::enable_lods(obj->get_component<Renderer>()->model);
+
                     auto extra_renderer = pepng::make_extra_renderer(obj->get_component<Renderer>());
                     obj->replace_components<Renderer>(extra_renderer);
+
+                    // Large stage pieces hide what is behind them (CPU occlusion culling).
+                    if (obj->name == "Stage" || obj->name == "Screen" || obj->name == "Pillar" || obj->name == "Pillar.001")
+                    {
+                        obj->attach_component(pepng::make_occluder());
+                    }
                 }
 
-                // Adds DynamicTexture if object named Display (in this case, the screen).
+                // Cycles the screen images on the object named Display (in this case, the screen), streamed through a ring of textures.
                 if (obj->name == "Display")
                 {
-                    obj->attach_component(pepng::make_dynamic_texture(2, 4));
+                    obj->attach_component(pepng::make_streamed_texture(screens));
                 }
             });
 
@@ -540,10 +702,145 @@ int main()
         }),
         pepng::make_transform());
 
+    // LIGHTS
+    // A grid of colored point lights over the PA2 stage (clustered lighting only shades each fragment with its cluster's lights).
+    auto lights = pepng::make_object("Lights");
+    lights->attach_component(pepng::make_transform(glm::vec3(0.0f, 3.0f, -25.0f)));
+
+    for (int i = 0; i < 16; i++)
+    {
+        for (int j = 0; j < 8; j++)
+        {
+            std::stringstream ss;
+
+            ss << "Light " << i << "." << j;
+
+            float hue = (i * 8 + j) / 128.0f * 6.2831853f;
+            glm::vec3 color = glm::vec3(std::sin(hue), std::sin(hue + 2.0943951f), std::sin(hue + 4.1887902f)) * 0.5f + 0.5f;
+
+            auto light = pepng::make_object(ss.str());
+            light->attach_component(pepng::make_transform(glm::vec3((i - 7.5f) * 4.0f, 0.0f, (j - 3.5f) * 5.0f)))
+                ->attach_component(pepng::make_point_light(color, 1.5f, 6.0f));
+
+            lights->attach_child(light);
+        }
+    }
+
+    lights->attach_component(pepng::make_outliner());
+
+    pepng::instantiate(lights);
+
+    // OBJ
+    // Primitives converted to OBJ, parsed in chunks on the job system (one object per shape).
+    auto obj_scene = pepng::load_obj(model_path / "obj" / "primitives.obj");
+
+    auto obj_primitives = pepng::make_object("OBJ Primitives");
+    obj_primitives->attach_component(pepng::make_transform(glm::vec3(-45.0f, 1.0f, -25.0f)));
+
+    for (size_t i = 0; i < obj_scene->shapes.size(); i++)
+    {
+        auto& shape = obj_scene->shapes[i];
+
+        std::shared_ptr<ExtraMaterial> material;
+
+        if (shape.material < 0)
+        {
+            material = pepng::make_extra_material(object_shader_program, pepng::make_texture(), glm::vec3(1.0f));
+        }
+        else
+        {
+            auto& obj_material = obj_scene->materials[shape.material];
+
+            material = obj_material.diffuse_map.empty()
+                ? pepng::make_extra_material(object_shader_program, pepng::make_texture(), obj_material.diffuse)
+                : pepng::make_extra_material(object_shader_program, pepng::resources()->texture(obj_material.diffuse_map));
+
+            if (obj_material.opacity < 1.0f)
+            {
+                material->blend_mode = BlendMode::ALPHA_BLEND;
+                material->alpha = obj_material.opacity;
+            }
+        }
+
+        auto shape_object = pepng::make_object(shape.name);
+        shape_object
+            ->attach_component(pepng::make_transform(glm::vec3(i * 3.0f, 0.0f, 0.0f)))
+            ->attach_component(pepng::make_extra_renderer(pepng::make_mesh_model(shape.mesh, shape.name), material));
+
+        obj_primitives->attach_child(shape_object);
+    }
+
+    obj_primitives->attach_component(pepng::make_outliner());
+
+    pepng::instantiate(obj_primitives);
+
+    // CROWD
+    // A field of tentacles sharing one Rig: poses are evaluated on the job system, drawn in one instanced draw.
+    auto tentacle_scene = pepng::load_collada(model_path / "skinned" / "tentacle.dae");
+    auto tentacle_rig = pepng::make_rig(tentacle_scene, 0);
+    auto tentacle_material = pepng::make_extra_material(object_shader_program, pepng::make_texture(), glm::vec3(0.8f, 0.3f, 0.5f));
+
+    auto crowd = pepng::make_object("Crowd");
+    crowd->attach_component(pepng::make_transform(glm::vec3(45.0f, 0.0f, -25.0f)));
+
+    // One tentacle stamped out by a Prefab, each copy with its own Transform.
+    auto tentacle = pepng::make_object("Tentacle");
+    tentacle->attach_component(pepng::make_transform(glm::vec3(0.0f)))
+        ->attach_component(pepng::make_animator(tentacle_rig, tentacle_material));
+
+    std::vector<std::shared_ptr<Transform>> tentacle_transforms;
+
+    for (int i = 0; i < 16; i++)
+    {
+        for (int j = 0; j < 16; j++)
+        {
+            tentacle_transforms.push_back(pepng::make_transform(glm::vec3((i - 7.5f) * 2.5f, 0.0f, (j - 7.5f) * 2.5f), glm::vec3(0.0f, (i * 16 + j) * 37.0f, 0.0f)));
+        }
+    }
+
+    auto tentacles = pepng::make_prefab(tentacle)->build(tentacle_transforms.size(), tentacle_transforms);
+
+    for (int k = 0; k < (int) tentacles.size(); k++)
+    {
+        std::stringstream ss;
+
+        ss << "Tentacle " << k / 16 << "." << k % 16;
+
+        tentacles[k]->name = ss.str();
+
+        // Out of phase, so the crowd does not move in lockstep.
+        auto animator = tentacles[k]->get_component<Animator>();
+        animator->time = k * 0.37f;
+        animator->speed = 0.75f + (((k / 16) * 7 + (k % 16) * 3) % 8) * 0.0625f;
+
+        crowd->attach_child(tentacles[k]);
+    }
+
+    crowd->attach_component(pepng::make_parallel_update());
+    crowd->attach_component(pepng::make_outliner());
+    pepng::instantiate(crowd);
+
+    // FOUNTAIN
+    // Up to a million particles simulated in SIMD chunks on the job system, drawn in one instanced draw.
+    auto fountain_emitter = pepng::make_particle_emitter(1 << 20, pepng::make_extra_material(particle_shader_program, pepng::make_texture(), glm::vec3(0.3f, 0.6f, 1.0f)));
+    fountain_emitter->rate = 200000.0f;
+    fountain_emitter->speed = 15.0f;
+    fountain_emitter->spread = 12.0f;
+    fountain_emitter->life = 4.5f;
+    fountain_emitter->life_variance = 0.3f;
+    fountain_emitter->size = 0.08f;
+
+    auto fountain = pepng::make_object("Fountain");
+    fountain->attach_component(pepng::make_transform(glm::vec3(-45.0f, 0.0f, -25.0f)))
+        ->attach_component(fountain_emitter)
+        ->attach_component(pepng::make_outliner());
+
+    pepng::instantiate(fountain);
+
     // SKYBOX
     auto skybox = pepng::make_object("Skybox");
     skybox->attach_component(pepng::make_transform(glm::vec3(0.0f), glm::vec3(90.0f, 0.0f, 0.0f), glm::vec3(100.0f)))
-        ->attach_component(pepng::make_skybox(pepng::make_material(skybox_shader_program, skybox_texture)));
+        ->attach_component(pepng::make_skybox(pepng::make_material(skybox_shader_program, skybox_texture->acquire())));
 
     pepng::instantiate(skybox);
 
@@ -563,10 +860,43 @@ int main()
                 pepng::make_perspective(glm::radians(60.0f), 1, 0.1f, 1000.0f)));
     //Adds FPS controller to the camera.
     camera->attach_component(pepng::make_fps());
+    // Records the camera path, and overrides the FPS controller while replaying.
+    camera->attach_component(pepng::make_input_replay());
+    // Poses the camera for offscreen captures (after the components above, so the shot pose wins).
+    camera->attach_component(pepng::make_capture_camera());
 
     //Instantiates the camera.
     pepng::instantiate(camera);
 
+    // TOP VIEW
+    // Picture in picture over the PA2 stage, drawn by MultiView in the same pass as the camera.
+    auto top_view = pepng::make_object("Top View");
+    top_view->attach_component(pepng::make_transform(glm::vec3(0.0f, 60.0f, -25.0f), glm::vec3(-90.0f, 0.0f, 0.0f)));
+
+    pepng::instantiate(top_view);
+
+    pepng::multi_view()->add_view(top_view, glm::vec4(0.72f, 0.72f, 0.26f, 0.26f));
+
+    // Replays the draws recorded by ExtraRenderer/Skybox this frame. Instantiated last so it renders last.
+    auto command_flush = pepng::make_object("Command Flush");
+    command_flush->attach_component(pepng::make_transform())
+        ->attach_component(pepng::make_command_flush());
+
+    pepng::instantiate(command_flush);
+
+    // OFFSCREEN CAPTURE
+    // Renders the requested images through the game loop, which closes once they are written.
+    if (!capture_path.empty())
+    {
+        auto capture = pepng::capture();
+        capture->exit_when_done = true;
+
+        if (turntable)
+            capture->start(capture_path, capture_size, pepng::turntable(glm::vec3(0.0f, 0.0f, -25.0f), 40.0f, 15.0f, capture_count));
+        else
+            capture->start(capture_path, capture_size, capture_count);
+    }
+
     // Enters the game loop. Returns when the program exits or fails.
     return pepng::update();
 }
\ No newline at end of file
@@ -1,13 +1,16 @@
 #include "axes.hpp"
 
+#include "../component/extra_renderer.hpp"
+
 std::shared_ptr<Object> pepng::make_axes(std::shared_ptr<Transform> transform, GLuint shaderProgram) {
     auto axes = pepng::make_object("Axes");
 
     axes->attach_component(transform);
 
-    auto material = pepng::make_material(shaderProgram, pepng::make_texture());
+    auto material = pepng::make_extra_material(shaderProgram, pepng::make_texture());
 
-    axes->attach_component(pepng::make_renderer(
+    // Recorded like every other draw, so it is replayed in the same pass (see CommandFlush).
+    axes->attach_component(pepng::make_extra_renderer(
             pepng::make_model()
                 ->attach_buffer(
                     pepng::make_buffer<glm::vec3>(
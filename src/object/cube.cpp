@@ -3,6 +3,8 @@
  */
 #include "cube.hpp"
 
+#include "../component/extra_renderer.hpp"
+
 std::shared_ptr<Object> pepng::make_cube(std::shared_ptr<Transform> transform, std::shared_ptr<Texture> texture, GLuint shaderProgram) {
     // Create a base object with name. 
     // Name will be used for IMGUI (and other reflection).
@@ -15,7 +17,8 @@ std::shared_ptr<Object> pepng::make_cube(std::shared_ptr<Transform> transform, s
     // Attach Renderer.
     cube->attach_component(
         // Create Renderer. Takes Model and Material.
-        pepng::make_renderer(
+        // ExtraRenderer records the draw, so it is replayed with the rest of the frame (see CommandFlush).
+        pepng::make_extra_renderer(
             // Create Model. Basically a collection of buffers.
             pepng::make_model()
                 // Attach Buffer.
@@ -88,7 +91,7 @@ std::shared_ptr<Object> pepng::make_cube(std::shared_ptr<Transform> transform, s
                 // Sets the model name.
                 ->set_name("Cube"),
             // Create material that contains the shader and texture.
-            pepng::make_material(shaderProgram, texture)
+            pepng::make_extra_material(shaderProgram, texture)
         )
     );
 
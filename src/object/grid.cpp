@@ -1,5 +1,7 @@
 #include "grid.hpp"
 
+#include "../component/extra_renderer.hpp"
+
 std::shared_ptr<Object> pepng::make_grid(std::shared_ptr<Transform> transform, GLuint shaderProgram, int count, glm::vec4 color) {
     auto grid = pepng::make_object("Grid");
 
@@ -30,9 +32,14 @@ std::shared_ptr<Object> pepng::make_grid(std::shared_ptr<Transform> transform, G
         colors.push_back(color);
     }
 
-    auto material = pepng::make_material(shaderProgram, pepng::make_texture());
+    auto material = pepng::make_extra_material(shaderProgram, pepng::make_texture());
+
+    // Drawn in the sorted transparent pass when the lines are translucent.
+    if(color.w < 1.0f) {
+        material->blend_mode = BlendMode::ALPHA_BLEND;
+    }
 
-    grid->attach_component(pepng::make_renderer(
+    grid->attach_component(pepng::make_extra_renderer(
             pepng::make_model()
                 ->attach_buffer(
                     pepng::make_buffer<glm::vec3>(
@@ -5,4 +5,5 @@
  */
 #pragma once
 
-#include "cube.hpp"
\ No newline at end of file
+#include "cube.hpp"
+#include "prefab.hpp"
\ No newline at end of file
@@ -0,0 +1,131 @@
+#include "prefab.hpp"
+
+#include "../component/extra_renderer.hpp"
+
+Prefab::Prefab(std::shared_ptr<Object> object) :
+    __root_transform(-1)
+{
+    std::vector<std::pair<std::shared_ptr<Object>, int>> stack { { object, -1 } };
+
+    while(!stack.empty()) {
+        auto [current, parent] = stack.back();
+        stack.pop_back();
+
+        int index = (int) this->__nodes.size();
+
+        this->__nodes.push_back(Node {
+            current->name,
+            parent,
+            this->__components.size(),
+            current->components.size()
+        });
+
+        for(auto& component : current->components) {
+            if(index == 0 && this->__root_transform < 0 && std::dynamic_pointer_cast<Transform>(component) != nullptr) {
+                this->__root_transform = (int) this->__components.size();
+            }
+
+            this->__component_index[component.get()] = this->__components.size();
+            this->__components.push_back(component);
+        }
+
+        // Reversed so the pre-order matches instantiation order.
+        for(auto it = current->children.rbegin(); it != current->children.rend(); it++) {
+            stack.push_back({ *it, index });
+        }
+    }
+}
+
+std::shared_ptr<Component> Prefab::__instance_component(std::shared_ptr<Component> component) {
+    // Renderers share Model/Material instead of deep-copying the material.
+    if(auto extra_renderer = std::dynamic_pointer_cast<ExtraRenderer>(component)) {
+        return pepng::make_extra_renderer_instance(extra_renderer);
+    }
+
+    return component->clone();
+}
+
+size_t Prefab::size() {
+    return this->__nodes.size();
+}
+
+std::vector<std::shared_ptr<Object>> Prefab::build(size_t count, const std::vector<std::shared_ptr<Transform>>& transforms) {
+    if(!transforms.empty() && transforms.size() != count) {
+        std::stringstream ss;
+
+        ss << "Prefab expected " << count << " transforms but got " << transforms.size() << "." << std::endl;
+
+        throw std::runtime_error(ss.str());
+    }
+
+    std::vector<std::shared_ptr<Object>> roots;
+    roots.reserve(count);
+
+    // Reused by every copy: the copy of __components[i] is components[i].
+    std::vector<std::shared_ptr<Object>> objects(this->__nodes.size());
+    std::vector<std::shared_ptr<Component>> components(this->__components.size());
+
+    auto map = [&](const std::shared_ptr<Component>& component) -> std::shared_ptr<Component> {
+        auto it = this->__component_index.find(component.get());
+
+        return it != this->__component_index.end() ? components[it->second] : nullptr;
+    };
+
+    for(size_t i = 0; i < count; i++) {
+        for(size_t k = 0; k < this->__components.size(); k++) {
+            // The root Transform is swapped with the supplied one.
+            components[k] = !transforms.empty() && (int) k == this->__root_transform
+                ? transforms[i]
+                : Prefab::__instance_component(this->__components[k]);
+        }
+
+        for(auto& component : components) {
+            if(auto linked = std::dynamic_pointer_cast<PrefabLinked>(component)) {
+                linked->remap(map);
+            }
+        }
+
+        for(size_t j = 0; j < this->__nodes.size(); j++) {
+            auto& node = this->__nodes[j];
+            auto object = pepng::make_object(node.name);
+
+            for(size_t k = node.first_component; k < node.first_component + node.component_count; k++) {
+                object->attach_component(components[k]);
+            }
+
+            if(j == 0 && !transforms.empty() && this->__root_transform < 0) {
+                object->attach_component(transforms[i]);
+            }
+
+            if(node.parent >= 0) {
+                objects[node.parent]->attach_child(object);
+            }
+
+            objects[j] = object;
+        }
+
+        roots.push_back(objects[0]);
+    }
+
+    return roots;
+}
+
+std::shared_ptr<Prefab> Prefab::make_prefab(std::shared_ptr<Object> object) {
+    std::shared_ptr<Prefab> prefab(new Prefab(object));
+
+    return prefab;
+}
+
+std::shared_ptr<Prefab> pepng::make_prefab(std::shared_ptr<Object> object) {
+    return Prefab::make_prefab(object);
+}
+
+std::vector<std::shared_ptr<Object>> pepng::instantiate(std::shared_ptr<Prefab> prefab, size_t count, const std::vector<std::shared_ptr<Transform>>& transforms) {
+    auto roots = prefab->build(count, transforms);
+
+    for(auto& root : roots) {
+        pepng::instantiate(root);
+    }
+
+    return roots;
+}
\ No newline at end of file
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <pepng.h>
+
+#include <functional>
+
+/**
+ * Component referencing other Components of its subtree (e.g. a cached Transform).
+ *
+ * Prefab copies are remapped after they are built, so they reference the copy instead of the snapshot.
+ */
+class PrefabLinked {
+    public:
+        virtual ~PrefabLinked() = default;
+
+        /**
+         * Points the references into the copy.
+         *
+         * @param map The copy of a Component of the snapshot (nullptr for Components outside the subtree).
+         */
+        virtual void remap(const std::function<std::shared_ptr<Component>(const std::shared_ptr<Component>&)>& map) = 0;
+};
+
+/**
+ * Template of an Object subtree that can be stamped out many times.
+ *
+ * The subtree is flattened once (pre-order) into a node table and a component table. The Components are
+ * referenced, not copied: each copy clones them once, sharing the immutable Model/Material data by reference,
+ * and PrefabLinked Components are remapped onto the copy.
+ */
+class Prefab {
+    public:
+        /**
+         * Shared_ptr constructor for Prefab.
+         *
+         * @param object The root of the subtree to snapshot.
+         */
+        static std::shared_ptr<Prefab> make_prefab(std::shared_ptr<Object> object);
+
+        /**
+         * Builds count copies of the snapshot (without instantiating them).
+         *
+         * @param count The number of copies.
+         * @param transforms Root Transform of each copy. Empty keeps the snapshot root Transform.
+         */
+        std::vector<std::shared_ptr<Object>> build(size_t count, const std::vector<std::shared_ptr<Transform>>& transforms);
+
+        // Number of Objects in one copy.
+        size_t size();
+
+    private:
+        Prefab(std::shared_ptr<Object> object);
+
+        // Copies a component for a new instance, sharing whatever is immutable.
+        static std::shared_ptr<Component> __instance_component(std::shared_ptr<Component> component);
+
+        // Index of the root Transform in __components (-1 if the root has none).
+        int __root_transform;
+
+        struct Node {
+            std::string name;
+            // Index of the parent node (-1 for the root).
+            int parent;
+            size_t first_component;
+            size_t component_count;
+        };
+
+        std::vector<Node> __nodes;
+        std::vector<std::shared_ptr<Component>> __components;
+        // Index in __components of each Component, to remap references.
+        std::unordered_map<Component*, size_t> __component_index;
+};
+
+namespace pepng {
+    std::shared_ptr<Prefab> make_prefab(std::shared_ptr<Object> object);
+
+    /**
+     * Instantiates count copies of a Prefab in the world.
+     *
+     * @param prefab The snapshot to copy.
+     * @param count The number of copies.
+     * @param transforms Root Transform of each copy (either empty or count long).
+     * @return The root of every copy.
+     */
+    std::vector<std::shared_ptr<Object>> instantiate(std::shared_ptr<Prefab> prefab, size_t count, const std::vector<std::shared_ptr<Transform>>& transforms = {});
+};
\ No newline at end of file
@@ -0,0 +1,437 @@
+#include "asset_streaming.hpp"
+
+#include "collada.hpp"
+#include "command_list.hpp"
+#include "input_log.hpp"
+#include "lod.hpp"
+
+// Browsers without shared memory have no threads, files are parsed when their Model is first needed there.
+#if !defined(__EMSCRIPTEN__) || defined(__EMSCRIPTEN_PTHREADS__)
+#define PEPNG_LOAD_THREAD 1
+#endif
+
+namespace {
+    // Weight of the newest sample in the smoothed camera velocity.
+    constexpr float SMOOTHING = 0.25f;
+}
+
+ModelHandle::ModelHandle(AssetStreaming* streaming, const std::filesystem::path& path, bool lods) :
+    min(-1.0f),
+    max(1.0f),
+    __streaming(streaming),
+    __path(path),
+    __lods(lods),
+    __state(State::UNLOADED)
+{}
+
+const std::filesystem::path& ModelHandle::path() {
+    return this->__path;
+}
+
+bool ModelHandle::resident() {
+    return this->__model != nullptr;
+}
+
+bool ModelHandle::pending() {
+    std::lock_guard<std::mutex> lock(this->__streaming->__mutex);
+
+    return this->__state == State::QUEUED || this->__state == State::PARSED;
+}
+
+void ModelHandle::request() {
+    {
+        std::lock_guard<std::mutex> lock(this->__streaming->__mutex);
+
+        if(this->__state != State::UNLOADED) {
+            return;
+        }
+
+        this->__state = State::QUEUED;
+    }
+
+    this->__streaming->__queue(this);
+}
+
+void ModelHandle::__parse() {
+    std::shared_ptr<Mesh> mesh;
+    std::exception_ptr error;
+
+    try {
+        auto scene = pepng::load_collada(this->__path);
+
+        if(scene->meshes.empty()) {
+            std::stringstream ss;
+
+            ss << this->__path << " has no geometry." << std::endl;
+
+            throw std::runtime_error(ss.str());
+        }
+
+        mesh = scene->meshes[0];
+    } catch(...) {
+        error = std::current_exception();
+    }
+
+    std::lock_guard<std::mutex> lock(this->__streaming->__mutex);
+
+    this->__mesh = mesh;
+    this->__error = error;
+    this->__state = error != nullptr ? State::FAILED : State::PARSED;
+}
+
+std::shared_ptr<Model> ModelHandle::model() {
+    if(this->__model != nullptr) {
+        return this->__model;
+    }
+
+    State state;
+    std::exception_ptr error;
+
+    {
+        std::lock_guard<std::mutex> lock(this->__streaming->__mutex);
+
+        state = this->__state;
+        // Taken once, so the error is reported once.
+        std::swap(error, this->__error);
+    }
+
+    if(state == State::FAILED) {
+        this->__report(error);
+
+        return nullptr;
+    }
+
+    #ifdef PEPNG_LOAD_THREAD
+    bool parse = false;
+    #else
+    // Parsed here instead, the upload budget bounds the stalls.
+    bool parse = state == State::QUEUED;
+    #endif
+
+    if((state != State::PARSED && !parse) || !this->__streaming->upload()) {
+        return nullptr;
+    }
+
+    if(parse) {
+        this->__parse();
+
+        if(this->__state == State::FAILED) {
+            this->__report(this->__error);
+            this->__error = nullptr;
+
+            return nullptr;
+        }
+    }
+
+    this->__model = pepng::make_mesh_model(this->__mesh, this->__path.stem().string());
+    this->__model->delayed_init();
+
+    if(this->__lods) {
+        pepng::enable_lods(this->__model);
+    }
+
+    this->min = this->__mesh->min;
+    this->max = this->__mesh->max;
+
+    std::lock_guard<std::mutex> lock(this->__streaming->__mutex);
+
+    this->__state = State::RESIDENT;
+
+    return this->__model;
+}
+
+void ModelHandle::__report(std::exception_ptr error) {
+    if(error == nullptr) {
+        return;
+    }
+
+    try {
+        std::rethrow_exception(error);
+    } catch(const std::exception& exception) {
+        std::string message = exception.what();
+
+        // Messages end with a new line.
+        if(!message.empty() && message.back() == '\n') {
+            message.pop_back();
+        }
+
+        std::cout << "Could not load " << this->__path << ", its placeholder stays: " << message << std::endl;
+    } catch(...) {
+        std::cout << "Could not load " << this->__path << ", its placeholder stays." << std::endl;
+    }
+}
+
+glm::mat4 ModelHandle::box() {
+    glm::vec3 half = glm::max((this->max - this->min) * 0.5f, glm::vec3(1e-3f));
+
+    return glm::scale(glm::translate(glm::mat4(1.0f), (this->min + this->max) * 0.5f), half);
+}
+
+AssetStreaming::AssetStreaming() :
+    enabled(true),
+    load_distance(80.0f),
+    prefetch_time(1.0f),
+    uploads_per_frame(2),
+    __frame((size_t) -1),
+    __uploads(0),
+    __motion_frame((size_t) -1),
+    __has_position(false),
+    __position(0.0f),
+    __velocity(0.0f),
+    __stop(false)
+{
+    #ifdef PEPNG_LOAD_THREAD
+    this->__loader = std::thread([this]() {
+        this->__load_loop();
+    });
+    #endif
+}
+
+AssetStreaming::~AssetStreaming() {
+    {
+        std::lock_guard<std::mutex> lock(this->__mutex);
+
+        this->__stop = true;
+    }
+
+    this->__wake.notify_all();
+
+    if(this->__loader.joinable()) {
+        this->__loader.join();
+    }
+}
+
+std::shared_ptr<AssetStreaming> AssetStreaming::make_asset_streaming() {
+    std::shared_ptr<AssetStreaming> asset_streaming(new AssetStreaming());
+
+    return asset_streaming;
+}
+
+std::shared_ptr<AssetStreaming> pepng::make_asset_streaming() {
+    return AssetStreaming::make_asset_streaming();
+}
+
+std::shared_ptr<AssetStreaming> pepng::asset_streaming() {
+    static auto asset_streaming = pepng::make_asset_streaming();
+
+    return asset_streaming;
+}
+
+std::shared_ptr<ModelHandle> AssetStreaming::model(const std::filesystem::path& path, bool lods) {
+    std::error_code error;
+    auto canonical = std::filesystem::weakly_canonical(path, error).string();
+
+    if(error) {
+        canonical = path.string();
+    }
+
+    auto it = this->__models.find(canonical);
+
+    if(it != this->__models.end()) {
+        return it->second;
+    }
+
+    std::shared_ptr<ModelHandle> handle(new ModelHandle(this, path, lods));
+
+    this->__models[canonical] = handle;
+
+    return handle;
+}
+
+void AssetStreaming::__queue(ModelHandle* handle) {
+    {
+        std::lock_guard<std::mutex> lock(this->__mutex);
+
+        this->__pending.push_back(handle);
+    }
+
+    this->__wake.notify_one();
+}
+
+void AssetStreaming::prefetch(std::shared_ptr<TextureHandle> handle) {
+    auto unread = TextureHandle::ReadState::UNREAD;
+
+    if(!handle->__read_state.compare_exchange_strong(unread, TextureHandle::ReadState::QUEUED)) {
+        return;
+    }
+
+    #ifdef PEPNG_LOAD_THREAD
+    {
+        std::lock_guard<std::mutex> lock(this->__mutex);
+
+        this->__pending_textures.push_back(handle);
+    }
+
+    this->__wake.notify_one();
+    #else
+    handle->__read_state = TextureHandle::ReadState::READ;
+    #endif
+}
+
+void AssetStreaming::__load_loop() {
+    while(true) {
+        ModelHandle* handle = nullptr;
+        std::shared_ptr<TextureHandle> texture_handle;
+
+        {
+            std::unique_lock<std::mutex> lock(this->__mutex);
+
+            this->__wake.wait(lock, [this]() {
+                return this->__stop || !this->__pending.empty() || !this->__pending_textures.empty();
+            });
+
+            if(this->__stop) {
+                return;
+            }
+
+            // Models first, they replace placeholder boxes.
+            if(!this->__pending.empty()) {
+                handle = this->__pending.front();
+                this->__pending.pop_front();
+            } else {
+                texture_handle = this->__pending_textures.front();
+                this->__pending_textures.pop_front();
+            }
+        }
+
+        if(handle != nullptr) {
+            handle->__parse();
+        } else {
+            texture_handle->__read();
+        }
+    }
+}
+
+void AssetStreaming::__begin_frame() {
+    size_t frame = pepng::commands()->frame();
+
+    if(frame == this->__frame) {
+        return;
+    }
+
+    this->__frame = frame;
+    this->__uploads = 0;
+
+    this->__last_stats = this->__stats;
+    this->__stats = Stats();
+
+    this->__last_stats.models = this->__models.size();
+    this->__last_stats.speed = glm::length(this->__velocity);
+
+    for(auto& [path, handle] : this->__models) {
+        if(handle->resident()) {
+            this->__last_stats.resident++;
+        } else if(handle->pending()) {
+            this->__last_stats.pending++;
+        }
+    }
+}
+
+bool AssetStreaming::upload() {
+    this->__begin_frame();
+
+    if(this->enabled && this->__uploads >= this->uploads_per_frame) {
+        return false;
+    }
+
+    this->__uploads++;
+    this->__stats.uploads++;
+
+    return true;
+}
+
+bool AssetStreaming::wanted(const View& view, const glm::mat4& world, const glm::vec3& min, const glm::vec3& max) {
+    this->__begin_frame();
+
+    // Camera motion, sampled once per frame.
+    if(this->__motion_frame != this->__frame) {
+        float dt = pepng::input_log()->delta_time();
+
+        // Only consecutive frames, a stale position would read as a jump.
+        if(this->__has_position && this->__motion_frame + 1 == this->__frame && dt > 0.0f) {
+            this->__velocity = glm::mix(this->__velocity, (view.position - this->__position) / dt, SMOOTHING);
+        }
+
+        this->__motion_frame = this->__frame;
+        this->__position = view.position;
+        this->__has_position = true;
+    }
+
+    if(!this->enabled) {
+        return true;
+    }
+
+    glm::vec3 center = glm::vec3(world * glm::vec4((min + max) * 0.5f, 1.0f));
+    float scale = std::max({ glm::length(glm::vec3(world[0])), glm::length(glm::vec3(world[1])), glm::length(glm::vec3(world[2])) });
+    float radius = glm::length(max - min) * 0.5f * scale;
+
+    // In the view moved by offset, and within the load distance of its eye.
+    auto reachable = [&](const glm::vec3& offset) {
+        if(glm::distance(center, view.position + offset) - radius > this->load_distance) {
+            return false;
+        }
+
+        for(auto& plane : view.planes) {
+            if(glm::dot(glm::vec3(plane), center - offset) + plane.w < -radius) {
+                return false;
+            }
+        }
+
+        return true;
+    };
+
+    if(reachable(glm::vec3(0.0f))) {
+        return true;
+    }
+
+    glm::vec3 offset = this->__velocity * this->prefetch_time;
+
+    if(glm::dot(offset, offset) > 1e-6f && reachable(offset)) {
+        this->__stats.prefetched++;
+
+        return true;
+    }
+
+    return false;
+}
+
+std::shared_ptr<Model> AssetStreaming::placeholder() {
+    if(this->__placeholder != nullptr) {
+        return this->__placeholder;
+    }
+
+    auto mesh = pepng::make_mesh();
+
+    for(auto normal : { glm::vec3(1, 0, 0), glm::vec3(-1, 0, 0), glm::vec3(0, 1, 0), glm::vec3(0, -1, 0), glm::vec3(0, 0, 1), glm::vec3(0, 0, -1) }) {
+        // Axes of the face with u x v = normal, so the triangles below are counter-clockwise from outside.
+        glm::vec3 u(normal.y, normal.z, normal.x);
+        glm::vec3 v = glm::cross(normal, u);
+
+        unsigned int first = (unsigned int) mesh->positions.size();
+
+        // 4 vertices per face, each face has its own normal.
+        for(int i = 0; i < 4; i++) {
+            glm::vec2 corner(i & 1 ? 1.0f : -1.0f, i & 2 ? 1.0f : -1.0f);
+
+            mesh->positions.push_back(normal + u * corner.x + v * corner.y);
+            mesh->normals.push_back(normal);
+            mesh->uvs.push_back(corner * 0.5f + 0.5f);
+        }
+
+        for(unsigned int index : { 0u, 1u, 3u, 0u, 3u, 2u }) {
+            mesh->indices.push_back(first + index);
+        }
+    }
+
+    mesh->compute_bounds();
+
+    this->__placeholder = pepng::make_mesh_model(mesh, "Placeholder");
+
+    return this->__placeholder;
+}
+
+const AssetStreaming::Stats& AssetStreaming::stats() {
+    this->__begin_frame();
+
+    return this->__last_stats;
+}
\ No newline at end of file
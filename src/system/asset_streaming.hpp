@@ -0,0 +1,176 @@
+#pragma once
+
+#include <pepng.h>
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+#include "mesh.hpp"
+#include "resources.hpp"
+#include "view.hpp"
+
+class AssetStreaming;
+
+/**
+ * Model of a COLLADA file (its first geometry), loaded when first needed.
+ *
+ * The file is parsed on the loader thread and uploaded on the GL thread. Until then, renderers draw the
+ * placeholder box stretched to the handle's bounds.
+ */
+class ModelHandle {
+    public:
+        const std::filesystem::path& path();
+
+        // Object space bounds: a unit box until loaded (what the placeholder covers), then the Mesh's.
+        glm::vec3 min;
+        glm::vec3 max;
+
+        bool resident();
+        // Queued or parsed, not uploaded yet.
+        bool pending();
+
+        // Queues the load (once).
+        void request();
+
+        /**
+         * The Model once loaded, nullptr before (never waits on the loader).
+         *
+         * A parsed Mesh is uploaded here if this frame's upload budget allows (must be called on the GL thread).
+         * A failed load is reported once on the standard output and stays nullptr (the placeholder is drawn).
+         */
+        std::shared_ptr<Model> model();
+
+        // Placeholder box matrix: the unit box [-1, 1] scaled and moved onto the bounds.
+        glm::mat4 box();
+
+    private:
+        friend class AssetStreaming;
+
+        ModelHandle(AssetStreaming* streaming, const std::filesystem::path& path, bool lods);
+
+        enum class State { UNLOADED, QUEUED, PARSED, RESIDENT, FAILED };
+
+        // Parses the file into __mesh (on the loader thread, or on the GL thread without threads).
+        void __parse();
+        // Prints the error of a failed load (nothing if already reported).
+        void __report(std::exception_ptr error);
+
+        AssetStreaming* __streaming;
+        std::filesystem::path __path;
+        bool __lods;
+
+        // Guarded by the AssetStreaming mutex.
+        State __state;
+        std::shared_ptr<Mesh> __mesh;
+        std::exception_ptr __error;
+
+        std::shared_ptr<Model> __model;
+};
+
+/**
+ * Decides which assets referenced by handle become resident, and loads their Models in the background.
+ * Texture files are read ahead on the same thread (the engine decodes them when they are acquired).
+ *
+ * An asset is wanted when its object is in the view and within load_distance of the camera, now or at
+ * the camera position predicted prefetch_time ahead from its velocity. Uploads (Models and textures) are
+ * capped per frame, so the first frame only pays for what it shows.
+ */
+class AssetStreaming {
+    public:
+        static std::shared_ptr<AssetStreaming> make_asset_streaming();
+
+        // When off, every handle is loaded on its first draw.
+        bool enabled;
+        // World units.
+        float load_distance;
+        // Seconds of camera motion to predict (0 disables prefetching).
+        float prefetch_time;
+        // Models and textures uploaded per frame at most.
+        size_t uploads_per_frame;
+
+        struct Stats {
+            size_t models = 0;
+            size_t resident = 0;
+            size_t pending = 0;
+            size_t uploads = 0;
+            // Objects only wanted because of the predicted camera position.
+            size_t prefetched = 0;
+            // Smoothed camera speed (world units per second).
+            float speed = 0.0f;
+        };
+
+        /**
+         * Handle to the Model of a file (deduplicated by path, nothing is loaded yet).
+         *
+         * @param lods Generates LOD levels once loaded (see pepng::enable_lods).
+         */
+        std::shared_ptr<ModelHandle> model(const std::filesystem::path& path, bool lods = false);
+
+        /**
+         * Whether an object's assets should be resident (see the class).
+         *
+         * @param min, max Object space bounds.
+         */
+        bool wanted(const View& view, const glm::mat4& world, const glm::vec3& min, const glm::vec3& max);
+
+        /**
+         * Reads a texture's file on the loader thread ahead of its acquire(), once per load (see TextureHandle::read).
+         *
+         * Without threads, the handle is marked read right away (acquire() reads the file).
+         */
+        void prefetch(std::shared_ptr<TextureHandle> handle);
+
+        // Takes one upload of this frame's budget, false once it is spent.
+        bool upload();
+
+        // Unit box [-1, 1] drawn for Models that are not loaded.
+        std::shared_ptr<Model> placeholder();
+
+        // Statistics of the last finished frame.
+        const Stats& stats();
+
+        ~AssetStreaming();
+
+    private:
+        friend class ModelHandle;
+
+        AssetStreaming();
+
+        void __begin_frame();
+        void __queue(ModelHandle* handle);
+        void __load_loop();
+
+        std::unordered_map<std::string, std::shared_ptr<ModelHandle>> __models;
+        std::shared_ptr<Model> __placeholder;
+
+        size_t __frame;
+        size_t __uploads;
+        // Frame whose camera motion was sampled.
+        size_t __motion_frame;
+        bool __has_position;
+        glm::vec3 __position;
+        glm::vec3 __velocity;
+
+        Stats __stats;
+        Stats __last_stats;
+
+        std::mutex __mutex;
+        std::condition_variable __wake;
+        // Handles live as long as the manager (never removed from __models).
+        std::deque<ModelHandle*> __pending;
+        std::deque<std::shared_ptr<TextureHandle>> __pending_textures;
+        bool __stop;
+        std::thread __loader;
+};
+
+namespace pepng {
+    std::shared_ptr<AssetStreaming> make_asset_streaming();
+
+    /**
+     * The engine-wide AssetStreaming used by ExtraRenderer.
+     */
+    std::shared_ptr<AssetStreaming> asset_streaming();
+};
\ No newline at end of file
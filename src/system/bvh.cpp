@@ -0,0 +1,268 @@
+#include "bvh.hpp"
+
+#include <algorithm>
+#include <limits>
+
+#include "memory.hpp"
+
+namespace {
+    constexpr float INFINITE_T = std::numeric_limits<float>::infinity();
+
+    // Möller-Trumbore, two sided.
+    float intersect_triangle(const Ray& ray, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) {
+        glm::vec3 ab = b - a;
+        glm::vec3 ac = c - a;
+        glm::vec3 p = glm::cross(ray.direction, ac);
+
+        float determinant = glm::dot(ab, p);
+
+        if(std::abs(determinant) < 1e-12f) {
+            return INFINITE_T;
+        }
+
+        float inverse = 1.0f / determinant;
+        glm::vec3 s = ray.origin - a;
+        float u = glm::dot(s, p) * inverse;
+
+        if(u < 0.0f || u > 1.0f) {
+            return INFINITE_T;
+        }
+
+        glm::vec3 q = glm::cross(s, ab);
+        float v = glm::dot(ray.direction, q) * inverse;
+
+        if(v < 0.0f || u + v > 1.0f) {
+            return INFINITE_T;
+        }
+
+        float t = glm::dot(ac, q) * inverse;
+
+        return t > 0.0f ? t : INFINITE_T;
+    }
+}
+
+Bvh::Bvh() {}
+
+std::shared_ptr<Bvh> Bvh::make_bvh(const std::vector<glm::vec3>& mins, const std::vector<glm::vec3>& maxs) {
+    std::shared_ptr<Bvh> bvh(new Bvh());
+
+    uint32_t count = (uint32_t) mins.size();
+
+    if(count == 0) {
+        return bvh;
+    }
+
+    bvh->primitives.resize(count);
+
+    for(uint32_t i = 0; i < count; i++) {
+        bvh->primitives[i] = i;
+    }
+
+    bvh->nodes.reserve(2 * (count / Bvh::LEAF_SIZE + 1));
+    bvh->nodes.push_back(Node());
+    bvh->__build(0, 0, count, mins, maxs);
+
+    return bvh;
+}
+
+std::shared_ptr<Bvh> pepng::make_bvh(const std::vector<glm::vec3>& mins, const std::vector<glm::vec3>& maxs) {
+    return Bvh::make_bvh(mins, maxs);
+}
+
+void Bvh::__build(uint32_t node, uint32_t first, uint32_t count, const std::vector<glm::vec3>& mins, const std::vector<glm::vec3>& maxs) {
+    glm::vec3 min(std::numeric_limits<float>::max());
+    glm::vec3 max(std::numeric_limits<float>::lowest());
+    glm::vec3 centroid_min(std::numeric_limits<float>::max());
+    glm::vec3 centroid_max(std::numeric_limits<float>::lowest());
+
+    for(uint32_t i = first; i < first + count; i++) {
+        uint32_t primitive = this->primitives[i];
+        glm::vec3 centroid = (mins[primitive] + maxs[primitive]) * 0.5f;
+
+        min = glm::min(min, mins[primitive]);
+        max = glm::max(max, maxs[primitive]);
+        centroid_min = glm::min(centroid_min, centroid);
+        centroid_max = glm::max(centroid_max, centroid);
+    }
+
+    this->nodes[node].min = min;
+    this->nodes[node].max = max;
+
+    glm::vec3 extent = centroid_max - centroid_min;
+    int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+
+    // Small or degenerate (all centroids equal) ranges become leaves.
+    if(count <= Bvh::LEAF_SIZE || extent[axis] <= 0.0f) {
+        this->nodes[node].first = first;
+        this->nodes[node].count = count;
+
+        return;
+    }
+
+    uint32_t half = count / 2;
+
+    std::nth_element(
+        this->primitives.begin() + first,
+        this->primitives.begin() + first + half,
+        this->primitives.begin() + first + count,
+        [&](uint32_t a, uint32_t b) {
+            return mins[a][axis] + maxs[a][axis] < mins[b][axis] + maxs[b][axis];
+        });
+
+    uint32_t left = (uint32_t) this->nodes.size();
+
+    this->nodes.push_back(Node());
+    this->nodes.push_back(Node());
+
+    this->nodes[node].first = left;
+    this->nodes[node].count = 0;
+
+    this->__build(left, first, half, mins, maxs);
+    this->__build(left + 1, first + half, count - half, mins, maxs);
+}
+
+void Bvh::refit(const std::vector<glm::vec3>& mins, const std::vector<glm::vec3>& maxs) {
+    // Children are always stored after their parent.
+    for(size_t i = this->nodes.size(); i-- > 0;) {
+        auto& node = this->nodes[i];
+
+        if(node.count > 0) {
+            node.min = glm::vec3(std::numeric_limits<float>::max());
+            node.max = glm::vec3(std::numeric_limits<float>::lowest());
+
+            for(uint32_t j = node.first; j < node.first + node.count; j++) {
+                node.min = glm::min(node.min, mins[this->primitives[j]]);
+                node.max = glm::max(node.max, maxs[this->primitives[j]]);
+            }
+        } else {
+            auto& left = this->nodes[node.first];
+            auto& right = this->nodes[node.first + 1];
+
+            node.min = glm::min(left.min, right.min);
+            node.max = glm::max(left.max, right.max);
+        }
+    }
+}
+
+float Bvh::raycast(const Ray& ray, float max_t, const std::function<float(uint32_t, float)>& hit) const {
+    float closest = max_t;
+
+    if(this->nodes.empty()) {
+        return closest;
+    }
+
+    glm::vec3 inverse_direction = 1.0f / ray.direction;
+
+    // Median splits keep the depth logarithmic, one slot per level is enough.
+    uint32_t stack[64];
+    int size = 0;
+
+    if(pepng::intersect_box(ray, inverse_direction, this->nodes[0].min, this->nodes[0].max) < closest) {
+        stack[size++] = 0;
+    }
+
+    while(size > 0) {
+        auto& node = this->nodes[stack[--size]];
+
+        // The closest hit may have moved since the node was pushed.
+        if(pepng::intersect_box(ray, inverse_direction, node.min, node.max) >= closest) {
+            continue;
+        }
+
+        if(node.count > 0) {
+            for(uint32_t i = node.first; i < node.first + node.count; i++) {
+                closest = hit(this->primitives[i], closest);
+            }
+
+            continue;
+        }
+
+        uint32_t near = node.first, far = node.first + 1;
+
+        float near_t = pepng::intersect_box(ray, inverse_direction, this->nodes[near].min, this->nodes[near].max);
+        float far_t = pepng::intersect_box(ray, inverse_direction, this->nodes[far].min, this->nodes[far].max);
+
+        if(far_t < near_t) {
+            std::swap(near, far);
+            std::swap(near_t, far_t);
+        }
+
+        if(far_t < closest && size < 64) {
+            stack[size++] = far;
+        }
+
+        if(near_t < closest && size < 64) {
+            stack[size++] = near;
+        }
+    }
+
+    return closest;
+}
+
+float pepng::intersect_box(const Ray& ray, const glm::vec3& inverse_direction, const glm::vec3& min, const glm::vec3& max) {
+    glm::vec3 t0 = (min - ray.origin) * inverse_direction;
+    glm::vec3 t1 = (max - ray.origin) * inverse_direction;
+
+    glm::vec3 near = glm::min(t0, t1);
+    glm::vec3 far = glm::max(t0, t1);
+
+    float enter = std::max(0.0f, std::max(near.x, std::max(near.y, near.z)));
+    float exit = std::min(far.x, std::min(far.y, far.z));
+
+    return enter <= exit ? enter : INFINITE_T;
+}
+
+std::shared_ptr<Bvh> pepng::triangle_bvh(std::shared_ptr<Mesh> mesh) {
+    static std::unordered_map<Mesh*, std::pair<std::weak_ptr<Mesh>, std::shared_ptr<Bvh>>> cache;
+
+    auto it = cache.find(mesh.get());
+
+    if(it != cache.end() && !it->second.first.expired()) {
+        return it->second.second;
+    }
+
+    // Frees the trees of destroyed Meshes (including the entry being replaced).
+    for(auto entry = cache.begin(); entry != cache.end();) {
+        if(entry->second.first.expired()) {
+            pepng::memory()->untrack(entry->second.second.get());
+
+            entry = cache.erase(entry);
+        } else {
+            ++entry;
+        }
+    }
+
+    size_t count = mesh->triangle_count();
+
+    std::vector<glm::vec3> mins(count), maxs(count);
+
+    for(size_t i = 0; i < count; i++) {
+        auto& a = mesh->positions[mesh->indices[i * 3]];
+        auto& b = mesh->positions[mesh->indices[i * 3 + 1]];
+        auto& c = mesh->positions[mesh->indices[i * 3 + 2]];
+
+        mins[i] = glm::min(a, glm::min(b, c));
+        maxs[i] = glm::max(a, glm::max(b, c));
+    }
+
+    auto bvh = pepng::make_bvh(mins, maxs);
+
+    cache[mesh.get()] = { mesh, bvh };
+
+    pepng::memory()->track(bvh.get(), MemoryRecord { "cpu", "", "triangle bvh", 1, 0, bvh->nodes.size() * sizeof(Bvh::Node) + bvh->primitives.size() * sizeof(uint32_t) });
+
+    return bvh;
+}
+
+float pepng::raycast(const Ray& ray, std::shared_ptr<Mesh> mesh, float max_t) {
+    auto bvh = pepng::triangle_bvh(mesh);
+
+    return bvh->raycast(ray, max_t, [&](uint32_t triangle, float closest) {
+        float t = intersect_triangle(ray,
+            mesh->positions[mesh->indices[triangle * 3]],
+            mesh->positions[mesh->indices[triangle * 3 + 1]],
+            mesh->positions[mesh->indices[triangle * 3 + 2]]);
+
+        return std::min(t, closest);
+    });
+}
\ No newline at end of file
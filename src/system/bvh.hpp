@@ -0,0 +1,77 @@
+#pragma once
+
+#include <pepng.h>
+
+#include "mesh.hpp"
+
+struct Ray {
+    glm::vec3 origin;
+    // Not normalized: t is preserved by affine transforms of the ray.
+    glm::vec3 direction;
+};
+
+/**
+ * Bounding volume hierarchy over axis aligned boxes (median split, up to LEAF_SIZE primitives per leaf).
+ */
+class Bvh {
+    public:
+        /**
+         * Builds a Bvh over primitive boxes.
+         *
+         * @param mins Minimum corner of every primitive.
+         * @param maxs Maximum corner of every primitive.
+         */
+        static std::shared_ptr<Bvh> make_bvh(const std::vector<glm::vec3>& mins, const std::vector<glm::vec3>& maxs);
+
+        struct Node {
+            glm::vec3 min;
+            glm::vec3 max;
+            // First primitive for leaves, left child for inner nodes (right child is left + 1).
+            uint32_t first;
+            // Primitive count (0 for inner nodes).
+            uint32_t count;
+        };
+
+        std::vector<Node> nodes;
+        // Primitive indices in leaf order.
+        std::vector<uint32_t> primitives;
+
+        /**
+         * Recomputes node bounds for moved primitives (same count, topology is kept).
+         */
+        void refit(const std::vector<glm::vec3>& mins, const std::vector<glm::vec3>& maxs);
+
+        /**
+         * Closest hit along a ray, visiting nearer children first.
+         *
+         * @param hit Called with a primitive and the closest t so far; returns the new closest t.
+         * @return The closest t (max_t if nothing was hit).
+         */
+        float raycast(const Ray& ray, float max_t, const std::function<float(uint32_t, float)>& hit) const;
+
+        static constexpr uint32_t LEAF_SIZE = 4;
+
+    private:
+        Bvh();
+
+        void __build(uint32_t node, uint32_t first, uint32_t count, const std::vector<glm::vec3>& mins, const std::vector<glm::vec3>& maxs);
+};
+
+namespace pepng {
+    std::shared_ptr<Bvh> make_bvh(const std::vector<glm::vec3>& mins, const std::vector<glm::vec3>& maxs);
+
+    /**
+     * Cached Bvh over the triangles of a Mesh.
+     */
+    std::shared_ptr<Bvh> triangle_bvh(std::shared_ptr<Mesh> mesh);
+
+    /**
+     * Closest triangle hit of a ray against a Mesh, in ray t (max_t if missed).
+     */
+    float raycast(const Ray& ray, std::shared_ptr<Mesh> mesh, float max_t);
+
+    /**
+     * Ray entry t into a box (infinity if missed).
+     */
+    float intersect_box(const Ray& ray, const glm::vec3& inverse_direction, const glm::vec3& min, const glm::vec3& max);
+};
\ No newline at end of file
@@ -0,0 +1,1149 @@
+#include "collada.hpp"
+
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <string_view>
+
+#include "job_system.hpp"
+#include "mapped_file.hpp"
+#include "number_parsing.hpp"
+
+namespace {
+    bool is_space(char c) {
+        return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+    }
+
+    std::string_view trim(std::string_view text) {
+        while(!text.empty() && is_space(text.front())) {
+            text.remove_prefix(1);
+        }
+
+        while(!text.empty() && is_space(text.back())) {
+            text.remove_suffix(1);
+        }
+
+        return text;
+    }
+
+    // "#id" -> "id".
+    std::string_view reference(std::string_view url) {
+        if(!url.empty() && url.front() == '#') {
+            url.remove_prefix(1);
+        }
+
+        return url;
+    }
+
+    [[noreturn]] void parse_error(const std::string& message, size_t offset) {
+        std::stringstream ss;
+
+        ss << "COLLADA: " << message << " (byte " << offset << ")." << std::endl;
+
+        throw std::runtime_error(ss.str());
+    }
+
+    /**
+     * Appends the whitespace separated numbers of text to values.
+     */
+    template<typename T>
+    void parse_numbers(std::string_view text, std::vector<T>& values, size_t offset) {
+        const char* it = text.data();
+        const char* end = it + text.size();
+
+        while(true) {
+            while(it < end && is_space(*it)) {
+                it++;
+            }
+
+            if(it == end) {
+                return;
+            }
+
+            T value;
+            const char* next = pepng::parse_number(it, end, value);
+
+            if(next == nullptr) {
+                parse_error("invalid number", offset + (it - text.data()));
+            }
+
+            values.push_back(value);
+            it = next;
+        }
+    }
+
+    size_t parse_size(std::string_view text) {
+        size_t value = 0;
+        std::from_chars(text.data(), text.data() + text.size(), value);
+
+        return value;
+    }
+
+    /**
+     * Pull tokenizer over XML text. Names, attributes and text are views into the source (nothing is copied).
+     *
+     * Declarations, comments and DOCTYPEs are skipped, self-closing tags produce an OPEN and a CLOSE.
+     */
+    class XmlReader {
+        public:
+            enum class Event { OPEN, CLOSE, TEXT, END };
+
+            XmlReader(std::string_view source, size_t begin, size_t end) :
+                __source(source),
+                __position(begin),
+                __end(end),
+                __pending_close(false)
+            {}
+
+            Event next() {
+                if(this->__pending_close) {
+                    this->__pending_close = false;
+
+                    return Event::CLOSE;
+                }
+
+                while(this->__position < this->__end) {
+                    if(this->__source[this->__position] != '<') {
+                        size_t tag = std::min(this->__source.find('<', this->__position), this->__end);
+
+                        this->__text = this->__source.substr(this->__position, tag - this->__position);
+                        this->__position = tag;
+
+                        if(!trim(this->__text).empty()) {
+                            return Event::TEXT;
+                        }
+
+                        continue;
+                    }
+
+                    auto rest = this->__source.substr(this->__position, this->__end - this->__position);
+
+                    if(rest.compare(0, 2, "<?") == 0) {
+                        this->__skip_past("?>");
+
+                        continue;
+                    }
+
+                    if(rest.compare(0, 4, "<!--") == 0) {
+                        this->__skip_past("-->");
+
+                        continue;
+                    }
+
+                    if(rest.compare(0, 9, "<![CDATA[") == 0) {
+                        size_t begin = this->__position + 9;
+
+                        this->__skip_past("]]>");
+                        this->__text = this->__source.substr(begin, this->__position - 3 - begin);
+
+                        return Event::TEXT;
+                    }
+
+                    if(rest.compare(0, 2, "<!") == 0) {
+                        this->__skip_past(">");
+
+                        continue;
+                    }
+
+                    size_t close = this->__tag_end();
+                    auto tag = this->__source.substr(this->__position + 1, close - this->__position - 1);
+
+                    this->__position = close + 1;
+
+                    if(!tag.empty() && tag.front() == '/') {
+                        this->__name = trim(tag.substr(1));
+
+                        return Event::CLOSE;
+                    }
+
+                    if(!tag.empty() && tag.back() == '/') {
+                        tag.remove_suffix(1);
+                        this->__pending_close = true;
+                    }
+
+                    size_t name_end = 0;
+
+                    while(name_end < tag.size() && !is_space(tag[name_end])) {
+                        name_end++;
+                    }
+
+                    this->__name = tag.substr(0, name_end);
+                    this->__attributes = tag.substr(name_end);
+
+                    return Event::OPEN;
+                }
+
+                return Event::END;
+            }
+
+            // Element of the last OPEN/CLOSE.
+            std::string_view name() {
+                return this->__name;
+            }
+
+            // Content of the last TEXT (untrimmed).
+            std::string_view text() {
+                return this->__text;
+            }
+
+            // Value of an attribute of the last OPEN (empty if missing). Entities are not decoded.
+            std::string_view attribute(std::string_view key) {
+                auto attributes = this->__attributes;
+                size_t i = 0;
+
+                while(i < attributes.size()) {
+                    while(i < attributes.size() && is_space(attributes[i])) {
+                        i++;
+                    }
+
+                    size_t name_begin = i;
+
+                    while(i < attributes.size() && attributes[i] != '=' && !is_space(attributes[i])) {
+                        i++;
+                    }
+
+                    auto name = attributes.substr(name_begin, i - name_begin);
+
+                    while(i < attributes.size() && (is_space(attributes[i]) || attributes[i] == '=')) {
+                        i++;
+                    }
+
+                    if(i >= attributes.size()) {
+                        break;
+                    }
+
+                    char quote = attributes[i++];
+                    size_t value_end = attributes.find(quote, i);
+
+                    if(value_end == std::string_view::npos) {
+                        break;
+                    }
+
+                    if(name == key) {
+                        return attributes.substr(i, value_end - i);
+                    }
+
+                    i = value_end + 1;
+                }
+
+                return {};
+            }
+
+            size_t offset() {
+                return this->__position;
+            }
+
+            // The last OPEN was a self-closing tag (its CLOSE comes next).
+            bool self_closing() {
+                return this->__pending_close;
+            }
+
+            void seek(size_t offset) {
+                this->__position = offset;
+                this->__pending_close = false;
+            }
+
+        private:
+            void __skip_past(std::string_view token) {
+                size_t found = this->__source.find(token, this->__position);
+
+                if(found == std::string_view::npos || found + token.size() > this->__end) {
+                    parse_error("unterminated markup", this->__position);
+                }
+
+                this->__position = found + token.size();
+            }
+
+            // Position of the '>' closing the tag at the current position (quoted '>' are skipped).
+            size_t __tag_end() {
+                char quote = 0;
+
+                for(size_t i = this->__position + 1; i < this->__end; i++) {
+                    char c = this->__source[i];
+
+                    if(quote != 0) {
+                        quote = c == quote ? 0 : quote;
+                    } else if(c == '"' || c == '\'') {
+                        quote = c;
+                    } else if(c == '>') {
+                        return i;
+                    }
+                }
+
+                parse_error("unterminated tag", this->__position);
+            }
+
+            std::string_view __source;
+            size_t __position;
+            size_t __end;
+            bool __pending_close;
+
+            std::string_view __name;
+            std::string_view __attributes;
+            std::string_view __text;
+    };
+
+    struct GeometryRange {
+        std::string id;
+        std::string name;
+        // Content of the <geometry> element (between its tags).
+        size_t begin;
+        size_t end;
+    };
+
+    struct FloatSource {
+        std::vector<float> values;
+        size_t stride = 1;
+    };
+
+    struct Input {
+        std::string_view semantic;
+        std::string_view source;
+        size_t offset;
+    };
+
+    struct VertexKey {
+        unsigned int position;
+        unsigned int normal;
+        unsigned int uv;
+
+        bool operator==(const VertexKey& other) const {
+            return this->position == other.position && this->normal == other.normal && this->uv == other.uv;
+        }
+    };
+
+    struct VertexHash {
+        size_t operator()(const VertexKey& key) const {
+            return ((size_t) key.position * 73856093u) ^ ((size_t) key.normal * 19349663u) ^ ((size_t) key.uv * 83492791u);
+        }
+    };
+
+    /**
+     * Parses one <geometry> into a Mesh. Runs on a worker, so it only touches its own range and Mesh.
+     *
+     * @param position_indices Filled with the <vertices> position index of every Mesh vertex (skins weight those).
+     */
+    std::shared_ptr<Mesh> parse_geometry(std::string_view source, const GeometryRange& range, std::vector<unsigned int>& position_indices) {
+        auto mesh = pepng::make_mesh();
+
+        std::unordered_map<std::string_view, FloatSource> sources;
+        std::unordered_map<std::string_view, std::vector<Input>> vertices;
+
+        FloatSource* current_source = nullptr;
+        std::string_view vertices_id;
+        bool in_vertices = false;
+
+        bool in_primitive = false;
+        std::string_view primitive;
+        std::vector<Input> inputs;
+        std::vector<unsigned int> vcount;
+        std::vector<unsigned int> indices;
+
+        std::unordered_map<VertexKey, unsigned int, VertexHash> welded;
+        const FloatSource* welded_sources[3] = { nullptr, nullptr, nullptr };
+
+        // Appends the triangles of the current primitive block.
+        auto emit = [&]() {
+            const FloatSource* attributes[3] = { nullptr, nullptr, nullptr };
+            size_t offsets[3] = { 0, 0, 0 };
+            size_t stride = 0;
+
+            auto bind = [&](std::string_view semantic, std::string_view id, size_t offset) {
+                int slot = semantic == "POSITION" ? 0 : semantic == "NORMAL" ? 1 : semantic == "TEXCOORD" ? 2 : -1;
+
+                // Only the first UV set is kept.
+                if(slot < 0 || attributes[slot] != nullptr) {
+                    return;
+                }
+
+                auto it = sources.find(id);
+
+                if(it == sources.end()) {
+                    parse_error("missing source " + std::string(id), range.begin);
+                }
+
+                attributes[slot] = &it->second;
+                offsets[slot] = offset;
+            };
+
+            for(auto& input : inputs) {
+                stride = std::max(stride, input.offset + 1);
+
+                if(input.semantic == "VERTEX") {
+                    for(auto& vertex_input : vertices[input.source]) {
+                        bind(vertex_input.semantic, vertex_input.source, input.offset);
+                    }
+                } else {
+                    bind(input.semantic, input.source, input.offset);
+                }
+            }
+
+            if(attributes[0] == nullptr || stride == 0) {
+                parse_error("primitive without positions in " + range.id, range.begin);
+            }
+
+            // Blocks reading other sources cannot share vertices.
+            if(!std::equal(attributes, attributes + 3, welded_sources)) {
+                welded.clear();
+                std::copy(attributes, attributes + 3, welded_sources);
+            }
+
+            auto fetch = [&](int slot, unsigned int index, size_t size) {
+                size_t at = (size_t) index * attributes[slot]->stride;
+
+                if(at + size > attributes[slot]->values.size()) {
+                    parse_error("index out of range in " + range.id, range.begin);
+                }
+
+                return attributes[slot]->values.data() + at;
+            };
+
+            auto corner = [&](size_t c) {
+                const unsigned int* tuple = indices.data() + c * stride;
+
+                VertexKey key {
+                    tuple[offsets[0]],
+                    attributes[1] != nullptr ? tuple[offsets[1]] : 0u,
+                    attributes[2] != nullptr ? tuple[offsets[2]] : 0u
+                };
+
+                auto [it, inserted] = welded.try_emplace(key, (unsigned int) mesh->positions.size());
+
+                if(inserted) {
+                    size_t index = mesh->positions.size();
+
+                    const float* position = fetch(0, key.position, 3);
+                    mesh->positions.push_back(glm::vec3(position[0], position[1], position[2]));
+                    position_indices.push_back(key.position);
+
+                    // Earlier blocks without the attribute are padded with zeros.
+                    if(attributes[1] != nullptr) {
+                        const float* normal = fetch(1, key.normal, 3);
+                        mesh->normals.resize(index);
+                        mesh->normals.push_back(glm::vec3(normal[0], normal[1], normal[2]));
+                    }
+
+                    if(attributes[2] != nullptr) {
+                        const float* uv = fetch(2, key.uv, 2);
+                        mesh->uvs.resize(index);
+                        mesh->uvs.push_back(glm::vec2(uv[0], uv[1]));
+                    }
+                }
+
+                mesh->indices.push_back(it->second);
+            };
+
+            size_t corner_count = indices.size() / stride;
+
+            if(primitive == "triangles") {
+                mesh->indices.reserve(mesh->indices.size() + corner_count);
+
+                for(size_t c = 0; c + 2 < corner_count; c += 3) {
+                    corner(c);
+                    corner(c + 1);
+                    corner(c + 2);
+                }
+
+                return;
+            }
+
+            // Polygons are triangulated as fans.
+            size_t first = 0;
+
+            for(auto count : vcount) {
+                if(first + count > corner_count) {
+                    parse_error("vcount exceeds <p> in " + range.id, range.begin);
+                }
+
+                for(size_t i = 1; i + 1 < count; i++) {
+                    corner(first);
+                    corner(first + i);
+                    corner(first + i + 1);
+                }
+
+                first += count;
+            }
+        };
+
+        XmlReader reader(source, range.begin, range.end);
+        std::string_view element;
+
+        for(auto event = reader.next(); event != XmlReader::Event::END; event = reader.next()) {
+            if(event == XmlReader::Event::OPEN) {
+                element = reader.name();
+
+                if(element == "source") {
+                    current_source = &sources[reader.attribute("id")];
+                } else if(element == "float_array" && current_source != nullptr) {
+                    current_source->values.reserve(parse_size(reader.attribute("count")));
+                } else if(element == "accessor" && current_source != nullptr) {
+                    current_source->stride = std::max<size_t>(1, parse_size(reader.attribute("stride")));
+                } else if(element == "vertices") {
+                    vertices_id = reader.attribute("id");
+                    in_vertices = true;
+                } else if(element == "input") {
+                    Input input { reader.attribute("semantic"), reference(reader.attribute("source")), parse_size(reader.attribute("offset")) };
+
+                    if(in_vertices) {
+                        vertices[vertices_id].push_back(input);
+                    } else if(in_primitive) {
+                        inputs.push_back(input);
+                    }
+                } else if(element == "triangles" || element == "polylist" || element == "polygons") {
+                    in_primitive = true;
+                    primitive = element;
+                    inputs.clear();
+                    vcount.clear();
+                    indices.clear();
+                    indices.reserve(parse_size(reader.attribute("count")) * 3);
+                }
+            } else if(event == XmlReader::Event::CLOSE) {
+                auto name = reader.name();
+
+                if(name == "source") {
+                    current_source = nullptr;
+                } else if(name == "vertices") {
+                    in_vertices = false;
+                } else if(in_primitive && name == primitive) {
+                    emit();
+                    in_primitive = false;
+                }
+
+                element = {};
+            } else {
+                size_t offset = reader.offset() - reader.text().size();
+
+                if(element == "float_array" && current_source != nullptr) {
+                    parse_numbers(reader.text(), current_source->values, offset);
+                } else if(element == "vcount" && in_primitive) {
+                    parse_numbers(reader.text(), vcount, offset);
+                } else if(element == "p" && in_primitive) {
+                    size_t before = indices.size();
+                    parse_numbers(reader.text(), indices, offset);
+
+                    // <polygons> has one <p> per polygon.
+                    if(primitive == "polygons") {
+                        size_t stride = 0;
+
+                        for(auto& input : inputs) {
+                            stride = std::max(stride, input.offset + 1);
+                        }
+
+                        vcount.push_back((unsigned int) ((indices.size() - before) / std::max<size_t>(1, stride)));
+                    }
+                }
+            }
+        }
+
+        if(!mesh->normals.empty()) {
+            mesh->normals.resize(mesh->positions.size());
+        }
+
+        if(!mesh->uvs.empty()) {
+            mesh->uvs.resize(mesh->positions.size());
+        }
+
+        mesh->compute_bounds();
+
+        return mesh;
+    }
+
+    // Appends the first count numbers of text as floats (missing ones stay 0).
+    void parse_floats(std::string_view text, float* values, size_t count, size_t offset) {
+        std::vector<float> parsed;
+        parse_numbers(text, parsed, offset);
+
+        for(size_t i = 0; i < count && i < parsed.size(); i++) {
+            values[i] = parsed[i];
+        }
+    }
+
+    // COLLADA matrices are row-major.
+    glm::mat4 read_matrix(const float* values) {
+        glm::mat4 matrix;
+
+        for(int row = 0; row < 4; row++) {
+            for(int column = 0; column < 4; column++) {
+                matrix[column][row] = values[row * 4 + column];
+            }
+        }
+
+        return matrix;
+    }
+
+    // Appends the whitespace separated names of text (<Name_array>, <IDREF_array>).
+    void parse_names(std::string_view text, std::vector<std::string_view>& names) {
+        size_t i = 0;
+
+        while(i < text.size()) {
+            while(i < text.size() && is_space(text[i])) {
+                i++;
+            }
+
+            size_t begin = i;
+
+            while(i < text.size() && !is_space(text[i])) {
+                i++;
+            }
+
+            if(i > begin) {
+                names.push_back(text.substr(begin, i - begin));
+            }
+        }
+    }
+
+    // Content of a <library_controllers> or <library_animations>.
+    struct LibraryRange {
+        size_t begin;
+        size_t end;
+    };
+
+    /**
+     * <skin> as written: influences per <vertices> position.
+     */
+    struct RawSkin {
+        std::string id;
+        std::string name;
+        std::string geometry;
+        glm::mat4 bind_shape = glm::mat4(1.0f);
+        std::vector<std::string> joints;
+        std::vector<glm::mat4> inverse_binds;
+        // Influences of position i are [offsets[i], offsets[i + 1]) in influences, as (joint, weight).
+        std::vector<size_t> offsets;
+        std::vector<std::pair<int, float>> influences;
+    };
+
+    /**
+     * Parses the <controller>s of a <library_controllers>. Runs on a worker.
+     */
+    void parse_controllers(std::string_view source, const LibraryRange& range, std::vector<RawSkin>& skins) {
+        std::unordered_map<std::string_view, FloatSource> sources;
+        std::unordered_map<std::string_view, std::vector<std::string_view>> names;
+
+        RawSkin skin;
+        bool in_skin = false;
+        std::string_view source_id;
+        bool in_source = false;
+        bool in_joints = false;
+        bool in_weights = false;
+        std::vector<Input> joint_inputs;
+        std::vector<Input> weight_inputs;
+        std::vector<unsigned int> vcount;
+        std::vector<int> v;
+
+        // Resolves the sources of the current <skin>.
+        auto finish = [&]() {
+            for(auto& input : joint_inputs) {
+                if(input.semantic == "JOINT") {
+                    for(auto name : names[input.source]) {
+                        skin.joints.emplace_back(name);
+                    }
+                } else if(input.semantic == "INV_BIND_MATRIX") {
+                    auto& matrices = sources[input.source].values;
+
+                    for(size_t i = 0; i + 16 <= matrices.size(); i += 16) {
+                        skin.inverse_binds.push_back(read_matrix(&matrices[i]));
+                    }
+                }
+            }
+
+            if(skin.joints.size() != skin.inverse_binds.size()) {
+                parse_error("joint and inverse bind matrix counts differ in " + skin.id, range.begin);
+            }
+
+            const FloatSource* weights = nullptr;
+            size_t joint_offset = 0, weight_offset = 0, stride = 0;
+            bool has_joints = false;
+
+            for(auto& input : weight_inputs) {
+                stride = std::max(stride, input.offset + 1);
+
+                if(input.semantic == "JOINT") {
+                    joint_offset = input.offset;
+                    has_joints = true;
+                } else if(input.semantic == "WEIGHT") {
+                    auto it = sources.find(input.source);
+
+                    if(it == sources.end()) {
+                        parse_error("missing source " + std::string(input.source), range.begin);
+                    }
+
+                    weights = &it->second;
+                    weight_offset = input.offset;
+                }
+            }
+
+            if(weights == nullptr || !has_joints) {
+                parse_error("<vertex_weights> without joints or weights in " + skin.id, range.begin);
+            }
+
+            skin.offsets.reserve(vcount.size() + 1);
+            skin.offsets.push_back(0);
+
+            size_t at = 0;
+
+            for(auto count : vcount) {
+                for(unsigned int i = 0; i < count; i++, at += stride) {
+                    if(at + stride > v.size()) {
+                        parse_error("<vcount> exceeds <v> in " + skin.id, range.begin);
+                    }
+
+                    int weight = v[at + weight_offset];
+
+                    if(weight < 0 || (size_t) weight >= weights->values.size()) {
+                        parse_error("weight index out of range in " + skin.id, range.begin);
+                    }
+
+                    skin.influences.push_back({ v[at + joint_offset], weights->values[weight] });
+                }
+
+                skin.offsets.push_back(skin.influences.size());
+            }
+
+            skins.push_back(std::move(skin));
+        };
+
+        XmlReader reader(source, range.begin, range.end);
+        std::string_view element;
+
+        for(auto event = reader.next(); event != XmlReader::Event::END; event = reader.next()) {
+            if(event == XmlReader::Event::OPEN) {
+                element = reader.name();
+
+                if(element == "controller") {
+                    skin = RawSkin();
+                    skin.id = std::string(reader.attribute("id"));
+                    skin.name = std::string(reader.attribute("name"));
+                    in_skin = false;
+                    sources.clear();
+                    names.clear();
+                    joint_inputs.clear();
+                    weight_inputs.clear();
+                    vcount.clear();
+                    v.clear();
+                } else if(element == "skin") {
+                    skin.geometry = std::string(reference(reader.attribute("source")));
+                    in_skin = true;
+                } else if(element == "source") {
+                    source_id = reader.attribute("id");
+                    sources[source_id];
+                    in_source = true;
+                } else if(element == "accessor" && in_source) {
+                    sources[source_id].stride = std::max<size_t>(1, parse_size(reader.attribute("stride")));
+                } else if(element == "joints") {
+                    in_joints = true;
+                } else if(element == "vertex_weights") {
+                    in_weights = true;
+                    vcount.reserve(parse_size(reader.attribute("count")));
+                } else if(element == "input") {
+                    Input input { reader.attribute("semantic"), reference(reader.attribute("source")), parse_size(reader.attribute("offset")) };
+
+                    if(in_joints) {
+                        joint_inputs.push_back(input);
+                    } else if(in_weights) {
+                        weight_inputs.push_back(input);
+                    }
+                }
+            } else if(event == XmlReader::Event::CLOSE) {
+                auto name = reader.name();
+
+                if(name == "source") {
+                    in_source = false;
+                } else if(name == "joints") {
+                    in_joints = false;
+                } else if(name == "vertex_weights") {
+                    in_weights = false;
+                } else if(name == "controller" && in_skin) {
+                    finish();
+                }
+
+                element = {};
+            } else {
+                size_t offset = reader.offset() - reader.text().size();
+
+                if(element == "bind_shape_matrix") {
+                    float values[16] = {};
+                    parse_floats(reader.text(), values, 16, offset);
+                    skin.bind_shape = read_matrix(values);
+                } else if(element == "float_array" && in_source) {
+                    parse_numbers(reader.text(), sources[source_id].values, offset);
+                } else if((element == "Name_array" || element == "IDREF_array") && in_source) {
+                    parse_names(reader.text(), names[source_id]);
+                } else if(element == "vcount" && in_weights) {
+                    parse_numbers(reader.text(), vcount, offset);
+                } else if(element == "v" && in_weights) {
+                    parse_numbers(reader.text(), v, offset);
+                }
+            }
+        }
+    }
+
+    /**
+     * Parses the channels of a <library_animations> (nested <animation>s included). Runs on a worker.
+     */
+    void parse_animations(std::string_view source, const LibraryRange& range, std::vector<ColladaChannel>& channels) {
+        std::unordered_map<std::string_view, FloatSource> sources;
+        // Sampler id to its INPUT (times) and OUTPUT (values) sources.
+        std::unordered_map<std::string_view, std::pair<std::string_view, std::string_view>> samplers;
+        // Sampler and target of every <channel>.
+        std::vector<std::pair<std::string_view, std::string_view>> targets;
+
+        std::string_view source_id;
+        std::string_view sampler_id;
+        bool in_source = false;
+        bool in_sampler = false;
+
+        XmlReader reader(source, range.begin, range.end);
+        std::string_view element;
+
+        for(auto event = reader.next(); event != XmlReader::Event::END; event = reader.next()) {
+            if(event == XmlReader::Event::OPEN) {
+                element = reader.name();
+
+                if(element == "source") {
+                    source_id = reader.attribute("id");
+                    sources[source_id];
+                    in_source = true;
+                } else if(element == "accessor" && in_source) {
+                    sources[source_id].stride = std::max<size_t>(1, parse_size(reader.attribute("stride")));
+                } else if(element == "sampler") {
+                    sampler_id = reader.attribute("id");
+                    in_sampler = true;
+                } else if(element == "input" && in_sampler) {
+                    auto semantic = reader.attribute("semantic");
+
+                    if(semantic == "INPUT") {
+                        samplers[sampler_id].first = reference(reader.attribute("source"));
+                    } else if(semantic == "OUTPUT") {
+                        samplers[sampler_id].second = reference(reader.attribute("source"));
+                    }
+                } else if(element == "channel") {
+                    targets.push_back({ reference(reader.attribute("source")), reader.attribute("target") });
+                }
+            } else if(event == XmlReader::Event::CLOSE) {
+                auto name = reader.name();
+
+                if(name == "source") {
+                    in_source = false;
+                } else if(name == "sampler") {
+                    in_sampler = false;
+                }
+
+                element = {};
+            } else if(element == "float_array" && in_source) {
+                parse_numbers(reader.text(), sources[source_id].values, reader.offset() - reader.text().size());
+            }
+        }
+
+        for(auto& [sampler_name, target] : targets) {
+            auto sampler = samplers.find(sampler_name);
+
+            if(sampler == samplers.end()) {
+                parse_error("missing sampler " + std::string(sampler_name), range.begin);
+            }
+
+            auto input = sources.find(sampler->second.first);
+            auto output = sources.find(sampler->second.second);
+
+            if(input == sources.end() || output == sources.end()) {
+                parse_error("missing source of sampler " + std::string(sampler_name), range.begin);
+            }
+
+            size_t slash = target.find('/');
+
+            ColladaChannel channel;
+            channel.node = std::string(target.substr(0, slash));
+            channel.target = slash == std::string_view::npos ? std::string() : std::string(target.substr(slash + 1));
+            channel.times = input->second.values;
+            channel.values = output->second.values;
+            channel.stride = output->second.stride;
+
+            if(channel.values.size() < channel.times.size() * channel.stride) {
+                parse_error("sampler " + std::string(sampler_name) + " has fewer values than keys", range.begin);
+            }
+
+            channels.push_back(std::move(channel));
+        }
+    }
+
+    /**
+     * Keeps the 4 strongest influences of every Mesh vertex, as bytes. Runs on a worker.
+     */
+    void pack_skin(const RawSkin& raw, const std::vector<unsigned int>& position_indices, ColladaSkin& skin) {
+        // Joint indices are stored as bytes.
+        if(raw.joints.size() > 256) {
+            parse_error("more than 256 joints in " + raw.id, 0);
+        }
+
+        size_t count = position_indices.size();
+
+        skin.vertex_joints.resize(count);
+        skin.vertex_weights.resize(count);
+
+        for(size_t v = 0; v < count; v++) {
+            unsigned int position = position_indices[v];
+
+            std::array<std::pair<int, float>, 4> kept;
+            kept.fill({ 0, 0.0f });
+
+            if((size_t) position + 1 < raw.offsets.size()) {
+                for(size_t i = raw.offsets[position]; i < raw.offsets[position + 1]; i++) {
+                    auto influence = raw.influences[i];
+
+                    // Joint -1 is the bind shape, which skinning always applies.
+                    if(influence.first < 0 || (size_t) influence.first >= raw.joints.size() || influence.second <= 0.0f) {
+                        continue;
+                    }
+
+                    // The weaker one keeps sinking, so kept stays sorted strongest first.
+                    for(auto& slot : kept) {
+                        if(influence.second > slot.second) {
+                            std::swap(influence, slot);
+                        }
+                    }
+                }
+            }
+
+            auto& joints = skin.vertex_joints[v];
+            auto& weights = skin.vertex_weights[v];
+
+            float total = kept[0].second + kept[1].second + kept[2].second + kept[3].second;
+
+            // Unweighted vertices follow the first joint.
+            if(total <= 0.0f) {
+                joints = { 0, 0, 0, 0 };
+                weights = { 255, 0, 0, 0 };
+
+                continue;
+            }
+
+            int sum = 0;
+
+            for(int k = 0; k < 4; k++) {
+                joints[k] = (uint8_t) kept[k].first;
+                weights[k] = (uint8_t) std::lround(kept[k].second / total * 255.0f);
+                sum += weights[k];
+            }
+
+            // Rounding leftovers go to the strongest influence, so the weights always sum to 255.
+            weights[0] = (uint8_t) (weights[0] + 255 - sum);
+        }
+    }
+}
+
+ColladaScene::ColladaScene() :
+    up_axis("Y_UP"),
+    parse_ms(0.0f)
+{}
+
+std::shared_ptr<ColladaScene> ColladaScene::make_collada_scene() {
+    std::shared_ptr<ColladaScene> scene(new ColladaScene());
+
+    return scene;
+}
+
+std::shared_ptr<ColladaScene> pepng::make_collada_scene() {
+    return ColladaScene::make_collada_scene();
+}
+
+std::shared_ptr<Mesh> ColladaScene::mesh(const std::string& id_or_name) {
+    for(size_t i = 0; i < this->meshes.size(); i++) {
+        if(this->geometry_ids[i] == id_or_name || this->geometry_names[i] == id_or_name) {
+            return this->meshes[i];
+        }
+    }
+
+    return nullptr;
+}
+
+std::shared_ptr<ColladaScene> pepng::load_collada(const std::filesystem::path& path) {
+    auto start = std::chrono::steady_clock::now();
+
+    auto file = pepng::map_file(path);
+    auto source = file->view();
+
+    auto scene = pepng::make_collada_scene();
+
+    std::vector<GeometryRange> geometries;
+    std::vector<LibraryRange> controller_libraries;
+    std::vector<LibraryRange> animation_libraries;
+    std::vector<std::pair<size_t, std::string_view>> instances;
+    std::vector<std::pair<size_t, std::string_view>> controller_instances;
+    std::vector<size_t> node_stack;
+    bool in_visual_scene = false;
+
+    // Pass 1: hierarchy and geometry ranges. Geometry bodies are jumped over without tokenizing them.
+    XmlReader reader(source, 0, source.size());
+    std::string_view element;
+
+    for(auto event = reader.next(); event != XmlReader::Event::END; event = reader.next()) {
+        if(event == XmlReader::Event::OPEN) {
+            element = reader.name();
+
+            if(element == "geometry") {
+                GeometryRange range { std::string(reader.attribute("id")), std::string(reader.attribute("name")), reader.offset(), 0 };
+
+                size_t close = source.find("</geometry>", range.begin);
+
+                if(close == std::string_view::npos) {
+                    parse_error("unterminated <geometry>", range.begin);
+                }
+
+                range.end = close;
+                geometries.push_back(std::move(range));
+
+                reader.seek(close + std::strlen("</geometry>"));
+                element = {};
+            } else if((element == "library_controllers" || element == "library_animations") && !reader.self_closing()) {
+                // Parsed in pass 2, next to the geometries.
+                std::string close_tag = "</" + std::string(element) + ">";
+                LibraryRange range { reader.offset(), source.find(close_tag, reader.offset()) };
+
+                if(range.end == std::string_view::npos) {
+                    parse_error("unterminated <" + std::string(element) + ">", range.begin);
+                }
+
+                (element == "library_controllers" ? controller_libraries : animation_libraries).push_back(range);
+
+                reader.seek(range.end + close_tag.size());
+                element = {};
+            } else if(element == "visual_scene") {
+                in_visual_scene = true;
+            } else if(element == "node" && in_visual_scene) {
+                auto name = reader.attribute("name");
+
+                ColladaNode node;
+                node.name = std::string(name.empty() ? reader.attribute("id") : name);
+                node.id = std::string(reader.attribute("id"));
+                node.sid = std::string(reader.attribute("sid"));
+                node.joint = reader.attribute("type") == "JOINT";
+                node.matrix = glm::mat4(1.0f);
+                node.geometry = -1;
+                node.skin = -1;
+                node.parent = node_stack.empty() ? -1 : (int) node_stack.back();
+
+                if(node.parent >= 0) {
+                    scene->nodes[node.parent].children.push_back(scene->nodes.size());
+                }
+
+                node_stack.push_back(scene->nodes.size());
+                scene->nodes.push_back(std::move(node));
+            } else if(element == "instance_geometry" && !node_stack.empty()) {
+                instances.push_back({ node_stack.back(), reference(reader.attribute("url")) });
+            } else if(element == "instance_controller" && !node_stack.empty()) {
+                controller_instances.push_back({ node_stack.back(), reference(reader.attribute("url")) });
+            }
+        } else if(event == XmlReader::Event::CLOSE) {
+            auto name = reader.name();
+
+            if(name == "node" && in_visual_scene && !node_stack.empty()) {
+                node_stack.pop_back();
+            } else if(name == "visual_scene") {
+                in_visual_scene = false;
+            }
+
+            element = {};
+        } else {
+            size_t offset = reader.offset() - reader.text().size();
+
+            if(element == "up_axis") {
+                scene->up_axis = std::string(trim(reader.text()));
+            } else if(in_visual_scene && !node_stack.empty()) {
+                // Transform elements compose in document order.
+                auto& matrix = scene->nodes[node_stack.back()].matrix;
+                float values[16] = {};
+
+                if(element == "matrix") {
+                    parse_floats(reader.text(), values, 16, offset);
+                    matrix = matrix * read_matrix(values);
+                } else if(element == "translate") {
+                    parse_floats(reader.text(), values, 3, offset);
+                    matrix = glm::translate(matrix, glm::vec3(values[0], values[1], values[2]));
+                } else if(element == "rotate") {
+                    parse_floats(reader.text(), values, 4, offset);
+                    matrix = glm::rotate(matrix, glm::radians(values[3]), glm::vec3(values[0], values[1], values[2]));
+                } else if(element == "scale") {
+                    parse_floats(reader.text(), values, 3, offset);
+                    matrix = glm::scale(matrix, glm::vec3(values[0], values[1], values[2]));
+                }
+            }
+        }
+    }
+
+    std::unordered_map<std::string_view, int> geometry_index;
+
+    for(size_t i = 0; i < geometries.size(); i++) {
+        scene->geometry_ids.push_back(geometries[i].id);
+        scene->geometry_names.push_back(geometries[i].name);
+        geometry_index[geometries[i].id] = (int) i;
+    }
+
+    for(auto& [node, url] : instances) {
+        auto it = geometry_index.find(url);
+
+        if(it != geometry_index.end() && scene->nodes[node].geometry < 0) {
+            scene->nodes[node].geometry = it->second;
+        }
+    }
+
+    // Pass 2: geometries are independent, so they are parsed in parallel (the libraries as two more jobs).
+    scene->meshes.resize(geometries.size());
+
+    std::vector<std::vector<unsigned int>> position_indices(geometries.size());
+    std::vector<RawSkin> raw_skins;
+
+    pepng::jobs()->parallel_for(geometries.size() + 2, [&](size_t i) {
+        if(i < geometries.size()) {
+            scene->meshes[i] = parse_geometry(source, geometries[i], position_indices[i]);
+        } else if(i == geometries.size()) {
+            for(auto& range : controller_libraries) {
+                parse_controllers(source, range, raw_skins);
+            }
+        } else {
+            for(auto& range : animation_libraries) {
+                parse_animations(source, range, scene->channels);
+            }
+        }
+    });
+
+    // Skins are packed per Mesh vertex, which needs the parsed geometry.
+    std::unordered_map<std::string_view, int> skin_index;
+    scene->skins.resize(raw_skins.size());
+
+    for(size_t i = 0; i < raw_skins.size(); i++) {
+        auto& raw = raw_skins[i];
+        auto& skin = scene->skins[i];
+
+        auto geometry = geometry_index.find(raw.geometry);
+
+        skin.id = raw.id;
+        skin.name = raw.name;
+        skin.geometry = geometry != geometry_index.end() ? geometry->second : -1;
+        skin.bind_shape = raw.bind_shape;
+        skin.joints = raw.joints;
+        skin.inverse_binds = raw.inverse_binds;
+
+        skin_index[raw.id] = (int) i;
+    }
+
+    pepng::jobs()->parallel_for(raw_skins.size(), [&](size_t i) {
+        auto& skin = scene->skins[i];
+
+        if(skin.geometry >= 0) {
+            pack_skin(raw_skins[i], position_indices[skin.geometry], skin);
+        }
+    });
+
+    for(auto& [node, url] : controller_instances) {
+        auto it = skin_index.find(url);
+
+        if(it != skin_index.end() && scene->nodes[node].skin < 0) {
+            scene->nodes[node].skin = it->second;
+        }
+    }
+
+    scene->parse_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    return scene;
+}
\ No newline at end of file
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <pepng.h>
+
+#include <array>
+
+#include "mesh.hpp"
+
+/**
+ * Node of a COLLADA visual scene.
+ */
+struct ColladaNode {
+    std::string name;
+    std::string id;
+    // Scoped id, which skins usually name their joints by.
+    std::string sid;
+    // type="JOINT".
+    bool joint;
+    // Local transform (column-major, as COLLADA's row-major matrix is transposed on load).
+    glm::mat4 matrix;
+    // Index in ColladaScene::meshes or -1.
+    int geometry;
+    // Index in ColladaScene::skins (<instance_controller>) or -1.
+    int skin;
+    // Index in ColladaScene::nodes or -1 for roots.
+    int parent;
+    std::vector<size_t> children;
+};
+
+/**
+ * Skin of a <controller>, packed for GPU skinning.
+ *
+ * Every Mesh vertex keeps its 4 strongest influences. Weights are renormalized and stored as bytes summing to 255.
+ */
+struct ColladaSkin {
+    std::string id;
+    std::string name;
+    // Index in ColladaScene::meshes or -1.
+    int geometry;
+    glm::mat4 bind_shape;
+    // Joint sids (or ids) in the controller's order, which the vertex joints index.
+    std::vector<std::string> joints;
+    std::vector<glm::mat4> inverse_binds;
+    // One per Mesh vertex. Unused influences have weight 0.
+    std::vector<std::array<uint8_t, 4>> vertex_joints;
+    std::vector<std::array<uint8_t, 4>> vertex_weights;
+};
+
+/**
+ * Channel of an <animation> (keys are read as linear, whatever the sampler's interpolation).
+ */
+struct ColladaChannel {
+    // Id of the animated node.
+    std::string node;
+    // Animated element of the node ("transform" for baked matrices).
+    std::string target;
+    std::vector<float> times;
+    // stride values per key (16 for matrices, row-major as in the file).
+    std::vector<float> values;
+    size_t stride;
+};
+
+/**
+ * Geometry, skins, animations and node hierarchy of a COLLADA document (no materials, geometry stays in file axes).
+ */
+class ColladaScene {
+    public:
+        static std::shared_ptr<ColladaScene> make_collada_scene();
+
+        // One Mesh per <geometry>, every primitive block merged.
+        std::vector<std::shared_ptr<Mesh>> meshes;
+        std::vector<std::string> geometry_ids;
+        std::vector<std::string> geometry_names;
+
+        // Parents come before their children.
+        std::vector<ColladaNode> nodes;
+
+        // One per <controller> with a <skin>.
+        std::vector<ColladaSkin> skins;
+        std::vector<ColladaChannel> channels;
+
+        // Content of <up_axis> (Y_UP if missing).
+        std::string up_axis;
+
+        // Wall time of the load (mapping, both passes).
+        float parse_ms;
+
+        /**
+         * The Mesh of a <geometry> by id or name. nullptr if missing.
+         */
+        std::shared_ptr<Mesh> mesh(const std::string& id_or_name);
+
+    private:
+        ColladaScene();
+};
+
+namespace pepng {
+    std::shared_ptr<ColladaScene> make_collada_scene();
+
+    /**
+     * Loads the geometry, skins and animations of a COLLADA file.
+     *
+     * A streaming, zero-copy tokenizer runs over the memory-mapped file: one serial pass reads the
+     * hierarchy and finds every <geometry> and library of controllers/animations, then they are parsed
+     * in parallel on the JobSystem. <triangles> and <polylist> (fan triangulated) are read, numbers go
+     * through std::from_chars.
+     *
+     * Throws on files that cannot be opened or malformed primitives.
+     */
+    std::shared_ptr<ColladaScene> load_collada(const std::filesystem::path& path);
+};
\ No newline at end of file
@@ -0,0 +1,617 @@
+#include "command_list.hpp"
+
+#include "radix_sort.hpp"
+
+#include <chrono>
+
+size_t CommandList::__push_payload(const float* data, size_t count) {
+    size_t offset = this->__payload.size();
+
+    this->__payload.insert(this->__payload.end(), data, data + count);
+
+    return offset;
+}
+
+void CommandList::use_program(GLuint program) {
+    this->__commands.push_back(Command { Type::USE_PROGRAM, (GLint) program, 0, 0, 0, 0 });
+}
+
+void CommandList::bind_texture(GLuint unit, GLenum target, GLuint texture) {
+    this->__commands.push_back(Command { Type::BIND_TEXTURE, (GLint) unit, texture, target, 0, 0 });
+}
+
+void CommandList::uniform(GLint location, int value) {
+    if(location < 0) {
+        return;
+    }
+
+    // Small integers are exact in the float payload.
+    float payload = (float) value;
+
+    this->__commands.push_back(Command { Type::UNIFORM_1I, location, 0, 0, 1, this->__push_payload(&payload, 1) });
+}
+
+void CommandList::uniform(GLint location, float value) {
+    if(location < 0) {
+        return;
+    }
+
+    this->__commands.push_back(Command { Type::UNIFORM_1F, location, 0, 0, 1, this->__push_payload(&value, 1) });
+}
+
+void CommandList::uniform(GLint location, const glm::vec3& value) {
+    if(location < 0) {
+        return;
+    }
+
+    this->__commands.push_back(Command { Type::UNIFORM_3F, location, 0, 0, 1, this->__push_payload(glm::value_ptr(value), 3) });
+}
+
+void CommandList::uniform(GLint location, const glm::vec4& value) {
+    if(location < 0) {
+        return;
+    }
+
+    this->__commands.push_back(Command { Type::UNIFORM_4F, location, 0, 0, 1, this->__push_payload(glm::value_ptr(value), 4) });
+}
+
+void CommandList::uniform(GLint location, const glm::mat4& value) {
+    if(location < 0) {
+        return;
+    }
+
+    this->__commands.push_back(Command { Type::UNIFORM_MATRIX_4F, location, 0, 0, 1, this->__push_payload(glm::value_ptr(value), 16) });
+}
+
+void CommandList::uniform(GLint location, size_t payload) {
+    if(location < 0) {
+        return;
+    }
+
+    this->__commands.push_back(Command { Type::UNIFORM_MATRIX_4F, location, 0, 0, 1, payload });
+}
+
+size_t CommandList::push_matrix(const glm::mat4& value) {
+    return this->__push_payload(glm::value_ptr(value), 16);
+}
+
+void CommandList::depth_mask(bool enabled) {
+    this->__depth_mask = enabled;
+    this->__commands.push_back(Command { Type::DEPTH_MASK, 0, 0, (GLenum) (enabled ? GL_TRUE : GL_FALSE), 0, 0 });
+}
+
+bool CommandList::recorded_depth_mask() {
+    return this->__depth_mask;
+}
+
+void CommandList::color_mask(bool enabled) {
+    this->__commands.push_back(Command { Type::COLOR_MASK, 0, 0, (GLenum) (enabled ? GL_TRUE : GL_FALSE), 0, 0 });
+}
+
+void CommandList::depth_test(bool enabled) {
+    this->__commands.push_back(Command { Type::DEPTH_TEST, 0, 0, (GLenum) (enabled ? GL_TRUE : GL_FALSE), 0, 0 });
+}
+
+void CommandList::blend(bool enabled) {
+    this->__commands.push_back(Command { Type::BLEND, 0, 0, (GLenum) (enabled ? GL_TRUE : GL_FALSE), 0, 0 });
+}
+
+void CommandList::begin_query(GLenum target, GLuint query) {
+    this->__commands.push_back(Command { Type::BEGIN_QUERY, 0, query, target, 0, 0 });
+}
+
+void CommandList::end_query(GLenum target) {
+    this->__commands.push_back(Command { Type::END_QUERY, 0, 0, target, 0, 0 });
+}
+
+void CommandList::begin_conditional_render(GLuint query) {
+    this->__commands.push_back(Command { Type::BEGIN_CONDITIONAL_RENDER, 0, query, 0, 0, 0 });
+}
+
+void CommandList::end_conditional_render() {
+    this->__commands.push_back(Command { Type::END_CONDITIONAL_RENDER, 0, 0, 0, 0, 0 });
+}
+
+void CommandList::bind_vertex_array(GLuint vao) {
+    this->__commands.push_back(Command { Type::BIND_VERTEX_ARRAY, (GLint) vao, 0, 0, 0, 0 });
+}
+
+void CommandList::viewport(const glm::vec4& rect, bool clear_depth) {
+    this->__commands.push_back(Command { Type::VIEWPORT, 0, 0, (GLenum) (clear_depth ? GL_TRUE : GL_FALSE), 0, this->__push_payload(glm::value_ptr(rect), 4) });
+}
+
+void CommandList::draw_arrays(GLenum mode, GLint first, GLsizei count) {
+    this->__commands.push_back(Command { Type::DRAW_ARRAYS, 0, (GLuint) first, mode, count, 0 });
+    this->__draw_count++;
+}
+
+void CommandList::draw_arrays_instanced(GLenum mode, GLint first, GLsizei count, GLsizei instance_count) {
+    this->__commands.push_back(Command { Type::DRAW_ARRAYS_INSTANCED, 0, (GLuint) first, mode, count, (size_t) instance_count });
+    this->__draw_count++;
+}
+
+void CommandList::draw_elements(GLenum mode, GLsizei count, GLenum type, size_t offset) {
+    this->__commands.push_back(Command { Type::DRAW_ELEMENTS, (GLint) type, (GLuint) offset, mode, count, 0 });
+    this->__draw_count++;
+}
+
+void CommandList::draw_elements_instanced(GLenum mode, GLsizei count, GLenum type, size_t offset, GLsizei instance_count) {
+    this->__commands.push_back(Command { Type::DRAW_ELEMENTS_INSTANCED, (GLint) type, (GLuint) offset, mode, count, (size_t) instance_count });
+    this->__draw_count++;
+}
+
+void CommandList::begin_item(BlendMode blend_mode, float depth) {
+    uint32_t key = pepng::float_key(depth);
+
+    // Back to front: the farthest gets the smallest key.
+    if(blend_mode == BlendMode::ALPHA_BLEND) {
+        key = ~key;
+    }
+
+    // The blend mode in the 2 upper bits sorts the passes in the same sort, the depth keeps 30 bits.
+    key = ((uint32_t) blend_mode << 30) | (key >> 2);
+
+    this->__items.push_back(Item { this->__commands.size(), this->__commands.size(), blend_mode, key });
+
+    if(blend_mode == BlendMode::ALPHA_BLEND) {
+        this->blend(true);
+        this->depth_mask(false);
+    }
+}
+
+void CommandList::end_item() {
+    if(this->__items.empty()) {
+        return;
+    }
+
+    auto& item = this->__items.back();
+
+    // Unsorted lists stay correct: the state is restored for whatever comes next.
+    if(item.blend_mode == BlendMode::ALPHA_BLEND) {
+        this->depth_mask(true);
+        this->blend(false);
+    }
+
+    item.end = this->__commands.size();
+}
+
+CommandList::SortStats CommandList::sort() {
+    SortStats stats;
+
+    if(this->__items.empty()) {
+        return stats;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    auto& keys = this->__keys;
+
+    keys.resize(this->__items.size());
+
+    for(size_t i = 0; i < this->__items.size(); i++) {
+        keys[i] = ((uint64_t) this->__items[i].key << 32) | i;
+    }
+
+    pepng::radix_sort(keys, this->__scratch);
+
+    auto sorted = std::chrono::steady_clock::now();
+
+    auto& ranges = this->__ranges;
+
+    ranges.clear();
+
+    // Commands between items first, in their order.
+    size_t cursor = 0;
+
+    for(auto& item : this->__items) {
+        if(cursor < item.begin) {
+            ranges.push_back({ cursor, item.begin });
+        }
+
+        cursor = item.end;
+    }
+
+    ranges.push_back({ cursor, this->__commands.size() });
+
+    bool blending = false;
+
+    for(auto value : keys) {
+        auto& item = this->__items[(uint32_t) value];
+
+        if(item.blend_mode != BlendMode::ALPHA_BLEND) {
+            ranges.push_back({ item.begin, item.end });
+
+            if(item.blend_mode == BlendMode::NONE) {
+                stats.opaque++;
+            } else {
+                stats.alpha_tested++;
+            }
+
+            continue;
+        }
+
+        // Only the last blended item restores the state (replay skips the blend/depth mask changes that repeat).
+        ranges.push_back({ item.begin, item.end - 2 });
+        stats.blended++;
+        blending = true;
+    }
+
+    if(blending) {
+        size_t restore = this->__commands.size();
+
+        this->depth_mask(true);
+        this->blend(false);
+
+        ranges.push_back({ restore, this->__commands.size() });
+    }
+
+    // Commands recorded after sorting are replayed after the sorted ones.
+    this->__sorted_end = this->__commands.size();
+
+    stats.sort_ms = std::chrono::duration<float, std::milli>(sorted - start).count();
+    stats.reorder_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - sorted).count();
+
+    this->__items.clear();
+
+    return stats;
+}
+
+template<typename F> void CommandList::__for_each(F&& f) {
+    for(auto& range : this->__ranges) {
+        for(size_t i = range.first; i < range.second; i++) {
+            f(this->__commands[i]);
+        }
+    }
+
+    for(size_t i = this->__sorted_end; i < this->__commands.size(); i++) {
+        f(this->__commands[i]);
+    }
+}
+
+void CommandList::clear() {
+    this->__commands.clear();
+    this->__payload.clear();
+    this->__items.clear();
+    this->__ranges.clear();
+    this->__sorted_end = 0;
+    this->__draw_count = 0;
+    this->__depth_mask = true;
+}
+
+size_t CommandList::size() {
+    return this->__commands.size();
+}
+
+size_t CommandList::draw_count() {
+    return this->__draw_count;
+}
+
+uint64_t CommandList::hash() {
+    // FNV-1a.
+    uint64_t hash = 14695981039346656037ull;
+
+    auto mix = [&hash](const void* data, size_t size) {
+        auto bytes = (const unsigned char*) data;
+
+        for(size_t i = 0; i < size; i++) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+    };
+
+    auto mix_command = [&mix](const Command& command) {
+        mix(&command.type, sizeof(command.type));
+        mix(&command.target, sizeof(command.target));
+        mix(&command.mode, sizeof(command.mode));
+        mix(&command.count, sizeof(command.count));
+
+        // Query names rotate every frame without changing the image.
+        bool query = command.type == Type::BEGIN_QUERY || command.type == Type::BEGIN_CONDITIONAL_RENDER;
+
+        if(!query) {
+            mix(&command.value, sizeof(command.value));
+        }
+
+        if(command.type == Type::DRAW_ARRAYS_INSTANCED || command.type == Type::DRAW_ELEMENTS_INSTANCED) {
+            mix(&command.payload, sizeof(command.payload));
+        }
+    };
+
+    // In replay order.
+    this->__for_each(mix_command);
+
+    mix(this->__payload.data(), this->__payload.size() * sizeof(float));
+
+    return hash;
+}
+
+void CommandList::replay() {
+    // Other renderers issue GL directly between replays, so the tracked state starts unknown.
+    GLint program = -1;
+    GLint vao = -1;
+    GLenum depth_mask = GL_TRUE + 1;
+    GLenum blend = GL_TRUE + 1;
+    GLint active_unit = -1;
+    std::vector<std::pair<GLenum, GLuint>> textures(16, { 0, (GLuint) -1 });
+    // Viewport the replay started with (read on the first VIEWPORT command).
+    glm::ivec4 base_viewport(0);
+
+    auto execute = [&](const Command& command) {
+        const float* payload = this->__payload.data() + command.payload;
+
+        switch(command.type) {
+            case Type::USE_PROGRAM:
+                if(program != command.target) {
+                    glUseProgram(command.target);
+                    program = command.target;
+                }
+                break;
+            case Type::BIND_TEXTURE: {
+                auto bound = std::make_pair(command.mode, command.value);
+
+                if(command.target < (GLint) textures.size() && textures[command.target] == bound) {
+                    break;
+                }
+
+                if(active_unit != command.target) {
+                    glActiveTexture(GL_TEXTURE0 + command.target);
+                    active_unit = command.target;
+                }
+
+                glBindTexture(command.mode, command.value);
+
+                if(command.target < (GLint) textures.size()) {
+                    textures[command.target] = bound;
+                }
+                break;
+            }
+            case Type::UNIFORM_1I:
+                glUniform1i(command.target, (GLint) payload[0]);
+                break;
+            case Type::UNIFORM_1F:
+                glUniform1f(command.target, payload[0]);
+                break;
+            case Type::UNIFORM_3F:
+                glUniform3fv(command.target, command.count, payload);
+                break;
+            case Type::UNIFORM_4F:
+                glUniform4fv(command.target, command.count, payload);
+                break;
+            case Type::UNIFORM_MATRIX_4F:
+                glUniformMatrix4fv(command.target, command.count, GL_FALSE, payload);
+                break;
+            case Type::DEPTH_MASK:
+                if(depth_mask != command.mode) {
+                    glDepthMask(command.mode);
+                    depth_mask = command.mode;
+                }
+                break;
+            case Type::COLOR_MASK:
+                glColorMask(command.mode, command.mode, command.mode, command.mode);
+                break;
+            case Type::DEPTH_TEST:
+                if(command.mode == GL_TRUE) {
+                    glEnable(GL_DEPTH_TEST);
+                } else {
+                    glDisable(GL_DEPTH_TEST);
+                }
+                break;
+            case Type::BLEND:
+                if(blend != command.mode) {
+                    if(command.mode == GL_TRUE) {
+                        glEnable(GL_BLEND);
+                        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+                    } else {
+                        glDisable(GL_BLEND);
+                    }
+
+                    blend = command.mode;
+                }
+                break;
+            case Type::BEGIN_QUERY:
+                glBeginQuery(command.mode, command.value);
+                break;
+            case Type::END_QUERY:
+                glEndQuery(command.mode);
+                break;
+            case Type::BEGIN_CONDITIONAL_RENDER:
+                #ifndef __EMSCRIPTEN__
+                glBeginConditionalRender(command.value, GL_QUERY_NO_WAIT);
+                #endif
+                break;
+            case Type::END_CONDITIONAL_RENDER:
+                #ifndef __EMSCRIPTEN__
+                glEndConditionalRender();
+                #endif
+                break;
+            case Type::BIND_VERTEX_ARRAY:
+                if(vao != command.target) {
+                    glBindVertexArray(command.target);
+                    vao = command.target;
+                }
+                break;
+            case Type::VIEWPORT: {
+                if(base_viewport.z == 0) {
+                    glGetIntegerv(GL_VIEWPORT, glm::value_ptr(base_viewport));
+                }
+
+                glm::ivec4 rect(
+                    base_viewport.x + (int) (payload[0] * base_viewport.z),
+                    base_viewport.y + (int) (payload[1] * base_viewport.w),
+                    std::max(1, (int) (payload[2] * base_viewport.z)),
+                    std::max(1, (int) (payload[3] * base_viewport.w)));
+
+                glViewport(rect.x, rect.y, rect.z, rect.w);
+
+                if(command.mode == GL_TRUE) {
+                    glEnable(GL_SCISSOR_TEST);
+                    glScissor(rect.x, rect.y, rect.z, rect.w);
+                    glClear(GL_DEPTH_BUFFER_BIT);
+                    glDisable(GL_SCISSOR_TEST);
+                }
+                break;
+            }
+            case Type::DRAW_ARRAYS:
+                glDrawArrays(command.mode, (GLint) command.value, command.count);
+                break;
+            case Type::DRAW_ARRAYS_INSTANCED:
+                glDrawArraysInstanced(command.mode, (GLint) command.value, command.count, (GLsizei) command.payload);
+                break;
+            case Type::DRAW_ELEMENTS:
+                glDrawElements(command.mode, command.count, (GLenum) command.target, (const void*) (uintptr_t) command.value);
+                break;
+            case Type::DRAW_ELEMENTS_INSTANCED:
+                glDrawElementsInstanced(command.mode, command.count, (GLenum) command.target, (const void*) (uintptr_t) command.value, (GLsizei) command.payload);
+                break;
+        }
+    };
+
+    this->__for_each(execute);
+
+    glDepthMask(GL_TRUE);
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    glEnable(GL_DEPTH_TEST);
+    glDisable(GL_BLEND);
+
+    if(base_viewport.z != 0) {
+        glViewport(base_viewport.x, base_viewport.y, base_viewport.z, base_viewport.w);
+    }
+}
+
+CommandQueue::CommandQueue(size_t buffer_count) :
+    __slots(std::max<size_t>(buffer_count, 2)),
+    __write(0),
+    __read(0),
+    __frame(0),
+    __last_draw_count(0),
+    __last_command_count(0)
+{}
+
+std::shared_ptr<CommandQueue> CommandQueue::make_command_queue(size_t buffer_count) {
+    std::shared_ptr<CommandQueue> queue(new CommandQueue(buffer_count));
+
+    return queue;
+}
+
+std::shared_ptr<CommandQueue> pepng::make_command_queue(size_t buffer_count) {
+    return CommandQueue::make_command_queue(buffer_count);
+}
+
+std::shared_ptr<CommandQueue> pepng::commands() {
+    static auto queue = pepng::make_command_queue(2);
+
+    return queue;
+}
+
+CommandList& CommandQueue::record() {
+    std::unique_lock<std::mutex> lock(this->__mutex);
+
+    auto& slot = this->__slots[this->__write];
+
+    if(slot.state != State::RECORDING) {
+        this->__fence.wait(lock, [&slot]() {
+            return slot.state == State::FREE;
+        });
+
+        slot.list.clear();
+        slot.state = State::RECORDING;
+    }
+
+    return slot.list;
+}
+
+void CommandQueue::submit() {
+    {
+        std::unique_lock<std::mutex> lock(this->__mutex);
+
+        auto& slot = this->__slots[this->__write];
+
+        if(slot.state != State::RECORDING) {
+            this->__fence.wait(lock, [&slot]() {
+                return slot.state == State::FREE;
+            });
+
+            slot.list.clear();
+        }
+
+        slot.state = State::SUBMITTED;
+
+        this->__write = (this->__write + 1) % this->__slots.size();
+        this->__frame++;
+    }
+
+    this->__fence.notify_all();
+}
+
+bool CommandQueue::replay(bool wait) {
+    Slot* slot;
+
+    {
+        std::unique_lock<std::mutex> lock(this->__mutex);
+
+        slot = &this->__slots[this->__read];
+
+        if(slot->state != State::SUBMITTED) {
+            if(!wait) {
+                return false;
+            }
+
+            this->__fence.wait(lock, [slot]() {
+                return slot->state == State::SUBMITTED;
+            });
+        }
+
+        slot->state = State::REPLAYING;
+    }
+
+    slot->list.replay();
+
+    {
+        std::lock_guard<std::mutex> lock(this->__mutex);
+
+        this->__last_draw_count = slot->list.draw_count();
+        this->__last_command_count = slot->list.size();
+
+        slot->state = State::FREE;
+
+        this->__read = (this->__read + 1) % this->__slots.size();
+    }
+
+    this->__fence.notify_all();
+
+    return true;
+}
+
+size_t CommandQueue::frame() {
+    std::lock_guard<std::mutex> lock(this->__mutex);
+
+    return this->__frame;
+}
+
+size_t CommandQueue::last_draw_count() {
+    std::lock_guard<std::mutex> lock(this->__mutex);
+
+    return this->__last_draw_count;
+}
+
+size_t CommandQueue::last_command_count() {
+    std::lock_guard<std::mutex> lock(this->__mutex);
+
+    return this->__last_command_count;
+}
+
+GLint pepng::uniform_location(GLuint program, const std::string& name) {
+    static std::unordered_map<GLuint, std::unordered_map<std::string, GLint>> locations;
+
+    auto& program_locations = locations[program];
+    auto it = program_locations.find(name);
+
+    if(it != program_locations.end()) {
+        return it->second;
+    }
+
+    GLint location = glGetUniformLocation(program, name.c_str());
+
+    program_locations[name] = location;
+
+    return location;
+}
\ No newline at end of file
@@ -0,0 +1,242 @@
+#pragma once
+
+#include <pepng.h>
+
+#include <condition_variable>
+#include <mutex>
+
+/**
+ * How a material's alpha is drawn (see CommandList::begin_item).
+ */
+enum class BlendMode {
+    // Opaque, drawn front to back.
+    NONE,
+    // Fragments under the material's cutoff are discarded, drawn front to back after the opaque draws.
+    ALPHA_TEST,
+    // Blended over what is behind, drawn back to front last without writing depth.
+    ALPHA_BLEND
+};
+
+/**
+ * Backend-agnostic list of recorded GL work (state changes, uniform payloads, draws).
+ *
+ * Recording into the list touches no GL state. The recorders do, though (occlusion queries, LOD and edge
+ * buffer builds, light texture uploads), so recording stays on the thread that owns the context.
+ * Replay skips redundant program/texture/VAO/depth-mask/blend changes.
+ */
+class CommandList {
+    public:
+        enum class Type {
+            USE_PROGRAM,
+            BIND_TEXTURE,
+            UNIFORM_1I,
+            UNIFORM_1F,
+            UNIFORM_3F,
+            UNIFORM_4F,
+            UNIFORM_MATRIX_4F,
+            DEPTH_MASK,
+            COLOR_MASK,
+            DEPTH_TEST,
+            BLEND,
+            BEGIN_QUERY,
+            END_QUERY,
+            BEGIN_CONDITIONAL_RENDER,
+            END_CONDITIONAL_RENDER,
+            BIND_VERTEX_ARRAY,
+            VIEWPORT,
+            DRAW_ARRAYS,
+            DRAW_ARRAYS_INSTANCED,
+            DRAW_ELEMENTS,
+            DRAW_ELEMENTS_INSTANCED
+        };
+
+        struct Command {
+            Type type;
+            // Program, texture unit, VAO, uniform location or index type depending on type.
+            GLint target;
+            // Texture name, query, first vertex or element offset depending on type.
+            GLuint value;
+            // Texture target, query target, primitive mode or boolean depending on type.
+            GLenum mode;
+            GLsizei count;
+            // Offset of the uniform data in the payload arena (instance count of instanced draws).
+            size_t payload;
+        };
+
+        void use_program(GLuint program);
+        void bind_texture(GLuint unit, GLenum target, GLuint texture);
+        // Integer uniforms (sampler units, counts).
+        void uniform(GLint location, int value);
+        void uniform(GLint location, float value);
+        void uniform(GLint location, const glm::vec3& value);
+        void uniform(GLint location, const glm::vec4& value);
+        void uniform(GLint location, const glm::mat4& value);
+        // Matrix uniform reading a payload stored once by push_matrix (shared by several draws).
+        void uniform(GLint location, size_t payload);
+        void depth_mask(bool enabled);
+        // Depth write state the commands recorded so far leave (true at the start of a list).
+        bool recorded_depth_mask();
+        void color_mask(bool enabled);
+        // Enabled again at the end of the replay.
+        void depth_test(bool enabled);
+        // Source alpha over destination, disabled again at the end of the replay.
+        void blend(bool enabled);
+        void begin_query(GLenum target, GLuint query);
+        void end_query(GLenum target);
+        // Draws until end_conditional_render are skipped by the GPU if the query saw no samples (no-op on WebGL).
+        void begin_conditional_render(GLuint query);
+        void end_conditional_render();
+        void bind_vertex_array(GLuint vao);
+        /**
+         * Draws into a sub-rectangle of the viewport the replay started with (restored at the end of the replay).
+         *
+         * @param rect x, y, width, height relative to that viewport (origin bottom left).
+         * @param clear_depth Clears the depth of the rectangle first (views drawn over others).
+         */
+        void viewport(const glm::vec4& rect, bool clear_depth);
+        void draw_arrays(GLenum mode, GLint first, GLsizei count);
+        void draw_arrays_instanced(GLenum mode, GLint first, GLsizei count, GLsizei instance_count);
+        void draw_elements(GLenum mode, GLsizei count, GLenum type, size_t offset);
+        // Counts as one draw whatever the number of instances.
+        void draw_elements_instanced(GLenum mode, GLsizei count, GLenum type, size_t offset, GLsizei instance_count);
+
+        /**
+         * Starts a draw that sort() may move: the commands until end_item() must set everything the draw
+         * reads (program, uniforms, textures, VAO). Items do not nest.
+         *
+         * Blended items turn blending on and depth writes off until end_item().
+         *
+         * @param depth View space distance of the draw (the sort key).
+         */
+        void begin_item(BlendMode blend_mode, float depth);
+        void end_item();
+
+        struct SortStats {
+            size_t opaque = 0;
+            size_t alpha_tested = 0;
+            size_t blended = 0;
+            // Radix sort of the keys.
+            float sort_ms = 0.0f;
+            // Building the replay order.
+            float reorder_ms = 0.0f;
+        };
+
+        /**
+         * Orders the items after the other commands: opaque draws front to back (early depth rejection),
+         * then alpha tested ones front to back, then blended ones back to front with blending on.
+         *
+         * Only the replay order changes (nothing is copied), commands outside items keep their order.
+         * Called once, after the items of the frame are recorded.
+         */
+        SortStats sort();
+
+        // Executes the commands on the calling thread (which must own the GL context).
+        void replay();
+
+        // Stores a matrix in the payload arena, for uniform(location, payload).
+        size_t push_matrix(const glm::mat4& value);
+
+        void clear();
+        size_t size();
+        size_t draw_count();
+
+        // Hash of the recorded work (query names excluded). Equal hashes draw the same frame.
+        uint64_t hash();
+
+    private:
+        size_t __push_payload(const float* data, size_t count);
+
+        std::vector<Command> __commands;
+        std::vector<float> __payload;
+        size_t __draw_count = 0;
+        bool __depth_mask = true;
+
+        struct Item {
+            size_t begin;
+            size_t end;
+            BlendMode blend_mode;
+            uint32_t key;
+        };
+
+        std::vector<Item> __items;
+
+        // Kept between frames so sorting does not allocate (key in the upper bits, item index in the lower ones).
+        std::vector<uint64_t> __keys;
+        std::vector<uint64_t> __scratch;
+
+        // Replay order set by sort() (ranges of __commands), followed by the commands from __sorted_end.
+        std::vector<std::pair<size_t, size_t>> __ranges;
+        size_t __sorted_end = 0;
+
+        // Calls f on every command in replay order.
+        template<typename F> void __for_each(F&& f);
+};
+
+/**
+ * Ring of CommandLists shared by a recording thread and a replaying thread.
+ *
+ * Each list is fenced: recording waits until its previous replay finished, replay waits until it was submitted.
+ */
+class CommandQueue {
+    public:
+        /**
+         * Shared_ptr constructor for CommandQueue.
+         *
+         * @param buffer_count Number of lists in flight (2 = double buffered, 3 = triple buffered).
+         */
+        static std::shared_ptr<CommandQueue> make_command_queue(size_t buffer_count);
+
+        // The list currently being recorded (blocks while it is still being replayed).
+        CommandList& record();
+
+        // Closes the recorded list and hands it to the replaying side.
+        void submit();
+
+        /**
+         * Replays the oldest submitted list.
+         *
+         * @param wait Blocks until a list is submitted when true.
+         * @return False if no list was ready.
+         */
+        bool replay(bool wait);
+
+        // Number of submitted frames. Used to invalidate per-frame caches.
+        size_t frame();
+
+        size_t last_draw_count();
+        size_t last_command_count();
+
+    private:
+        CommandQueue(size_t buffer_count);
+
+        enum class State { FREE, RECORDING, SUBMITTED, REPLAYING };
+
+        struct Slot {
+            CommandList list;
+            State state = State::FREE;
+        };
+
+        std::vector<Slot> __slots;
+        size_t __write;
+        size_t __read;
+        size_t __frame;
+        size_t __last_draw_count;
+        size_t __last_command_count;
+
+        std::mutex __mutex;
+        std::condition_variable __fence;
+};
+
+namespace pepng {
+    std::shared_ptr<CommandQueue> make_command_queue(size_t buffer_count = 2);
+
+    /**
+     * The engine-wide CommandQueue the render phase records into.
+     */
+    std::shared_ptr<CommandQueue> commands();
+
+    /**
+     * Cached glGetUniformLocation.
+     */
+    GLint uniform_location(GLuint program, const std::string& name);
+};
\ No newline at end of file
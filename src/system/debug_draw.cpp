@@ -0,0 +1,294 @@
+#include "debug_draw.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+#ifdef IMGUI
+#include <imgui_internal.h>
+#endif
+
+DebugDraw::DebugDraw() :
+    enabled(true),
+    program(0),
+    light_ranges(false),
+    __initialized(false),
+    __buffer(0)
+{}
+
+std::shared_ptr<DebugDraw> DebugDraw::make_debug_draw() {
+    std::shared_ptr<DebugDraw> debug_draw(new DebugDraw());
+
+    return debug_draw;
+}
+
+std::shared_ptr<DebugDraw> pepng::make_debug_draw() {
+    return DebugDraw::make_debug_draw();
+}
+
+std::shared_ptr<DebugDraw> pepng::debug_draw() {
+    static auto debug_draw = pepng::make_debug_draw();
+
+    return debug_draw;
+}
+
+const DebugDraw::Stats& DebugDraw::stats() {
+    return this->__stats;
+}
+
+void DebugDraw::__push(const glm::vec3& a, const glm::vec3& b, const glm::vec4& color, bool on_top) {
+    auto& vertices = on_top ? this->__overlay : this->__vertices;
+
+    vertices.push_back(Vertex { a, color });
+    vertices.push_back(Vertex { b, color });
+}
+
+void DebugDraw::line(const glm::vec3& a, const glm::vec3& b, const glm::vec4& color, bool on_top) {
+    if(!this->enabled) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(this->__mutex);
+
+    this->__push(a, b, color, on_top);
+}
+
+void DebugDraw::aabb(const glm::vec3& min, const glm::vec3& max, const glm::vec4& color, const glm::mat4& world, bool on_top) {
+    if(!this->enabled) {
+        return;
+    }
+
+    glm::vec3 corners[8];
+
+    for(int i = 0; i < 8; i++) {
+        glm::vec3 corner((i & 1) ? max.x : min.x, (i & 2) ? max.y : min.y, (i & 4) ? max.z : min.z);
+
+        // The divide only matters for projective matrices (frustum).
+        glm::vec4 transformed = world * glm::vec4(corner, 1.0f);
+
+        corners[i] = glm::vec3(transformed) / transformed.w;
+    }
+
+    std::lock_guard<std::mutex> lock(this->__mutex);
+
+    // Corners differing by one bit share an edge.
+    for(int i = 0; i < 8; i++) {
+        for(int bit = 1; bit < 8; bit <<= 1) {
+            if(!(i & bit)) {
+                this->__push(corners[i], corners[i | bit], color, on_top);
+            }
+        }
+    }
+}
+
+void DebugDraw::sphere(const glm::vec3& center, float radius, const glm::vec4& color, bool on_top) {
+    if(!this->enabled) {
+        return;
+    }
+
+    glm::vec2 circle[DebugDraw::SPHERE_SEGMENTS + 1];
+
+    for(int i = 0; i <= DebugDraw::SPHERE_SEGMENTS; i++) {
+        float angle = i * 6.2831853f / DebugDraw::SPHERE_SEGMENTS;
+
+        circle[i] = glm::vec2(std::cos(angle), std::sin(angle)) * radius;
+    }
+
+    std::lock_guard<std::mutex> lock(this->__mutex);
+
+    for(int i = 0; i < DebugDraw::SPHERE_SEGMENTS; i++) {
+        auto& a = circle[i];
+        auto& b = circle[i + 1];
+
+        this->__push(center + glm::vec3(a.x, a.y, 0.0f), center + glm::vec3(b.x, b.y, 0.0f), color, on_top);
+        this->__push(center + glm::vec3(a.x, 0.0f, a.y), center + glm::vec3(b.x, 0.0f, b.y), color, on_top);
+        this->__push(center + glm::vec3(0.0f, a.x, a.y), center + glm::vec3(0.0f, b.x, b.y), color, on_top);
+    }
+}
+
+void DebugDraw::frustum(const glm::mat4& view_projection, const glm::vec4& color, bool on_top) {
+    // The NDC cube through the inverse matrix.
+    this->aabb(glm::vec3(-1.0f), glm::vec3(1.0f), color, glm::inverse(view_projection), on_top);
+}
+
+void DebugDraw::axes(const glm::mat4& world, float size, bool on_top) {
+    if(!this->enabled) {
+        return;
+    }
+
+    glm::vec3 origin = glm::vec3(world[3]);
+
+    std::lock_guard<std::mutex> lock(this->__mutex);
+
+    for(int axis = 0; axis < 3; axis++) {
+        glm::vec4 color(0.0f, 0.0f, 0.0f, 1.0f);
+        color[axis] = 1.0f;
+
+        this->__push(origin, origin + glm::normalize(glm::vec3(world[axis])) * size, color, on_top);
+    }
+}
+
+void DebugDraw::marker(const glm::vec3& position, const std::string& text, const glm::vec4& color) {
+    if(!this->enabled) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(this->__mutex);
+
+    for(int axis = 0; axis < 3; axis++) {
+        glm::vec3 offset(0.0f);
+        offset[axis] = 0.25f;
+
+        this->__push(position - offset, position + offset, color, true);
+    }
+
+    this->__markers.push_back(Marker { position, text, color });
+}
+
+void DebugDraw::__init() {
+    this->__initialized = true;
+
+    glGenVertexArrays(BUFFER_COUNT, this->__vaos);
+    glGenBuffers(BUFFER_COUNT, this->__buffers);
+
+    // Same layout as the line shader's Models: position at 0, color at 1.
+    for(size_t i = 0; i < BUFFER_COUNT; i++) {
+        this->__capacities[i] = 0;
+
+        glBindVertexArray(this->__vaos[i]);
+        glBindBuffer(GL_ARRAY_BUFFER, this->__buffers[i]);
+
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*) offsetof(Vertex, position));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*) offsetof(Vertex, color));
+    }
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void DebugDraw::record(CommandList& list) {
+    // The View the scene was recorded with (read by FrameStart at the start of the pass).
+    bool drawable = this->program != 0 && Camera::current_camera != nullptr;
+    View view = drawable ? pepng::current_view() : View();
+
+    {
+        std::lock_guard<std::mutex> lock(this->__mutex);
+
+        this->__upload.clear();
+        this->__upload.insert(this->__upload.end(), this->__vertices.begin(), this->__vertices.end());
+        this->__upload.insert(this->__upload.end(), this->__overlay.begin(), this->__overlay.end());
+
+        this->__stats = Stats();
+        this->__stats.vertices = this->__vertices.size();
+        this->__stats.overlay_vertices = this->__overlay.size();
+        this->__stats.markers = this->__markers.size();
+
+        this->__vertices.clear();
+        this->__overlay.clear();
+    }
+
+    #ifdef IMGUI
+    if(drawable) {
+        this->__draw_markers(view);
+    }
+    #endif
+
+    {
+        std::lock_guard<std::mutex> lock(this->__mutex);
+
+        this->__markers.clear();
+    }
+
+    if(this->__upload.empty() || !drawable) {
+        return;
+    }
+
+    if(!this->__initialized) {
+        this->__init();
+    }
+
+    size_t size = this->__upload.size() * sizeof(Vertex);
+
+    // Unchanged shapes reuse the last buffer, which also keeps the list hash stable for redraw-on-demand.
+    bool unchanged = this->__last_upload.size() == this->__upload.size()
+        && std::memcmp(this->__last_upload.data(), this->__upload.data(), size) == 0;
+
+    if(!unchanged) {
+        this->__buffer = (this->__buffer + 1) % BUFFER_COUNT;
+
+        size_t& capacity = this->__capacities[this->__buffer];
+
+        glBindBuffer(GL_ARRAY_BUFFER, this->__buffers[this->__buffer]);
+
+        // Orphans the old storage (the driver never waits on draws still reading it), grows by doubling.
+        if(size > capacity) {
+            capacity = std::max(size, capacity * 2);
+        }
+
+        glBufferData(GL_ARRAY_BUFFER, capacity, nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, size, this->__upload.data());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        this->__last_upload.swap(this->__upload);
+    }
+
+    list.use_program(this->program);
+    list.uniform(pepng::uniform_location(this->program, "u_projection"), view.projection);
+    list.uniform(pepng::uniform_location(this->program, "u_view"), view.view);
+    list.uniform(pepng::uniform_location(this->program, "u_world"), glm::mat4(1.0f));
+    list.bind_vertex_array(this->__vaos[this->__buffer]);
+
+    GLsizei depth_tested = (GLsizei) this->__stats.vertices;
+    GLsizei overlay = (GLsizei) this->__stats.overlay_vertices;
+
+    if(depth_tested > 0) {
+        list.draw_arrays(GL_LINES, 0, depth_tested);
+        this->__stats.draws++;
+    }
+
+    if(overlay > 0) {
+        list.depth_test(false);
+        list.draw_arrays(GL_LINES, depth_tested, overlay);
+        list.depth_test(true);
+        this->__stats.draws++;
+    }
+}
+
+#ifdef IMGUI
+void DebugDraw::__draw_markers(const View& view) {
+    auto context = ImGui::GetCurrentContext();
+
+    if(this->__markers.empty() || context == nullptr || !context->WithinFrameScope) {
+        return;
+    }
+
+    auto& io = ImGui::GetIO();
+    auto draw_list = ImGui::GetForegroundDrawList();
+
+    for(auto& marker : this->__markers) {
+        glm::vec4 clip = view.view_projection * glm::vec4(marker.position, 1.0f);
+
+        if(clip.w <= 0.0f) {
+            continue;
+        }
+
+        glm::vec3 ndc = glm::vec3(clip) / clip.w;
+
+        if(std::abs(ndc.x) > 1.0f || std::abs(ndc.y) > 1.0f) {
+            continue;
+        }
+
+        // Viewport pixels (origin bottom left) to ImGui coordinates (origin top left, window units).
+        float x = view.viewport.x + (ndc.x * 0.5f + 0.5f) * view.viewport.z;
+        float y = view.viewport.y + (ndc.y * 0.5f + 0.5f) * view.viewport.w;
+        float scale_x = io.DisplayFramebufferScale.x > 0.0f ? io.DisplayFramebufferScale.x : 1.0f;
+        float scale_y = io.DisplayFramebufferScale.y > 0.0f ? io.DisplayFramebufferScale.y : 1.0f;
+
+        ImVec2 position(x / scale_x + 4.0f, io.DisplaySize.y - y / scale_y);
+
+        draw_list->AddText(position, ImGui::ColorConvertFloat4ToU32(ImVec4(marker.color.x, marker.color.y, marker.color.z, marker.color.w)), marker.text.c_str());
+    }
+}
+#endif
\ No newline at end of file
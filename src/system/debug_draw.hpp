@@ -0,0 +1,113 @@
+#pragma once
+
+#include <pepng.h>
+
+#include <mutex>
+
+#include "command_list.hpp"
+#include "view.hpp"
+
+/**
+ * Immediate mode debug geometry: lines, boxes, spheres, frusta, axes and text markers.
+ *
+ * Shapes can be queued from any component (also ParallelSafe ones, queuing is locked) and only last
+ * one frame. They are appended to a single streamed vertex buffer, orphaned on every upload (WebGL has
+ * no persistent mapping), and drawn with the line shader in one draw for depth tested lines and one
+ * for lines drawn on top. Marker labels are drawn by ImGui.
+ */
+class DebugDraw {
+    public:
+        static std::shared_ptr<DebugDraw> make_debug_draw();
+
+        bool enabled;
+        // The line shader (nothing is drawn while 0).
+        GLuint program;
+        // PointLights queue their range.
+        bool light_ranges;
+
+        struct Stats {
+            size_t vertices = 0;
+            size_t overlay_vertices = 0;
+            size_t markers = 0;
+            size_t draws = 0;
+        };
+
+        void line(const glm::vec3& a, const glm::vec3& b, const glm::vec4& color, bool on_top = false);
+
+        /**
+         * @param world Transforms the box (object space bounds).
+         */
+        void aabb(const glm::vec3& min, const glm::vec3& max, const glm::vec4& color, const glm::mat4& world = glm::mat4(1.0f), bool on_top = false);
+
+        // Three great circles.
+        void sphere(const glm::vec3& center, float radius, const glm::vec4& color, bool on_top = false);
+
+        // The edges of the volume a view_projection matrix maps to clip space.
+        void frustum(const glm::mat4& view_projection, const glm::vec4& color, bool on_top = false);
+
+        // x, y and z of a matrix in red, green and blue.
+        void axes(const glm::mat4& world, float size, bool on_top = true);
+
+        // A cross with a label next to it.
+        void marker(const glm::vec3& position, const std::string& text, const glm::vec4& color = glm::vec4(1.0f));
+
+        /**
+         * Uploads the queued shapes and records their draws (called before the list is submitted).
+         */
+        void record(CommandList& list);
+
+        // Statistics of the last recorded frame.
+        const Stats& stats();
+
+        // Buffers in flight, so an upload never overwrites one a pending replay still reads.
+        static constexpr size_t BUFFER_COUNT = 3;
+        static constexpr int SPHERE_SEGMENTS = 24;
+
+    private:
+        DebugDraw();
+
+        struct Vertex {
+            glm::vec3 position;
+            glm::vec4 color;
+        };
+
+        struct Marker {
+            glm::vec3 position;
+            std::string text;
+            glm::vec4 color;
+        };
+
+        // Callers hold __mutex.
+        void __push(const glm::vec3& a, const glm::vec3& b, const glm::vec4& color, bool on_top);
+        void __init();
+
+        #ifdef IMGUI
+        void __draw_markers(const View& view);
+        #endif
+
+        std::mutex __mutex;
+        std::vector<Vertex> __vertices;
+        std::vector<Vertex> __overlay;
+        std::vector<Marker> __markers;
+
+        bool __initialized;
+        GLuint __vaos[BUFFER_COUNT];
+        GLuint __buffers[BUFFER_COUNT];
+        size_t __capacities[BUFFER_COUNT];
+        size_t __buffer;
+
+        // Concatenated __vertices and __overlay, and what the current buffer holds.
+        std::vector<Vertex> __upload;
+        std::vector<Vertex> __last_upload;
+
+        Stats __stats;
+};
+
+namespace pepng {
+    std::shared_ptr<DebugDraw> make_debug_draw();
+
+    /**
+     * The engine-wide DebugDraw flushed by CommandFlush.
+     */
+    std::shared_ptr<DebugDraw> debug_draw();
+};
\ No newline at end of file
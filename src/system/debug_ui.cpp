@@ -0,0 +1,24 @@
+#include "debug_ui.hpp"
+
+#ifdef IMGUI
+#include <imgui_internal.h>
+
+void pepng::debug_section(const std::string& name, const std::function<void()>& body) {
+    auto context = ImGui::GetCurrentContext();
+
+    if(context == nullptr || !context->WithinFrameScope) {
+        return;
+    }
+
+    // Windows with the same name are merged by ImGui, so this appends to the engine's Debug window.
+    if(ImGui::Begin("Debug")) {
+        if(ImGui::CollapsingHeader(name.c_str())) {
+            ImGui::PushID(name.c_str());
+            body();
+            ImGui::PopID();
+        }
+    }
+
+    ImGui::End();
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <pepng.h>
+
+#ifdef IMGUI
+namespace pepng {
+    /**
+     * Draws body under a collapsing header of the engine's Debug window.
+     *
+     * Safe to call from render(): does nothing outside of an ImGui frame.
+     */
+    void debug_section(const std::string& name, const std::function<void()>& body);
+};
+#endif
\ No newline at end of file
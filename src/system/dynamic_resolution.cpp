@@ -0,0 +1,351 @@
+#include "dynamic_resolution.hpp"
+
+#include "command_list.hpp"
+#include "memory.hpp"
+
+namespace {
+    // Weight of the newest sample in the smoothed frame time.
+    constexpr float SMOOTHING = 0.1f;
+    // The scale only grows back while under this fraction of the budget (avoids oscillating at the limit).
+    constexpr float HEADROOM = 0.85f;
+    constexpr float GROW_STEP = 0.01f;
+    constexpr float SHRINK_STEP = 0.1f;
+}
+
+DynamicResolution::DynamicResolution() :
+    enabled(true),
+    program(0),
+    #ifdef __EMSCRIPTEN__
+    // The frame interval never goes under the display refresh, so the budget must sit above it.
+    budget_ms(20.0f),
+    #else
+    budget_ms(12.0f),
+    #endif
+    min_scale(0.5f),
+    max_scale(1.0f),
+    __scale(1.0f),
+    __frame_ms(0.0f),
+    __framebuffer(0),
+    __color_texture(0),
+    __depth_buffer(0),
+    __size(0),
+    __checked_framebuffer(-1),
+    __blit(true),
+    __upscale_vao(0),
+    __queries {},
+    __pending {},
+    __query(0),
+    __timing(false),
+    __last_render(std::chrono::steady_clock::now())
+{}
+
+std::shared_ptr<DynamicResolution> DynamicResolution::make_dynamic_resolution() {
+    std::shared_ptr<DynamicResolution> resolution(new DynamicResolution());
+
+    return resolution;
+}
+
+std::shared_ptr<DynamicResolution> pepng::make_dynamic_resolution() {
+    return DynamicResolution::make_dynamic_resolution();
+}
+
+std::shared_ptr<DynamicResolution> pepng::resolution() {
+    static auto resolution = pepng::make_dynamic_resolution();
+
+    return resolution;
+}
+
+float DynamicResolution::scale() {
+    return this->enabled ? this->__scale : 1.0f;
+}
+
+float DynamicResolution::frame_ms() {
+    return this->__frame_ms;
+}
+
+glm::ivec2 DynamicResolution::target_size() {
+    return this->__size;
+}
+
+glm::ivec4 DynamicResolution::scaled(const glm::ivec4& viewport) {
+    float scale = this->scale();
+
+    return glm::ivec4(
+        (int) (viewport.x * scale),
+        (int) (viewport.y * scale),
+        std::max(1, (int) (viewport.z * scale)),
+        std::max(1, (int) (viewport.w * scale)));
+}
+
+void DynamicResolution::__resize(const glm::ivec2& size) {
+    if(this->__framebuffer == 0) {
+        glGenFramebuffers(1, &this->__framebuffer);
+        glGenTextures(1, &this->__color_texture);
+        glGenRenderbuffers(1, &this->__depth_buffer);
+    }
+
+    this->__size = size;
+
+    // Allocated once at window size: scale changes only move the viewport, never reallocate.
+    GLint previous_texture = 0;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &previous_texture);
+
+    glBindTexture(GL_TEXTURE_2D, this->__color_texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, size.x, size.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, previous_texture);
+
+    // Same format as the default framebuffer's depth, which the blit requires (see __blittable).
+    glBindRenderbuffer(GL_RENDERBUFFER, this->__depth_buffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, size.x, size.y);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    GLint previous_framebuffer = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous_framebuffer);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, this->__framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, this->__color_texture, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, this->__depth_buffer);
+
+    if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::stringstream ss;
+
+        ss << "Dynamic resolution target (" << size.x << "x" << size.y << ") is incomplete." << std::endl;
+
+        throw std::runtime_error(ss.str());
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, previous_framebuffer);
+
+    pepng::memory()->track(&this->__framebuffer, MemoryRecord { "target", "", "dynamic resolution", 1, (size_t) size.x * size.y * 8, 0 });
+}
+
+bool DynamicResolution::__blittable(GLint framebuffer) {
+    GLint sample_buffers = 0;
+    glGetIntegerv(GL_SAMPLE_BUFFERS, &sample_buffers);
+
+    // Blits into multisampled framebuffers are invalid.
+    if(sample_buffers != 0) {
+        return false;
+    }
+
+    // The window names its buffers, framebuffer objects their attachments.
+    GLenum depth = framebuffer == 0 ? GL_DEPTH : GL_DEPTH_ATTACHMENT;
+    GLenum stencil = framebuffer == 0 ? GL_STENCIL : GL_STENCIL_ATTACHMENT;
+
+    GLint depth_type = GL_NONE, stencil_type = GL_NONE;
+    glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, depth, GL_FRAMEBUFFER_ATTACHMENT_OBJECT_TYPE, &depth_type);
+    glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, stencil, GL_FRAMEBUFFER_ATTACHMENT_OBJECT_TYPE, &stencil_type);
+
+    if(depth_type == GL_NONE || stencil_type == GL_NONE) {
+        return false;
+    }
+
+    GLint depth_bits = 0, stencil_bits = 0, depth_component = 0;
+    glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, depth, GL_FRAMEBUFFER_ATTACHMENT_DEPTH_SIZE, &depth_bits);
+    glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, stencil, GL_FRAMEBUFFER_ATTACHMENT_STENCIL_SIZE, &stencil_bits);
+    glGetFramebufferAttachmentParameteriv(GL_FRAMEBUFFER, depth, GL_FRAMEBUFFER_ATTACHMENT_COMPONENT_TYPE, &depth_component);
+
+    // DEPTH24_STENCIL8, like the target.
+    return depth_bits == 24 && stencil_bits == 8 && depth_component == GL_UNSIGNED_NORMALIZED;
+}
+
+void DynamicResolution::__draw_upscale(const glm::ivec4& target, const glm::ivec4& window) {
+    if(this->__upscale_vao == 0) {
+        glGenVertexArrays(1, &this->__upscale_vao);
+    }
+
+    GLint previous_program = 0, previous_vao = 0, previous_texture = 0, previous_unit = 0;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &previous_program);
+    glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previous_vao);
+    glGetIntegerv(GL_ACTIVE_TEXTURE, &previous_unit);
+
+    glActiveTexture(GL_TEXTURE0);
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &previous_texture);
+
+    GLboolean depth_test = glIsEnabled(GL_DEPTH_TEST);
+    GLboolean blend = glIsEnabled(GL_BLEND);
+    GLboolean cull_face = glIsEnabled(GL_CULL_FACE);
+    GLboolean depth_mask = GL_TRUE;
+    glGetBooleanv(GL_DEPTH_WRITEMASK, &depth_mask);
+
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_BLEND);
+    glDisable(GL_CULL_FACE);
+    glDepthMask(GL_FALSE);
+
+    glUseProgram(this->program);
+    glBindVertexArray(this->__upscale_vao);
+    glBindTexture(GL_TEXTURE_2D, this->__color_texture);
+
+    glUniform1i(pepng::uniform_location(this->program, "u_texture"), 0);
+    glUniform4f(pepng::uniform_location(this->program, "u_source"),
+        (float) target.x / this->__size.x, (float) target.y / this->__size.y,
+        (float) target.z / this->__size.x, (float) target.w / this->__size.y);
+
+    glViewport(window.x, window.y, window.z, window.w);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    glBindTexture(GL_TEXTURE_2D, previous_texture);
+    glActiveTexture(previous_unit);
+    glBindVertexArray(previous_vao);
+    glUseProgram(previous_program);
+
+    glDepthMask(depth_mask);
+
+    if(depth_test) {
+        glEnable(GL_DEPTH_TEST);
+    }
+
+    if(blend) {
+        glEnable(GL_BLEND);
+    }
+
+    if(cull_face) {
+        glEnable(GL_CULL_FACE);
+    }
+}
+
+void DynamicResolution::__begin_timer() {
+    #ifndef __EMSCRIPTEN__
+    if(this->__queries[0] == 0) {
+        glGenQueries((GLsizei) DynamicResolution::QUERY_COUNT, this->__queries);
+    }
+
+    // Skips timing this frame if the oldest query is still in flight.
+    this->__timing = !this->__pending[this->__query];
+
+    if(this->__timing) {
+        glBeginQuery(GL_TIME_ELAPSED, this->__queries[this->__query]);
+    }
+    #endif
+}
+
+void DynamicResolution::__end_timer() {
+    #ifndef __EMSCRIPTEN__
+    if(this->__timing) {
+        glEndQuery(GL_TIME_ELAPSED);
+
+        this->__pending[this->__query] = true;
+        this->__query = (this->__query + 1) % DynamicResolution::QUERY_COUNT;
+    }
+    #endif
+}
+
+void DynamicResolution::__read_timers() {
+    #ifdef __EMSCRIPTEN__
+    auto now = std::chrono::steady_clock::now();
+
+    this->__adapt(std::chrono::duration<float, std::milli>(now - this->__last_render).count());
+    this->__last_render = now;
+    #else
+    // Oldest first, so samples are adapted from in order.
+    for(size_t i = 0; i < DynamicResolution::QUERY_COUNT; i++) {
+        size_t query = (this->__query + i) % DynamicResolution::QUERY_COUNT;
+
+        if(!this->__pending[query]) {
+            continue;
+        }
+
+        GLuint available = GL_FALSE;
+        glGetQueryObjectuiv(this->__queries[query], GL_QUERY_RESULT_AVAILABLE, &available);
+
+        if(!available) {
+            break;
+        }
+
+        GLuint64 nanoseconds = 0;
+        glGetQueryObjectui64v(this->__queries[query], GL_QUERY_RESULT, &nanoseconds);
+
+        this->__pending[query] = false;
+        this->__adapt(nanoseconds / 1e6f);
+    }
+    #endif
+}
+
+void DynamicResolution::__adapt(float ms) {
+    this->__frame_ms = this->__frame_ms == 0.0f ? ms : glm::mix(this->__frame_ms, ms, SMOOTHING);
+
+    float budget = std::max(this->budget_ms, 0.1f);
+
+    if(this->__frame_ms > budget) {
+        // Time is roughly proportional to the pixel count, the square of the scale.
+        this->__scale = std::max(this->__scale * std::sqrt(budget / this->__frame_ms), this->__scale - SHRINK_STEP);
+    } else if(this->__frame_ms < budget * HEADROOM) {
+        this->__scale += GROW_STEP;
+    }
+
+    this->__scale = glm::clamp(this->__scale, std::min(this->min_scale, this->max_scale), this->max_scale);
+}
+
+void DynamicResolution::render(const std::function<void()>& replay) {
+    if(!this->enabled) {
+        replay();
+
+        return;
+    }
+
+    GLint viewport[4], previous_framebuffer = 0;
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous_framebuffer);
+
+    glm::ivec4 window(viewport[0], viewport[1], viewport[2], viewport[3]);
+    glm::ivec2 size(window.x + window.z, window.y + window.w);
+
+    // Minimized window: nothing to scale, but the replay still releases its CommandQueue slot (recording would wait on it).
+    if(size.x <= 0 || size.y <= 0) {
+        replay();
+
+        return;
+    }
+
+    if(previous_framebuffer != this->__checked_framebuffer) {
+        this->__checked_framebuffer = previous_framebuffer;
+        this->__blit = this->__blittable(previous_framebuffer);
+    }
+
+    // Without the blit, the fullscreen triangle needs its shader.
+    if(!this->__blit && this->program == 0) {
+        replay();
+
+        return;
+    }
+
+    if(size != this->__size) {
+        this->__resize(size);
+    }
+
+    // Recorded draws used scale() for their viewport dependent uniforms, so the same scale is replayed.
+    glm::ivec4 target = this->scaled(window);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, this->__framebuffer);
+    glViewport(target.x, target.y, target.z, target.w);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+    this->__begin_timer();
+    replay();
+    this->__end_timer();
+
+    if(this->__blit) {
+        // Linear upscale of the color, nearest of the depth (what is drawn after still depth tests against the scene).
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, this->__framebuffer);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, previous_framebuffer);
+        glBlitFramebuffer(target.x, target.y, target.x + target.z, target.y + target.w,
+            window.x, window.y, window.x + window.z, window.y + window.w, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+        glBlitFramebuffer(target.x, target.y, target.x + target.z, target.y + target.w,
+            window.x, window.y, window.x + window.z, window.y + window.w, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, previous_framebuffer);
+    } else {
+        glBindFramebuffer(GL_FRAMEBUFFER, previous_framebuffer);
+
+        this->__draw_upscale(target, window);
+    }
+
+    glViewport(window.x, window.y, window.z, window.w);
+
+    this->__read_timers();
+}
\ No newline at end of file
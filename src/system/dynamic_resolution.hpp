@@ -0,0 +1,98 @@
+#pragma once
+
+#include <pepng.h>
+
+#include <chrono>
+
+/**
+ * Renders the replayed scene into an offscreen target at a fraction of the window resolution,
+ * then upscales it into the window with one blit.
+ *
+ * The blit also copies depth, which needs a single sampled DEPTH24_STENCIL8 window framebuffer. Otherwise
+ * (e.g. a multisampled or 16 bit depth context), the color is drawn with a fullscreen triangle and the
+ * window depth is left as it was.
+ *
+ * The scale adapts every frame to keep the measured scene time under a budget. GPU timer queries
+ * are read a few frames late so the pipeline never stalls. WebGL has no timer queries, so the
+ * CPU frame interval is used there.
+ * Everything drawn after the upscale (ImGui) stays at native resolution.
+ */
+class DynamicResolution {
+    public:
+        static std::shared_ptr<DynamicResolution> make_dynamic_resolution();
+
+        bool enabled;
+        // The upscale shader, used when the blit is not possible (scaling is skipped then while 0).
+        GLuint program;
+        // Scene time to hold (milliseconds).
+        float budget_ms;
+        float min_scale;
+        float max_scale;
+
+        // Scale of the draws currently being recorded (they are replayed at this scale).
+        float scale();
+
+        // Smoothed time the scale is adapted from.
+        float frame_ms();
+
+        // Size of the offscreen target (the window size, drawn into its scaled corner).
+        glm::ivec2 target_size();
+
+        /**
+         * A viewport in window pixels, as drawn into the offscreen target.
+         */
+        glm::ivec4 scaled(const glm::ivec4& viewport);
+
+        /**
+         * Runs replay into the scaled target, blits it into the current framebuffer and adapts the scale.
+         *
+         * replay always runs (directly when disabled or the viewport is empty): it releases the replayed list.
+         */
+        void render(const std::function<void()>& replay);
+
+        // Timer queries in flight (results are read QUERY_COUNT - 1 frames late at worst).
+        static constexpr size_t QUERY_COUNT = 4;
+
+    private:
+        DynamicResolution();
+
+        void __resize(const glm::ivec2& size);
+        // Whether depth (and color) can be blitted into a framebuffer (0 is the window).
+        bool __blittable(GLint framebuffer);
+        void __draw_upscale(const glm::ivec4& target, const glm::ivec4& window);
+        void __begin_timer();
+        void __end_timer();
+        void __read_timers();
+        void __adapt(float ms);
+
+        float __scale;
+        float __frame_ms;
+
+        GLuint __framebuffer;
+        // A texture, so the fallback can sample it.
+        GLuint __color_texture;
+        GLuint __depth_buffer;
+        glm::ivec2 __size;
+
+        // Framebuffer __blit was checked for (-1 before the first check).
+        GLint __checked_framebuffer;
+        bool __blit;
+        // Empty VAO of the fullscreen triangle.
+        GLuint __upscale_vao;
+
+        GLuint __queries[QUERY_COUNT];
+        bool __pending[QUERY_COUNT];
+        size_t __query;
+        bool __timing;
+
+        std::chrono::steady_clock::time_point __last_render;
+};
+
+namespace pepng {
+    std::shared_ptr<DynamicResolution> make_dynamic_resolution();
+
+    /**
+     * The engine-wide DynamicResolution used by CommandFlush.
+     */
+    std::shared_ptr<DynamicResolution> resolution();
+};
\ No newline at end of file
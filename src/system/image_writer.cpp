@@ -0,0 +1,336 @@
+#include "image_writer.hpp"
+
+#include <array>
+#include <fstream>
+
+namespace {
+    constexpr size_t MIN_MATCH = 3;
+    constexpr size_t MAX_MATCH = 258;
+    constexpr size_t WINDOW = 32768;
+    constexpr size_t HASH_BITS = 15;
+    // Candidates tried per position (longer chains compress a little better, much slower).
+    constexpr size_t CHAIN_DEPTH = 16;
+
+    const uint16_t LENGTH_BASE[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+    const uint8_t LENGTH_EXTRA[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+    const uint16_t DISTANCE_BASE[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+    const uint8_t DISTANCE_EXTRA[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+    const std::array<uint32_t, 256>& crc_table() {
+        static const std::array<uint32_t, 256> table = []() {
+            std::array<uint32_t, 256> table;
+
+            for(uint32_t i = 0; i < 256; i++) {
+                uint32_t c = i;
+
+                for(int k = 0; k < 8; k++) {
+                    c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                }
+
+                table[i] = c;
+            }
+
+            return table;
+        }();
+
+        return table;
+    }
+
+    uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc = 0) {
+        auto& table = crc_table();
+
+        crc = ~crc;
+
+        for(size_t i = 0; i < size; i++) {
+            crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        }
+
+        return ~crc;
+    }
+
+    uint32_t adler32(const uint8_t* data, size_t size) {
+        uint32_t a = 1, b = 0;
+
+        // 5552 is the largest run whose sums cannot overflow before the modulo.
+        while(size > 0) {
+            size_t run = std::min<size_t>(size, 5552);
+
+            for(size_t i = 0; i < run; i++) {
+                a += data[i];
+                b += a;
+            }
+
+            a %= 65521;
+            b %= 65521;
+            data += run;
+            size -= run;
+        }
+
+        return (b << 16) | a;
+    }
+
+    // Deflate bit stream (least significant bit first, Huffman codes most significant bit first).
+    class BitWriter {
+        public:
+            BitWriter(std::vector<uint8_t>& out) :
+                __out(out),
+                __bits(0),
+                __count(0)
+            {}
+
+            void bits(uint32_t value, int count) {
+                this->__bits |= (uint64_t) value << this->__count;
+                this->__count += count;
+
+                while(this->__count >= 8) {
+                    this->__out.push_back((uint8_t) this->__bits);
+                    this->__bits >>= 8;
+                    this->__count -= 8;
+                }
+            }
+
+            void code(uint32_t code, int length) {
+                uint32_t reversed = 0;
+
+                for(int i = 0; i < length; i++) {
+                    reversed |= ((code >> i) & 1) << (length - 1 - i);
+                }
+
+                this->bits(reversed, length);
+            }
+
+            void flush() {
+                if(this->__count > 0) {
+                    this->__out.push_back((uint8_t) this->__bits);
+                }
+
+                this->__bits = 0;
+                this->__count = 0;
+            }
+
+        private:
+            std::vector<uint8_t>& __out;
+            uint64_t __bits;
+            int __count;
+    };
+
+    // Fixed Huffman code of a literal/length symbol (RFC 1951, 3.2.6).
+    void literal_length(BitWriter& writer, uint32_t symbol) {
+        if(symbol < 144) {
+            writer.code(0x30 + symbol, 8);
+        } else if(symbol < 256) {
+            writer.code(0x190 + symbol - 144, 9);
+        } else if(symbol < 280) {
+            writer.code(symbol - 256, 7);
+        } else {
+            writer.code(0xC0 + symbol - 280, 8);
+        }
+    }
+
+    void match(BitWriter& writer, size_t length, size_t distance) {
+        int l = 28;
+
+        while(LENGTH_BASE[l] > length) {
+            l--;
+        }
+
+        literal_length(writer, 257 + l);
+        writer.bits((uint32_t) (length - LENGTH_BASE[l]), LENGTH_EXTRA[l]);
+
+        int d = 29;
+
+        while(DISTANCE_BASE[d] > distance) {
+            d--;
+        }
+
+        writer.code(d, 5);
+        writer.bits((uint32_t) (distance - DISTANCE_BASE[d]), DISTANCE_EXTRA[d]);
+    }
+
+    uint32_t hash(const uint8_t* data) {
+        return ((data[0] << 16 | data[1] << 8 | data[2]) * 2654435761u) >> (32 - HASH_BITS);
+    }
+
+    // One fixed Huffman block wrapped in a zlib stream.
+    std::vector<uint8_t> zlib_compress(const std::vector<uint8_t>& data) {
+        std::vector<uint8_t> out;
+        out.reserve(data.size() / 2 + 64);
+
+        out.push_back(0x78);
+        out.push_back(0x01);
+
+        BitWriter writer(out);
+
+        // Final block, fixed codes.
+        writer.bits(1, 1);
+        writer.bits(1, 2);
+
+        std::vector<int32_t> head((size_t) 1 << HASH_BITS, -1);
+        std::vector<int32_t> previous(data.size(), -1);
+
+        size_t size = data.size();
+        size_t i = 0;
+
+        auto insert = [&](size_t position) {
+            if(position + MIN_MATCH <= size) {
+                uint32_t h = hash(&data[position]);
+
+                previous[position] = head[h];
+                head[h] = (int32_t) position;
+            }
+        };
+
+        while(i < size) {
+            size_t best_length = 0, best_distance = 0;
+
+            if(i + MIN_MATCH <= size) {
+                int32_t candidate = head[hash(&data[i])];
+                size_t limit = std::min(MAX_MATCH, size - i);
+
+                for(size_t depth = 0; candidate >= 0 && depth < CHAIN_DEPTH && i - candidate <= WINDOW; depth++) {
+                    const uint8_t* a = &data[candidate];
+                    const uint8_t* b = &data[i];
+                    size_t length = 0;
+
+                    while(length < limit && a[length] == b[length]) {
+                        length++;
+                    }
+
+                    if(length > best_length) {
+                        best_length = length;
+                        best_distance = i - candidate;
+
+                        if(length == limit) {
+                            break;
+                        }
+                    }
+
+                    candidate = previous[candidate];
+                }
+            }
+
+            if(best_length >= MIN_MATCH) {
+                match(writer, best_length, best_distance);
+
+                for(size_t k = 0; k < best_length; k++) {
+                    insert(i + k);
+                }
+
+                i += best_length;
+            } else {
+                literal_length(writer, data[i]);
+                insert(i);
+                i++;
+            }
+        }
+
+        literal_length(writer, 256);
+        writer.flush();
+
+        uint32_t adler = adler32(data.data(), data.size());
+
+        for(int shift = 24; shift >= 0; shift -= 8) {
+            out.push_back((uint8_t) (adler >> shift));
+        }
+
+        return out;
+    }
+
+    void put_u32(std::vector<uint8_t>& out, uint32_t value) {
+        for(int shift = 24; shift >= 0; shift -= 8) {
+            out.push_back((uint8_t) (value >> shift));
+        }
+    }
+
+    void put_chunk(std::vector<uint8_t>& out, const char* type, const std::vector<uint8_t>& data) {
+        put_u32(out, (uint32_t) data.size());
+
+        size_t start = out.size();
+
+        out.insert(out.end(), type, type + 4);
+        out.insert(out.end(), data.begin(), data.end());
+
+        put_u32(out, crc32(&out[start], out.size() - start));
+    }
+}
+
+std::vector<uint8_t> pepng::encode_png(const uint8_t* rgba, const glm::ivec2& size, bool flip_rows) {
+    size_t stride = (size_t) size.x * 4;
+
+    // Every row starts with its filter type. Sub (difference to the pixel on the left) suits rendered gradients.
+    std::vector<uint8_t> filtered;
+    filtered.resize((stride + 1) * size.y);
+
+    for(int y = 0; y < size.y; y++) {
+        const uint8_t* row = rgba + stride * (flip_rows ? size.y - 1 - y : y);
+        uint8_t* out = &filtered[(stride + 1) * y];
+
+        out[0] = 1;
+
+        for(size_t x = 0; x < stride; x++) {
+            out[x + 1] = (uint8_t) (row[x] - (x >= 4 ? row[x - 4] : 0));
+        }
+    }
+
+    std::vector<uint8_t> png = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+    std::vector<uint8_t> header;
+    put_u32(header, (uint32_t) size.x);
+    put_u32(header, (uint32_t) size.y);
+    // 8 bits per channel, RGBA, deflate, adaptive filtering, not interlaced.
+    header.insert(header.end(), { 8, 6, 0, 0, 0 });
+
+    put_chunk(png, "IHDR", header);
+    put_chunk(png, "IDAT", zlib_compress(filtered));
+    put_chunk(png, "IEND", {});
+
+    return png;
+}
+
+std::vector<uint8_t> pepng::encode_ppm(const uint8_t* rgba, const glm::ivec2& size, bool flip_rows) {
+    std::stringstream header;
+    header << "P6\n" << size.x << " " << size.y << "\n255\n";
+
+    std::string text = header.str();
+    std::vector<uint8_t> ppm(text.begin(), text.end());
+
+    ppm.reserve(ppm.size() + (size_t) size.x * size.y * 3);
+
+    for(int y = 0; y < size.y; y++) {
+        const uint8_t* row = rgba + (size_t) size.x * 4 * (flip_rows ? size.y - 1 - y : y);
+
+        for(int x = 0; x < size.x; x++) {
+            ppm.insert(ppm.end(), row + x * 4, row + x * 4 + 3);
+        }
+    }
+
+    return ppm;
+}
+
+void pepng::write_image(const std::filesystem::path& path, const uint8_t* rgba, const glm::ivec2& size, bool flip_rows) {
+    auto extension = path.extension().string();
+
+    std::vector<uint8_t> encoded;
+
+    if(extension == ".png") {
+        encoded = pepng::encode_png(rgba, size, flip_rows);
+    } else if(extension == ".ppm") {
+        encoded = pepng::encode_ppm(rgba, size, flip_rows);
+    } else {
+        std::stringstream ss;
+
+        ss << "Cannot write " << path << ": only .png and .ppm images are supported." << std::endl;
+
+        throw std::runtime_error(ss.str());
+    }
+
+    std::ofstream file(path, std::ios::binary);
+
+    if(!file.write((const char*) encoded.data(), encoded.size())) {
+        std::stringstream ss;
+
+        ss << "Could not write " << path << "." << std::endl;
+
+        throw std::runtime_error(ss.str());
+    }
+}
\ No newline at end of file
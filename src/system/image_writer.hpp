@@ -0,0 +1,24 @@
+#pragma once
+
+#include <pepng.h>
+
+namespace pepng {
+    /**
+     * Encodes RGBA8 pixels as a PNG (Sub filtered, deflated with fixed Huffman codes and a hash chain).
+     *
+     * Needs no image library. Thread safe, so images can be encoded on workers.
+     *
+     * @param flip_rows True for GL read backs (first row at the bottom).
+     */
+    std::vector<uint8_t> encode_png(const uint8_t* rgba, const glm::ivec2& size, bool flip_rows);
+
+    /**
+     * Encodes RGBA8 pixels as a binary PPM (alpha dropped).
+     */
+    std::vector<uint8_t> encode_ppm(const uint8_t* rgba, const glm::ivec2& size, bool flip_rows);
+
+    /**
+     * Writes RGBA8 pixels to a .png or .ppm file, picked from the extension. Throws on other extensions or write errors.
+     */
+    void write_image(const std::filesystem::path& path, const uint8_t* rgba, const glm::ivec2& size, bool flip_rows);
+};
\ No newline at end of file
@@ -0,0 +1,443 @@
+#include "input_log.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#include "command_list.hpp"
+#include "dynamic_resolution.hpp"
+
+namespace {
+    constexpr char MAGIC[4] = { 'P', 'E', 'P', 'I' };
+    constexpr uint32_t VERSION = 1;
+
+    template<typename T>
+    void write_value(std::ofstream& stream, const T& value) {
+        stream.write((const char*) &value, sizeof(T));
+    }
+
+    template<typename T>
+    T read_value(std::ifstream& stream) {
+        T value {};
+        stream.read((char*) &value, sizeof(T));
+
+        return value;
+    }
+
+    void write_string(std::ofstream& stream, const std::string& text) {
+        write_value<uint16_t>(stream, (uint16_t) text.size());
+        stream.write(text.data(), text.size());
+    }
+
+    std::string read_string(std::ifstream& stream) {
+        std::string text(read_value<uint16_t>(stream), '\0');
+        stream.read(text.data(), text.size());
+
+        return text;
+    }
+
+    [[noreturn]] void log_error(const std::filesystem::path& path, const std::string& message) {
+        std::stringstream ss;
+
+        ss << "Input log " << path << ": " << message << std::endl;
+
+        throw std::runtime_error(ss.str());
+    }
+
+    float percentile(std::vector<float> values, float p) {
+        if(values.empty()) {
+            return 0.0f;
+        }
+
+        size_t n = std::min(values.size() - 1, (size_t) (p * (values.size() - 1) + 0.5f));
+        std::nth_element(values.begin(), values.begin() + n, values.end());
+
+        return values[n];
+    }
+}
+
+InputLog::InputLog() :
+    __mode(Mode::IDLE),
+    __next_mode(Mode::IDLE),
+    __watched_held(false),
+    __index(0),
+    __frame((size_t) -1),
+    __last_time(glfwGetTime()),
+    __stats{}
+{
+    this->__current.delta = 0.0f;
+    this->__current.cursor = glm::dvec2(0.0);
+    this->__current.captured = false;
+}
+
+std::shared_ptr<InputLog> InputLog::make_input_log() {
+    std::shared_ptr<InputLog> input_log(new InputLog());
+
+    return input_log;
+}
+
+std::shared_ptr<InputLog> pepng::make_input_log() {
+    return InputLog::make_input_log();
+}
+
+std::shared_ptr<InputLog> pepng::input_log() {
+    static auto input_log = pepng::make_input_log();
+
+    return input_log;
+}
+
+void InputLog::track(const std::vector<std::string>& labels) {
+    for(auto& label : labels) {
+        if(this->__label_index.try_emplace(label, this->__labels.size()).second) {
+            this->__labels.push_back(label);
+        }
+    }
+
+    // Reads before the first begin_frame see released keys.
+    this->__current.values.resize(this->__labels.size(), 0.0f);
+}
+
+size_t InputLog::track_pose(const std::string& name) {
+    this->__pose_names.push_back(name);
+
+    return this->__pose_names.size() - 1;
+}
+
+void InputLog::watch(const std::vector<std::string>& labels) {
+    this->__watched.insert(this->__watched.end(), labels.begin(), labels.end());
+}
+
+void InputLog::__live(Frame& frame) {
+    auto input = pepng::input();
+
+    frame.values.resize(this->__labels.size());
+
+    for(size_t i = 0; i < this->__labels.size(); i++) {
+        frame.values[i] = input->axis(this->__labels[i]);
+    }
+
+    this->__watched_held = false;
+
+    for(auto& label : this->__watched) {
+        this->__watched_held = this->__watched_held || input->axis(label) != 0.0f;
+    }
+
+    glfwGetCursorPos(glfwGetCurrentContext(), &frame.cursor.x, &frame.cursor.y);
+
+    #ifdef IMGUI
+    frame.captured = ImGui::GetIO().WantCaptureMouse;
+    #else
+    frame.captured = false;
+    #endif
+
+    frame.poses.assign(this->__pose_names.size() * 2, glm::vec3(0.0f));
+}
+
+void InputLog::begin_frame() {
+    size_t frame = pepng::commands()->frame();
+
+    if(frame == this->__frame) {
+        return;
+    }
+
+    this->__frame = frame;
+
+    double time = glfwGetTime();
+    float delta = (float) (time - this->__last_time);
+    this->__last_time = time;
+
+    if(this->__mode == Mode::RECORDING) {
+        this->__frames.push_back(this->__current);
+    } else if(this->__mode == Mode::REPLAYING) {
+        this->__frame_ms.push_back(delta * 1000.0f);
+        this->__gpu_ms.push_back(pepng::resolution()->frame_ms());
+    }
+
+    // Recording and replaying start on a boundary so no frame is half recorded.
+    if(this->__next_mode != this->__mode) {
+        this->__mode = this->__next_mode;
+        this->__index = 0;
+    }
+
+    if(this->__mode == Mode::REPLAYING) {
+        if(this->__index >= this->__frames.size()) {
+            this->__dump();
+            this->__mode = this->__next_mode = Mode::IDLE;
+        } else {
+            this->__current = this->__frames[this->__index++];
+            this->__watched_held = false;
+
+            return;
+        }
+    }
+
+    this->__live(this->__current);
+    this->__current.delta = delta;
+
+    if(this->__mode == Mode::RECORDING) {
+        this->__index++;
+    }
+}
+
+float InputLog::axis(const std::string& label) const {
+    auto it = this->__label_index.find(label);
+
+    // Untracked labels are never recorded, so they stay live.
+    if(it == this->__label_index.end()) {
+        return this->__mode == Mode::REPLAYING ? 0.0f : pepng::input()->axis(label);
+    }
+
+    return this->__current.values[it->second];
+}
+
+bool InputLog::active() const {
+    if(this->__watched_held) {
+        return true;
+    }
+
+    for(auto value : this->__current.values) {
+        if(value != 0.0f) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+glm::dvec2 InputLog::cursor() const {
+    return this->__current.cursor;
+}
+
+bool InputLog::mouse_captured() const {
+    return this->__current.captured;
+}
+
+float InputLog::delta_time() const {
+    return this->__current.delta;
+}
+
+void InputLog::pose(size_t slot, std::shared_ptr<Transform> transform) {
+    if(slot >= this->__pose_names.size()) {
+        return;
+    }
+
+    auto& poses = this->__current.poses;
+
+    if(this->__mode == Mode::REPLAYING) {
+        transform->position = poses[slot * 2];
+        transform->rotation = poses[slot * 2 + 1];
+    } else {
+        poses[slot * 2] = transform->position;
+        poses[slot * 2 + 1] = transform->rotation;
+    }
+}
+
+void InputLog::record(const std::filesystem::path& path) {
+    this->stop();
+
+    this->__path = path;
+    this->__frames.clear();
+    this->__next_mode = Mode::RECORDING;
+}
+
+void InputLog::replay(const std::filesystem::path& path) {
+    this->stop();
+
+    this->__read(path);
+
+    this->__path = path;
+    this->__frame_ms.clear();
+    this->__gpu_ms.clear();
+    this->__next_mode = Mode::REPLAYING;
+}
+
+void InputLog::stop() {
+    if(this->__mode == Mode::RECORDING) {
+        this->__write();
+    } else if(this->__mode == Mode::REPLAYING) {
+        this->__dump();
+    }
+
+    this->__mode = this->__next_mode = Mode::IDLE;
+}
+
+InputLog::Mode InputLog::mode() {
+    return this->__mode;
+}
+
+size_t InputLog::frame_index() {
+    return this->__index;
+}
+
+size_t InputLog::frame_count() {
+    return this->__frames.size();
+}
+
+const InputLog::ReplayStats& InputLog::last_replay() {
+    return this->__stats;
+}
+
+void InputLog::__write() {
+    std::ofstream stream(this->__path, std::ios::binary);
+
+    if(!stream) {
+        log_error(this->__path, "cannot be written.");
+    }
+
+    stream.write(MAGIC, sizeof(MAGIC));
+    write_value<uint32_t>(stream, VERSION);
+    write_value<uint32_t>(stream, (uint32_t) this->__labels.size());
+
+    for(auto& label : this->__labels) {
+        write_string(stream, label);
+    }
+
+    write_value<uint32_t>(stream, (uint32_t) this->__pose_names.size());
+
+    for(auto& name : this->__pose_names) {
+        write_string(stream, name);
+    }
+
+    write_value<uint32_t>(stream, (uint32_t) this->__frames.size());
+
+    // Labels are mostly idle, so a frame only stores the ones that changed (bit set per label).
+    std::vector<float> previous(this->__labels.size(), 0.0f);
+    std::vector<uint32_t> changed((this->__labels.size() + 31) / 32);
+
+    for(auto& frame : this->__frames) {
+        std::fill(changed.begin(), changed.end(), 0u);
+
+        for(size_t i = 0; i < frame.values.size(); i++) {
+            if(frame.values[i] != previous[i]) {
+                changed[i / 32] |= 1u << (i % 32);
+            }
+        }
+
+        write_value<float>(stream, frame.delta);
+        stream.write((const char*) changed.data(), changed.size() * sizeof(uint32_t));
+
+        for(size_t i = 0; i < frame.values.size(); i++) {
+            if(changed[i / 32] & (1u << (i % 32))) {
+                write_value<float>(stream, frame.values[i]);
+                previous[i] = frame.values[i];
+            }
+        }
+
+        write_value<float>(stream, (float) frame.cursor.x);
+        write_value<float>(stream, (float) frame.cursor.y);
+        write_value<uint8_t>(stream, frame.captured ? 1 : 0);
+        stream.write((const char*) frame.poses.data(), frame.poses.size() * sizeof(glm::vec3));
+    }
+}
+
+void InputLog::__read(const std::filesystem::path& path) {
+    std::ifstream stream(path, std::ios::binary);
+
+    if(!stream) {
+        log_error(path, "cannot be opened.");
+    }
+
+    char magic[4];
+    stream.read(magic, sizeof(magic));
+
+    if(!stream || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 || read_value<uint32_t>(stream) != VERSION) {
+        log_error(path, "is not an input log of this version.");
+    }
+
+    uint32_t label_count = read_value<uint32_t>(stream);
+
+    std::vector<std::string> labels(label_count);
+
+    for(auto& label : labels) {
+        label = read_string(stream);
+    }
+
+    if(labels != this->__labels) {
+        log_error(path, "was recorded with other labels.");
+    }
+
+    std::vector<std::string> pose_names(read_value<uint32_t>(stream));
+
+    for(auto& name : pose_names) {
+        name = read_string(stream);
+    }
+
+    if(pose_names != this->__pose_names) {
+        log_error(path, "was recorded with other poses.");
+    }
+
+    uint32_t frame_count = read_value<uint32_t>(stream);
+
+    std::vector<float> values(label_count, 0.0f);
+    std::vector<uint32_t> changed((label_count + 31) / 32);
+
+    this->__frames.clear();
+    this->__frames.reserve(frame_count);
+
+    for(uint32_t f = 0; f < frame_count; f++) {
+        Frame frame;
+        frame.delta = read_value<float>(stream);
+        stream.read((char*) changed.data(), changed.size() * sizeof(uint32_t));
+
+        for(size_t i = 0; i < label_count; i++) {
+            if(changed[i / 32] & (1u << (i % 32))) {
+                values[i] = read_value<float>(stream);
+            }
+        }
+
+        frame.values = values;
+        frame.cursor.x = read_value<float>(stream);
+        frame.cursor.y = read_value<float>(stream);
+        frame.captured = read_value<uint8_t>(stream) != 0;
+        frame.poses.resize(pose_names.size() * 2);
+        stream.read((char*) frame.poses.data(), frame.poses.size() * sizeof(glm::vec3));
+
+        if(!stream) {
+            log_error(path, "is truncated.");
+        }
+
+        this->__frames.push_back(std::move(frame));
+    }
+}
+
+void InputLog::__dump() {
+    auto& frame_ms = this->__frame_ms;
+
+    this->__stats = ReplayStats{};
+    this->__stats.frames = frame_ms.size();
+
+    if(frame_ms.empty()) {
+        return;
+    }
+
+    float total = 0.0f, gpu_total = 0.0f;
+
+    for(size_t i = 0; i < frame_ms.size(); i++) {
+        total += frame_ms[i];
+        gpu_total += this->__gpu_ms[i];
+    }
+
+    this->__stats.average_ms = total / frame_ms.size();
+    this->__stats.gpu_ms = gpu_total / frame_ms.size();
+    this->__stats.p50_ms = percentile(frame_ms, 0.5f);
+    this->__stats.p95_ms = percentile(frame_ms, 0.95f);
+    this->__stats.p99_ms = percentile(frame_ms, 0.99f);
+
+    auto path = this->__path;
+    path += ".frames.csv";
+
+    std::ofstream stream(path);
+
+    if(!stream) {
+        log_error(path, "cannot be written.");
+    }
+
+    stream << "frame,frame_ms,gpu_ms" << std::endl;
+
+    for(size_t i = 0; i < frame_ms.size(); i++) {
+        stream << i << "," << frame_ms[i] << "," << this->__gpu_ms[i] << std::endl;
+    }
+
+    frame_ms.clear();
+    this->__gpu_ms.clear();
+}
\ No newline at end of file
@@ -0,0 +1,146 @@
+#pragma once
+
+#include <pepng.h>
+
+/**
+ * Records the per-frame input of the app into a compact binary log and replays it.
+ *
+ * A frame stores the delta time, every tracked label (only the ones that changed), the cursor,
+ * whether ImGui owned the mouse and the pose of every tracked Transform. While replaying, reads
+ * go to the log instead of GLFW and the frame times are collected, then dumped next to the log.
+ *
+ * Only labels the app reads through the log are tracked. Input the engine reads itself (the FPS camera)
+ * is replayed through pose slots.
+ *
+ * begin_frame advances the log once per pepng::commands()->frame() on the main thread, before anything
+ * reads it (FrameStart and ParallelUpdate call it). Reads never change the log, so job system workers
+ * can make them while the main thread waits.
+ */
+class InputLog {
+    public:
+        static std::shared_ptr<InputLog> make_input_log();
+
+        enum class Mode { IDLE, RECORDING, REPLAYING };
+
+        struct ReplayStats {
+            size_t frames;
+            float average_ms;
+            float p50_ms;
+            float p95_ms;
+            float p99_ms;
+            // GPU scene time (DynamicResolution) averaged over the replay.
+            float gpu_ms;
+        };
+
+        /**
+         * Adds labels to record. Must match between the recording and the replaying run.
+         */
+        void track(const std::vector<std::string>& labels);
+
+        /**
+         * Adds a pose slot (replayed poses overwrite whatever moved the Transform).
+         *
+         * @return The slot to pass to pose.
+         */
+        size_t track_pose(const std::string& name);
+
+        /**
+         * Adds labels only checked by active(), always live and never recorded (held camera keys).
+         */
+        void watch(const std::vector<std::string>& labels);
+
+        /**
+         * Starts this frame's values (once per frame, later calls do nothing). Main thread only.
+         */
+        void begin_frame();
+
+        // Value of a label: live, recorded this frame or replayed. Untracked labels are read from the engine (main thread only), 0 while replaying.
+        float axis(const std::string& label) const;
+
+        // True if a tracked or watched label is non-zero this frame (a key or button is held).
+        bool active() const;
+
+        // Cursor position (window coordinates).
+        glm::dvec2 cursor() const;
+
+        // True if ImGui wanted the mouse this frame.
+        bool mouse_captured() const;
+
+        // Seconds between this frame and the previous one (the recorded value while replaying).
+        float delta_time() const;
+
+        /**
+         * Records the pose of a Transform, or overwrites it with the replayed one.
+         * Call it after everything that moves the Transform this frame.
+         */
+        void pose(size_t slot, std::shared_ptr<Transform> transform);
+
+        /**
+         * Starts recording (from the next frame). The log is written on stop.
+         */
+        void record(const std::filesystem::path& path);
+
+        /**
+         * Starts replaying a log (from the next frame). Throws if it does not match the tracked labels and poses.
+         */
+        void replay(const std::filesystem::path& path);
+
+        /**
+         * Ends recording (writes the log) or replaying (writes <log>.frames.csv).
+         */
+        void stop();
+
+        Mode mode();
+        size_t frame_index();
+        size_t frame_count();
+        const ReplayStats& last_replay();
+
+    private:
+        InputLog();
+
+        struct Frame {
+            float delta;
+            std::vector<float> values;
+            glm::dvec2 cursor;
+            bool captured;
+            // Position and rotation per pose slot.
+            std::vector<glm::vec3> poses;
+        };
+
+        void __live(Frame& frame);
+        void __write();
+        void __read(const std::filesystem::path& path);
+        void __dump();
+
+        Mode __mode;
+        Mode __next_mode;
+        std::filesystem::path __path;
+
+        std::vector<std::string> __labels;
+        std::unordered_map<std::string, size_t> __label_index;
+        std::vector<std::string> __pose_names;
+
+        std::vector<std::string> __watched;
+        bool __watched_held;
+
+        std::vector<Frame> __frames;
+        // Frame being read/written (recording appends it at the next boundary).
+        Frame __current;
+        size_t __index;
+
+        size_t __frame;
+        double __last_time;
+
+        std::vector<float> __frame_ms;
+        std::vector<float> __gpu_ms;
+        ReplayStats __stats;
+};
+
+namespace pepng {
+    std::shared_ptr<InputLog> make_input_log();
+
+    /**
+     * The InputLog app code reads its input through.
+     */
+    std::shared_ptr<InputLog> input_log();
+};
\ No newline at end of file
@@ -0,0 +1,188 @@
+#include "job_system.hpp"
+
+namespace {
+    // Queue owned by the current thread (workers only).
+    thread_local int current_queue = -1;
+}
+
+JobSystem::JobSystem(unsigned int worker_count) :
+    __queued(0),
+    __running(true),
+    __serial(false),
+    __next_queue(0)
+{
+    for(unsigned int i = 0; i < worker_count; i++) {
+        this->__queues.push_back(std::make_unique<Queue>());
+    }
+
+    for(unsigned int i = 0; i < worker_count; i++) {
+        this->__threads.emplace_back(&JobSystem::__worker, this, i);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(this->__sleep_mutex);
+
+        this->__running = false;
+    }
+
+    this->__sleep.notify_all();
+
+    for(auto& thread : this->__threads) {
+        thread.join();
+    }
+}
+
+std::shared_ptr<JobSystem> JobSystem::make_job_system(unsigned int worker_count) {
+    std::shared_ptr<JobSystem> job_system(new JobSystem(worker_count));
+
+    return job_system;
+}
+
+std::shared_ptr<JobSystem> pepng::make_job_system(unsigned int worker_count) {
+    return JobSystem::make_job_system(worker_count);
+}
+
+std::shared_ptr<JobSystem> pepng::jobs() {
+    #if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+    static auto job_system = pepng::make_job_system(0);
+    #else
+    static auto job_system = pepng::make_job_system(std::max(1u, std::thread::hardware_concurrency()) - 1);
+    #endif
+
+    return job_system;
+}
+
+void JobSystem::set_serial(bool serial) {
+    this->__serial = serial;
+}
+
+bool JobSystem::serial() {
+    return this->__serial;
+}
+
+unsigned int JobSystem::worker_count() {
+    return (unsigned int) this->__threads.size();
+}
+
+void JobSystem::parallel_for(size_t count, const std::function<void(size_t)>& job, size_t grain) {
+    grain = std::max<size_t>(grain, 1);
+
+    if(this->__serial || this->__queues.empty() || count <= grain) {
+        for(size_t i = 0; i < count; i++) {
+            job(i);
+        }
+
+        return;
+    }
+
+    Batch batch;
+    batch.job = &job;
+    batch.remaining = (count + grain - 1) / grain;
+
+    for(size_t begin = 0; begin < count; begin += grain) {
+        Task task { &batch, begin, std::min(begin + grain, count) };
+
+        // Nested batches stay on the worker's own queue, others are spread for thieves to balance.
+        unsigned int index = current_queue >= 0
+            ? (unsigned int) current_queue
+            : this->__next_queue++ % this->__queues.size();
+
+        std::lock_guard<std::mutex> lock(this->__queues[index]->mutex);
+
+        this->__queued++;
+        this->__queues[index]->tasks.push_back(task);
+    }
+
+    {
+        // Pairs with the predicate check of sleeping workers so no wake-up is lost.
+        std::lock_guard<std::mutex> lock(this->__sleep_mutex);
+    }
+
+    this->__sleep.notify_all();
+
+    // The calling thread helps instead of blocking.
+    while(batch.remaining > 0) {
+        Task task;
+
+        if(this->__pop(current_queue >= 0 ? current_queue : 0, task)) {
+            this->__run(task);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    if(batch.exception) {
+        std::rethrow_exception(batch.exception);
+    }
+}
+
+bool JobSystem::__pop(unsigned int index, Task& task) {
+    size_t queue_count = this->__queues.size();
+
+    // Own queue first (LIFO keeps caches warm), then steal (FIFO takes the oldest, biggest work).
+    for(size_t offset = 0; offset < queue_count; offset++) {
+        auto& queue = this->__queues[(index + offset) % queue_count];
+
+        std::lock_guard<std::mutex> lock(queue->mutex);
+
+        if(queue->tasks.empty()) {
+            continue;
+        }
+
+        if(offset == 0) {
+            task = queue->tasks.back();
+            queue->tasks.pop_back();
+        } else {
+            task = queue->tasks.front();
+            queue->tasks.pop_front();
+        }
+
+        this->__queued--;
+
+        return true;
+    }
+
+    return false;
+}
+
+void JobSystem::__run(Task& task) {
+    try {
+        for(size_t i = task.begin; i < task.end; i++) {
+            (*task.batch->job)(i);
+        }
+    } catch(...) {
+        std::lock_guard<std::mutex> lock(task.batch->mutex);
+
+        if(!task.batch->exception) {
+            task.batch->exception = std::current_exception();
+        }
+    }
+
+    task.batch->remaining--;
+}
+
+void JobSystem::__worker(unsigned int index) {
+    current_queue = (int) index;
+
+    while(true) {
+        Task task;
+
+        if(this->__pop(index, task)) {
+            this->__run(task);
+
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(this->__sleep_mutex);
+
+        this->__sleep.wait(lock, [this]() {
+            return this->__queued > 0 || !this->__running;
+        });
+
+        if(!this->__running) {
+            return;
+        }
+    }
+}
\ No newline at end of file
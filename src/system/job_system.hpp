@@ -0,0 +1,89 @@
+#pragma once
+
+#include <pepng.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+/**
+ * Work-stealing thread pool.
+ *
+ * Every worker owns a queue: it pops its own work from the back and steals from the front of the others.
+ * The submitting thread helps until its batch is done, so nested batches cannot deadlock.
+ */
+class JobSystem {
+    public:
+        /**
+         * Shared_ptr constructor for JobSystem.
+         *
+         * @param worker_count The number of worker threads (0 runs every job on the calling thread).
+         */
+        static std::shared_ptr<JobSystem> make_job_system(unsigned int worker_count);
+
+        ~JobSystem();
+
+        /**
+         * Runs job(i) for every i in [0, count) and waits for all of them.
+         *
+         * The first exception thrown by a job is rethrown on the calling thread.
+         *
+         * @param count The number of indices.
+         * @param job The job to run per index.
+         * @param grain The number of indices per queued task.
+         */
+        void parallel_for(size_t count, const std::function<void(size_t)>& job, size_t grain = 1);
+
+        // Serial mode runs every batch in index order on the calling thread (deterministic debugging).
+        void set_serial(bool serial);
+        bool serial();
+
+        unsigned int worker_count();
+
+    private:
+        JobSystem(unsigned int worker_count);
+
+        struct Batch {
+            const std::function<void(size_t)>* job;
+            std::atomic<size_t> remaining;
+            std::mutex mutex;
+            std::exception_ptr exception;
+        };
+
+        struct Task {
+            Batch* batch;
+            size_t begin;
+            size_t end;
+        };
+
+        struct Queue {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        void __worker(unsigned int index);
+        bool __pop(unsigned int index, Task& task);
+        void __run(Task& task);
+
+        std::vector<std::unique_ptr<Queue>> __queues;
+        std::vector<std::thread> __threads;
+
+        std::mutex __sleep_mutex;
+        std::condition_variable __sleep;
+        std::atomic<size_t> __queued;
+        std::atomic<bool> __running;
+        std::atomic<bool> __serial;
+        std::atomic<unsigned int> __next_queue;
+};
+
+namespace pepng {
+    std::shared_ptr<JobSystem> make_job_system(unsigned int worker_count);
+
+    /**
+     * The engine-wide JobSystem (created on first use with one worker per spare core).
+     */
+    std::shared_ptr<JobSystem> jobs();
+};
\ No newline at end of file
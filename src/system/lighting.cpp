@@ -0,0 +1,392 @@
+#include "lighting.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#include "dynamic_resolution.hpp"
+#include "job_system.hpp"
+#include "memory.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#endif
+
+namespace {
+    constexpr int SLICE_CLUSTERS = Lighting::CLUSTERS_X * Lighting::CLUSTERS_Y;
+
+    static_assert(SLICE_CLUSTERS % 4 == 0, "Cluster boxes are tested 4 at a time.");
+
+    /**
+     * Bit i set if the sphere touches box first + i (squared distance from the center to the box against radius).
+     */
+    int sphere_boxes4(const float* min_x, const float* min_y, const float* min_z,
+        const float* max_x, const float* max_y, const float* max_z, size_t first, const glm::vec4& sphere) {
+        #if defined(__SSE2__)
+        __m128 zero = _mm_setzero_ps();
+        __m128 cx = _mm_set1_ps(sphere.x), cy = _mm_set1_ps(sphere.y), cz = _mm_set1_ps(sphere.z);
+
+        __m128 dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(min_x + first), cx), _mm_sub_ps(cx, _mm_loadu_ps(max_x + first))), zero);
+        __m128 dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(min_y + first), cy), _mm_sub_ps(cy, _mm_loadu_ps(max_y + first))), zero);
+        __m128 dz = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_loadu_ps(min_z + first), cz), _mm_sub_ps(cz, _mm_loadu_ps(max_z + first))), zero);
+
+        __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+
+        return _mm_movemask_ps(_mm_cmple_ps(distance, _mm_set1_ps(sphere.w * sphere.w)));
+        #elif defined(__wasm_simd128__)
+        v128_t zero = wasm_f32x4_splat(0.0f);
+        v128_t cx = wasm_f32x4_splat(sphere.x), cy = wasm_f32x4_splat(sphere.y), cz = wasm_f32x4_splat(sphere.z);
+
+        v128_t dx = wasm_f32x4_max(wasm_f32x4_max(wasm_f32x4_sub(wasm_v128_load(min_x + first), cx), wasm_f32x4_sub(cx, wasm_v128_load(max_x + first))), zero);
+        v128_t dy = wasm_f32x4_max(wasm_f32x4_max(wasm_f32x4_sub(wasm_v128_load(min_y + first), cy), wasm_f32x4_sub(cy, wasm_v128_load(max_y + first))), zero);
+        v128_t dz = wasm_f32x4_max(wasm_f32x4_max(wasm_f32x4_sub(wasm_v128_load(min_z + first), cz), wasm_f32x4_sub(cz, wasm_v128_load(max_z + first))), zero);
+
+        v128_t distance = wasm_f32x4_add(wasm_f32x4_add(wasm_f32x4_mul(dx, dx), wasm_f32x4_mul(dy, dy)), wasm_f32x4_mul(dz, dz));
+
+        return wasm_i32x4_bitmask(wasm_f32x4_le(distance, wasm_f32x4_splat(sphere.w * sphere.w)));
+        #else
+        int mask = 0;
+
+        for(size_t i = 0; i < 4; i++) {
+            size_t c = first + i;
+
+            float dx = std::max(std::max(min_x[c] - sphere.x, sphere.x - max_x[c]), 0.0f);
+            float dy = std::max(std::max(min_y[c] - sphere.y, sphere.y - max_y[c]), 0.0f);
+            float dz = std::max(std::max(min_z[c] - sphere.z, sphere.z - max_z[c]), 0.0f);
+
+            if(dx * dx + dy * dy + dz * dz <= sphere.w * sphere.w) {
+                mask |= 1 << i;
+            }
+        }
+
+        return mask;
+        #endif
+    }
+
+    GLuint make_data_texture(GLenum internal_format, GLenum format, GLenum type, int width, int height) {
+        GLuint texture;
+
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, internal_format, width, height, 0, format, type, nullptr);
+
+        // Fetched with texelFetch only. Integer and float textures cannot be filtered on WebGL2.
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        return texture;
+    }
+}
+
+Lighting::Lighting() :
+    enabled(false),
+    ambient(0.3f),
+    __frame((size_t) -1),
+    __binned(false),
+    __projection(0.0f),
+    __near(0.0f),
+    __far(0.0f),
+    __cluster_lights(SLICE_CLUSTERS * Lighting::CLUSTERS_Z),
+    __light_texture(0),
+    __grid_texture(0),
+    __index_texture(0)
+{}
+
+std::shared_ptr<Lighting> Lighting::make_lighting() {
+    std::shared_ptr<Lighting> lighting(new Lighting());
+
+    return lighting;
+}
+
+std::shared_ptr<Lighting> pepng::make_lighting() {
+    return Lighting::make_lighting();
+}
+
+std::shared_ptr<Lighting> pepng::lighting() {
+    static auto lighting = pepng::make_lighting();
+
+    return lighting;
+}
+
+const Lighting::Stats& Lighting::stats() {
+    return this->__last_stats;
+}
+
+void Lighting::add_light(const LightSource& light) {
+    // Nothing would consume it.
+    if(!this->enabled) {
+        return;
+    }
+
+    this->__next_lights.push_back(light);
+}
+
+void Lighting::__begin_frame() {
+    size_t frame = pepng::commands()->frame();
+
+    if(frame == this->__frame) {
+        return;
+    }
+
+    this->__frame = frame;
+    this->__last_stats = this->__stats;
+    this->__stats = Stats();
+
+    // Lights registered during this frame's update.
+    std::swap(this->__lights, this->__next_lights);
+    this->__next_lights.clear();
+
+    this->__stats.lights = this->__lights.size();
+    this->__binned = false;
+}
+
+void Lighting::record(CommandList& list, GLuint program, const View& view) {
+    // Lights of this frame are taken even when disabled, so they never pile up.
+    this->__begin_frame();
+
+    // Without lights, objects keep their unlit look instead of only getting the ambient.
+    bool lit = this->enabled && !this->__lights.empty();
+
+    list.uniform(pepng::uniform_location(program, "u_lighting"), lit ? 1.0f : 0.0f);
+
+    if(!lit) {
+        return;
+    }
+
+    if(!this->__binned) {
+        this->__binned = true;
+
+        this->__bin(view);
+        this->__upload();
+    }
+
+    list.bind_texture(Lighting::TEXTURE_UNIT, GL_TEXTURE_2D, this->__light_texture);
+    list.bind_texture(Lighting::TEXTURE_UNIT + 1, GL_TEXTURE_2D, this->__grid_texture);
+    list.bind_texture(Lighting::TEXTURE_UNIT + 2, GL_TEXTURE_2D, this->__index_texture);
+
+    list.uniform(pepng::uniform_location(program, "u_lights"), Lighting::TEXTURE_UNIT);
+    list.uniform(pepng::uniform_location(program, "u_light_grid"), Lighting::TEXTURE_UNIT + 1);
+    list.uniform(pepng::uniform_location(program, "u_light_indices"), Lighting::TEXTURE_UNIT + 2);
+
+    list.uniform(pepng::uniform_location(program, "u_ambient"), this->ambient);
+    // gl_FragCoord is in the (possibly scaled) render target.
+    list.uniform(pepng::uniform_location(program, "u_cluster_viewport"), glm::vec4(pepng::resolution()->scaled(view.viewport)));
+    // Depth slice of a fragment: log(depth / near) * scale.
+    list.uniform(pepng::uniform_location(program, "u_cluster_depth"),
+        glm::vec4(this->__near, Lighting::CLUSTERS_Z / std::log(this->__far / this->__near), 0.0f, 0.0f));
+}
+
+void Lighting::__build_clusters(const glm::mat4& projection) {
+    this->__projection = projection;
+
+    // Inverts the depth terms of a GL perspective projection.
+    this->__near = projection[3][2] / (projection[2][2] - 1.0f);
+    this->__far = projection[3][2] / (projection[2][2] + 1.0f);
+
+    size_t count = SLICE_CLUSTERS * Lighting::CLUSTERS_Z;
+
+    for(auto array : { &this->__min_x, &this->__min_y, &this->__min_z, &this->__max_x, &this->__max_y, &this->__max_z }) {
+        array->resize(count);
+    }
+
+    // Exponential slices keep clusters roughly cubic along the depth.
+    auto slice_depth = [this](int k) {
+        return this->__near * std::pow(this->__far / this->__near, (float) k / Lighting::CLUSTERS_Z);
+    };
+
+    for(int k = 0; k < Lighting::CLUSTERS_Z; k++) {
+        float depths[2] = { slice_depth(k), slice_depth(k + 1) };
+
+        for(int j = 0; j < Lighting::CLUSTERS_Y; j++) {
+            for(int i = 0; i < Lighting::CLUSTERS_X; i++) {
+                float ndc_x[2] = { -1.0f + 2.0f * i / Lighting::CLUSTERS_X, -1.0f + 2.0f * (i + 1) / Lighting::CLUSTERS_X };
+                float ndc_y[2] = { -1.0f + 2.0f * j / Lighting::CLUSTERS_Y, -1.0f + 2.0f * (j + 1) / Lighting::CLUSTERS_Y };
+
+                glm::vec3 min(std::numeric_limits<float>::max());
+                glm::vec3 max(std::numeric_limits<float>::lowest());
+
+                // Corners of the tile at both slice depths (view space looks down -z).
+                for(float depth : depths) {
+                    for(float x : ndc_x) {
+                        for(float y : ndc_y) {
+                            glm::vec3 corner(
+                                depth * (x + projection[2][0]) / projection[0][0],
+                                depth * (y + projection[2][1]) / projection[1][1],
+                                -depth);
+
+                            min = glm::min(min, corner);
+                            max = glm::max(max, corner);
+                        }
+                    }
+                }
+
+                size_t c = k * SLICE_CLUSTERS + j * Lighting::CLUSTERS_X + i;
+
+                this->__min_x[c] = min.x;
+                this->__min_y[c] = min.y;
+                this->__min_z[c] = min.z;
+                this->__max_x[c] = max.x;
+                this->__max_y[c] = max.y;
+                this->__max_z[c] = max.z;
+            }
+        }
+    }
+}
+
+void Lighting::__bin(const View& view) {
+    auto start = std::chrono::steady_clock::now();
+
+    if(view.projection != this->__projection) {
+        this->__build_clusters(view.projection);
+    }
+
+    this->__view_lights.clear();
+    this->__view_colors.clear();
+    this->__light_slices.clear();
+
+    float scale = Lighting::CLUSTERS_Z / std::log(this->__far / this->__near);
+
+    auto slice = [&](float depth) {
+        return std::clamp((int) std::floor(std::log(std::max(depth, this->__near) / this->__near) * scale), 0, Lighting::CLUSTERS_Z - 1);
+    };
+
+    // Culls the light bounds against the frustum in one SIMD batch.
+    this->__light_bounds.resize(this->__lights.size());
+    this->__light_visible.resize(this->__lights.size());
+
+    for(size_t l = 0; l < this->__lights.size(); l++) {
+        auto& light = this->__lights[l];
+
+        this->__light_bounds.set(l, light.position - light.radius, light.position + light.radius);
+    }
+
+    pepng::frustum_test(view.planes, this->__light_bounds, this->__light_visible.data());
+
+    for(size_t l = 0; l < this->__lights.size(); l++) {
+        auto& light = this->__lights[l];
+
+        if(this->__view_lights.size() == (size_t) Lighting::MAX_LIGHTS) {
+            break;
+        }
+
+        if(!this->__light_visible[l]) {
+            continue;
+        }
+
+        glm::vec3 position = glm::vec3(view.view * glm::vec4(light.position, 1.0f));
+
+        this->__view_lights.push_back(glm::vec4(position, light.radius));
+        this->__view_colors.push_back(light.color);
+        this->__light_slices.push_back(glm::ivec2(slice(-position.z - light.radius), slice(-position.z + light.radius)));
+    }
+
+    size_t light_count = this->__view_lights.size();
+
+    // Light texture rows: (view position, radius) then (color, 0).
+    this->__light_data.resize(light_count * 8);
+
+    for(size_t l = 0; l < light_count; l++) {
+        auto& color = this->__view_colors[l];
+
+        std::memcpy(&this->__light_data[l * 4], glm::value_ptr(this->__view_lights[l]), 4 * sizeof(float));
+        this->__light_data[(light_count + l) * 4] = color.x;
+        this->__light_data[(light_count + l) * 4 + 1] = color.y;
+        this->__light_data[(light_count + l) * 4 + 2] = color.z;
+        this->__light_data[(light_count + l) * 4 + 3] = 0.0f;
+    }
+
+    // Every slice owns its clusters, so slices are binned in parallel without locks.
+    pepng::jobs()->parallel_for(Lighting::CLUSTERS_Z, [this, light_count](size_t k) {
+        auto* cluster_lights = &this->__cluster_lights[k * SLICE_CLUSTERS];
+
+        for(size_t c = 0; c < (size_t) SLICE_CLUSTERS; c++) {
+            cluster_lights[c].clear();
+        }
+
+        size_t offset = k * SLICE_CLUSTERS;
+
+        for(size_t l = 0; l < light_count; l++) {
+            auto& slices = this->__light_slices[l];
+
+            if((int) k < slices.x || (int) k > slices.y) {
+                continue;
+            }
+
+            for(size_t c = 0; c < (size_t) SLICE_CLUSTERS; c += 4) {
+                int mask = sphere_boxes4(this->__min_x.data(), this->__min_y.data(), this->__min_z.data(),
+                    this->__max_x.data(), this->__max_y.data(), this->__max_z.data(), offset + c, this->__view_lights[l]);
+
+                for(int bit = 0; mask != 0; bit++, mask >>= 1) {
+                    if(mask & 1) {
+                        cluster_lights[c + bit].push_back((uint32_t) l);
+                    }
+                }
+            }
+        }
+    }, 1);
+
+    // Flattens the per cluster lists into (offset, count) and one index list.
+    size_t capacity = (size_t) Lighting::INDEX_WIDTH * Lighting::MAX_INDEX_ROWS;
+
+    this->__grid_data.resize(this->__cluster_lights.size() * 2);
+    this->__index_data.clear();
+
+    for(size_t c = 0; c < this->__cluster_lights.size(); c++) {
+        auto& lights = this->__cluster_lights[c];
+
+        size_t count = std::min(lights.size(), capacity - this->__index_data.size());
+
+        this->__grid_data[c * 2] = (uint32_t) this->__index_data.size();
+        this->__grid_data[c * 2 + 1] = (uint32_t) count;
+
+        this->__index_data.insert(this->__index_data.end(), lights.begin(), lights.begin() + count);
+
+        this->__stats.overflow += lights.size() - count;
+        this->__stats.occupied_clusters += lights.empty() ? 0 : 1;
+        this->__stats.max_cluster_lights = std::max(this->__stats.max_cluster_lights, lights.size());
+    }
+
+    this->__stats.visible_lights = light_count;
+    this->__stats.indices = this->__index_data.size();
+    this->__stats.bin_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void Lighting::__upload() {
+    if(this->__light_texture == 0) {
+        this->__light_texture = make_data_texture(GL_RGBA32F, GL_RGBA, GL_FLOAT, Lighting::MAX_LIGHTS, 2);
+        this->__grid_texture = make_data_texture(GL_RG32UI, GL_RG_INTEGER, GL_UNSIGNED_INT, SLICE_CLUSTERS, Lighting::CLUSTERS_Z);
+        this->__index_texture = make_data_texture(GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, Lighting::INDEX_WIDTH, Lighting::MAX_INDEX_ROWS);
+
+        size_t bytes = Lighting::MAX_LIGHTS * 2 * 16 + SLICE_CLUSTERS * Lighting::CLUSTERS_Z * 8 + Lighting::INDEX_WIDTH * Lighting::MAX_INDEX_ROWS * 4;
+
+        pepng::memory()->track(&this->__light_texture, MemoryRecord { "texture", "", "light clusters", 1, bytes, 0 });
+    }
+
+    size_t light_count = this->__view_lights.size();
+
+    if(light_count > 0) {
+        glBindTexture(GL_TEXTURE_2D, this->__light_texture);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, (GLsizei) light_count, 2, GL_RGBA, GL_FLOAT, this->__light_data.data());
+    }
+
+    glBindTexture(GL_TEXTURE_2D, this->__grid_texture);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, SLICE_CLUSTERS, Lighting::CLUSTERS_Z, GL_RG_INTEGER, GL_UNSIGNED_INT, this->__grid_data.data());
+
+    // Only the used rows of the index texture are sent (the last one padded).
+    size_t rows = (this->__index_data.size() + Lighting::INDEX_WIDTH - 1) / Lighting::INDEX_WIDTH;
+
+    if(rows > 0) {
+        this->__index_data.resize(rows * Lighting::INDEX_WIDTH, 0);
+
+        glBindTexture(GL_TEXTURE_2D, this->__index_texture);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, Lighting::INDEX_WIDTH, (GLsizei) rows, GL_RED_INTEGER, GL_UNSIGNED_INT, this->__index_data.data());
+    }
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
\ No newline at end of file
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <pepng.h>
+
+#include "command_list.hpp"
+#include "simd_math.hpp"
+#include "view.hpp"
+
+struct LightSource {
+    glm::vec3 position;
+    float radius;
+    // Linear color, premultiplied by intensity.
+    glm::vec3 color;
+};
+
+/**
+ * Clustered forward lighting.
+ *
+ * The view frustum is split into CLUSTERS_X * CLUSTERS_Y screen tiles and CLUSTERS_Z exponential depth slices.
+ * Point lights registered during update are binned per cluster on the CPU (SIMD sphere vs cluster box tests,
+ * one job per depth slice) and uploaded as integer textures, so the object shader only loops over the lights
+ * of its fragment's cluster. WebGL2 has neither compute shaders nor texture buffers, so both paths use this.
+ */
+class Lighting {
+    public:
+        static std::shared_ptr<Lighting> make_lighting();
+
+        // Unlit (the texture or flat color as is) when false, the default. Also unlit while no light is registered.
+        bool enabled;
+        glm::vec3 ambient;
+
+        struct Stats {
+            size_t lights = 0;
+            size_t visible_lights = 0;
+            size_t occupied_clusters = 0;
+            size_t max_cluster_lights = 0;
+            size_t indices = 0;
+            // Light references dropped because the index texture was full.
+            size_t overflow = 0;
+            float bin_ms = 0.0f;
+        };
+
+        // Statistics of the last finished frame.
+        const Stats& stats();
+
+        // Registers a light for the next frame (ignored while disabled).
+        void add_light(const LightSource& light);
+
+        /**
+         * Records the light textures and uniforms for a program (after use_program).
+         *
+         * The first call of a frame bins the lights for view and uploads the result.
+         */
+        void record(CommandList& list, GLuint program, const View& view);
+
+        static constexpr int CLUSTERS_X = 16;
+        static constexpr int CLUSTERS_Y = 9;
+        static constexpr int CLUSTERS_Z = 24;
+        static constexpr int MAX_LIGHTS = 1024;
+        // Width of the index texture (its height grows up to MAX_INDEX_ROWS).
+        static constexpr int INDEX_WIDTH = 1024;
+        static constexpr int MAX_INDEX_ROWS = 64;
+        // First texture unit used (unit 0 is the material texture).
+        static constexpr int TEXTURE_UNIT = 1;
+
+    private:
+        Lighting();
+
+        void __begin_frame();
+        void __build_clusters(const glm::mat4& projection);
+        void __bin(const View& view);
+        void __upload();
+
+        size_t __frame;
+        bool __binned;
+        Stats __stats;
+        Stats __last_stats;
+
+        std::vector<LightSource> __lights;
+        std::vector<LightSource> __next_lights;
+
+        // Projection the cluster boxes were built for.
+        glm::mat4 __projection;
+        float __near;
+        float __far;
+
+        // View space cluster boxes, SoA per depth slice (CLUSTERS_X * CLUSTERS_Y entries per slice).
+        std::vector<float> __min_x, __min_y, __min_z;
+        std::vector<float> __max_x, __max_y, __max_z;
+
+        // World bounds of the registered lights, culled in one batch.
+        AabbArray __light_bounds;
+        std::vector<uint8_t> __light_visible;
+
+        // View space lights of this frame (x, y, z, radius) and the depth slices they span.
+        std::vector<glm::vec4> __view_lights;
+        std::vector<glm::vec3> __view_colors;
+        std::vector<glm::ivec2> __light_slices;
+
+        // Light indices per cluster (capacity kept across frames).
+        std::vector<std::vector<uint32_t>> __cluster_lights;
+
+        // Upload staging: light texels, cluster (offset, count) and the flattened index list.
+        std::vector<float> __light_data;
+        std::vector<uint32_t> __grid_data;
+        std::vector<uint32_t> __index_data;
+
+        GLuint __light_texture;
+        GLuint __grid_texture;
+        GLuint __index_texture;
+};
+
+namespace pepng {
+    std::shared_ptr<Lighting> make_lighting();
+
+    /**
+     * The engine-wide Lighting.
+     */
+    std::shared_ptr<Lighting> lighting();
+};
\ No newline at end of file
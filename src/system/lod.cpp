@@ -0,0 +1,408 @@
+#include "lod.hpp"
+
+#include <array>
+#include <queue>
+
+#include "command_list.hpp"
+#include "job_system.hpp"
+
+namespace {
+    // Symmetric 4x4 error quadric stored as its upper triangle.
+    struct Quadric {
+        double a[10] = {};
+
+        void add_plane(const glm::dvec3& normal, double d, double weight) {
+            double plane[4] = { normal.x, normal.y, normal.z, d };
+            int k = 0;
+
+            for(int i = 0; i < 4; i++) {
+                for(int j = i; j < 4; j++) {
+                    this->a[k++] += plane[i] * plane[j] * weight;
+                }
+            }
+        }
+
+        Quadric& operator+=(const Quadric& other) {
+            for(int i = 0; i < 10; i++) {
+                this->a[i] += other.a[i];
+            }
+
+            return *this;
+        }
+
+        double error(const glm::vec3& v) const {
+            double x = v.x, y = v.y, z = v.z;
+
+            return a[0] * x * x + 2 * a[1] * x * y + 2 * a[2] * x * z + 2 * a[3] * x
+                + a[4] * y * y + 2 * a[5] * y * z + 2 * a[6] * y
+                + a[7] * z * z + 2 * a[8] * z
+                + a[9];
+        }
+    };
+
+    struct Candidate {
+        double cost;
+        unsigned int keep;
+        unsigned int remove;
+        unsigned int keep_version;
+        unsigned int remove_version;
+        glm::vec3 target;
+
+        bool operator>(const Candidate& other) const {
+            return this->cost > other.cost;
+        }
+    };
+
+    glm::vec3 face_normal(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) {
+        return glm::cross(b - a, c - a);
+    }
+}
+
+std::shared_ptr<Mesh> pepng::simplify(std::shared_ptr<Mesh> mesh, float ratio) {
+    // Welds vertices split by normals/UVs so collapses see the real topology.
+    std::vector<unsigned int> welded = pepng::weld_positions(mesh->positions);
+    std::vector<unsigned int> representative;
+    std::vector<glm::vec3> positions;
+
+    for(size_t i = 0; i < mesh->positions.size(); i++) {
+        // Ids are numbered in order of first appearance.
+        if(welded[i] == positions.size()) {
+            representative.push_back((unsigned int) i);
+            positions.push_back(mesh->positions[i]);
+        }
+    }
+
+    std::vector<std::array<unsigned int, 3>> faces;
+    faces.reserve(mesh->triangle_count());
+
+    for(size_t i = 0; i + 2 < mesh->indices.size(); i += 3) {
+        std::array<unsigned int, 3> face { welded[mesh->indices[i]], welded[mesh->indices[i + 1]], welded[mesh->indices[i + 2]] };
+
+        if(face[0] != face[1] && face[1] != face[2] && face[0] != face[2]) {
+            faces.push_back(face);
+        }
+    }
+
+    size_t vertex_count = positions.size();
+
+    std::vector<Quadric> quadrics(vertex_count);
+    std::vector<std::vector<unsigned int>> vertex_faces(vertex_count);
+
+    for(size_t f = 0; f < faces.size(); f++) {
+        auto& face = faces[f];
+
+        glm::vec3 normal = face_normal(positions[face[0]], positions[face[1]], positions[face[2]]);
+        double area = glm::length(normal);
+
+        if(area > 0.0) {
+            glm::dvec3 unit = glm::dvec3(normal) / area;
+            double d = -glm::dot(unit, glm::dvec3(positions[face[0]]));
+
+            for(auto v : face) {
+                quadrics[v].add_plane(unit, d, area * 0.5);
+            }
+        }
+
+        for(auto v : face) {
+            vertex_faces[v].push_back((unsigned int) f);
+        }
+    }
+
+    std::vector<bool> face_alive(faces.size(), true);
+    std::vector<bool> vertex_alive(vertex_count, true);
+    std::vector<unsigned int> versions(vertex_count, 0);
+
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> heap;
+
+    auto push_candidate = [&](unsigned int keep, unsigned int remove) {
+        Quadric quadric = quadrics[keep];
+        quadric += quadrics[remove];
+
+        // Cheaper than solving the 3x3 system and never leaves the hull of the edge.
+        glm::vec3 options[3] = { positions[keep], positions[remove], (positions[keep] + positions[remove]) * 0.5f };
+
+        Candidate candidate { quadric.error(options[0]), keep, remove, versions[keep], versions[remove], options[0] };
+
+        for(int i = 1; i < 3; i++) {
+            double cost = quadric.error(options[i]);
+
+            if(cost < candidate.cost) {
+                candidate.cost = cost;
+                candidate.target = options[i];
+            }
+        }
+
+        heap.push(candidate);
+    };
+
+    for(auto& face : faces) {
+        for(int i = 0; i < 3; i++) {
+            push_candidate(face[i], face[(i + 1) % 3]);
+        }
+    }
+
+    size_t alive = faces.size();
+    size_t target = std::max<size_t>(1, (size_t) (faces.size() * ratio));
+
+    // True if moving vertex to position flips or degenerates one of its faces (ignoring faces also using other).
+    auto flips = [&](unsigned int vertex, unsigned int other, const glm::vec3& position) {
+        for(auto f : vertex_faces[vertex]) {
+            if(!face_alive[f]) {
+                continue;
+            }
+
+            auto& face = faces[f];
+
+            if(face[0] == other || face[1] == other || face[2] == other) {
+                continue;
+            }
+
+            glm::vec3 corners[3];
+
+            for(int i = 0; i < 3; i++) {
+                corners[i] = face[i] == vertex ? position : positions[face[i]];
+            }
+
+            glm::vec3 before = face_normal(positions[face[0]], positions[face[1]], positions[face[2]]);
+            glm::vec3 after = face_normal(corners[0], corners[1], corners[2]);
+
+            if(glm::dot(before, after) <= 0.0f) {
+                return true;
+            }
+        }
+
+        return false;
+    };
+
+    while(alive > target && !heap.empty()) {
+        auto candidate = heap.top();
+        heap.pop();
+
+        unsigned int keep = candidate.keep, remove = candidate.remove;
+
+        if(!vertex_alive[keep] || !vertex_alive[remove]
+            || versions[keep] != candidate.keep_version || versions[remove] != candidate.remove_version) {
+            continue;
+        }
+
+        if(flips(keep, remove, candidate.target) || flips(remove, keep, candidate.target)) {
+            continue;
+        }
+
+        positions[keep] = candidate.target;
+        quadrics[keep] += quadrics[remove];
+        vertex_alive[remove] = false;
+        versions[keep]++;
+
+        for(auto f : vertex_faces[remove]) {
+            if(!face_alive[f]) {
+                continue;
+            }
+
+            auto& face = faces[f];
+
+            if(face[0] == keep || face[1] == keep || face[2] == keep) {
+                face_alive[f] = false;
+                alive--;
+
+                continue;
+            }
+
+            for(auto& v : face) {
+                if(v == remove) {
+                    v = keep;
+                }
+            }
+
+            vertex_faces[keep].push_back(f);
+        }
+
+        vertex_faces[remove].clear();
+
+        // Drops dead faces and re-queues every edge around the moved vertex.
+        auto& keep_faces = vertex_faces[keep];
+        keep_faces.erase(std::remove_if(keep_faces.begin(), keep_faces.end(), [&](unsigned int f) {
+            return !face_alive[f];
+        }), keep_faces.end());
+
+        for(auto f : keep_faces) {
+            for(auto v : faces[f]) {
+                if(v != keep) {
+                    push_candidate(keep, v);
+                }
+            }
+        }
+    }
+
+    auto simplified = pepng::make_mesh();
+
+    std::vector<unsigned int> remap(vertex_count, (unsigned int) -1);
+
+    for(size_t f = 0; f < faces.size(); f++) {
+        if(!face_alive[f]) {
+            continue;
+        }
+
+        for(auto v : faces[f]) {
+            if(remap[v] == (unsigned int) -1) {
+                remap[v] = (unsigned int) simplified->positions.size();
+
+                simplified->positions.push_back(positions[v]);
+
+                if(!mesh->normals.empty()) {
+                    simplified->normals.push_back(mesh->normals[representative[v]]);
+                }
+
+                if(!mesh->uvs.empty()) {
+                    simplified->uvs.push_back(mesh->uvs[representative[v]]);
+                }
+            }
+
+            simplified->indices.push_back(remap[v]);
+        }
+    }
+
+    simplified->compute_bounds();
+
+    return simplified;
+}
+
+LodGroup::LodGroup() :
+    center(0.0f),
+    radius(0.0f)
+{}
+
+std::shared_ptr<LodGroup> LodGroup::make_lod_group(std::shared_ptr<Model> model, std::shared_ptr<Mesh> mesh, const std::vector<float>& ratios) {
+    static const float thresholds[] = { 256.0f, 96.0f, 32.0f, 12.0f };
+
+    std::shared_ptr<LodGroup> group(new LodGroup());
+
+    group->source = model;
+    group->triangle_counts.push_back(mesh->triangle_count());
+    group->center = mesh->center;
+    group->radius = mesh->radius;
+
+    // Simplification is CPU only, so the levels are built in parallel. Uploads stay on this (GL) thread.
+    std::vector<std::shared_ptr<Mesh>> meshes(ratios.size());
+
+    pepng::jobs()->parallel_for(ratios.size(), [&](size_t i) {
+        meshes[i] = pepng::simplify(mesh, ratios[i]);
+    });
+
+    for(size_t i = 0; i < meshes.size() && i < std::size(thresholds); i++) {
+        size_t triangle_count = meshes[i]->triangle_count();
+
+        // Stops once a level no longer removes a meaningful amount of triangles.
+        if(triangle_count == 0 || triangle_count > group->triangle_counts.back() * 0.9f) {
+            break;
+        }
+
+        std::stringstream name;
+        name << "LOD" << group->level_count();
+
+        group->levels.push_back(pepng::make_mesh_model(meshes[i], name.str()));
+        group->triangle_counts.push_back(triangle_count);
+        group->thresholds.push_back(thresholds[i]);
+    }
+
+    return group;
+}
+
+size_t LodGroup::level_count() {
+    return this->levels.size() + 1;
+}
+
+std::shared_ptr<Model> LodGroup::level(size_t index) {
+    return index == 0 ? this->source.lock() : this->levels[index - 1];
+}
+
+size_t LodGroup::select(const View& view, const glm::mat4& world, size_t current) {
+    size_t level = std::min(current, this->level_count() - 1);
+
+    glm::vec3 center = glm::vec3(world * glm::vec4(this->center, 1.0f));
+    float scale = std::max(glm::length(glm::vec3(world[0])), std::max(glm::length(glm::vec3(world[1])), glm::length(glm::vec3(world[2]))));
+    float radius = this->radius * scale;
+    float distance = glm::length(center - view.position);
+
+    if(distance <= radius) {
+        return 0;
+    }
+
+    // Projected diameter in pixels (projection[1][1] is cot(fov / 2)).
+    float size = radius * view.projection[1][1] * (float) view.viewport.w / distance;
+
+    while(level + 1 < this->level_count() && size < this->thresholds[level] * (1.0f - LodGroup::HYSTERESIS)) {
+        level++;
+    }
+
+    while(level > 0 && size > this->thresholds[level - 1] * (1.0f + LodGroup::HYSTERESIS)) {
+        level--;
+    }
+
+    return level;
+}
+
+namespace {
+    struct LodEntry {
+        std::weak_ptr<Model> model;
+        std::vector<float> ratios;
+        bool built = false;
+        std::shared_ptr<LodGroup> group;
+    };
+
+    std::unordered_map<Model*, LodEntry>& lod_entries() {
+        static std::unordered_map<Model*, LodEntry> entries;
+
+        return entries;
+    }
+}
+
+void pepng::enable_lods(std::shared_ptr<Model> model, std::vector<float> ratios) {
+    auto& entries = lod_entries();
+
+    // Drops the levels of destroyed Models (their Model* may be reused by a new Model).
+    for(auto it = entries.begin(); it != entries.end();) {
+        it = it->second.model.expired() ? entries.erase(it) : std::next(it);
+    }
+
+    auto& entry = entries[model.get()];
+
+    entry.model = model;
+    entry.ratios = ratios;
+    entry.built = false;
+    entry.group = nullptr;
+}
+
+std::shared_ptr<LodGroup> pepng::lod_group(std::shared_ptr<Model> model) {
+    auto& entries = lod_entries();
+
+    auto it = entries.find(model.get());
+
+    if(it == entries.end() || it->second.model.expired()) {
+        return nullptr;
+    }
+
+    auto& entry = it->second;
+
+    if(!entry.built) {
+        // Read back and simplification are spread over frames, one Model per frame.
+        static size_t built_frame = (size_t) -1;
+
+        size_t frame = pepng::commands()->frame();
+
+        if(built_frame == frame) {
+            return nullptr;
+        }
+
+        built_frame = frame;
+        entry.built = true;
+
+        auto mesh = pepng::read_mesh(model);
+
+        if(mesh != nullptr && mesh->triangle_count() > 0) {
+            entry.group = LodGroup::make_lod_group(model, mesh, entry.ratios);
+        }
+    }
+
+    return entry.group;
+}
\ No newline at end of file
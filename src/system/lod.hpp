@@ -0,0 +1,67 @@
+#pragma once
+
+#include <pepng.h>
+
+#include "mesh.hpp"
+#include "view.hpp"
+
+/**
+ * Levels of detail of a Model, generated by quadric error edge collapse.
+ *
+ * Level 0 is the original Model (held weakly, the group never keeps it alive). Level i is drawn once the
+ * projected bounding sphere is smaller than thresholds[i - 1] pixels.
+ */
+class LodGroup {
+    public:
+        static std::shared_ptr<LodGroup> make_lod_group(std::shared_ptr<Model> model, std::shared_ptr<Mesh> mesh, const std::vector<float>& ratios);
+
+        std::weak_ptr<Model> source;
+        // Generated levels: levels[i - 1] is level i.
+        std::vector<std::shared_ptr<Model>> levels;
+        // One per level, the original included.
+        std::vector<size_t> triangle_counts;
+        // Projected diameter (pixels) under which the next level is used. One per extra level.
+        std::vector<float> thresholds;
+
+        // Object space bounding sphere of the original Model.
+        glm::vec3 center;
+        float radius;
+
+        /**
+         * Picks a level from the projected size of the bounding sphere.
+         *
+         * @param current The level drawn last frame (hysteresis keeps it until the size leaves a band).
+         */
+        size_t select(const View& view, const glm::mat4& world, size_t current);
+
+        // Number of levels, the original included.
+        size_t level_count();
+        // The Model of a level (the source for level 0, nullptr once it is destroyed).
+        std::shared_ptr<Model> level(size_t index);
+
+        // Fraction of the thresholds to cross before switching (avoids popping at the boundary).
+        static constexpr float HYSTERESIS = 0.1f;
+
+    private:
+        LodGroup();
+};
+
+namespace pepng {
+    /**
+     * Simplifies a Mesh to roughly ratio of its triangles (Garland-Heckbert quadrics, position welded).
+     */
+    std::shared_ptr<Mesh> simplify(std::shared_ptr<Mesh> mesh, float ratio);
+
+    /**
+     * Opts a Model into LOD generation. The levels are built on its first render (needs the GL thread).
+     * One Model is built per frame (its levels in parallel on the job system), so large scenes do not stall one frame.
+     *
+     * @param ratios Triangle ratio of every extra level.
+     */
+    void enable_lods(std::shared_ptr<Model> model, std::vector<float> ratios = { 0.5f, 0.2f, 0.05f });
+
+    /**
+     * The LodGroup of a Model (building it if it was enabled). nullptr if not enabled, not readable, or not built yet.
+     */
+    std::shared_ptr<LodGroup> lod_group(std::shared_ptr<Model> model);
+};
\ No newline at end of file
@@ -0,0 +1,130 @@
+#include "mapped_file.hpp"
+
+#include <fstream>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elif !defined(__EMSCRIPTEN__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    [[noreturn]] void open_error(const std::filesystem::path& path) {
+        std::stringstream ss;
+
+        ss << "Could not open " << path << "." << std::endl;
+
+        throw std::runtime_error(ss.str());
+    }
+}
+
+MappedFile::MappedFile() :
+    __data(nullptr),
+    __size(0)
+    #ifdef _WIN32
+    , __file(nullptr),
+    __mapping(nullptr)
+    #endif
+{}
+
+MappedFile::~MappedFile() {
+    if(this->__data == nullptr || !this->__buffer.empty()) {
+        return;
+    }
+
+    #if defined(_WIN32)
+    UnmapViewOfFile(this->__data);
+    CloseHandle(this->__mapping);
+    CloseHandle(this->__file);
+    #elif !defined(__EMSCRIPTEN__)
+    munmap((void*) this->__data, this->__size);
+    #endif
+}
+
+std::shared_ptr<MappedFile> MappedFile::make_mapped_file(const std::filesystem::path& path) {
+    std::shared_ptr<MappedFile> file(new MappedFile());
+
+    #if defined(_WIN32)
+    HANDLE handle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+    if(handle == INVALID_HANDLE_VALUE) {
+        open_error(path);
+    }
+
+    LARGE_INTEGER size;
+    GetFileSizeEx(handle, &size);
+
+    file->__file = handle;
+    file->__size = (size_t) size.QuadPart;
+
+    if(file->__size > 0) {
+        file->__mapping = CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+        if(file->__mapping == nullptr) {
+            open_error(path);
+        }
+
+        file->__data = (const char*) MapViewOfFile(file->__mapping, FILE_MAP_READ, 0, 0, 0);
+    }
+    #elif !defined(__EMSCRIPTEN__)
+    int descriptor = open(path.c_str(), O_RDONLY);
+
+    if(descriptor < 0) {
+        open_error(path);
+    }
+
+    struct stat status;
+    fstat(descriptor, &status);
+
+    file->__size = (size_t) status.st_size;
+
+    if(file->__size > 0) {
+        void* data = mmap(nullptr, file->__size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+
+        if(data == MAP_FAILED) {
+            close(descriptor);
+            open_error(path);
+        }
+
+        // Parsers read front to back.
+        madvise(data, file->__size, MADV_SEQUENTIAL);
+
+        file->__data = (const char*) data;
+    }
+
+    // The mapping stays valid after the descriptor is closed.
+    close(descriptor);
+    #else
+    std::ifstream stream(path, std::ios::binary | std::ios::ate);
+
+    if(!stream) {
+        open_error(path);
+    }
+
+    file->__buffer.resize((size_t) stream.tellg());
+    stream.seekg(0);
+    stream.read(file->__buffer.data(), file->__buffer.size());
+
+    file->__data = file->__buffer.data();
+    file->__size = file->__buffer.size();
+    #endif
+
+    return file;
+}
+
+std::shared_ptr<MappedFile> pepng::map_file(const std::filesystem::path& path) {
+    return MappedFile::make_mapped_file(path);
+}
+
+std::string_view MappedFile::view() {
+    return std::string_view(this->__data, this->__size);
+}
+
+size_t MappedFile::size() {
+    return this->__size;
+}
\ No newline at end of file
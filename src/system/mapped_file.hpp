@@ -0,0 +1,41 @@
+#pragma once
+
+#include <pepng.h>
+
+#include <string_view>
+
+/**
+ * Read-only view of a whole file, memory-mapped where the platform allows it (read into memory on WebGL).
+ *
+ * Parsers work on string_views into it, so the file is never copied.
+ */
+class MappedFile {
+    public:
+        static std::shared_ptr<MappedFile> make_mapped_file(const std::filesystem::path& path);
+
+        ~MappedFile();
+
+        std::string_view view();
+        size_t size();
+
+    private:
+        MappedFile();
+
+        const char* __data;
+        size_t __size;
+
+        // Fallback storage when the file is not mapped.
+        std::vector<char> __buffer;
+
+        #ifdef _WIN32
+        void* __file;
+        void* __mapping;
+        #endif
+};
+
+namespace pepng {
+    /**
+     * Maps a file. Throws if it cannot be opened.
+     */
+    std::shared_ptr<MappedFile> map_file(const std::filesystem::path& path);
+};
\ No newline at end of file
@@ -0,0 +1,346 @@
+#include "memory.hpp"
+
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <tuple>
+
+#include "mesh.hpp"
+#include "model_info.hpp"
+
+namespace {
+    constexpr uint64_t FNV_OFFSET = 14695981039346656037ull;
+    constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+    size_t buffer_size(GLuint buffer) {
+        GLint size = 0;
+
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        glGetBufferParameteriv(GL_ARRAY_BUFFER, GL_BUFFER_SIZE, &size);
+
+        return (size_t) size;
+    }
+
+    #ifndef __EMSCRIPTEN__
+    uint64_t buffer_hash(GLuint buffer, size_t size, uint64_t hash) {
+        std::vector<unsigned char> data(size);
+
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        glGetBufferSubData(GL_ARRAY_BUFFER, 0, size, data.data());
+
+        return pepng::content_hash(data.data(), size, hash);
+    }
+
+    size_t bytes_per_texel(GLint format) {
+        switch(format) {
+            case GL_R8:
+            case GL_RED:
+                return 1;
+            case GL_RG8:
+                return 2;
+            case GL_RGB8:
+            case GL_RGB:
+                return 3;
+            case GL_RGBA16F:
+                return 8;
+            case GL_RGBA32F:
+                return 16;
+            default:
+                return 4;
+        }
+    }
+    #endif
+
+    std::string escape(const std::string& text) {
+        std::stringstream ss;
+
+        for(char c : text) {
+            if(c == '"' || c == '\\') {
+                ss << '\\' << c;
+            } else if((unsigned char) c < 0x20) {
+                ss << "\\u" << std::hex << std::setw(4) << std::setfill('0') << (int) c << std::dec;
+            } else {
+                ss << c;
+            }
+        }
+
+        return ss.str();
+    }
+}
+
+uint64_t pepng::content_hash(const void* data, size_t size, uint64_t hash) {
+    auto bytes = (const unsigned char*) data;
+
+    for(size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * FNV_PRIME;
+    }
+
+    return hash;
+}
+
+size_t pepng::texture_bytes(std::shared_ptr<Texture> texture) {
+    // GLES 3.0 cannot query texture levels.
+    #ifdef __EMSCRIPTEN__
+    return 0;
+    #else
+    GLint previous_texture = 0, width = 0, height = 0, format = 0, min_filter = 0;
+
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &previous_texture);
+
+    glBindTexture(GL_TEXTURE_2D, texture->gl_index());
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_INTERNAL_FORMAT, &format);
+    glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, &min_filter);
+
+    glBindTexture(GL_TEXTURE_2D, previous_texture);
+
+    size_t bytes = (size_t) width * height * bytes_per_texel(format);
+
+    // A full mip chain adds a third.
+    if(min_filter != GL_NEAREST && min_filter != GL_LINEAR) {
+        bytes += bytes / 3;
+    }
+
+    return bytes;
+    #endif
+}
+
+MemoryTracker::MemoryTracker() {}
+
+std::shared_ptr<MemoryTracker> MemoryTracker::make_memory_tracker() {
+    std::shared_ptr<MemoryTracker> memory_tracker(new MemoryTracker());
+
+    return memory_tracker;
+}
+
+std::shared_ptr<MemoryTracker> pepng::make_memory_tracker() {
+    return MemoryTracker::make_memory_tracker();
+}
+
+std::shared_ptr<MemoryTracker> pepng::memory() {
+    static auto memory_tracker = pepng::make_memory_tracker();
+
+    return memory_tracker;
+}
+
+void MemoryTracker::track(const void* key, const MemoryRecord& record) {
+    this->__tracked[key] = record;
+}
+
+void MemoryTracker::untrack(const void* key) {
+    this->__tracked.erase(key);
+}
+
+void MemoryTracker::observe(std::shared_ptr<Model> model, const std::string& owner, const std::string& source) {
+    auto& observed = this->__models[model.get()];
+
+    // A new Model reusing the address of a destroyed one starts over.
+    if(observed.resource.expired()) {
+        observed = Observed<Model> { model, owner, source, 0 };
+    }
+
+    observed.users++;
+}
+
+void MemoryTracker::observe(std::shared_ptr<Texture> texture, const std::string& owner, const std::string& source) {
+    auto& observed = this->__textures[texture.get()];
+
+    if(observed.resource.expired()) {
+        observed = Observed<Texture> { texture, owner, source, 0 };
+    }
+
+    observed.users++;
+}
+
+void MemoryTracker::release(std::shared_ptr<Model> model) {
+    auto it = this->__models.find(model.get());
+
+    if(it != this->__models.end() && !it->second.resource.expired() && it->second.users > 0) {
+        it->second.users--;
+    }
+}
+
+void MemoryTracker::release(std::shared_ptr<Texture> texture) {
+    auto it = this->__textures.find(texture.get());
+
+    if(it != this->__textures.end() && !it->second.resource.expired() && it->second.users > 0) {
+        it->second.users--;
+    }
+}
+
+std::vector<MemoryRecord> MemoryTracker::snapshot(bool hash) {
+    std::vector<MemoryRecord> records;
+
+    for(auto& [key, record] : this->__tracked) {
+        records.push_back(record);
+    }
+
+    GLint previous_buffer = 0, previous_texture = 0;
+    glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &previous_buffer);
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &previous_texture);
+
+    for(auto it = this->__models.begin(); it != this->__models.end();) {
+        auto model = it->second.resource.lock();
+
+        if(model == nullptr) {
+            it = this->__models.erase(it);
+
+            continue;
+        }
+
+        MemoryRecord record { "model", it->second.owner, it->second.source, it->second.users };
+
+        if(model->is_init()) {
+            auto& info = pepng::model_info(model);
+
+            auto buffers = info.vertex_buffers;
+
+            if(info.indexed) {
+                buffers.push_back(info.element_buffer);
+            }
+
+            uint64_t content = FNV_OFFSET;
+
+            for(auto buffer : buffers) {
+                size_t size = buffer_size(buffer);
+
+                record.gpu_bytes += size;
+
+                #ifndef __EMSCRIPTEN__
+                if(hash) {
+                    content = buffer_hash(buffer, size, content);
+                }
+                #endif
+            }
+
+            record.hash = hash && !buffers.empty() ? content : 0;
+        }
+
+        if(auto mesh = pepng::cached_mesh(model)) {
+            record.cpu_bytes += pepng::mesh_bytes(mesh);
+        }
+
+        records.push_back(record);
+        it++;
+    }
+
+    for(auto it = this->__textures.begin(); it != this->__textures.end();) {
+        auto texture = it->second.resource.lock();
+
+        if(texture == nullptr) {
+            it = this->__textures.erase(it);
+
+            continue;
+        }
+
+        MemoryRecord record { "texture", it->second.owner, it->second.source, it->second.users };
+
+        record.gpu_bytes = pepng::texture_bytes(texture);
+
+        // Texture read back is desktop only.
+        #ifndef __EMSCRIPTEN__
+        GLint width = 0, height = 0;
+
+        glBindTexture(GL_TEXTURE_2D, texture->gl_index());
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
+
+        if(hash && width > 0 && height > 0) {
+            std::vector<unsigned char> pixels((size_t) width * height * 4);
+
+            glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+            record.hash = pepng::content_hash(pixels.data(), pixels.size());
+        }
+        #endif
+
+        records.push_back(record);
+        it++;
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, previous_buffer);
+    glBindTexture(GL_TEXTURE_2D, previous_texture);
+
+    // The maps have no stable order: ties are broken by name so dumps of two runs line up.
+    std::stable_sort(records.begin(), records.end(), [](const MemoryRecord& a, const MemoryRecord& b) {
+        size_t a_bytes = a.gpu_bytes + a.cpu_bytes;
+        size_t b_bytes = b.gpu_bytes + b.cpu_bytes;
+
+        if(a_bytes != b_bytes) {
+            return a_bytes > b_bytes;
+        }
+
+        return std::tie(a.tag, a.owner, a.source, a.hash) < std::tie(b.tag, b.owner, b.source, b.hash);
+    });
+
+    return records;
+}
+
+std::vector<std::vector<size_t>> MemoryTracker::duplicates(const std::vector<MemoryRecord>& records) {
+    std::map<std::pair<std::string, uint64_t>, std::vector<size_t>> groups;
+
+    for(size_t i = 0; i < records.size(); i++) {
+        if(records[i].hash != 0) {
+            groups[{ records[i].tag, records[i].hash }].push_back(i);
+        }
+    }
+
+    std::vector<std::vector<size_t>> result;
+
+    for(auto& [key, group] : groups) {
+        if(group.size() > 1) {
+            result.push_back(group);
+        }
+    }
+
+    return result;
+}
+
+std::string MemoryTracker::to_json(const std::vector<MemoryRecord>& records) {
+    size_t gpu_bytes = 0, cpu_bytes = 0;
+
+    for(auto& record : records) {
+        gpu_bytes += record.gpu_bytes;
+        cpu_bytes += record.cpu_bytes;
+    }
+
+    std::stringstream ss;
+
+    ss << "{\n";
+    ss << "  \"gpu_bytes\": " << gpu_bytes << ",\n";
+    ss << "  \"cpu_bytes\": " << cpu_bytes << ",\n";
+    ss << "  \"resources\": [";
+
+    for(size_t i = 0; i < records.size(); i++) {
+        auto& record = records[i];
+
+        ss << (i == 0 ? "\n" : ",\n");
+        ss << "    { \"tag\": \"" << escape(record.tag)
+            << "\", \"owner\": \"" << escape(record.owner)
+            << "\", \"source\": \"" << escape(record.source)
+            << "\", \"users\": " << record.users
+            << ", \"gpu_bytes\": " << record.gpu_bytes
+            << ", \"cpu_bytes\": " << record.cpu_bytes
+            << ", \"hash\": \"" << std::hex << std::setw(16) << std::setfill('0') << record.hash << std::dec << std::setfill(' ')
+            << "\" }";
+    }
+
+    ss << "\n  ]\n}\n";
+
+    return ss.str();
+}
+
+void MemoryTracker::dump(const std::filesystem::path& path) {
+    std::ofstream file(path);
+
+    if(!file) {
+        std::stringstream ss;
+
+        ss << "Could not write memory snapshot to " << path << "." << std::endl;
+
+        throw std::runtime_error(ss.str());
+    }
+
+    file << MemoryTracker::to_json(this->snapshot(true));
+}
\ No newline at end of file
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <pepng.h>
+
+/**
+ * One GL allocation (or group of buffers of a Model) and its CPU side data.
+ */
+struct MemoryRecord {
+    // Kind of resource: "model", "texture", "buffer", "target"...
+    std::string tag;
+    // Name of the first Object using it.
+    std::string owner;
+    // File it was loaded from, empty if unknown or generated.
+    std::string source;
+    // Number of Objects using it.
+    size_t users = 0;
+    size_t gpu_bytes = 0;
+    size_t cpu_bytes = 0;
+    // FNV-1a of the GL contents (0 when not hashed or not readable).
+    uint64_t hash = 0;
+};
+
+/**
+ * Accounts GPU and CPU memory per resource.
+ *
+ * Engine resources cannot be hooked at allocation, so renderers report the Models/Textures they use
+ * and they are measured from GL when a snapshot is taken. Allocations made by this code base are tracked explicitly.
+ */
+class MemoryTracker {
+    public:
+        static std::shared_ptr<MemoryTracker> make_memory_tracker();
+
+        // Explicit allocation (replaced if key is already tracked).
+        void track(const void* key, const MemoryRecord& record);
+        void untrack(const void* key);
+
+        // Resources used by an Object (kept weakly, measured lazily).
+        void observe(std::shared_ptr<Model> model, const std::string& owner, const std::string& source = "");
+        void observe(std::shared_ptr<Texture> texture, const std::string& owner, const std::string& source = "");
+
+        // An Object stopped using a resource it observed.
+        void release(std::shared_ptr<Model> model);
+        void release(std::shared_ptr<Texture> texture);
+
+        /**
+         * Measures every live resource, largest first (ties by tag, owner and source, so dumps diff cleanly).
+         *
+         * @param hash Also hashes contents to find duplicates (reads GL memory back, desktop only).
+         */
+        std::vector<MemoryRecord> snapshot(bool hash);
+
+        // Groups of records (indices into the snapshot) sharing tag and content hash.
+        static std::vector<std::vector<size_t>> duplicates(const std::vector<MemoryRecord>& records);
+
+        static std::string to_json(const std::vector<MemoryRecord>& records);
+
+        // Writes a hashed snapshot as JSON (diffable between builds).
+        void dump(const std::filesystem::path& path);
+
+    private:
+        MemoryTracker();
+
+        template<typename T>
+        struct Observed {
+            std::weak_ptr<T> resource;
+            std::string owner;
+            std::string source;
+            size_t users;
+        };
+
+        std::unordered_map<const void*, MemoryRecord> __tracked;
+        std::unordered_map<Model*, Observed<Model>> __models;
+        std::unordered_map<Texture*, Observed<Texture>> __textures;
+};
+
+namespace pepng {
+    /**
+     * FNV-1a content hash (chain calls by passing the previous hash).
+     */
+    uint64_t content_hash(const void* data, size_t size, uint64_t hash = 14695981039346656037ull);
+
+    /**
+     * GPU bytes of a 2D Texture (mip chain included). 0 when it cannot be queried (WebGL).
+     */
+    size_t texture_bytes(std::shared_ptr<Texture> texture);
+
+    std::shared_ptr<MemoryTracker> make_memory_tracker();
+
+    /**
+     * The engine-wide MemoryTracker.
+     */
+    std::shared_ptr<MemoryTracker> memory();
+};
\ No newline at end of file
@@ -0,0 +1,321 @@
+#include "mesh.hpp"
+
+#include <cstring>
+
+#include "memory.hpp"
+#include "model_info.hpp"
+
+Mesh::Mesh() :
+    min(0.0f),
+    max(0.0f),
+    center(0.0f),
+    radius(0.0f)
+{}
+
+std::shared_ptr<Mesh> Mesh::make_mesh() {
+    std::shared_ptr<Mesh> mesh(new Mesh());
+
+    return mesh;
+}
+
+std::shared_ptr<Mesh> pepng::make_mesh() {
+    return Mesh::make_mesh();
+}
+
+size_t Mesh::triangle_count() {
+    return this->indices.size() / 3;
+}
+
+void Mesh::compute_bounds() {
+    if(this->positions.empty()) {
+        this->min = this->max = this->center = glm::vec3(0.0f);
+        this->radius = 0.0f;
+
+        return;
+    }
+
+    this->min = this->max = this->positions[0];
+
+    for(auto& position : this->positions) {
+        this->min = glm::min(this->min, position);
+        this->max = glm::max(this->max, position);
+    }
+
+    this->center = (this->min + this->max) * 0.5f;
+    this->radius = 0.0f;
+
+    for(auto& position : this->positions) {
+        this->radius = std::max(this->radius, glm::length(position - this->center));
+    }
+}
+
+#ifndef __EMSCRIPTEN__
+namespace {
+    // Reads a float attribute of the bound VAO (components per vertex). Empty when disabled or not float.
+    std::vector<float> read_attribute(GLuint index, int components) {
+        GLint enabled = 0;
+        glGetVertexAttribiv(index, GL_VERTEX_ATTRIB_ARRAY_ENABLED, &enabled);
+
+        if(!enabled) {
+            return {};
+        }
+
+        GLint buffer = 0, size = 0, type = 0, stride = 0;
+        void* pointer = nullptr;
+
+        glGetVertexAttribiv(index, GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING, &buffer);
+        glGetVertexAttribiv(index, GL_VERTEX_ATTRIB_ARRAY_SIZE, &size);
+        glGetVertexAttribiv(index, GL_VERTEX_ATTRIB_ARRAY_TYPE, &type);
+        glGetVertexAttribiv(index, GL_VERTEX_ATTRIB_ARRAY_STRIDE, &stride);
+        glGetVertexAttribPointerv(index, GL_VERTEX_ATTRIB_ARRAY_POINTER, &pointer);
+
+        if(buffer == 0 || type != GL_FLOAT || size < components) {
+            return {};
+        }
+
+        size_t element_size = size * sizeof(float);
+        size_t offset = (size_t) pointer;
+
+        if(stride == 0) {
+            stride = (GLint) element_size;
+        }
+
+        GLint byte_count = 0;
+
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        glGetBufferParameteriv(GL_ARRAY_BUFFER, GL_BUFFER_SIZE, &byte_count);
+
+        if((size_t) byte_count < offset + element_size) {
+            return {};
+        }
+
+        std::vector<unsigned char> bytes(byte_count);
+        glGetBufferSubData(GL_ARRAY_BUFFER, 0, byte_count, bytes.data());
+
+        size_t vertex_count = (byte_count - offset - element_size) / stride + 1;
+
+        std::vector<float> values(vertex_count * components);
+
+        for(size_t i = 0; i < vertex_count; i++) {
+            std::memcpy(&values[i * components], &bytes[offset + i * stride], components * sizeof(float));
+        }
+
+        return values;
+    }
+}
+#endif
+
+namespace {
+    struct PositionKey {
+        uint32_t bits[3];
+
+        bool operator==(const PositionKey& other) const {
+            return std::memcmp(this->bits, other.bits, sizeof(this->bits)) == 0;
+        }
+    };
+
+    struct PositionHash {
+        size_t operator()(const PositionKey& key) const {
+            return ((size_t) key.bits[0] * 73856093u) ^ ((size_t) key.bits[1] * 19349663u) ^ ((size_t) key.bits[2] * 83492791u);
+        }
+    };
+
+    // Meshes read back or uploaded by make_mesh_model, keyed by Model.
+    std::unordered_map<Model*, std::pair<std::weak_ptr<Model>, std::shared_ptr<Mesh>>>& mesh_cache() {
+        static std::unordered_map<Model*, std::pair<std::weak_ptr<Model>, std::shared_ptr<Mesh>>> cache;
+
+        return cache;
+    }
+
+    // Drops the Meshes of destroyed Models (their Model* may be reused by a new Model), then caches mesh.
+    void cache_mesh(std::shared_ptr<Model> model, std::shared_ptr<Mesh> mesh) {
+        auto& cache = mesh_cache();
+
+        for(auto it = cache.begin(); it != cache.end();) {
+            it = it->second.first.expired() ? cache.erase(it) : std::next(it);
+        }
+
+        cache[model.get()] = { model, mesh };
+    }
+}
+
+std::shared_ptr<Mesh> pepng::read_mesh(std::shared_ptr<Model> model) {
+    auto& cache = mesh_cache();
+
+    auto it = cache.find(model.get());
+
+    if(it != cache.end() && !it->second.first.expired()) {
+        return it->second.second;
+    }
+
+    #ifdef __EMSCRIPTEN__
+    // WebGL has no buffer read back through the GLES headers, only Meshes we uploaded are known.
+    return nullptr;
+    #else
+
+    if(!model->is_init()) {
+        model->delayed_init();
+    }
+
+    auto& info = pepng::model_info(model);
+
+    glBindVertexArray(info.vao);
+
+    auto positions = read_attribute(0, 3);
+    auto normals = read_attribute(1, 3);
+    auto uvs = read_attribute(2, 2);
+
+    std::shared_ptr<Mesh> mesh;
+
+    size_t vertex_count = positions.size() / 3;
+
+    if(vertex_count > 0) {
+        mesh = pepng::make_mesh();
+
+        mesh->positions.resize(vertex_count);
+
+        for(size_t i = 0; i < vertex_count; i++) {
+            mesh->positions[i] = glm::vec3(positions[i * 3], positions[i * 3 + 1], positions[i * 3 + 2]);
+        }
+
+        if(normals.size() / 3 >= vertex_count) {
+            mesh->normals.resize(vertex_count);
+
+            for(size_t i = 0; i < vertex_count; i++) {
+                mesh->normals[i] = glm::vec3(normals[i * 3], normals[i * 3 + 1], normals[i * 3 + 2]);
+            }
+        }
+
+        if(uvs.size() / 2 >= vertex_count) {
+            mesh->uvs.resize(vertex_count);
+
+            for(size_t i = 0; i < vertex_count; i++) {
+                mesh->uvs[i] = glm::vec2(uvs[i * 2], uvs[i * 2 + 1]);
+            }
+        }
+
+        size_t count = (size_t) model->count();
+
+        if(info.indexed) {
+            GLint byte_count = 0;
+            glGetBufferParameteriv(GL_ELEMENT_ARRAY_BUFFER, GL_BUFFER_SIZE, &byte_count);
+
+            count = std::min(count, (size_t) byte_count / sizeof(unsigned int));
+
+            mesh->indices.resize(count);
+            glGetBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, count * sizeof(unsigned int), mesh->indices.data());
+        } else {
+            count = std::min(count, vertex_count);
+
+            mesh->indices.resize(count);
+
+            for(size_t i = 0; i < count; i++) {
+                mesh->indices[i] = (unsigned int) i;
+            }
+        }
+
+        // Drops a trailing partial triangle and out of range indices.
+        mesh->indices.resize(mesh->indices.size() - mesh->indices.size() % 3);
+
+        for(auto& index : mesh->indices) {
+            if(index >= vertex_count) {
+                index = 0;
+            }
+        }
+
+        mesh->compute_bounds();
+    }
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    cache_mesh(model, mesh);
+
+    return mesh;
+    #endif
+}
+
+std::shared_ptr<Mesh> pepng::cached_mesh(std::shared_ptr<Model> model) {
+    auto& cache = mesh_cache();
+
+    auto it = cache.find(model.get());
+
+    if(it == cache.end() || it->second.first.expired()) {
+        return nullptr;
+    }
+
+    return it->second.second;
+}
+
+std::vector<unsigned int> pepng::weld_positions(const std::vector<glm::vec3>& positions) {
+    std::unordered_map<PositionKey, unsigned int, PositionHash> ids;
+    std::vector<unsigned int> welded(positions.size());
+
+    for(size_t i = 0; i < positions.size(); i++) {
+        PositionKey key;
+        std::memcpy(key.bits, glm::value_ptr(positions[i]), sizeof(key.bits));
+
+        welded[i] = ids.try_emplace(key, (unsigned int) ids.size()).first->second;
+    }
+
+    return welded;
+}
+
+size_t pepng::mesh_bytes(std::shared_ptr<Mesh> mesh) {
+    return mesh->positions.size() * sizeof(glm::vec3)
+        + mesh->normals.size() * sizeof(glm::vec3)
+        + mesh->uvs.size() * sizeof(glm::vec2)
+        + mesh->indices.size() * sizeof(unsigned int);
+}
+
+std::shared_ptr<Model> pepng::make_mesh_model(std::shared_ptr<Mesh> mesh, std::string name) {
+    auto model = pepng::make_model()
+        ->attach_buffer(
+            pepng::make_buffer<glm::vec3>(
+                mesh->positions,
+                GL_ARRAY_BUFFER,
+                0,
+                3
+            )
+        );
+
+    if(!mesh->normals.empty()) {
+        model->attach_buffer(
+            pepng::make_buffer<glm::vec3>(
+                mesh->normals,
+                GL_ARRAY_BUFFER,
+                1,
+                3
+            )
+        );
+    }
+
+    if(!mesh->uvs.empty()) {
+        model->attach_buffer(
+            pepng::make_buffer<glm::vec2>(
+                mesh->uvs,
+                GL_ARRAY_BUFFER,
+                2,
+                2
+            )
+        );
+    }
+
+    model
+        ->attach_buffer(
+            pepng::make_buffer<int>(
+                std::vector<int>(mesh->indices.begin(), mesh->indices.end()),
+                GL_ELEMENT_ARRAY_BUFFER
+            )
+        )
+        ->set_element_array(true)
+        ->set_count((int) mesh->indices.size())
+        ->set_name(name);
+
+    // Saves the read back (and makes the Mesh reachable on WebGL).
+    cache_mesh(model, mesh);
+
+    pepng::memory()->observe(model, name, "generated");
+
+    return model;
+}
\ No newline at end of file
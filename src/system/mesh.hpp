@@ -0,0 +1,64 @@
+#pragma once
+
+#include <pepng.h>
+
+/**
+ * CPU copy of indexed triangle geometry (layout of the object shader: position 0, normal 1, UV 2).
+ */
+class Mesh {
+    public:
+        static std::shared_ptr<Mesh> make_mesh();
+
+        std::vector<glm::vec3> positions;
+        // Either empty or one per position.
+        std::vector<glm::vec3> normals;
+        // Either empty or one per position.
+        std::vector<glm::vec2> uvs;
+        std::vector<unsigned int> indices;
+
+        // Object space bounds (updated by compute_bounds).
+        glm::vec3 min;
+        glm::vec3 max;
+        glm::vec3 center;
+        float radius;
+
+        void compute_bounds();
+
+        size_t triangle_count();
+
+    private:
+        Mesh();
+};
+
+namespace pepng {
+    std::shared_ptr<Mesh> make_mesh();
+
+    /**
+     * Reads the geometry of a Model back from its GL buffers (cached per Model).
+     *
+     * The engine does not keep CPU copies of loaded Models, so this is the only way to reach them.
+     *
+     * @return nullptr when read back is not available (WebGL, unless made by make_mesh_model) or the Model has no float positions.
+     */
+    std::shared_ptr<Mesh> read_mesh(std::shared_ptr<Model> model);
+
+    /**
+     * The Mesh of a Model if it was already read back or uploaded (never touches GL).
+     */
+    std::shared_ptr<Mesh> cached_mesh(std::shared_ptr<Model> model);
+
+    /**
+     * Welds vertices split by normals/UVs: the id of each position, numbered in order of first appearance.
+     *
+     * Positions are compared bit for bit (no epsilon).
+     */
+    std::vector<unsigned int> weld_positions(const std::vector<glm::vec3>& positions);
+
+    // CPU bytes of a Mesh.
+    size_t mesh_bytes(std::shared_ptr<Mesh> mesh);
+
+    /**
+     * Uploads a Mesh as a new indexed Model.
+     */
+    std::shared_ptr<Model> make_mesh_model(std::shared_ptr<Mesh> mesh, std::string name);
+};
\ No newline at end of file
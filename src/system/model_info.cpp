@@ -0,0 +1,71 @@
+#include "model_info.hpp"
+
+namespace {
+    struct CachedModelInfo {
+        // Guards against a new Model reusing the address of a destroyed one.
+        std::weak_ptr<Model> model;
+        ModelInfo info;
+    };
+}
+
+const ModelInfo& pepng::model_info(std::shared_ptr<Model> model) {
+    static std::unordered_map<Model*, CachedModelInfo> cache;
+
+    auto it = cache.find(model.get());
+
+    if(it != cache.end() && !it->second.model.expired()) {
+        return it->second.info;
+    }
+
+    ModelInfo info;
+    info.vao = model->vao();
+
+    GLint element_buffer = 0;
+
+    GLint max_attributes = 0;
+    glGetIntegerv(GL_MAX_VERTEX_ATTRIBS, &max_attributes);
+
+    glBindVertexArray(info.vao);
+    glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &element_buffer);
+
+    for(GLint i = 0; i < max_attributes; i++) {
+        GLint enabled = GL_FALSE, buffer = 0;
+        glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_ENABLED, &enabled);
+        glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING, &buffer);
+
+        if(enabled != GL_FALSE && buffer != 0
+            && std::find(info.vertex_buffers.begin(), info.vertex_buffers.end(), (GLuint) buffer) == info.vertex_buffers.end()) {
+            info.vertex_buffers.push_back((GLuint) buffer);
+        }
+    }
+
+    glBindVertexArray(0);
+
+    info.indexed = element_buffer != 0;
+    info.element_buffer = (GLuint) element_buffer;
+
+    auto& cached = cache[model.get()];
+    cached.model = model;
+    cached.info = info;
+
+    return cached.info;
+}
+
+glm::mat4 pepng::model_matrix(std::shared_ptr<Transform> transform, std::shared_ptr<Model> model) {
+    return transform->parent_matrix
+        * glm::translate(glm::mat4(1.0f), model->offset())
+        * transform->world_matrix()
+        * glm::translate(glm::mat4(1.0f), -model->offset());
+}
+
+void pepng::record_draw(CommandList& list, std::shared_ptr<Model> model, GLenum render_mode) {
+    auto& info = pepng::model_info(model);
+
+    list.bind_vertex_array(info.vao);
+
+    if(info.indexed) {
+        list.draw_elements(render_mode, model->count(), GL_UNSIGNED_INT, 0);
+    } else {
+        list.draw_arrays(render_mode, 0, model->count());
+    }
+}
\ No newline at end of file
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <pepng.h>
+
+#include "command_list.hpp"
+
+/**
+ * GL layout of a Model that the engine does not expose (queried once from its VAO).
+ */
+struct ModelInfo {
+    GLuint vao;
+    // Whether the VAO has an element buffer (indices are GL_UNSIGNED_INT like make_buffer<int>).
+    bool indexed;
+    GLuint element_buffer;
+    // Buffers of the enabled vertex attributes (without duplicates).
+    std::vector<GLuint> vertex_buffers;
+};
+
+namespace pepng {
+    /**
+     * Cached ModelInfo of a Model. The Model must be initialized.
+     */
+    const ModelInfo& model_info(std::shared_ptr<Model> model);
+
+    /**
+     * World matrix of a Model under a Transform (rotations/scales happen around the Model offset).
+     */
+    glm::mat4 model_matrix(std::shared_ptr<Transform> transform, std::shared_ptr<Model> model);
+
+    /**
+     * Records the VAO bind and the draw of a whole Model.
+     */
+    void record_draw(CommandList& list, std::shared_ptr<Model> model, GLenum render_mode);
+};
\ No newline at end of file
@@ -0,0 +1,205 @@
+#include "multi_view.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+#include "job_system.hpp"
+#include "lighting.hpp"
+#include "render_mode.hpp"
+
+MultiView::MultiView() :
+    enabled(false)
+{}
+
+std::shared_ptr<MultiView> MultiView::make_multi_view() {
+    std::shared_ptr<MultiView> multi_view(new MultiView());
+
+    return multi_view;
+}
+
+std::shared_ptr<MultiView> pepng::make_multi_view() {
+    return MultiView::make_multi_view();
+}
+
+std::shared_ptr<MultiView> pepng::multi_view() {
+    static auto multi_view = pepng::make_multi_view();
+
+    return multi_view;
+}
+
+void MultiView::add_view(std::shared_ptr<Object> eye, const glm::vec4& rect, float fov, float near_plane, float far_plane) {
+    if(eye->get_component<Transform>() == nullptr) {
+        std::stringstream ss;
+
+        ss << *eye << " has no transform to place a view." << std::endl;
+
+        throw std::runtime_error(ss.str());
+    }
+
+    this->__eyes.push_back(Eye { eye, rect, fov, near_plane, far_plane });
+}
+
+bool MultiView::active() {
+    return this->enabled && !this->__eyes.empty();
+}
+
+const MultiView::Stats& MultiView::stats() {
+    return this->__stats;
+}
+
+void MultiView::submit(const Item& item, const View& view) {
+    if(this->__items.empty()) {
+        this->__main = view;
+    }
+
+    this->__items.push_back(item);
+}
+
+void MultiView::__build_views() {
+    this->__views.clear();
+    this->__rects.clear();
+
+    this->__views.push_back(this->__main);
+    this->__rects.push_back(glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
+
+    auto& window = this->__main.viewport;
+
+    for(auto& eye : this->__eyes) {
+        auto object = eye.object.lock();
+
+        if(object == nullptr) {
+            continue;
+        }
+
+        auto transform = object->get_component<Transform>();
+
+        glm::ivec4 viewport(
+            window.x + (int) (eye.rect.x * window.z),
+            window.y + (int) (eye.rect.y * window.w),
+            std::max(1, (int) (eye.rect.z * window.z)),
+            std::max(1, (int) (eye.rect.w * window.w)));
+
+        glm::mat4 view = glm::inverse(transform->parent_matrix * transform->world_matrix());
+        glm::mat4 projection = glm::perspective(eye.fov, (float) viewport.z / (float) viewport.w, eye.near_plane, eye.far_plane);
+
+        this->__views.push_back(pepng::make_view(view, projection, viewport));
+        this->__rects.push_back(eye.rect);
+    }
+
+    this->__eyes.erase(std::remove_if(this->__eyes.begin(), this->__eyes.end(), [](const Eye& eye) {
+        return eye.object.expired();
+    }), this->__eyes.end());
+}
+
+void MultiView::record(CommandList& list) {
+    auto& items = this->__items;
+
+    this->__stats = Stats();
+
+    if(items.empty()) {
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    // Camera independent work, once per frame.
+    size_t count = items.size();
+
+    this->__local.resize(count);
+    this->__worlds.resize(count);
+    this->__payloads.resize(count);
+    this->__order.resize(count);
+
+    for(size_t i = 0; i < count; i++) {
+        this->__local.set(i, items[i].min, items[i].max);
+        this->__worlds[i] = items[i].world;
+        this->__payloads[i] = list.push_matrix(items[i].world);
+        this->__order[i] = (uint32_t) i;
+    }
+
+    pepng::transform_aabbs(this->__worlds.data(), this->__local, this->__world);
+
+    std::sort(this->__order.begin(), this->__order.end(), [&items](uint32_t a, uint32_t b) {
+        return items[a].program != items[b].program ? items[a].program < items[b].program : items[a].texture < items[b].texture;
+    });
+
+    auto culled = std::chrono::steady_clock::now();
+
+    // One frustum test job per view over the shared world bounds.
+    this->__build_views();
+    this->__visible.resize(this->__views.size());
+
+    pepng::jobs()->parallel_for(this->__views.size(), [this](size_t v) {
+        this->__visible[v].resize(this->__world.min_x.size());
+
+        pepng::frustum_test(this->__views[v].planes, this->__world, this->__visible[v].data());
+    });
+
+    auto end = std::chrono::steady_clock::now();
+
+    this->__stats.views = this->__views.size();
+    this->__stats.items = count;
+    this->__stats.bounds_ms = std::chrono::duration<float, std::milli>(culled - start).count();
+    this->__stats.cull_ms = std::chrono::duration<float, std::milli>(end - culled).count();
+
+    for(size_t v = 0; v < this->__views.size(); v++) {
+        this->__record_view(list, v);
+    }
+
+    items.clear();
+}
+
+void MultiView::__record_view(CommandList& list, size_t v) {
+    auto& view = this->__views[v];
+    auto& visible = this->__visible[v];
+
+    size_t drawn = 0;
+    GLuint program = 0;
+
+    list.viewport(this->__rects[v], v > 0);
+
+    for(auto i : this->__order) {
+        if(!visible[i]) {
+            continue;
+        }
+
+        auto& item = this->__items[i];
+
+        // Camera uniforms once per program and view.
+        if(item.program != program) {
+            program = item.program;
+
+            list.use_program(program);
+            list.uniform(pepng::uniform_location(program, "u_projection"), view.projection);
+            list.uniform(pepng::uniform_location(program, "u_view"), view.view);
+
+            // The light clusters are binned for the main camera, so extra views are unlit.
+            if(v == 0) {
+                pepng::lighting()->record(list, program, view);
+            } else {
+                list.uniform(pepng::uniform_location(program, "u_lighting"), 0.0f);
+            }
+
+            // The sorted transparent pass is single view, every view draws opaque.
+            list.uniform(pepng::uniform_location(program, "u_alpha_cutoff"), 0.0f);
+            list.uniform(pepng::uniform_location(program, "u_blend"), 0.0f);
+        }
+
+        GLint u_has_color = pepng::uniform_location(program, "u_has_color");
+
+        if(item.color.x >= 0) {
+            list.uniform(u_has_color, (float) GL_TRUE);
+            list.uniform(pepng::uniform_location(program, "u_color"), item.color);
+        } else {
+            list.uniform(u_has_color, (float) GL_FALSE);
+        }
+
+        list.bind_texture(0, GL_TEXTURE_2D, item.texture);
+        list.uniform(pepng::uniform_location(program, "u_world"), this->__payloads[i]);
+        pepng::record_draw_override(list, item.model, item.render_mode);
+
+        drawn++;
+    }
+
+    this->__stats.drawn.push_back(drawn);
+}
\ No newline at end of file
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <pepng.h>
+
+#include "command_list.hpp"
+#include "simd_math.hpp"
+#include "view.hpp"
+
+/**
+ * Renders the scene for the main camera and extra views (split screen, picture in picture) in one pass.
+ *
+ * While active, ExtraRenderers submit their draw here instead of recording it. Before the list is
+ * submitted, the world bounds and per-object uniforms of every draw are computed once, each view is
+ * frustum culled in parallel against those shared bounds, and only the camera uniforms and the
+ * visible draws are recorded per view (the world matrices are stored once in the payload arena).
+ */
+class MultiView {
+    public:
+        static std::shared_ptr<MultiView> make_multi_view();
+
+        // Opt-in (also needs at least one extra view).
+        bool enabled;
+
+        struct Item {
+            GLuint program;
+            glm::mat4 world;
+            // Object space bounds.
+            glm::vec3 min;
+            glm::vec3 max;
+            std::shared_ptr<Model> model;
+            GLenum render_mode;
+            GLuint texture;
+            // Flat color, x < 0 if textured.
+            glm::vec3 color;
+        };
+
+        struct Stats {
+            size_t views = 0;
+            size_t items = 0;
+            // Draws recorded per view (the main view first).
+            std::vector<size_t> drawn;
+            float bounds_ms = 0.0f;
+            float cull_ms = 0.0f;
+        };
+
+        /**
+         * Adds a view drawn over the main one.
+         *
+         * @param eye Object whose Transform places the view (looking down its -z).
+         * @param rect x, y, width, height relative to the window (origin bottom left).
+         * @param fov Vertical field of view (radians).
+         */
+        void add_view(std::shared_ptr<Object> eye, const glm::vec4& rect, float fov = glm::radians(60.0f), float near_plane = 0.1f, float far_plane = 1000.0f);
+
+        // True if renderers should submit here this frame.
+        bool active();
+
+        /**
+         * Queues a draw for every view.
+         *
+         * @param view The main camera's View.
+         */
+        void submit(const Item& item, const View& view);
+
+        /**
+         * Culls the queued draws and records them for every view (called before the list is submitted).
+         */
+        void record(CommandList& list);
+
+        // Statistics of the last recorded frame.
+        const Stats& stats();
+
+        // Bounds used for draws without a readable Mesh (never culled).
+        static constexpr float UNBOUNDED = 1e30f;
+
+    private:
+        MultiView();
+
+        struct Eye {
+            std::weak_ptr<Object> object;
+            glm::vec4 rect;
+            float fov;
+            float near_plane;
+            float far_plane;
+        };
+
+        void __build_views();
+        void __record_view(CommandList& list, size_t v);
+
+        std::vector<Eye> __eyes;
+
+        std::vector<Item> __items;
+        View __main;
+
+        // Shared by all views.
+        AabbArray __local;
+        AabbArray __world;
+        std::vector<glm::mat4> __worlds;
+        std::vector<size_t> __payloads;
+        // Items sorted by program then texture (fewer state changes in every view).
+        std::vector<uint32_t> __order;
+
+        // Views of the frame (the main one first), with their rectangle and visibility (one byte per item).
+        std::vector<View> __views;
+        std::vector<glm::vec4> __rects;
+        std::vector<std::vector<uint8_t>> __visible;
+
+        Stats __stats;
+};
+
+namespace pepng {
+    std::shared_ptr<MultiView> make_multi_view();
+
+    /**
+     * The engine-wide MultiView used by ExtraRenderer and CommandFlush.
+     */
+    std::shared_ptr<MultiView> multi_view();
+};
\ No newline at end of file
@@ -0,0 +1,127 @@
+#include "number_parsing.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+
+namespace {
+    // from_chars rejects the '+' sign exporters sometimes write.
+    const char* skip_plus(const char* it, const char* end) {
+        return it < end && *it == '+' ? it + 1 : it;
+    }
+
+    #if !defined(__cpp_lib_to_chars)
+    bool is_digit(const char* it, const char* end) {
+        return it < end && *it >= '0' && *it <= '9';
+    }
+
+    /**
+     * Decimal float for toolchains without float from_chars (libc++, Emscripten).
+     *
+     * Stops at end (mapped files are not null terminated) and ignores the locale, unlike strtof.
+     * The first 19 significant digits are kept, and the scaling is done in double precision.
+     */
+    const char* parse_float(const char* it, const char* end, float& value) {
+        bool negative = it < end && *it == '-';
+
+        if(negative) {
+            it++;
+        }
+
+        uint64_t mantissa = 0;
+        int digits = 0;
+        int exponent = 0;
+        bool any = false;
+
+        for(; is_digit(it, end); it++) {
+            any = true;
+
+            if(digits < 19) {
+                mantissa = mantissa * 10 + (uint64_t) (*it - '0');
+                digits += mantissa != 0;
+            } else {
+                exponent++;
+            }
+        }
+
+        if(it < end && *it == '.') {
+            for(it++; is_digit(it, end); it++) {
+                any = true;
+
+                if(digits < 19) {
+                    mantissa = mantissa * 10 + (uint64_t) (*it - '0');
+                    digits += mantissa != 0;
+                    exponent--;
+                }
+            }
+        }
+
+        if(!any) {
+            return nullptr;
+        }
+
+        // The exponent only counts with digits after the 'e' (otherwise the number ends before it).
+        if(it < end && (*it == 'e' || *it == 'E')) {
+            const char* next = it + 1;
+            bool negative_exponent = next < end && *next == '-';
+
+            if(next < end && (*next == '-' || *next == '+')) {
+                next++;
+            }
+
+            if(is_digit(next, end)) {
+                int written = 0;
+
+                for(; is_digit(next, end); next++) {
+                    // Past this, the value is 0 or infinite anyway.
+                    written = std::min(written * 10 + (*next - '0'), 100000);
+                }
+
+                exponent += negative_exponent ? -written : written;
+                it = next;
+            }
+        }
+
+        double result = (double) mantissa;
+
+        if(mantissa != 0 && exponent != 0) {
+            double scale = std::pow(10.0, (double) std::abs(exponent));
+
+            result = exponent < 0 ? result / scale : result * scale;
+        }
+
+        value = (float) (negative ? -result : result);
+
+        return it;
+    }
+    #endif
+}
+
+const char* pepng::parse_number(const char* it, const char* end, float& value) {
+    it = skip_plus(it, end);
+
+    #if defined(__cpp_lib_to_chars)
+    auto result = std::from_chars(it, end, value);
+
+    return result.ec == std::errc() ? result.ptr : nullptr;
+    #else
+    return parse_float(it, end, value);
+    #endif
+}
+
+const char* pepng::parse_number(const char* it, const char* end, int& value) {
+    it = skip_plus(it, end);
+
+    auto result = std::from_chars(it, end, value);
+
+    return result.ec == std::errc() ? result.ptr : nullptr;
+}
+
+const char* pepng::parse_number(const char* it, const char* end, unsigned int& value) {
+    it = skip_plus(it, end);
+
+    auto result = std::from_chars(it, end, value);
+
+    return result.ec == std::errc() ? result.ptr : nullptr;
+}
\ No newline at end of file
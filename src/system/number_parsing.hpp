@@ -0,0 +1,16 @@
+#pragma once
+
+#include <pepng.h>
+
+/**
+ * Locale-independent number parsing for the text model loaders (std::from_chars, or a parser bounded by end
+ * where the standard library has no float from_chars).
+ *
+ * Every function parses one number starting at it (no leading whitespace) and returns
+ * the first character after it, or nullptr if there is no number there.
+ */
+namespace pepng {
+    const char* parse_number(const char* it, const char* end, float& value);
+    const char* parse_number(const char* it, const char* end, int& value);
+    const char* parse_number(const char* it, const char* end, unsigned int& value);
+};
\ No newline at end of file
@@ -0,0 +1,575 @@
+#include "obj.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <string_view>
+
+#include "job_system.hpp"
+#include "mapped_file.hpp"
+#include "number_parsing.hpp"
+
+namespace {
+    bool is_space(char c) {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    std::string_view trim(std::string_view text) {
+        while(!text.empty() && is_space(text.front())) {
+            text.remove_prefix(1);
+        }
+
+        while(!text.empty() && is_space(text.back())) {
+            text.remove_suffix(1);
+        }
+
+        return text;
+    }
+
+    [[noreturn]] void parse_error(const std::filesystem::path& path, const std::string& message, size_t offset) {
+        std::stringstream ss;
+
+        ss << "OBJ: " << message << " in " << path << " (byte " << offset << ")." << std::endl;
+
+        throw std::runtime_error(ss.str());
+    }
+
+    // Position, UV and normal indices, 0-based (-1 when missing).
+    struct Corner {
+        int index[3];
+
+        bool operator==(const Corner& other) const {
+            return std::memcmp(this->index, other.index, sizeof(this->index)) == 0;
+        }
+    };
+
+    struct CornerHash {
+        size_t operator()(const Corner& corner) const {
+            return ((size_t) corner.index[0] * 73856093u) ^ ((size_t) corner.index[1] * 19349663u) ^ ((size_t) corner.index[2] * 83492791u);
+        }
+    };
+
+    // An o/g or usemtl statement, applying from a triangle of its chunk on.
+    struct Switch {
+        size_t triangle;
+        bool material;
+        std::string_view name;
+    };
+
+    struct Chunk {
+        size_t begin;
+        size_t end;
+
+        std::vector<glm::vec3> positions;
+        std::vector<glm::vec2> uvs;
+        std::vector<glm::vec3> normals;
+
+        // Three per triangle.
+        std::vector<Corner> corners;
+
+        // Slots (corner * 3 + attribute) of negative indices, relative to this chunk until fixed up.
+        std::vector<size_t> relative;
+
+        std::vector<Switch> switches;
+        std::vector<std::string_view> libraries;
+    };
+
+    class LineParser {
+        public:
+            LineParser(const std::filesystem::path& path, std::string_view source, const char* it, const char* end) :
+                __path(path),
+                __source(source),
+                __it(it),
+                __end(end)
+            {}
+
+            void skip_space() {
+                while(this->__it < this->__end && is_space(*this->__it)) {
+                    this->__it++;
+                }
+            }
+
+            bool done() {
+                this->skip_space();
+
+                return this->__it >= this->__end;
+            }
+
+            std::string_view word() {
+                this->skip_space();
+
+                const char* begin = this->__it;
+
+                while(this->__it < this->__end && !is_space(*this->__it)) {
+                    this->__it++;
+                }
+
+                return std::string_view(begin, this->__it - begin);
+            }
+
+            std::string_view rest() {
+                auto text = trim(std::string_view(this->__it, this->__end - this->__it));
+                this->__it = this->__end;
+
+                return text;
+            }
+
+            // Reads up to count floats, throws if fewer than required.
+            void floats(float* values, int count, int required) {
+                for(int i = 0; i < count; i++) {
+                    if(this->done()) {
+                        if(i < required) {
+                            this->error("missing number");
+                        }
+
+                        return;
+                    }
+
+                    this->number(values[i]);
+                }
+            }
+
+            template<typename T>
+            void number(T& value) {
+                const char* next = pepng::parse_number(this->__it, this->__end, value);
+
+                if(next == nullptr) {
+                    this->error("invalid number");
+                }
+
+                this->__it = next;
+            }
+
+            bool peek(char c) {
+                return this->__it < this->__end && *this->__it == c;
+            }
+
+            void advance() {
+                this->__it++;
+            }
+
+            [[noreturn]] void error(const std::string& message) {
+                parse_error(this->__path, message, this->__it - this->__source.data());
+            }
+
+        private:
+            const std::filesystem::path& __path;
+            std::string_view __source;
+            const char* __it;
+            const char* __end;
+    };
+
+    void parse_chunk(const std::filesystem::path& path, std::string_view source, Chunk& chunk) {
+        const char* it = source.data() + chunk.begin;
+        const char* end = source.data() + chunk.end;
+
+        // Rough guess (bytes per statement) so the tables rarely reallocate.
+        size_t guess = (chunk.end - chunk.begin) / 40;
+        chunk.positions.reserve(guess);
+        chunk.corners.reserve(guess * 3);
+
+        std::vector<Corner> face;
+        std::vector<int> face_relative;
+
+        while(it < end) {
+            const char* line_end = (const char*) std::memchr(it, '\n', end - it);
+
+            if(line_end == nullptr) {
+                line_end = end;
+            }
+
+            LineParser line(path, source, it, line_end);
+            it = line_end + 1;
+
+            auto keyword = line.word();
+
+            if(keyword.empty() || keyword.front() == '#') {
+                continue;
+            }
+
+            if(keyword == "v") {
+                glm::vec3 position(0.0f);
+                line.floats(&position.x, 3, 3);
+                chunk.positions.push_back(position);
+            } else if(keyword == "vt") {
+                glm::vec2 uv(0.0f);
+                line.floats(&uv.x, 2, 1);
+                chunk.uvs.push_back(uv);
+            } else if(keyword == "vn") {
+                glm::vec3 normal(0.0f);
+                line.floats(&normal.x, 3, 3);
+                chunk.normals.push_back(normal);
+            } else if(keyword == "f") {
+                face.clear();
+                face_relative.clear();
+
+                int counts[3] = { (int) chunk.positions.size(), (int) chunk.uvs.size(), (int) chunk.normals.size() };
+
+                while(!line.done()) {
+                    Corner corner { { -1, -1, -1 } };
+                    int relative = 0;
+
+                    for(int attribute = 0; attribute < 3; attribute++) {
+                        if(attribute > 0) {
+                            if(!line.peek('/')) {
+                                break;
+                            }
+
+                            line.advance();
+
+                            // "v//vn"
+                            if(line.peek('/')) {
+                                continue;
+                            }
+                        }
+
+                        int value;
+                        line.number(value);
+
+                        if(value == 0) {
+                            line.error("index 0");
+                        }
+
+                        if(value > 0) {
+                            corner.index[attribute] = value - 1;
+                        } else {
+                            // Relative to this chunk for now (may point into a previous chunk).
+                            corner.index[attribute] = counts[attribute] + value;
+                            relative |= 1 << attribute;
+                        }
+                    }
+
+                    face.push_back(corner);
+                    face_relative.push_back(relative);
+                }
+
+                if(face.size() < 3) {
+                    line.error("face with less than 3 corners");
+                }
+
+                auto emit = [&](size_t i) {
+                    for(int attribute = 0; attribute < 3; attribute++) {
+                        if(face_relative[i] & (1 << attribute)) {
+                            chunk.relative.push_back(chunk.corners.size() * 3 + attribute);
+                        }
+                    }
+
+                    chunk.corners.push_back(face[i]);
+                };
+
+                for(size_t i = 1; i + 1 < face.size(); i++) {
+                    emit(0);
+                    emit(i);
+                    emit(i + 1);
+                }
+            } else if(keyword == "o" || keyword == "g") {
+                chunk.switches.push_back({ chunk.corners.size() / 3, false, line.rest() });
+            } else if(keyword == "usemtl") {
+                chunk.switches.push_back({ chunk.corners.size() / 3, true, line.rest() });
+            } else if(keyword == "mtllib") {
+                while(!line.done()) {
+                    chunk.libraries.push_back(line.word());
+                }
+            }
+        }
+    }
+
+    std::vector<ObjMaterial> parse_library(const std::filesystem::path& path) {
+        auto file = pepng::map_file(path);
+        auto source = file->view();
+
+        std::vector<ObjMaterial> materials;
+
+        const char* it = source.data();
+        const char* end = it + source.size();
+
+        while(it < end) {
+            const char* line_end = (const char*) std::memchr(it, '\n', end - it);
+
+            if(line_end == nullptr) {
+                line_end = end;
+            }
+
+            LineParser line(path, source, it, line_end);
+            it = line_end + 1;
+
+            auto keyword = line.word();
+
+            if(keyword.empty() || keyword.front() == '#') {
+                continue;
+            }
+
+            if(keyword == "newmtl") {
+                materials.push_back(ObjMaterial());
+                materials.back().name = std::string(line.rest());
+
+                continue;
+            }
+
+            if(materials.empty()) {
+                continue;
+            }
+
+            auto& material = materials.back();
+
+            if(keyword == "Ka") {
+                line.floats(&material.ambient.x, 3, 1);
+            } else if(keyword == "Kd") {
+                line.floats(&material.diffuse.x, 3, 1);
+            } else if(keyword == "Ks") {
+                line.floats(&material.specular.x, 3, 1);
+            } else if(keyword == "Ns") {
+                line.floats(&material.shininess, 1, 1);
+            } else if(keyword == "d") {
+                line.floats(&material.opacity, 1, 1);
+            } else if(keyword == "Tr") {
+                float transparency = 0.0f;
+                line.floats(&transparency, 1, 1);
+                material.opacity = 1.0f - transparency;
+            } else if(keyword == "map_Kd") {
+                // Options ("-bm 1" ...) come before the file name.
+                std::string_view file_name;
+
+                while(!line.done()) {
+                    file_name = line.word();
+                }
+
+                material.diffuse_map = path.parent_path() / std::string(file_name);
+            }
+        }
+
+        return materials;
+    }
+
+    // A run of triangles of one chunk.
+    struct Span {
+        size_t chunk;
+        size_t begin;
+        size_t end;
+    };
+
+    std::shared_ptr<Mesh> weld(const std::filesystem::path& path, const std::vector<Chunk>& chunks, const std::vector<Span>& spans,
+        const std::vector<glm::vec3>& positions, const std::vector<glm::vec2>& uvs, const std::vector<glm::vec3>& normals) {
+        auto mesh = pepng::make_mesh();
+
+        size_t corner_count = 0;
+
+        for(auto& span : spans) {
+            corner_count += (span.end - span.begin) * 3;
+        }
+
+        std::unordered_map<Corner, unsigned int, CornerHash> welded;
+        welded.reserve(corner_count / 2);
+        mesh->indices.reserve(corner_count);
+
+        bool has_uvs = false;
+        bool has_normals = false;
+        const int sizes[3] = { (int) positions.size(), (int) uvs.size(), (int) normals.size() };
+
+        for(auto& span : spans) {
+            for(size_t c = span.begin * 3; c < span.end * 3; c++) {
+                auto& corner = chunks[span.chunk].corners[c];
+
+                auto [it, inserted] = welded.try_emplace(corner, (unsigned int) mesh->positions.size());
+
+                if(inserted) {
+                    for(int attribute = 0; attribute < 3; attribute++) {
+                        // Only UVs and normals may be missing (-1).
+                        if(corner.index[attribute] >= sizes[attribute] || corner.index[attribute] < (attribute == 0 ? 0 : -1)) {
+                            std::stringstream ss;
+
+                            ss << "OBJ: face index out of range in " << path << "." << std::endl;
+
+                            throw std::runtime_error(ss.str());
+                        }
+                    }
+
+                    mesh->positions.push_back(positions[corner.index[0]]);
+                    mesh->uvs.push_back(corner.index[1] >= 0 ? uvs[corner.index[1]] : glm::vec2(0.0f));
+                    mesh->normals.push_back(corner.index[2] >= 0 ? normals[corner.index[2]] : glm::vec3(0.0f));
+
+                    has_uvs = has_uvs || corner.index[1] >= 0;
+                    has_normals = has_normals || corner.index[2] >= 0;
+                }
+
+                mesh->indices.push_back(it->second);
+            }
+        }
+
+        if(!has_uvs) {
+            mesh->uvs.clear();
+        }
+
+        if(!has_normals) {
+            mesh->normals.clear();
+        }
+
+        mesh->compute_bounds();
+
+        return mesh;
+    }
+}
+
+ObjScene::ObjScene() :
+    chunk_count(0),
+    parse_ms(0.0f)
+{}
+
+std::shared_ptr<ObjScene> ObjScene::make_obj_scene() {
+    std::shared_ptr<ObjScene> scene(new ObjScene());
+
+    return scene;
+}
+
+std::shared_ptr<ObjScene> pepng::make_obj_scene() {
+    return ObjScene::make_obj_scene();
+}
+
+std::shared_ptr<ObjScene> pepng::load_obj(const std::filesystem::path& path, size_t chunk_size) {
+    auto start = std::chrono::steady_clock::now();
+
+    auto file = pepng::map_file(path);
+    auto source = file->view();
+
+    auto jobs = pepng::jobs();
+    auto scene = pepng::make_obj_scene();
+
+    // Chunks end after a newline, so no statement is split.
+    size_t chunk_count = std::max<size_t>(1, source.size() / std::max<size_t>(1, chunk_size));
+    std::vector<Chunk> chunks;
+
+    for(size_t i = 0, begin = 0; i < chunk_count && begin < source.size(); i++) {
+        size_t end = i + 1 == chunk_count ? source.size() : source.find('\n', std::max(begin, source.size() * (i + 1) / chunk_count));
+        end = end == std::string_view::npos ? source.size() : std::min(end + 1, source.size());
+
+        Chunk chunk;
+        chunk.begin = begin;
+        chunk.end = end;
+        chunks.push_back(std::move(chunk));
+
+        begin = end;
+    }
+
+    scene->chunk_count = chunks.size();
+
+    jobs->parallel_for(chunks.size(), [&](size_t i) {
+        parse_chunk(path, source, chunks[i]);
+    });
+
+    // Offsets of every chunk in the merged tables.
+    std::vector<size_t> offsets(chunks.size() * 3);
+    size_t totals[3] = { 0, 0, 0 };
+
+    for(size_t i = 0; i < chunks.size(); i++) {
+        size_t sizes[3] = { chunks[i].positions.size(), chunks[i].uvs.size(), chunks[i].normals.size() };
+
+        for(int attribute = 0; attribute < 3; attribute++) {
+            offsets[i * 3 + attribute] = totals[attribute];
+            totals[attribute] += sizes[attribute];
+        }
+    }
+
+    std::vector<glm::vec3> positions(totals[0]);
+    std::vector<glm::vec2> uvs(totals[1]);
+    std::vector<glm::vec3> normals(totals[2]);
+
+    jobs->parallel_for(chunks.size(), [&](size_t i) {
+        auto& chunk = chunks[i];
+
+        std::copy(chunk.positions.begin(), chunk.positions.end(), positions.begin() + offsets[i * 3]);
+        std::copy(chunk.uvs.begin(), chunk.uvs.end(), uvs.begin() + offsets[i * 3 + 1]);
+        std::copy(chunk.normals.begin(), chunk.normals.end(), normals.begin() + offsets[i * 3 + 2]);
+
+        for(auto slot : chunk.relative) {
+            chunk.corners[slot / 3].index[slot % 3] += (int) offsets[i * 3 + slot % 3];
+        }
+
+        chunk.positions = {};
+        chunk.uvs = {};
+        chunk.normals = {};
+    });
+
+    // Groups the triangle runs by (object, material), in file order.
+    std::map<std::pair<std::string_view, std::string_view>, size_t> shape_index;
+    std::vector<std::vector<Span>> shape_spans;
+    std::vector<std::string_view> shape_materials;
+    std::vector<std::string_view> libraries;
+
+    std::string_view object;
+    std::string_view material;
+
+    for(size_t i = 0; i < chunks.size(); i++) {
+        auto& chunk = chunks[i];
+        size_t triangle_count = chunk.corners.size() / 3;
+        size_t begin = 0;
+
+        libraries.insert(libraries.end(), chunk.libraries.begin(), chunk.libraries.end());
+
+        auto add_span = [&](size_t end) {
+            if(end <= begin) {
+                return;
+            }
+
+            auto [it, inserted] = shape_index.try_emplace({ object, material }, shape_spans.size());
+
+            if(inserted) {
+                shape_spans.emplace_back();
+                shape_materials.push_back(material);
+
+                ObjShape shape;
+                shape.name = std::string(object);
+                shape.material = -1;
+                scene->shapes.push_back(std::move(shape));
+            }
+
+            shape_spans[it->second].push_back({ i, begin, end });
+            begin = end;
+        };
+
+        for(auto& change : chunk.switches) {
+            add_span(change.triangle);
+
+            if(change.material) {
+                material = change.name;
+            } else {
+                object = change.name;
+            }
+        }
+
+        add_span(triangle_count);
+    }
+
+    // Shapes are welded while the .mtl libraries are read.
+    std::vector<std::vector<ObjMaterial>> library_materials(libraries.size());
+
+    jobs->parallel_for(libraries.size() + scene->shapes.size(), [&](size_t i) {
+        if(i < libraries.size()) {
+            library_materials[i] = parse_library(path.parent_path() / std::string(libraries[i]));
+        } else {
+            size_t shape = i - libraries.size();
+
+            scene->shapes[shape].mesh = weld(path, chunks, shape_spans[shape], positions, uvs, normals);
+        }
+    });
+
+    std::unordered_map<std::string, int> material_index;
+
+    for(auto& materials : library_materials) {
+        for(auto& material : materials) {
+            material_index.try_emplace(material.name, (int) scene->materials.size());
+            scene->materials.push_back(std::move(material));
+        }
+    }
+
+    for(size_t i = 0; i < scene->shapes.size(); i++) {
+        auto it = material_index.find(std::string(shape_materials[i]));
+
+        if(it != material_index.end()) {
+            scene->shapes[i].material = it->second;
+        }
+    }
+
+    scene->parse_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    return scene;
+}
\ No newline at end of file
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <pepng.h>
+
+#include "mesh.hpp"
+
+/**
+ * Material of a .mtl library (the subset the object shader can use).
+ */
+struct ObjMaterial {
+    std::string name;
+    glm::vec3 ambient = glm::vec3(0.0f);
+    glm::vec3 diffuse = glm::vec3(1.0f);
+    glm::vec3 specular = glm::vec3(0.0f);
+    float shininess = 0.0f;
+    float opacity = 1.0f;
+    // Resolved against the .mtl directory. Empty if none.
+    std::filesystem::path diffuse_map;
+};
+
+/**
+ * Faces of one object/group using one material.
+ */
+struct ObjShape {
+    std::string name;
+    // Index in ObjScene::materials or -1.
+    int material;
+    std::shared_ptr<Mesh> mesh;
+};
+
+/**
+ * Geometry and materials of an OBJ file.
+ */
+class ObjScene {
+    public:
+        static std::shared_ptr<ObjScene> make_obj_scene();
+
+        std::vector<ObjShape> shapes;
+        std::vector<ObjMaterial> materials;
+
+        // Number of chunks the file was split into.
+        size_t chunk_count;
+
+        // Wall time of the load (mapping, chunks, merge, .mtl).
+        float parse_ms;
+
+    private:
+        ObjScene();
+};
+
+namespace pepng {
+    std::shared_ptr<ObjScene> make_obj_scene();
+
+    /**
+     * Loads an OBJ file and its .mtl libraries.
+     *
+     * The memory-mapped file is split at line boundaries and the chunks are parsed in parallel on the JobSystem.
+     * The per-chunk vertex tables are concatenated and relative (negative) face indices fixed up with the
+     * counts of the previous chunks. Shapes are then welded in parallel with the .mtl libraries.
+     * Faces with more than 3 corners are fan triangulated.
+     *
+     * Throws on files that cannot be opened, malformed statements or out of range indices.
+     *
+     * @param chunk_size Target bytes per chunk.
+     */
+    std::shared_ptr<ObjScene> load_obj(const std::filesystem::path& path, size_t chunk_size = 4 << 20);
+};
\ No newline at end of file
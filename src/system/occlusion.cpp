@@ -0,0 +1,439 @@
+#include "occlusion.hpp"
+
+#include <chrono>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#endif
+
+namespace {
+    // Vertices closer than this (clip w) are considered crossing the near plane.
+    constexpr float NEAR_W = 1e-4f;
+
+    float edge(const glm::vec2& a, const glm::vec2& b, const glm::vec2& p) {
+        return (b.x - a.x) * (p.y - a.y) - (b.y - a.y) * (p.x - a.x);
+    }
+}
+
+Occlusion::Occlusion() :
+    #ifdef __EMSCRIPTEN__
+    // WebGL results come back late and there is no conditional render.
+    mode(OcclusionMode::CPU),
+    #else
+    mode(OcclusionMode::GPU),
+    #endif
+    __frame((size_t) -1),
+    __depth(Occlusion::DEPTH_WIDTH * Occlusion::DEPTH_HEIGHT, 1.0f),
+    __rasterized(false)
+{}
+
+Occlusion::~Occlusion() {
+    for(auto& [key, query] : this->__queries) {
+        if(query.query != 0) {
+            this->__free_queries.push_back(query.query);
+        }
+    }
+
+    if(!this->__free_queries.empty()) {
+        glDeleteQueries((GLsizei) this->__free_queries.size(), this->__free_queries.data());
+    }
+
+    if(this->__box != 0) {
+        glDeleteVertexArrays(1, &this->__box);
+        glDeleteBuffers(1, &this->__box_buffer);
+
+        if(auto memory = this->__memory.lock()) {
+            memory->untrack(&this->__box);
+        }
+    }
+}
+
+std::shared_ptr<Occlusion> Occlusion::make_occlusion() {
+    std::shared_ptr<Occlusion> occlusion(new Occlusion());
+
+    return occlusion;
+}
+
+std::shared_ptr<Occlusion> pepng::make_occlusion() {
+    return Occlusion::make_occlusion();
+}
+
+std::shared_ptr<Occlusion> pepng::occlusion() {
+    static auto occlusion = pepng::make_occlusion();
+
+    return occlusion;
+}
+
+const Occlusion::Stats& Occlusion::stats() {
+    return this->__last_stats;
+}
+
+void Occlusion::add_occluder(const glm::mat4& world, std::shared_ptr<Mesh> mesh) {
+    if(mesh == nullptr || mesh->triangle_count() == 0) {
+        return;
+    }
+
+    this->__next_occluders.push_back(Occluder { world, mesh });
+}
+
+void Occlusion::forget(const void* key) {
+    auto it = this->__queries.find(key);
+
+    if(it == this->__queries.end()) {
+        return;
+    }
+
+    if(it->second.query != 0) {
+        this->__free_queries.push_back(it->second.query);
+    }
+
+    this->__queries.erase(it);
+}
+
+void Occlusion::__begin_frame() {
+    size_t frame = pepng::commands()->frame();
+
+    if(frame == this->__frame) {
+        return;
+    }
+
+    this->__frame = frame;
+    this->__last_stats = this->__stats;
+    this->__stats = Stats();
+
+    // Occluders registered during this frame's update.
+    std::swap(this->__occluders, this->__next_occluders);
+    this->__next_occluders.clear();
+
+    this->__stats.occluders = this->__occluders.size();
+    this->__rasterized = false;
+}
+
+void Occlusion::record(const void* key, CommandList& list, GLuint program, const View& view, const glm::mat4& world, std::shared_ptr<Mesh> bounds, const std::function<void()>& draw) {
+    this->__begin_frame();
+
+    if(this->mode == OcclusionMode::NONE || bounds == nullptr) {
+        draw();
+
+        return;
+    }
+
+    this->__stats.tested++;
+
+    if(this->mode == OcclusionMode::CPU) {
+        if(this->__cpu_visible(view, world, bounds)) {
+            draw();
+        } else {
+            this->__stats.culled++;
+        }
+
+        return;
+    }
+
+    this->__record_gpu(key, list, program, view, world, bounds, draw);
+}
+
+bool Occlusion::__cpu_visible(const View& view, const glm::mat4& world, std::shared_ptr<Mesh> bounds) {
+    if(!this->__rasterized) {
+        this->__rasterize(view);
+    }
+
+    if(this->__occluders.empty()) {
+        return true;
+    }
+
+    glm::mat4 matrix = view.view_projection * world;
+
+    glm::vec3 screen_min(std::numeric_limits<float>::max());
+    glm::vec3 screen_max(std::numeric_limits<float>::lowest());
+
+    for(int i = 0; i < 8; i++) {
+        glm::vec3 corner(
+            i & 1 ? bounds->max.x : bounds->min.x,
+            i & 2 ? bounds->max.y : bounds->min.y,
+            i & 4 ? bounds->max.z : bounds->min.z
+        );
+
+        glm::vec4 clip = matrix * glm::vec4(corner, 1.0f);
+
+        // Crosses the near plane: the projected rectangle is unbounded.
+        if(clip.w <= NEAR_W) {
+            return true;
+        }
+
+        glm::vec3 ndc = glm::vec3(clip) / clip.w;
+
+        screen_min = glm::min(screen_min, ndc);
+        screen_max = glm::max(screen_max, ndc);
+    }
+
+    // Entirely outside the view.
+    if(screen_max.x < -1.0f || screen_min.x > 1.0f || screen_max.y < -1.0f || screen_min.y > 1.0f) {
+        return false;
+    }
+
+    int x0 = std::max(0, (int) ((screen_min.x * 0.5f + 0.5f) * Occlusion::DEPTH_WIDTH));
+    int x1 = std::min(Occlusion::DEPTH_WIDTH - 1, (int) ((screen_max.x * 0.5f + 0.5f) * Occlusion::DEPTH_WIDTH));
+    int y0 = std::max(0, (int) ((screen_min.y * 0.5f + 0.5f) * Occlusion::DEPTH_HEIGHT));
+    int y1 = std::min(Occlusion::DEPTH_HEIGHT - 1, (int) ((screen_max.y * 0.5f + 0.5f) * Occlusion::DEPTH_HEIGHT));
+
+    // Nearest depth of the box (the nearest point of a box is one of its corners).
+    float depth = screen_min.z * 0.5f + 0.5f;
+
+    for(int y = y0; y <= y1; y++) {
+        const float* row = this->__depth.data() + y * Occlusion::DEPTH_WIDTH;
+        int x = x0;
+
+        // Visible as soon as one covered texel is further than the box.
+        #if defined(__SSE2__)
+        __m128 reference = _mm_set1_ps(depth);
+
+        for(; x + 3 <= x1; x += 4) {
+            if(_mm_movemask_ps(_mm_cmpge_ps(_mm_loadu_ps(row + x), reference)) != 0) {
+                return true;
+            }
+        }
+        #elif defined(__wasm_simd128__)
+        v128_t reference = wasm_f32x4_splat(depth);
+
+        for(; x + 3 <= x1; x += 4) {
+            if(wasm_v128_any_true(wasm_f32x4_ge(wasm_v128_load(row + x), reference))) {
+                return true;
+            }
+        }
+        #endif
+
+        for(; x <= x1; x++) {
+            if(row[x] >= depth) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+void Occlusion::__rasterize(const View& view) {
+    auto start = std::chrono::steady_clock::now();
+
+    this->__rasterized = true;
+
+    std::fill(this->__depth.begin(), this->__depth.end(), 1.0f);
+
+    std::vector<glm::vec4> clip;
+
+    for(auto& occluder : this->__occluders) {
+        glm::mat4 matrix = view.view_projection * occluder.world;
+
+        auto& mesh = occluder.mesh;
+
+        clip.resize(mesh->positions.size());
+
+        for(size_t i = 0; i < mesh->positions.size(); i++) {
+            clip[i] = matrix * glm::vec4(mesh->positions[i], 1.0f);
+        }
+
+        for(size_t i = 0; i + 2 < mesh->indices.size(); i += 3) {
+            auto& a = clip[mesh->indices[i]];
+            auto& b = clip[mesh->indices[i + 1]];
+            auto& c = clip[mesh->indices[i + 2]];
+
+            // Triangles crossing the near plane are skipped rather than clipped (only hides less).
+            if(a.w <= NEAR_W || b.w <= NEAR_W || c.w <= NEAR_W) {
+                continue;
+            }
+
+            this->__rasterize_triangle(a, b, c);
+        }
+
+        this->__stats.occluder_triangles += mesh->triangle_count();
+    }
+
+    pepng::memory()->track(&this->__depth, MemoryRecord { "cpu", "", "occlusion depth buffer", 1, 0, this->__depth.size() * sizeof(float) });
+
+    this->__stats.rasterize_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void Occlusion::__rasterize_triangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c) {
+    const glm::vec2 size((float) Occlusion::DEPTH_WIDTH, (float) Occlusion::DEPTH_HEIGHT);
+
+    glm::vec2 p[3];
+    float z[3];
+    const glm::vec4* vertices[3] = { &a, &b, &c };
+
+    for(int i = 0; i < 3; i++) {
+        glm::vec3 ndc = glm::vec3(*vertices[i]) / vertices[i]->w;
+
+        p[i] = (glm::vec2(ndc) * 0.5f + 0.5f) * size;
+        z[i] = ndc.z * 0.5f + 0.5f;
+    }
+
+    float area = edge(p[0], p[1], p[2]);
+
+    if(area == 0.0f) {
+        return;
+    }
+
+    // Occluders are rasterized two sided.
+    float sign = area > 0.0f ? 1.0f : -1.0f;
+    area *= sign;
+
+    int x0 = std::max(0, (int) std::floor(std::min(p[0].x, std::min(p[1].x, p[2].x))));
+    int x1 = std::min(Occlusion::DEPTH_WIDTH - 1, (int) std::ceil(std::max(p[0].x, std::max(p[1].x, p[2].x))));
+    int y0 = std::max(0, (int) std::floor(std::min(p[0].y, std::min(p[1].y, p[2].y))));
+    int y1 = std::min(Occlusion::DEPTH_HEIGHT - 1, (int) std::ceil(std::max(p[0].y, std::max(p[1].y, p[2].y))));
+
+    for(int y = y0; y <= y1; y++) {
+        float* row = this->__depth.data() + y * Occlusion::DEPTH_WIDTH;
+
+        for(int x = x0; x <= x1; x++) {
+            glm::vec2 center((float) x + 0.5f, (float) y + 0.5f);
+
+            float w0 = edge(p[1], p[2], center) * sign;
+            float w1 = edge(p[2], p[0], center) * sign;
+            float w2 = edge(p[0], p[1], center) * sign;
+
+            if(w0 < 0.0f || w1 < 0.0f || w2 < 0.0f) {
+                continue;
+            }
+
+            // NDC depth is affine in screen space.
+            float depth = (w0 * z[0] + w1 * z[1] + w2 * z[2]) / area;
+
+            row[x] = std::min(row[x], depth);
+        }
+    }
+}
+
+void Occlusion::__record_gpu(const void* key, CommandList& list, GLuint program, const View& view, const glm::mat4& world, std::shared_ptr<Mesh> bounds, const std::function<void()>& draw) {
+    auto& query = this->__queries[key];
+
+    if(query.query == 0) {
+        if(!this->__free_queries.empty()) {
+            query.query = this->__free_queries.back();
+            this->__free_queries.pop_back();
+        } else {
+            glGenQueries(1, &query.query);
+        }
+    }
+
+    // Only last frames' results are read, the pipeline is never stalled.
+    if(query.pending) {
+        GLuint available = GL_FALSE;
+        glGetQueryObjectuiv(query.query, GL_QUERY_RESULT_AVAILABLE, &available);
+
+        if(available == GL_TRUE) {
+            GLuint samples = 0;
+            glGetQueryObjectuiv(query.query, GL_QUERY_RESULT, &samples);
+
+            query.visible = samples != 0;
+            query.pending = false;
+        }
+    }
+
+    // A camera inside the box would not see its faces.
+    glm::vec3 local = glm::vec3(glm::inverse(world) * glm::vec4(view.position, 1.0f));
+    glm::vec3 margin = (bounds->max - bounds->min) * 0.05f + 0.01f;
+
+    if(glm::all(glm::greaterThanEqual(local, bounds->min - margin)) && glm::all(glm::lessThanEqual(local, bounds->max + margin))) {
+        query.visible = true;
+
+        draw();
+
+        return;
+    }
+
+    if(query.pending) {
+        if(query.visible) {
+            draw();
+        } else {
+            this->__stats.culled++;
+        }
+
+        return;
+    }
+
+    query.pending = true;
+
+    list.begin_query(GL_ANY_SAMPLES_PASSED, query.query);
+
+    if(query.visible) {
+        // Visible objects are their own query.
+        draw();
+
+        list.end_query(GL_ANY_SAMPLES_PASSED);
+
+        return;
+    }
+
+    this->__stats.culled++;
+
+    // Hidden objects query their bounding box without writing anything.
+    glm::vec3 half = glm::max((bounds->max - bounds->min) * 0.5f, glm::vec3(1e-3f));
+    glm::mat4 box = world * glm::scale(glm::translate(glm::mat4(1.0f), bounds->center), half);
+
+    // Blended items already turned depth writes off: the proxy puts back whatever the item set.
+    bool depth_mask = list.recorded_depth_mask();
+
+    list.color_mask(false);
+    list.depth_mask(false);
+    list.uniform(pepng::uniform_location(program, "u_world"), box);
+    list.bind_vertex_array(this->__box_vao());
+    list.draw_arrays(GL_TRIANGLES, 0, 36);
+    list.depth_mask(depth_mask);
+    list.color_mask(true);
+
+    list.end_query(GL_ANY_SAMPLES_PASSED);
+
+    // Lets the GPU draw it anyway if the box turns out visible (no popping when it reappears).
+    #ifndef __EMSCRIPTEN__
+    list.begin_conditional_render(query.query);
+    draw();
+    list.end_conditional_render();
+    #endif
+}
+
+GLuint Occlusion::__box_vao() {
+    if(this->__box != 0) {
+        return this->__box;
+    }
+
+    // Unit cube [-1, 1] with counter-clockwise outward faces.
+    static const float corners[8][3] = {
+        { -1, -1, -1 }, { 1, -1, -1 }, { 1, 1, -1 }, { -1, 1, -1 },
+        { -1, -1, 1 }, { 1, -1, 1 }, { 1, 1, 1 }, { -1, 1, 1 }
+    };
+
+    static const int faces[6][4] = {
+        { 0, 3, 2, 1 }, { 4, 5, 6, 7 }, { 0, 1, 5, 4 },
+        { 3, 7, 6, 2 }, { 0, 4, 7, 3 }, { 1, 2, 6, 5 }
+    };
+
+    std::vector<float> vertices;
+
+    for(auto& face : faces) {
+        for(int corner : { face[0], face[1], face[2], face[0], face[2], face[3] }) {
+            vertices.insert(vertices.end(), corners[corner], corners[corner] + 3);
+        }
+    }
+
+    glGenVertexArrays(1, &this->__box);
+    glBindVertexArray(this->__box);
+
+    glGenBuffers(1, &this->__box_buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, this->__box_buffer);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*) 0);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    this->__memory = pepng::memory();
+    pepng::memory()->track(&this->__box, MemoryRecord { "buffer", "", "occlusion box", 1, vertices.size() * sizeof(float), 0 });
+
+    return this->__box;
+}
\ No newline at end of file
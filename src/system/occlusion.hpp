@@ -0,0 +1,110 @@
+#pragma once
+
+#include <pepng.h>
+
+#include "command_list.hpp"
+#include "memory.hpp"
+#include "mesh.hpp"
+#include "view.hpp"
+
+enum class OcclusionMode {
+    NONE,
+    // Software depth buffer of the occluders, tested on the CPU while recording.
+    CPU,
+    // Hardware occlusion queries of last frame's results (+ conditional render on desktop GL).
+    GPU
+};
+
+/**
+ * Occlusion culling of renderers against designated occluders.
+ *
+ * Renderers ask it to record their draw. Depending on the mode the draw is recorded as is,
+ * dropped when hidden by the CPU depth buffer, or wrapped in an occlusion query.
+ */
+class Occlusion {
+    public:
+        static std::shared_ptr<Occlusion> make_occlusion();
+
+        OcclusionMode mode;
+
+        struct Stats {
+            size_t tested = 0;
+            size_t culled = 0;
+            size_t occluders = 0;
+            size_t occluder_triangles = 0;
+            float rasterize_ms = 0.0f;
+        };
+
+        // Statistics of the last finished frame.
+        const Stats& stats();
+
+        // Registers an occluder for the next frame (CPU mode).
+        void add_occluder(const glm::mat4& world, std::shared_ptr<Mesh> mesh);
+
+        /**
+         * Records a draw unless it is occluded.
+         *
+         * @param key Identifies the renderer across frames (for its query).
+         * @param bounds Object space bounds of the draw, nullptr if unknown (always drawn).
+         * @param draw Records the world matrix, VAO and draw into the list.
+         */
+        void record(const void* key, CommandList& list, GLuint program, const View& view, const glm::mat4& world, std::shared_ptr<Mesh> bounds, const std::function<void()>& draw);
+
+        // Releases the query of a renderer (no GL call, the query is reused).
+        void forget(const void* key);
+
+        // Deletes the queries and the box proxy.
+        ~Occlusion();
+
+        // Resolution of the CPU depth buffer.
+        static constexpr int DEPTH_WIDTH = 256;
+        static constexpr int DEPTH_HEIGHT = 128;
+
+    private:
+        Occlusion();
+
+        struct Occluder {
+            glm::mat4 world;
+            std::shared_ptr<Mesh> mesh;
+        };
+
+        struct Query {
+            GLuint query = 0;
+            bool pending = false;
+            bool visible = true;
+        };
+
+        void __begin_frame();
+        bool __cpu_visible(const View& view, const glm::mat4& world, std::shared_ptr<Mesh> bounds);
+        void __rasterize(const View& view);
+        void __rasterize_triangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c);
+        void __record_gpu(const void* key, CommandList& list, GLuint program, const View& view, const glm::mat4& world, std::shared_ptr<Mesh> bounds, const std::function<void()>& draw);
+        GLuint __box_vao();
+
+        size_t __frame;
+        Stats __stats;
+        Stats __last_stats;
+
+        std::vector<Occluder> __occluders;
+        std::vector<Occluder> __next_occluders;
+
+        std::vector<float> __depth;
+        bool __rasterized;
+
+        std::unordered_map<const void*, Query> __queries;
+        std::vector<GLuint> __free_queries;
+
+        GLuint __box = 0;
+        GLuint __box_buffer = 0;
+        // Where the box is tracked (weak: the tracker may be gone first during static teardown).
+        std::weak_ptr<MemoryTracker> __memory;
+};
+
+namespace pepng {
+    std::shared_ptr<Occlusion> make_occlusion();
+
+    /**
+     * The engine-wide Occlusion (CPU by default on WebGL, GPU elsewhere).
+     */
+    std::shared_ptr<Occlusion> occlusion();
+};
\ No newline at end of file
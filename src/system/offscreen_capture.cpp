@@ -0,0 +1,546 @@
+#include "offscreen_capture.hpp"
+
+#include <chrono>
+#include <iomanip>
+
+#include "debug_draw.hpp"
+#include "dynamic_resolution.hpp"
+#include "image_writer.hpp"
+#include "memory.hpp"
+#include "multi_view.hpp"
+
+// Browsers without shared memory have no threads, images are encoded as they are read back there.
+#if !defined(__EMSCRIPTEN__) || defined(__EMSCRIPTEN_PTHREADS__)
+#define PEPNG_ENCODE_THREAD 1
+#endif
+
+namespace {
+    // Weight of the newest sample in the smoothed timings.
+    constexpr float SMOOTHING = 0.1f;
+    // Longest single wait on a fence when a read back is forced (nanoseconds).
+    constexpr GLuint64 WAIT_TIMEOUT = 1000000000;
+
+    float smooth(float average, float sample) {
+        return average == 0.0f ? sample : glm::mix(average, sample, SMOOTHING);
+    }
+}
+
+OffscreenCapture::OffscreenCapture(unsigned int encoder_count) :
+    exit_when_done(false),
+    __next_shot(0),
+    __recording(-1),
+    __size(0),
+    __overridden(false),
+    __resolution_enabled(false),
+    __multi_view_enabled(false),
+    __debug_draw_enabled(false),
+    __framebuffer(0),
+    __color_buffer(0),
+    __depth_buffer(0),
+    __target_size(0),
+    __readback_write(0),
+    __readback_read(0),
+    __readback_count(0),
+    __encoder_count(encoder_count > 0 ? encoder_count : std::max(1u, std::thread::hardware_concurrency() / 2)),
+    __encoding(0),
+    __stop(false)
+{}
+
+OffscreenCapture::~OffscreenCapture() {
+    {
+        std::lock_guard<std::mutex> lock(this->__mutex);
+
+        this->__stop = true;
+    }
+
+    this->__wake.notify_all();
+
+    // Encoders only leave once the queue is empty, so read back images are still written.
+    for(auto& encoder : this->__encoders) {
+        encoder.join();
+    }
+}
+
+std::shared_ptr<OffscreenCapture> OffscreenCapture::make_offscreen_capture(unsigned int encoder_count) {
+    std::shared_ptr<OffscreenCapture> capture(new OffscreenCapture(encoder_count));
+
+    return capture;
+}
+
+std::shared_ptr<OffscreenCapture> pepng::make_offscreen_capture(unsigned int encoder_count) {
+    return OffscreenCapture::make_offscreen_capture(encoder_count);
+}
+
+std::shared_ptr<OffscreenCapture> pepng::capture() {
+    static auto capture = pepng::make_offscreen_capture();
+
+    return capture;
+}
+
+std::vector<CapturePose> pepng::turntable(const glm::vec3& center, float radius, float height, size_t count) {
+    std::vector<CapturePose> poses;
+    poses.reserve(count);
+
+    float pitch = -glm::degrees(std::atan2(height, radius));
+
+    for(size_t i = 0; i < count; i++) {
+        float angle = 6.2831853f * i / count;
+
+        poses.push_back(CapturePose {
+            center + glm::vec3(std::sin(angle) * radius, height, std::cos(angle) * radius),
+            glm::vec3(pitch, glm::degrees(angle), 0.0f)
+        });
+    }
+
+    return poses;
+}
+
+void OffscreenCapture::start(const std::filesystem::path& directory, const glm::ivec2& size, size_t frame_count, const std::string& extension) {
+    this->__start(directory, size, std::vector<Shot>(frame_count, Shot { false, {}, {} }), extension);
+}
+
+void OffscreenCapture::start(const std::filesystem::path& directory, const glm::ivec2& size, const std::vector<CapturePose>& poses, const std::string& extension) {
+    std::vector<Shot> shots;
+    shots.reserve(poses.size());
+
+    for(auto& pose : poses) {
+        shots.push_back(Shot { true, pose, {} });
+    }
+
+    this->__start(directory, size, std::move(shots), extension);
+}
+
+void OffscreenCapture::__start(const std::filesystem::path& directory, const glm::ivec2& size, std::vector<Shot> shots, const std::string& extension) {
+    if(this->active()) {
+        throw std::runtime_error("A capture is already running.");
+    }
+
+    if(size.x <= 0 || size.y <= 0) {
+        std::stringstream ss;
+
+        ss << "Cannot capture " << size.x << "x" << size.y << " images." << std::endl;
+
+        throw std::runtime_error(ss.str());
+    }
+
+    if(extension != ".png" && extension != ".ppm") {
+        std::stringstream ss;
+
+        ss << "Cannot capture " << extension << " images: only .png and .ppm are supported." << std::endl;
+
+        throw std::runtime_error(ss.str());
+    }
+
+    std::filesystem::create_directories(directory);
+
+    for(size_t i = 0; i < shots.size(); i++) {
+        std::stringstream name;
+        name << std::setw(5) << std::setfill('0') << i << extension;
+
+        shots[i].path = directory / name.str();
+    }
+
+    this->__shots = std::move(shots);
+    this->__next_shot = 0;
+    this->__size = size;
+
+    {
+        std::lock_guard<std::mutex> lock(this->__mutex);
+
+        this->__stats = Stats();
+        this->__stats.shots = this->__shots.size();
+        this->__error.clear();
+    }
+
+    #ifdef PEPNG_ENCODE_THREAD
+    // Started on the first capture, so runs without one never pay for the threads.
+    while(this->__encoders.size() < this->__encoder_count) {
+        this->__encoders.emplace_back([this]() {
+            this->__encode_loop();
+        });
+    }
+    #endif
+}
+
+void OffscreenCapture::stop() {
+    this->__shots.resize(this->__next_shot);
+
+    std::lock_guard<std::mutex> lock(this->__mutex);
+
+    this->__stats.shots = this->__shots.size();
+}
+
+bool OffscreenCapture::active() {
+    if(this->__next_shot < this->__shots.size() || this->__recording >= 0 || this->__readback_count > 0) {
+        return true;
+    }
+
+    for(auto shot : this->__submitted) {
+        if(shot >= 0) {
+            return true;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(this->__mutex);
+
+    return !this->__images.empty() || this->__encoding > 0;
+}
+
+bool OffscreenCapture::recording() {
+    return this->__recording >= 0;
+}
+
+void OffscreenCapture::pose(std::shared_ptr<Transform> transform) {
+    if(this->__next_shot >= this->__shots.size() || !this->__shots[this->__next_shot].posed) {
+        return;
+    }
+
+    auto& pose = this->__shots[this->__next_shot].pose;
+
+    transform->position = pose.position;
+    transform->rotation = pose.rotation;
+}
+
+void OffscreenCapture::adjust(View& view) {
+    if(this->__recording < 0) {
+        return;
+    }
+
+    // The camera follows the window aspect. projection[1][1] is cot(fov / 2), kept so the vertical field of view stays.
+    glm::mat4 projection = view.projection;
+    projection[0][0] = projection[1][1] * (float) this->__size.y / (float) this->__size.x;
+
+    view = pepng::make_view(view.view, projection, glm::ivec4(0, 0, this->__size.x, this->__size.y));
+}
+
+void OffscreenCapture::submitted() {
+    this->__submitted.push_back(this->__recording);
+
+    if(this->__next_shot < this->__shots.size()) {
+        this->__override(true);
+        this->__recording = (long) this->__next_shot++;
+    } else {
+        this->__recording = -1;
+    }
+}
+
+void OffscreenCapture::__override(bool enabled) {
+    if(enabled == this->__overridden) {
+        return;
+    }
+
+    auto resolution = pepng::resolution();
+    auto multi_view = pepng::multi_view();
+    auto debug_draw = pepng::debug_draw();
+
+    if(enabled) {
+        this->__resolution_enabled = resolution->enabled;
+        this->__multi_view_enabled = multi_view->enabled;
+        this->__debug_draw_enabled = debug_draw->enabled;
+
+        // Shots are drawn at full scale, without picture in picture or debug lines.
+        resolution->enabled = false;
+        multi_view->enabled = false;
+        debug_draw->enabled = false;
+    } else {
+        resolution->enabled = this->__resolution_enabled;
+        multi_view->enabled = this->__multi_view_enabled;
+        debug_draw->enabled = this->__debug_draw_enabled;
+    }
+
+    this->__overridden = enabled;
+}
+
+void OffscreenCapture::__resize(const glm::ivec2& size) {
+    if(this->__framebuffer == 0) {
+        glGenFramebuffers(1, &this->__framebuffer);
+        glGenRenderbuffers(1, &this->__color_buffer);
+        glGenRenderbuffers(1, &this->__depth_buffer);
+    }
+
+    this->__target_size = size;
+
+    glBindRenderbuffer(GL_RENDERBUFFER, this->__color_buffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, size.x, size.y);
+    glBindRenderbuffer(GL_RENDERBUFFER, this->__depth_buffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, size.x, size.y);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    GLint previous_framebuffer = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous_framebuffer);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, this->__framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, this->__color_buffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, this->__depth_buffer);
+
+    if(glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::stringstream ss;
+
+        ss << "Capture target (" << size.x << "x" << size.y << ") is incomplete." << std::endl;
+
+        throw std::runtime_error(ss.str());
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, previous_framebuffer);
+
+    size_t bytes = (size_t) size.x * size.y * 4;
+
+    pepng::memory()->track(&this->__framebuffer, MemoryRecord { "target", "", "offscreen capture", 1, bytes * 2, 0 });
+    #ifndef __EMSCRIPTEN__
+    pepng::memory()->track(&this->__readbacks, MemoryRecord { "buffer", "", "offscreen capture", 1, bytes * OffscreenCapture::PIXEL_BUFFER_COUNT, 0 });
+    #endif
+}
+
+void OffscreenCapture::render(const std::function<void()>& replay) {
+    long shot = -1;
+
+    if(!this->__submitted.empty()) {
+        shot = this->__submitted.front();
+        this->__submitted.pop_front();
+    }
+
+    if(shot >= 0) {
+        this->__render_shot(shot, replay);
+    } else {
+        pepng::resolution()->render(replay);
+    }
+
+    while(this->__read(false)) {}
+
+    if(this->__overridden && this->__recording < 0 && !this->active()) {
+        this->__override(false);
+    }
+
+    // Nothing is left once the last image is written (the override is restored by then).
+    if(this->exit_when_done && !this->__overridden && !this->active() && this->stats().shots > 0) {
+        glfwSetWindowShouldClose(glfwGetCurrentContext(), GLFW_TRUE);
+    }
+}
+
+void OffscreenCapture::__render_shot(long shot, const std::function<void()>& replay) {
+    glm::ivec2 size = this->__size;
+
+    if(size != this->__target_size) {
+        this->__resize(size);
+    }
+
+    GLint viewport[4], previous_framebuffer = 0;
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous_framebuffer);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, this->__framebuffer);
+    glViewport(0, 0, size.x, size.y);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+    replay();
+
+    // Fitted preview in the window (letterboxed over the cleared background).
+    float fit = std::min(viewport[2] / (float) size.x, viewport[3] / (float) size.y);
+    glm::ivec2 preview = glm::max(glm::ivec2(glm::vec2(size) * fit), glm::ivec2(1));
+    glm::ivec2 corner = glm::ivec2(viewport[0], viewport[1]) + (glm::ivec2(viewport[2], viewport[3]) - preview) / 2;
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, this->__framebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, previous_framebuffer);
+    glBlitFramebuffer(0, 0, size.x, size.y, corner.x, corner.y, corner.x + preview.x, corner.y + preview.y, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, this->__framebuffer);
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+
+    #ifdef __EMSCRIPTEN__
+    // WebGL cannot read buffers back, so the pixels are read right away (waits for the GPU).
+    auto start = std::chrono::steady_clock::now();
+
+    Image image { this->__shots[shot].path, size, std::vector<uint8_t>((size_t) size.x * size.y * 4) };
+    glReadPixels(0, 0, size.x, size.y, GL_RGBA, GL_UNSIGNED_BYTE, image.pixels.data());
+
+    {
+        std::lock_guard<std::mutex> lock(this->__mutex);
+
+        this->__stats.rendered++;
+        this->__stats.read_back++;
+        this->__stats.read_ms = smooth(this->__stats.read_ms, std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    this->__encode(image);
+    #else
+    // Every pixel buffer is in flight: the oldest is waited for rather than dropping a shot.
+    if(this->__readback_count == OffscreenCapture::PIXEL_BUFFER_COUNT) {
+        {
+            std::lock_guard<std::mutex> lock(this->__mutex);
+
+            this->__stats.stalls++;
+        }
+
+        this->__read(true);
+    }
+
+    auto& readback = this->__readbacks[this->__readback_write];
+
+    if(readback.buffer == 0) {
+        glGenBuffers(1, &readback.buffer);
+    }
+
+    // Orphaned, so a buffer still read by the driver is never waited for.
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+    glBufferData(GL_PIXEL_PACK_BUFFER, (size_t) size.x * size.y * 4, nullptr, GL_STREAM_READ);
+    glReadPixels(0, 0, size.x, size.y, GL_RGBA, GL_UNSIGNED_BYTE, (void*) 0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    readback.shot = shot;
+    readback.size = size;
+
+    this->__readback_write = (this->__readback_write + 1) % OffscreenCapture::PIXEL_BUFFER_COUNT;
+    this->__readback_count++;
+
+    {
+        std::lock_guard<std::mutex> lock(this->__mutex);
+
+        this->__stats.rendered++;
+    }
+    #endif
+
+    glBindFramebuffer(GL_FRAMEBUFFER, previous_framebuffer);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+}
+
+bool OffscreenCapture::__read(bool wait) {
+    if(this->__readback_count == 0) {
+        return false;
+    }
+
+    auto& readback = this->__readbacks[this->__readback_read];
+
+    GLenum status = glClientWaitSync(readback.fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, wait ? WAIT_TIMEOUT : 0);
+
+    while(wait && status == GL_TIMEOUT_EXPIRED) {
+        status = glClientWaitSync(readback.fence, 0, WAIT_TIMEOUT);
+    }
+
+    if(status == GL_TIMEOUT_EXPIRED) {
+        return false;
+    }
+
+    glDeleteSync(readback.fence);
+    readback.fence = 0;
+
+    this->__readback_read = (this->__readback_read + 1) % OffscreenCapture::PIXEL_BUFFER_COUNT;
+    this->__readback_count--;
+
+    if(status == GL_WAIT_FAILED) {
+        std::lock_guard<std::mutex> lock(this->__mutex);
+
+        this->__stats.failed++;
+        this->__error = "Waiting for a capture read back failed.";
+
+        return true;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    Image image { this->__shots[readback.shot].path, readback.size, std::vector<uint8_t>((size_t) readback.size.x * readback.size.y * 4) };
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer);
+    glGetBufferSubData(GL_PIXEL_PACK_BUFFER, 0, image.pixels.size(), image.pixels.data());
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    {
+        std::lock_guard<std::mutex> lock(this->__mutex);
+
+        this->__stats.read_back++;
+        this->__stats.read_ms = smooth(this->__stats.read_ms, std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    #ifdef PEPNG_ENCODE_THREAD
+    {
+        std::lock_guard<std::mutex> lock(this->__mutex);
+
+        this->__images.push_back(std::move(image));
+    }
+
+    this->__wake.notify_one();
+    #else
+    this->__encode(image);
+    #endif
+
+    return true;
+}
+
+void OffscreenCapture::__encode(Image& image) {
+    auto start = std::chrono::steady_clock::now();
+
+    std::string error;
+
+    try {
+        pepng::write_image(image.path, image.pixels.data(), image.size, true);
+    } catch(const std::runtime_error& exception) {
+        error = exception.what();
+    }
+
+    float ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::lock_guard<std::mutex> lock(this->__mutex);
+
+    if(error.empty()) {
+        this->__stats.written++;
+    } else {
+        this->__stats.failed++;
+        this->__error = error;
+    }
+
+    this->__stats.encode_ms = smooth(this->__stats.encode_ms, ms);
+}
+
+void OffscreenCapture::__encode_loop() {
+    while(true) {
+        Image image;
+
+        {
+            std::unique_lock<std::mutex> lock(this->__mutex);
+
+            this->__wake.wait(lock, [this]() {
+                return this->__stop || !this->__images.empty();
+            });
+
+            if(this->__images.empty()) {
+                return;
+            }
+
+            image = std::move(this->__images.front());
+            this->__images.pop_front();
+            this->__encoding++;
+        }
+
+        this->__encode(image);
+
+        {
+            std::lock_guard<std::mutex> lock(this->__mutex);
+
+            this->__encoding--;
+        }
+
+        this->__idle.notify_all();
+    }
+}
+
+void OffscreenCapture::finish() {
+    while(this->__read(true)) {}
+
+    std::unique_lock<std::mutex> lock(this->__mutex);
+
+    this->__idle.wait(lock, [this]() {
+        return this->__images.empty() && this->__encoding == 0;
+    });
+}
+
+OffscreenCapture::Stats OffscreenCapture::stats() {
+    std::lock_guard<std::mutex> lock(this->__mutex);
+
+    return this->__stats;
+}
+
+std::string OffscreenCapture::error() {
+    std::lock_guard<std::mutex> lock(this->__mutex);
+
+    return this->__error;
+}
\ No newline at end of file
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <pepng.h>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "view.hpp"
+
+/**
+ * Camera position and rotation (degrees, as Transform) of one captured image.
+ */
+struct CapturePose {
+    glm::vec3 position;
+    glm::vec3 rotation;
+};
+
+/**
+ * Renders frames into an offscreen target of any size and writes them as images (thumbnails, turntables).
+ *
+ * A shot is recorded like any frame, with the camera projection fixed for the target aspect, and replayed
+ * into the target instead of the window (a fitted preview is blitted into the window). Its pixels are copied
+ * into a ring of pixel buffers and read back frames later once a fence passed, so the GPU never waits for
+ * the CPU. Encoding runs on a pool of threads, overlapping the rendering of the next shots.
+ * Dynamic resolution, extra views and debug drawing are off while shots are recorded.
+ */
+class OffscreenCapture {
+    public:
+        /**
+         * @param encoder_count Encoding threads (0 picks half the cores).
+         */
+        static std::shared_ptr<OffscreenCapture> make_offscreen_capture(unsigned int encoder_count);
+
+        ~OffscreenCapture();
+
+        // Closes the window once the last image is written (headless runs).
+        bool exit_when_done;
+
+        struct Stats {
+            size_t shots = 0;
+            size_t rendered = 0;
+            size_t read_back = 0;
+            size_t written = 0;
+            size_t failed = 0;
+            // Shots rendered while every pixel buffer was still in flight (the oldest was waited for).
+            size_t stalls = 0;
+            float read_ms = 0.0f;
+            float encode_ms = 0.0f;
+        };
+
+        /**
+         * Captures the next frame_count frames from the current camera.
+         *
+         * @param directory Created if missing. Images are named 00000.png, 00001.png...
+         * @param extension ".png" or ".ppm".
+         */
+        void start(const std::filesystem::path& directory, const glm::ivec2& size, size_t frame_count, const std::string& extension = ".png");
+
+        /**
+         * Captures one image per pose (applied to the Transform given to pose()).
+         */
+        void start(const std::filesystem::path& directory, const glm::ivec2& size, const std::vector<CapturePose>& poses, const std::string& extension = ".png");
+
+        // Drops the shots not rendered yet (rendered ones are still written).
+        void stop();
+
+        // Shots are left to render, read back or write.
+        bool active();
+
+        // The frame being recorded is a shot.
+        bool recording();
+
+        /**
+         * Overwrites the camera pose with the one of the next shot. Call from the camera's update.
+         */
+        void pose(std::shared_ptr<Transform> transform);
+
+        /**
+         * Fixes the projection and viewport of a View recorded for a shot.
+         */
+        void adjust(View& view);
+
+        /**
+         * Marks the list about to be submitted and starts recording the next shot. Call before CommandQueue::submit.
+         */
+        void submitted();
+
+        /**
+         * Runs replay into the capture target if the replayed list is a shot, through pepng::resolution() otherwise.
+         * Then reads back and hands out finished shots.
+         */
+        void render(const std::function<void()>& replay);
+
+        // Blocks until every rendered shot is written.
+        void finish();
+
+        Stats stats();
+
+        // Last write error (empty if none).
+        std::string error();
+
+        static constexpr size_t PIXEL_BUFFER_COUNT = 3;
+
+    private:
+        OffscreenCapture(unsigned int encoder_count);
+
+        struct Shot {
+            bool posed;
+            CapturePose pose;
+            std::filesystem::path path;
+        };
+
+        struct Readback {
+            GLuint buffer = 0;
+            GLsync fence = 0;
+            long shot = -1;
+            glm::ivec2 size = glm::ivec2(0);
+        };
+
+        struct Image {
+            std::filesystem::path path;
+            glm::ivec2 size;
+            std::vector<uint8_t> pixels;
+        };
+
+        void __start(const std::filesystem::path& directory, const glm::ivec2& size, std::vector<Shot> shots, const std::string& extension);
+        void __resize(const glm::ivec2& size);
+        void __render_shot(long shot, const std::function<void()>& replay);
+        // Hands out the oldest read back if its fence passed (waits for it if wait). False if there was none to hand out.
+        bool __read(bool wait);
+        void __encode(Image& image);
+        void __encode_loop();
+        void __override(bool enabled);
+
+        std::vector<Shot> __shots;
+        size_t __next_shot;
+        long __recording;
+        // Shot (or -1) of every submitted list not replayed yet.
+        std::deque<long> __submitted;
+        glm::ivec2 __size;
+
+        // Saved while shots are recorded.
+        bool __overridden;
+        bool __resolution_enabled;
+        bool __multi_view_enabled;
+        bool __debug_draw_enabled;
+
+        GLuint __framebuffer;
+        GLuint __color_buffer;
+        GLuint __depth_buffer;
+        glm::ivec2 __target_size;
+
+        Readback __readbacks[PIXEL_BUFFER_COUNT];
+        size_t __readback_write;
+        size_t __readback_read;
+        size_t __readback_count;
+
+        unsigned int __encoder_count;
+        std::vector<std::thread> __encoders;
+        std::deque<Image> __images;
+        size_t __encoding;
+        bool __stop;
+
+        std::mutex __mutex;
+        std::condition_variable __wake;
+        std::condition_variable __idle;
+
+        Stats __stats;
+        std::string __error;
+};
+
+namespace pepng {
+    std::shared_ptr<OffscreenCapture> make_offscreen_capture(unsigned int encoder_count = 0);
+
+    /**
+     * The engine-wide OffscreenCapture used by CommandFlush.
+     */
+    std::shared_ptr<OffscreenCapture> capture();
+
+    /**
+     * Poses orbiting a point, looking at it from above.
+     *
+     * @param count Number of poses over a full turn.
+     */
+    std::vector<CapturePose> turntable(const glm::vec3& center, float radius, float height, size_t count);
+};
\ No newline at end of file
@@ -0,0 +1,145 @@
+#include "particles.hpp"
+
+#include "job_system.hpp"
+#include "memory.hpp"
+
+#include <chrono>
+
+ParticlePool::ParticlePool(size_t capacity) :
+    __capacity(capacity),
+    __count(0)
+{
+    size_t padded = (capacity + 7) & ~(size_t) 7;
+
+    for(auto array : { &this->x, &this->y, &this->z, &this->vx, &this->vy, &this->vz, &this->age, &this->life, &this->size }) {
+        array->assign(padded, 0.0f);
+    }
+
+    this->__dead.assign(padded, 0);
+
+    pepng::memory()->track(this, MemoryRecord { "cpu", "", "particle pool", 1, 0, this->bytes() });
+}
+
+ParticlePool::~ParticlePool() {
+    pepng::memory()->untrack(this);
+}
+
+std::shared_ptr<ParticlePool> ParticlePool::make_particle_pool(size_t capacity) {
+    std::shared_ptr<ParticlePool> pool(new ParticlePool(capacity));
+
+    return pool;
+}
+
+std::shared_ptr<ParticlePool> pepng::make_particle_pool(size_t capacity) {
+    return ParticlePool::make_particle_pool(capacity);
+}
+
+size_t ParticlePool::capacity() {
+    return this->__capacity;
+}
+
+size_t ParticlePool::count() {
+    return this->__count;
+}
+
+const ParticlePool::Stats& ParticlePool::stats() {
+    return this->__stats;
+}
+
+size_t ParticlePool::bytes() {
+    return this->x.size() * 9 * sizeof(float) + this->__dead.size();
+}
+
+void ParticlePool::clear() {
+    this->__count = 0;
+}
+
+bool ParticlePool::spawn(const glm::vec3& position, const glm::vec3& velocity, float life, float size) {
+    if(this->__count >= this->__capacity) {
+        return false;
+    }
+
+    size_t i = this->__count++;
+
+    this->x[i] = position.x;
+    this->y[i] = position.y;
+    this->z[i] = position.z;
+    this->vx[i] = velocity.x;
+    this->vy[i] = velocity.y;
+    this->vz[i] = velocity.z;
+    this->age[i] = 0.0f;
+    this->life[i] = life;
+    this->size[i] = size;
+
+    this->__stats.spawned++;
+
+    return true;
+}
+
+ParticleSpan ParticlePool::__span(size_t begin, size_t end) {
+    return ParticleSpan {
+        this->x.data() + begin, this->y.data() + begin, this->z.data() + begin,
+        this->vx.data() + begin, this->vy.data() + begin, this->vz.data() + begin,
+        this->age.data() + begin, this->life.data() + begin,
+        end - begin
+    };
+}
+
+void ParticlePool::simulate(float dt, const glm::vec3& gravity, float damping, bool threaded) {
+    auto start = std::chrono::steady_clock::now();
+
+    size_t count = this->__count;
+    // Chunks start on multiples of 8, so every kernel load stays inside the padding.
+    size_t chunks = threaded ? (count + CHUNK_SIZE - 1) / CHUNK_SIZE : 1;
+
+    if(chunks > 1) {
+        pepng::jobs()->parallel_for(chunks, [this, count, dt, gravity, damping](size_t chunk) {
+            size_t begin = chunk * CHUNK_SIZE;
+            size_t end = std::min(begin + CHUNK_SIZE, count);
+
+            pepng::integrate_particles(this->__span(begin, end), gravity, damping, dt, this->__dead.data() + begin);
+        });
+    } else if(count > 0) {
+        pepng::integrate_particles(this->__span(0, count), gravity, damping, dt, this->__dead.data());
+    }
+
+    auto integrated = std::chrono::steady_clock::now();
+
+    this->__compact();
+
+    auto end = std::chrono::steady_clock::now();
+
+    this->__stats.chunks = std::max<size_t>(chunks, 1);
+    this->__stats.integrate_ms = std::chrono::duration<float, std::milli>(integrated - start).count();
+    this->__stats.compact_ms = std::chrono::duration<float, std::milli>(end - integrated).count();
+}
+
+void ParticlePool::__compact() {
+    size_t count = this->__count;
+    size_t died = 0;
+    size_t i = 0;
+
+    while(i < count) {
+        if(!this->__dead[i]) {
+            i++;
+
+            continue;
+        }
+
+        // The last particle fills the hole. It may be dead too, so i is checked again.
+        count--;
+        died++;
+
+        if(i != count) {
+            for(auto array : { &this->x, &this->y, &this->z, &this->vx, &this->vy, &this->vz, &this->age, &this->life, &this->size }) {
+                (*array)[i] = (*array)[count];
+            }
+
+            this->__dead[i] = this->__dead[count];
+        }
+    }
+
+    this->__count = count;
+    this->__stats.died = died;
+    this->__stats.spawned = 0;
+}
\ No newline at end of file
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <pepng.h>
+
+#include "simd_math.hpp"
+
+/**
+ * Fixed capacity pool of particles stored as a structure of arrays.
+ *
+ * Nothing is allocated after construction: spawning appends to the live range, and dead particles are
+ * replaced by the last live ones (the order is not kept). Every array is padded to a multiple of 8, so
+ * the integrate_particles kernels always load full vectors.
+ */
+class ParticlePool {
+    public:
+        static std::shared_ptr<ParticlePool> make_particle_pool(size_t capacity);
+
+        std::vector<float> x, y, z;
+        std::vector<float> vx, vy, vz;
+        std::vector<float> age, life;
+        std::vector<float> size;
+
+        struct Stats {
+            size_t spawned = 0;
+            size_t died = 0;
+            // Chunks integrated on the JobSystem (1 when serial).
+            size_t chunks = 0;
+            float integrate_ms = 0.0f;
+            float compact_ms = 0.0f;
+        };
+
+        size_t capacity();
+        // Live particles, stored at [0, count).
+        size_t count();
+
+        /**
+         * Appends a particle.
+         *
+         * @return False if the pool is full.
+         */
+        bool spawn(const glm::vec3& position, const glm::vec3& velocity, float life, float size);
+
+        /**
+         * Integrates every particle, then removes the dead ones.
+         *
+         * @param threaded Splits the particles in chunks of CHUNK_SIZE integrated on the JobSystem.
+         */
+        void simulate(float dt, const glm::vec3& gravity, float damping, bool threaded);
+
+        void clear();
+
+        // Statistics of the last simulate (spawned counts since then).
+        const Stats& stats();
+
+        size_t bytes();
+
+        static constexpr size_t CHUNK_SIZE = 16384;
+
+        ~ParticlePool();
+
+    private:
+        ParticlePool(size_t capacity);
+
+        ParticleSpan __span(size_t begin, size_t end);
+        void __compact();
+
+        size_t __capacity;
+        size_t __count;
+        // One byte per particle, written by the kernels.
+        std::vector<uint8_t> __dead;
+
+        Stats __stats;
+};
+
+namespace pepng {
+    std::shared_ptr<ParticlePool> make_particle_pool(size_t capacity);
+};
\ No newline at end of file
@@ -0,0 +1,329 @@
+#include "picking.hpp"
+
+#include <chrono>
+
+#include "command_list.hpp"
+#include "memory.hpp"
+#include "model_info.hpp"
+#include "simd_math.hpp"
+
+Picking::Picking() :
+    #ifdef __EMSCRIPTEN__
+    // Loaded meshes cannot be read back on WebGL, so only IDs work there.
+    mode(PickingMode::GPU),
+    #else
+    mode(PickingMode::BVH),
+    #endif
+    __frame((size_t) -1),
+    __requested(false),
+    __pixel(0.0f),
+    __last_pick_ms(0.0f),
+    __bvh_rebuilds(0)
+{}
+
+std::shared_ptr<Picking> Picking::make_picking() {
+    std::shared_ptr<Picking> picking(new Picking());
+
+    return picking;
+}
+
+std::shared_ptr<Picking> pepng::make_picking() {
+    return Picking::make_picking();
+}
+
+std::shared_ptr<Picking> pepng::picking() {
+    static auto picking = pepng::make_picking();
+
+    return picking;
+}
+
+void Picking::__begin_frame() {
+    size_t frame = pepng::commands()->frame();
+
+    if(frame == this->__frame) {
+        return;
+    }
+
+    this->__frame = frame;
+
+    std::swap(this->__entries, this->__last_entries);
+    this->__entries.clear();
+}
+
+void Picking::add(std::shared_ptr<Object> object, const glm::mat4& world, std::shared_ptr<Model> model, std::shared_ptr<Mesh> mesh) {
+    this->__begin_frame();
+
+    this->__entries.push_back(Entry { object, world, model, mesh });
+}
+
+void Picking::request(const glm::vec2& pixel) {
+    this->__requested = true;
+    this->__pixel = pixel;
+}
+
+bool Picking::pending() {
+    return this->__requested || this->__fence != 0;
+}
+
+std::shared_ptr<Object> Picking::picked() {
+    return this->__picked.lock();
+}
+
+float Picking::last_pick_ms() {
+    return this->__last_pick_ms;
+}
+
+size_t Picking::bvh_rebuilds() {
+    return this->__bvh_rebuilds;
+}
+
+void Picking::process(const View& view, GLuint program) {
+    // Entries of the frame on screen (renderers of this frame did not record yet).
+    this->__begin_frame();
+
+    if(this->__fence != 0) {
+        this->__read_ids();
+    }
+
+    // One ID pass in flight at a time, later requests wait for it.
+    if(!this->__requested || this->__fence != 0) {
+        return;
+    }
+
+    this->__requested = false;
+
+    auto start = std::chrono::steady_clock::now();
+
+    if(this->mode == PickingMode::GPU) {
+        this->__render_ids(view, program);
+    } else {
+        this->__pick_bvh(view);
+    }
+
+    this->__last_pick_ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void Picking::__pick_bvh(const View& view) {
+    std::vector<Object*> objects;
+    std::vector<size_t> entries;
+    std::vector<glm::mat4> worlds;
+    AabbArray local;
+
+    for(size_t i = 0; i < this->__last_entries.size(); i++) {
+        auto& entry = this->__last_entries[i];
+        auto object = entry.object.lock();
+
+        if(object == nullptr || entry.mesh == nullptr) {
+            continue;
+        }
+
+        objects.push_back(object.get());
+        entries.push_back(i);
+        worlds.push_back(entry.world);
+    }
+
+    local.resize(entries.size());
+
+    for(size_t i = 0; i < entries.size(); i++) {
+        auto& mesh = this->__last_entries[entries[i]].mesh;
+
+        local.set(i, mesh->min, mesh->max);
+    }
+
+    // World boxes of the object space boxes, in one batch.
+    AabbArray world;
+    pepng::transform_aabbs(worlds.data(), local, world);
+
+    std::vector<glm::vec3> mins(entries.size()), maxs(entries.size());
+
+    for(size_t i = 0; i < entries.size(); i++) {
+        mins[i] = world.min(i);
+        maxs[i] = world.max(i);
+    }
+
+    // The topology stays valid while the same objects are drawn in the same order.
+    if(this->__scene == nullptr || objects != this->__scene_objects) {
+        this->__scene = pepng::make_bvh(mins, maxs);
+        this->__scene_objects = std::move(objects);
+        this->__bvh_rebuilds++;
+    } else {
+        this->__scene->refit(mins, maxs);
+    }
+
+    this->__scene_entries = std::move(entries);
+
+    // Ray from the near to the far plane through the pixel center.
+    glm::vec2 ndc = (this->__pixel + 0.5f - glm::vec2(view.viewport.x, view.viewport.y)) / glm::vec2(view.viewport.z, view.viewport.w) * 2.0f - 1.0f;
+    glm::mat4 inverse = glm::inverse(view.view_projection);
+
+    glm::vec4 near = inverse * glm::vec4(ndc, -1.0f, 1.0f);
+    glm::vec4 far = inverse * glm::vec4(ndc, 1.0f, 1.0f);
+
+    Ray ray;
+    ray.origin = glm::vec3(near) / near.w;
+    ray.direction = glm::vec3(far) / far.w - ray.origin;
+
+    const Entry* hit = nullptr;
+
+    this->__scene->raycast(ray, 1.0f, [&](uint32_t primitive, float closest) {
+        auto& entry = this->__last_entries[this->__scene_entries[primitive]];
+
+        glm::mat4 to_object = glm::inverse(entry.world);
+
+        Ray local;
+        local.origin = glm::vec3(to_object * glm::vec4(ray.origin, 1.0f));
+        local.direction = glm::vec3(to_object * glm::vec4(ray.direction, 0.0f));
+
+        // Affine transforms keep t, so hits of different objects compare directly.
+        float t = pepng::raycast(local, entry.mesh, closest);
+
+        if(t < closest) {
+            hit = &entry;
+
+            return t;
+        }
+
+        return closest;
+    });
+
+    this->__picked = hit != nullptr ? hit->object : std::weak_ptr<Object>();
+}
+
+void Picking::__render_ids(const View& view, GLuint program) {
+    glm::ivec2 size(view.viewport.z, view.viewport.w);
+
+    if(size.x <= 0 || size.y <= 0) {
+        return;
+    }
+
+    if(this->__framebuffer == 0) {
+        glGenFramebuffers(1, &this->__framebuffer);
+        glGenTextures(1, &this->__id_texture);
+        glGenRenderbuffers(1, &this->__depth_buffer);
+        glGenBuffers(1, &this->__pbo);
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, this->__pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, 4 * sizeof(GLuint), nullptr, GL_STREAM_READ);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+
+    GLint previous_framebuffer = 0, previous_program = 0, previous_viewport[4];
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous_framebuffer);
+    glGetIntegerv(GL_CURRENT_PROGRAM, &previous_program);
+    glGetIntegerv(GL_VIEWPORT, previous_viewport);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, this->__framebuffer);
+
+    if(size != this->__target_size) {
+        this->__target_size = size;
+
+        glBindTexture(GL_TEXTURE_2D, this->__id_texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R32UI, size.x, size.y, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        glBindRenderbuffer(GL_RENDERBUFFER, this->__depth_buffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, size.x, size.y);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, this->__id_texture, 0);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, this->__depth_buffer);
+
+        // 4 bytes of ID and 4 of depth per pixel.
+        pepng::memory()->track(&this->__framebuffer, MemoryRecord { "target", "", "picking IDs", 1, (size_t) size.x * size.y * 8, 0 });
+    }
+
+    glViewport(0, 0, size.x, size.y);
+
+    const GLuint background[4] = { 0, 0, 0, 0 };
+    glClearBufferuiv(GL_COLOR, 0, background);
+    glClear(GL_DEPTH_BUFFER_BIT);
+
+    glUseProgram(program);
+    glUniformMatrix4fv(pepng::uniform_location(program, "u_projection"), 1, GL_FALSE, glm::value_ptr(view.projection));
+    glUniformMatrix4fv(pepng::uniform_location(program, "u_view"), 1, GL_FALSE, glm::value_ptr(view.view));
+
+    GLint u_world = pepng::uniform_location(program, "u_world");
+    GLint u_id = pepng::uniform_location(program, "u_id");
+
+    this->__pass_objects.clear();
+
+    // ID 0 is the background, entry i is written as i + 1.
+    for(auto& entry : this->__last_entries) {
+        if(entry.object.expired() || !entry.model->is_init() || entry.model->vao() == (GLuint) -1) {
+            continue;
+        }
+
+        this->__pass_objects.push_back(entry.object);
+
+        glUniform1ui(u_id, (GLuint) this->__pass_objects.size());
+        glUniformMatrix4fv(u_world, 1, GL_FALSE, glm::value_ptr(entry.world));
+
+        auto& info = pepng::model_info(entry.model);
+
+        glBindVertexArray(info.vao);
+
+        if(info.indexed) {
+            glDrawElements(GL_TRIANGLES, entry.model->count(), GL_UNSIGNED_INT, (void*) 0);
+        } else {
+            glDrawArrays(GL_TRIANGLES, 0, entry.model->count());
+        }
+    }
+
+    glBindVertexArray(0);
+
+    // Only the picked pixel is copied, into the PBO: glReadPixels returns without waiting for the GPU.
+    glm::ivec2 pixel = glm::clamp(glm::ivec2(this->__pixel) - glm::ivec2(view.viewport.x, view.viewport.y), glm::ivec2(0), size - 1);
+
+    this->__pass_pixel = pixel;
+
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    #ifndef __EMSCRIPTEN__
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, this->__pbo);
+    glReadPixels(pixel.x, pixel.y, 1, 1, GL_RGBA_INTEGER, GL_UNSIGNED_INT, (void*) 0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    #endif
+
+    this->__fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, previous_framebuffer);
+    glViewport(previous_viewport[0], previous_viewport[1], previous_viewport[2], previous_viewport[3]);
+    glUseProgram(previous_program);
+}
+
+void Picking::__read_ids() {
+    GLenum status = glClientWaitSync(this->__fence, 0, 0);
+
+    if(status == GL_TIMEOUT_EXPIRED) {
+        return;
+    }
+
+    glDeleteSync(this->__fence);
+    this->__fence = 0;
+
+    if(status == GL_WAIT_FAILED) {
+        return;
+    }
+
+    GLuint values[4] = { 0, 0, 0, 0 };
+
+    #ifdef __EMSCRIPTEN__
+    // WebGL cannot read buffers back, but the finished ID target can be read without stalling.
+    GLint previous_framebuffer = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous_framebuffer);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, this->__framebuffer);
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glReadPixels(this->__pass_pixel.x, this->__pass_pixel.y, 1, 1, GL_RGBA_INTEGER, GL_UNSIGNED_INT, values);
+    glBindFramebuffer(GL_FRAMEBUFFER, previous_framebuffer);
+    #else
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, this->__pbo);
+    glGetBufferSubData(GL_PIXEL_PACK_BUFFER, 0, sizeof(values), values);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    #endif
+
+    GLuint id = values[0];
+
+    this->__picked = id > 0 && id <= this->__pass_objects.size() ? this->__pass_objects[id - 1] : std::weak_ptr<Object>();
+}
\ No newline at end of file
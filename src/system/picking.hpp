@@ -0,0 +1,101 @@
+#pragma once
+
+#include <pepng.h>
+
+#include "bvh.hpp"
+#include "view.hpp"
+
+enum class PickingMode {
+    // Object IDs rendered into an integer target, read back asynchronously through a PBO.
+    GPU,
+    // Ray cast against a scene Bvh of world boxes, then per-mesh triangle Bvhs.
+    BVH
+};
+
+/**
+ * Maps a pixel to the Object drawn there, from the draws renderers submitted last frame.
+ *
+ * Picks are requested and resolved a few frames later, so they never stall the pipeline.
+ */
+class Picking {
+    public:
+        static std::shared_ptr<Picking> make_picking();
+
+        PickingMode mode;
+
+        /**
+         * Registers a triangle draw for the current frame.
+         *
+         * @param mesh Object space geometry (nullptr: only the GPU mode can pick it).
+         */
+        void add(std::shared_ptr<Object> object, const glm::mat4& world, std::shared_ptr<Model> model, std::shared_ptr<Mesh> mesh);
+
+        /**
+         * Requests a pick at a pixel (GL window coordinates, origin bottom left).
+         */
+        void request(const glm::vec2& pixel);
+
+        /**
+         * Resolves pending picks. Call once per frame on the GL thread, before renderers record.
+         *
+         * @param program The picking shader program (u_projection, u_view, u_world, uint u_id).
+         */
+        void process(const View& view, GLuint program);
+
+        bool pending();
+
+        // The last picked Object (nullptr if the pick hit nothing or it was destroyed).
+        std::shared_ptr<Object> picked();
+
+        float last_pick_ms();
+        size_t bvh_rebuilds();
+
+    private:
+        Picking();
+
+        struct Entry {
+            std::weak_ptr<Object> object;
+            glm::mat4 world;
+            std::shared_ptr<Model> model;
+            std::shared_ptr<Mesh> mesh;
+        };
+
+        void __begin_frame();
+        void __pick_bvh(const View& view);
+        void __render_ids(const View& view, GLuint program);
+        void __read_ids();
+
+        size_t __frame;
+        std::vector<Entry> __entries;
+        std::vector<Entry> __last_entries;
+
+        bool __requested;
+        glm::vec2 __pixel;
+        std::weak_ptr<Object> __picked;
+        float __last_pick_ms;
+
+        // BVH mode: scene Bvh over the entries with a mesh, refitted while the same objects are drawn.
+        std::shared_ptr<Bvh> __scene;
+        std::vector<Object*> __scene_objects;
+        std::vector<size_t> __scene_entries;
+        size_t __bvh_rebuilds;
+
+        // GPU mode: ID target, PBO (desktop) and the pixel/objects of the pass in flight.
+        GLuint __framebuffer = 0;
+        GLuint __id_texture = 0;
+        GLuint __depth_buffer = 0;
+        glm::ivec2 __target_size = glm::ivec2(0);
+        GLuint __pbo = 0;
+        GLsync __fence = 0;
+        glm::ivec2 __pass_pixel = glm::ivec2(0);
+        std::vector<std::weak_ptr<Object>> __pass_objects;
+};
+
+namespace pepng {
+    std::shared_ptr<Picking> make_picking();
+
+    /**
+     * The engine-wide Picking (BVH by default, GPU on WebGL where meshes cannot be read back).
+     */
+    std::shared_ptr<Picking> picking();
+};
\ No newline at end of file
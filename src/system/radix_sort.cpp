@@ -0,0 +1,77 @@
+#include "radix_sort.hpp"
+
+#include <cstring>
+
+namespace {
+    // 3 passes of 11 bits, the histograms (24 KB) stay in the L1 cache.
+    constexpr int DIGIT_BITS = 11;
+    constexpr int PASSES = 3;
+    constexpr uint32_t DIGITS = 1u << DIGIT_BITS;
+}
+
+void pepng::radix_sort(std::vector<uint64_t>& values, std::vector<uint64_t>& scratch) {
+    size_t count = values.size();
+
+    scratch.resize(count);
+
+    if(count < 2) {
+        return;
+    }
+
+    // Every histogram in one read of the values.
+    static thread_local uint32_t histograms[PASSES][DIGITS];
+
+    std::memset(histograms, 0, sizeof(histograms));
+
+    for(auto value : values) {
+        uint32_t key = (uint32_t) (value >> 32);
+
+        histograms[0][key & (DIGITS - 1)]++;
+        histograms[1][(key >> DIGIT_BITS) & (DIGITS - 1)]++;
+        histograms[2][key >> (DIGIT_BITS * 2)]++;
+    }
+
+    uint64_t* source = values.data();
+    uint64_t* destination = scratch.data();
+
+    for(int pass = 0; pass < PASSES; pass++) {
+        auto& histogram = histograms[pass];
+        int shift = 32 + pass * DIGIT_BITS;
+
+        // All in one bucket: this digit would not move anything (e.g. the exponents of similar depths).
+        if(histogram[(source[0] >> shift) & (DIGITS - 1)] == count) {
+            continue;
+        }
+
+        // Turned into the write offset of every digit.
+        uint32_t offset = 0;
+
+        for(uint32_t i = 0; i < DIGITS; i++) {
+            uint32_t digit_count = histogram[i];
+
+            histogram[i] = offset;
+            offset += digit_count;
+        }
+
+        for(size_t i = 0; i < count; i++) {
+            uint64_t value = source[i];
+
+            destination[histogram[(value >> shift) & (DIGITS - 1)]++] = value;
+        }
+
+        std::swap(source, destination);
+    }
+
+    if(source != values.data()) {
+        std::memcpy(values.data(), source, count * sizeof(uint64_t));
+    }
+}
+
+uint32_t pepng::float_key(float value) {
+    uint32_t bits;
+
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    // Negatives have every bit flipped (larger magnitudes first), positives only the sign (after the negatives).
+    return bits ^ ((bits & 0x80000000u) ? 0xffffffffu : 0x80000000u);
+}
\ No newline at end of file
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <pepng.h>
+
+namespace pepng {
+    /**
+     * Stable LSD radix sort of 64-bit values by their upper 32 bits (the key, the lower bits usually hold an index).
+     *
+     * 11 bits per pass, passes where every key has the same digit are skipped.
+     *
+     * @param scratch Same size as values once sorted, kept by the caller so sorting every frame does not allocate.
+     */
+    void radix_sort(std::vector<uint64_t>& values, std::vector<uint64_t>& scratch);
+
+    // Key that orders floats like their values (negative ones included).
+    uint32_t float_key(float value);
+};
\ No newline at end of file
@@ -0,0 +1,105 @@
+#include "redraw.hpp"
+
+#include "input_log.hpp"
+
+RedrawScheduler::RedrawScheduler() :
+    enabled(false),
+    timeout(0.5f),
+    __requested(true),
+    __hash(0),
+    __changed(true),
+    __linger(RedrawScheduler::LINGER_FRAMES),
+    __idle_waits(0),
+    __last_time(glfwGetTime()),
+    __frames_per_second(0.0f)
+{}
+
+std::shared_ptr<RedrawScheduler> RedrawScheduler::make_redraw_scheduler() {
+    std::shared_ptr<RedrawScheduler> redraw_scheduler(new RedrawScheduler());
+
+    return redraw_scheduler;
+}
+
+std::shared_ptr<RedrawScheduler> pepng::make_redraw_scheduler() {
+    return RedrawScheduler::make_redraw_scheduler();
+}
+
+std::shared_ptr<RedrawScheduler> pepng::redraw() {
+    static auto redraw = pepng::make_redraw_scheduler();
+
+    return redraw;
+}
+
+void pepng::request_redraw() {
+    pepng::redraw()->request();
+}
+
+void RedrawScheduler::request() {
+    if(!this->__requested.exchange(true)) {
+        glfwPostEmptyEvent();
+    }
+}
+
+void RedrawScheduler::submitted(CommandList& list) {
+    uint64_t hash = list.hash();
+
+    this->__changed = hash != this->__hash;
+    this->__hash = hash;
+}
+
+bool RedrawScheduler::__dirty() {
+    bool dirty = this->__requested.exchange(false) || this->__changed;
+
+    auto input_log = pepng::input_log();
+
+    // Replays and recordings need every frame, held keys move the camera without new events.
+    dirty = dirty || input_log->mode() != InputLog::Mode::IDLE || input_log->active();
+
+    #ifdef IMGUI
+    auto& io = ImGui::GetIO();
+
+    dirty = dirty || ImGui::IsAnyItemActive() || io.MouseDelta.x != 0.0f || io.MouseDelta.y != 0.0f || io.MouseWheel != 0.0f;
+    #endif
+
+    return dirty;
+}
+
+void RedrawScheduler::wait() {
+    double time = glfwGetTime();
+    float delta = (float) (time - this->__last_time);
+    this->__last_time = time;
+
+    if(delta > 0.0f) {
+        this->__frames_per_second += (1.0f / delta - this->__frames_per_second) * 0.1f;
+    }
+
+    #ifndef __EMSCRIPTEN__
+    if(!this->enabled) {
+        return;
+    }
+
+    if(this->__dirty()) {
+        this->__linger = RedrawScheduler::LINGER_FRAMES;
+
+        return;
+    }
+
+    if(this->__linger > 0) {
+        this->__linger--;
+
+        return;
+    }
+
+    this->__idle_waits++;
+
+    glfwWaitEventsTimeout(this->timeout);
+    #endif
+}
+
+float RedrawScheduler::frames_per_second() {
+    return this->__frames_per_second;
+}
+
+size_t RedrawScheduler::idle_waits() {
+    return this->__idle_waits;
+}
\ No newline at end of file
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <pepng.h>
+
+#include <atomic>
+
+#include "command_list.hpp"
+
+/**
+ * Redraw-on-demand: blocks the loop on GLFW events while frames would come out identical.
+ *
+ * A frame is dirty when its recorded CommandList differs from the previous one (transforms, materials,
+ * textures, camera), a tracked input label is held, ImGui is being used or something called request.
+ * A few frames are still drawn after the last dirty one so ImGui and the occlusion queries settle.
+ * Not available on WebGL (the browser drives the loop).
+ */
+class RedrawScheduler {
+    public:
+        static std::shared_ptr<RedrawScheduler> make_redraw_scheduler();
+
+        // Opt-in.
+        bool enabled;
+        // Longest wait (seconds), so background work (loads, jobs) is still picked up.
+        float timeout;
+
+        /**
+         * Marks the next frame dirty. Thread-safe (wakes a blocked loop).
+         */
+        void request();
+
+        // Hashes the list about to be submitted. Called by CommandFlush while enabled.
+        void submitted(CommandList& list);
+
+        // Blocks until an event or the timeout if nothing is dirty. Called once per frame before the update.
+        void wait();
+
+        // Frames actually drawn per second (smoothed).
+        float frames_per_second();
+        // Number of times the loop blocked.
+        size_t idle_waits();
+
+        static constexpr int LINGER_FRAMES = 3;
+
+    private:
+        RedrawScheduler();
+
+        bool __dirty();
+
+        std::atomic<bool> __requested;
+        uint64_t __hash;
+        bool __changed;
+        int __linger;
+
+        size_t __idle_waits;
+        double __last_time;
+        float __frames_per_second;
+};
+
+namespace pepng {
+    std::shared_ptr<RedrawScheduler> make_redraw_scheduler();
+
+    std::shared_ptr<RedrawScheduler> redraw();
+
+    /**
+     * Asks for another frame in redraw-on-demand mode (call it every frame while animating).
+     */
+    void request_redraw();
+};
\ No newline at end of file
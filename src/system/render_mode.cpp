@@ -0,0 +1,198 @@
+#include "render_mode.hpp"
+
+#include <unordered_set>
+
+#include "memory.hpp"
+#include "mesh.hpp"
+#include "model_info.hpp"
+
+namespace {
+    std::optional<GLenum> current_override;
+
+    struct CachedEdgeBuffer {
+        std::weak_ptr<Model> model;
+        std::shared_ptr<EdgeBuffer> edges;
+    };
+
+    std::unordered_map<Model*, CachedEdgeBuffer>& edge_cache() {
+        static std::unordered_map<Model*, CachedEdgeBuffer> cache;
+
+        return cache;
+    }
+
+    // Deletes the GL objects of entries whose Model is gone (their Model* may be reused by a new Model).
+    void sweep_edge_cache() {
+        auto& cache = edge_cache();
+
+        for(auto it = cache.begin(); it != cache.end();) {
+            if(!it->second.model.expired()) {
+                ++it;
+
+                continue;
+            }
+
+            if(auto edges = it->second.edges) {
+                glDeleteVertexArrays(1, &edges->vao);
+                glDeleteBuffers(1, &edges->element_buffer);
+
+                pepng::memory()->untrack(edges.get());
+            }
+
+            it = cache.erase(it);
+        }
+    }
+
+    // Copies the float attribute pointers of a VAO into the bound one.
+    void copy_vertex_layout(GLuint source, GLuint target) {
+        GLint max_attributes = 0;
+        glGetIntegerv(GL_MAX_VERTEX_ATTRIBS, &max_attributes);
+
+        struct Attribute {
+            GLuint index;
+            GLint buffer, size, type, normalized, stride;
+            void* pointer;
+        };
+
+        std::vector<Attribute> attributes;
+
+        glBindVertexArray(source);
+
+        for(GLint i = 0; i < max_attributes; i++) {
+            GLint enabled = GL_FALSE;
+            glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_ENABLED, &enabled);
+
+            if(enabled == GL_FALSE) {
+                continue;
+            }
+
+            Attribute attribute { (GLuint) i, 0, 0, 0, 0, 0, nullptr };
+
+            glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING, &attribute.buffer);
+            glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_SIZE, &attribute.size);
+            glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_TYPE, &attribute.type);
+            glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_NORMALIZED, &attribute.normalized);
+            glGetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_STRIDE, &attribute.stride);
+            glGetVertexAttribPointerv(i, GL_VERTEX_ATTRIB_ARRAY_POINTER, &attribute.pointer);
+
+            attributes.push_back(attribute);
+        }
+
+        glBindVertexArray(target);
+
+        for(auto& attribute : attributes) {
+            glBindBuffer(GL_ARRAY_BUFFER, attribute.buffer);
+            glVertexAttribPointer(attribute.index, attribute.size, attribute.type, (GLboolean) attribute.normalized, attribute.stride, attribute.pointer);
+            glEnableVertexAttribArray(attribute.index);
+        }
+
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+}
+
+void pepng::set_render_mode_override(std::optional<GLenum> mode) {
+    current_override = mode;
+}
+
+std::optional<GLenum> pepng::render_mode_override() {
+    return current_override;
+}
+
+std::shared_ptr<EdgeBuffer> pepng::edge_buffer(std::shared_ptr<Model> model) {
+    auto& cache = edge_cache();
+
+    auto it = cache.find(model.get());
+
+    if(it != cache.end() && !it->second.model.expired()) {
+        return it->second.edges;
+    }
+
+    // Also frees the entry being replaced, if its Model is gone.
+    sweep_edge_cache();
+
+    auto& cached = cache[model.get()];
+    cached.model = model;
+    cached.edges = nullptr;
+
+    auto mesh = pepng::read_mesh(model);
+    std::vector<unsigned int> indices;
+
+    if(mesh != nullptr) {
+        // Vertices split by normals/UVs are welded by position, so seams are not drawn twice.
+        std::vector<unsigned int> welded = pepng::weld_positions(mesh->positions);
+        std::unordered_set<uint64_t> seen;
+
+        for(size_t i = 0; i + 2 < mesh->indices.size(); i += 3) {
+            for(int j = 0; j < 3; j++) {
+                unsigned int a = mesh->indices[i + j];
+                unsigned int b = mesh->indices[i + (j + 1) % 3];
+
+                uint64_t low = std::min(welded[a], welded[b]);
+                uint64_t high = std::max(welded[a], welded[b]);
+
+                if(low != high && seen.insert((high << 32) | low).second) {
+                    indices.push_back(a);
+                    indices.push_back(b);
+                }
+            }
+        }
+    } else if(!pepng::model_info(model).indexed) {
+        // Not readable (WebGL), but the triangles of a non indexed Model are its vertices in order:
+        // outline each of them (edges shared by two triangles are drawn twice).
+        unsigned int count = (unsigned int) std::max(model->count(), 0);
+
+        for(unsigned int i = 0; i + 2 < count; i += 3) {
+            for(unsigned int j = 0; j < 3; j++) {
+                indices.push_back(i + j);
+                indices.push_back(i + (j + 1) % 3);
+            }
+        }
+    }
+
+    if(indices.empty()) {
+        return nullptr;
+    }
+
+    auto edges = std::make_shared<EdgeBuffer>();
+    edges->count = (GLsizei) indices.size();
+
+    glGenVertexArrays(1, &edges->vao);
+    copy_vertex_layout(pepng::model_info(model).vao, edges->vao);
+
+    glGenBuffers(1, &edges->element_buffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, edges->element_buffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    cached.edges = edges;
+
+    pepng::memory()->track(edges.get(), MemoryRecord { "buffer", "", "edges", 1, indices.size() * sizeof(unsigned int), 0 });
+
+    return edges;
+}
+
+void pepng::record_draw_override(CommandList& list, std::shared_ptr<Model> model, GLenum render_mode) {
+    // Only triangle renderers follow the override (line and point Models are already what they are).
+    if(!current_override.has_value() || render_mode != GL_TRIANGLES) {
+        pepng::record_draw(list, model, render_mode);
+
+        return;
+    }
+
+    GLenum mode = current_override.value();
+
+    if(mode == GL_LINES) {
+        if(auto edges = pepng::edge_buffer(model)) {
+            list.bind_vertex_array(edges->vao);
+            list.draw_elements(GL_LINES, edges->count, GL_UNSIGNED_INT, 0);
+        } else {
+            // Triangle indices drawn as GL_LINES would pair unrelated vertices: stay filled instead.
+            pepng::record_draw(list, model, render_mode);
+        }
+
+        return;
+    }
+
+    pepng::record_draw(list, model, mode);
+}
\ No newline at end of file
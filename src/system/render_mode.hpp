@@ -0,0 +1,41 @@
+#pragma once
+
+#include <pepng.h>
+
+#include <optional>
+
+#include "command_list.hpp"
+
+/**
+ * Deduplicated GL_LINES index buffer of a triangle Model, drawn with a copy of the Model's vertex layout.
+ */
+struct EdgeBuffer {
+    GLuint vao;
+    GLuint element_buffer;
+    GLsizei count;
+};
+
+namespace pepng {
+    /**
+     * Scene-wide render mode applied to every triangle renderer (std::nullopt = their own mode).
+     */
+    void set_render_mode_override(std::optional<GLenum> mode);
+    std::optional<GLenum> render_mode_override();
+
+    /**
+     * Cached EdgeBuffer of a Model (built on first use from its read back Mesh).
+     *
+     * When the Mesh is not readable (WebGL), non indexed Models get the outline of every triangle instead.
+     *
+     * @return nullptr for indexed Models whose Mesh is not readable.
+     */
+    std::shared_ptr<EdgeBuffer> edge_buffer(std::shared_ptr<Model> model);
+
+    /**
+     * Records the draw of a Model through the render mode override.
+     *
+     * Triangle Models drawn as GL_LINES use their EdgeBuffer, so every edge is drawn once and whole.
+     * Without one (see edge_buffer), they keep their own mode.
+     */
+    void record_draw_override(CommandList& list, std::shared_ptr<Model> model, GLenum render_mode);
+};
\ No newline at end of file
@@ -0,0 +1,322 @@
+#include "resources.hpp"
+
+#include <fstream>
+
+#include "command_list.hpp"
+#include "memory.hpp"
+#include "texture_info.hpp"
+
+TextureHandle::TextureHandle(ResourceManager* manager, const std::filesystem::path& path, bool missing) :
+    __manager(manager),
+    __path(path),
+    __missing(missing),
+    __bytes(0),
+    __blend_mode(BlendMode::NONE),
+    __read_state(ReadState::UNREAD),
+    __hash(0),
+    __image_size(0),
+    __last_visible(0),
+    __pinned(false)
+{}
+
+const std::filesystem::path& TextureHandle::path() {
+    return this->__path;
+}
+
+bool TextureHandle::resident() {
+    return this->__texture != nullptr;
+}
+
+size_t TextureHandle::bytes() {
+    return this->__bytes;
+}
+
+BlendMode TextureHandle::blend_mode() {
+    return this->__blend_mode;
+}
+
+bool TextureHandle::read() {
+    return this->__read_state == ReadState::READ;
+}
+
+void TextureHandle::__read() {
+    // The engine decodes from the path on the GL thread: reading the file here leaves it in the OS cache.
+    std::ifstream file(this->__path, std::ios::binary);
+    std::vector<char> buffer(64 * 1024);
+    uint64_t hash = pepng::content_hash(nullptr, 0);
+    size_t size_read = 0;
+
+    while(file) {
+        file.read(buffer.data(), buffer.size());
+
+        hash = pepng::content_hash(buffer.data(), (size_t) file.gcount(), hash);
+        size_read += (size_t) file.gcount();
+    }
+
+    // Unreadable files are never shared.
+    this->__hash = size_read > 0 ? hash : 0;
+
+    glm::ivec2 size(0);
+
+    if(pepng::read_image_size(this->__path, size)) {
+        this->__image_size = size;
+    }
+
+    this->__read_state = ReadState::READ;
+}
+
+void TextureHandle::pin() {
+    this->__pinned = true;
+}
+
+std::shared_ptr<Texture> TextureHandle::acquire(std::shared_ptr<Material> material) {
+    this->__last_visible = pepng::commands()->frame();
+
+    // Only handles read ahead know their content: the others load their own Texture.
+    std::shared_ptr<Texture> shared = this->__texture == nullptr && this->read() ? this->__manager->__shared_texture(this) : nullptr;
+
+    if(shared != nullptr) {
+        // Counted once, by the handle that loaded it.
+        this->__texture = shared;
+        this->__bytes = 0;
+        this->__blend_mode = pepng::texture_blend_mode(this->__texture);
+
+        this->__manager->__loaded(this);
+    } else if(this->__texture == nullptr) {
+        this->__texture = this->__missing ? pepng::make_texture() : pepng::make_texture(this->__path);
+        this->__texture->delayed_init();
+
+        this->__bytes = pepng::texture_bytes(this->__texture);
+
+        // Sizes cannot be queried on WebGL: 4 bytes per pixel of the size read ahead from the header.
+        if(this->__bytes == 0 && this->read()) {
+            this->__bytes = (size_t) this->__image_size.x * this->__image_size.y * 4;
+        }
+
+        // Otherwise assumes 4 bytes per pixel of a ~1:4 compressed file.
+        if(this->__bytes == 0) {
+            std::error_code error;
+            this->__bytes = (size_t) std::filesystem::file_size(this->__path, error) * 16;
+        }
+
+        // Classified once per load, so renderers never read the texture back.
+        this->__blend_mode = pepng::texture_blend_mode(this->__texture);
+
+        this->__manager->__loaded(this);
+    }
+
+    if(material != nullptr) {
+        bool bound = false;
+
+        for(auto& weak : this->__materials) {
+            if(weak.lock() == material) {
+                bound = true;
+                break;
+            }
+        }
+
+        if(!bound) {
+            this->__materials.erase(std::remove_if(this->__materials.begin(), this->__materials.end(), [](const std::weak_ptr<Material>& weak) {
+                return weak.expired();
+            }), this->__materials.end());
+
+            this->__materials.push_back(material);
+        }
+
+        material->texture = this->__texture;
+    }
+
+    return this->__texture;
+}
+
+bool TextureHandle::__evict(std::shared_ptr<Texture> placeholder) {
+    if(this->__texture == nullptr || this->__pinned) {
+        return false;
+    }
+
+    std::vector<std::shared_ptr<Material>> materials;
+
+    for(auto& weak : this->__materials) {
+        auto material = weak.lock();
+
+        if(material != nullptr && material->texture == this->__texture) {
+            materials.push_back(material);
+        }
+    }
+
+    // Somebody else holds the Texture: releasing ours would not free anything.
+    if((size_t) this->__texture.use_count() > materials.size() + 1) {
+        return false;
+    }
+
+    for(auto& material : materials) {
+        material->texture = placeholder;
+    }
+
+    pepng::forget_texture_blend_mode(this->__texture);
+    pepng::memory()->release(this->__texture);
+    this->__texture = nullptr;
+    this->__read_state = ReadState::UNREAD;
+
+    return true;
+}
+
+ResourceManager::ResourceManager(size_t budget) :
+    __budget(budget),
+    __resident_bytes(0),
+    __eviction_count(0)
+{}
+
+std::shared_ptr<ResourceManager> ResourceManager::make_resource_manager(size_t budget) {
+    std::shared_ptr<ResourceManager> resource_manager(new ResourceManager(budget));
+
+    return resource_manager;
+}
+
+std::shared_ptr<ResourceManager> pepng::make_resource_manager(size_t budget) {
+    return ResourceManager::make_resource_manager(budget);
+}
+
+std::shared_ptr<ResourceManager> pepng::resources() {
+    static auto resource_manager = pepng::make_resource_manager();
+
+    return resource_manager;
+}
+
+std::shared_ptr<TextureHandle> ResourceManager::texture(const std::filesystem::path& path) {
+    std::error_code error;
+    auto canonical = std::filesystem::weakly_canonical(path, error).string();
+
+    if(error) {
+        canonical = path.string();
+    }
+
+    auto it = this->__by_path.find(canonical);
+
+    if(it != this->__by_path.end()) {
+        return it->second;
+    }
+
+    // Paths come from material files: a bad one shows the missing texture like the engine's loader (exceptions are fatal on WebAssembly).
+    bool missing = !std::filesystem::is_regular_file(path, error);
+
+    if(missing) {
+        std::cout << "Could not read texture " << path << ", the missing texture is shown instead." << std::endl;
+    }
+
+    // The content is hashed once read ahead, same bytes under another path (copies of an asset) then share one Texture.
+    std::shared_ptr<TextureHandle> handle(new TextureHandle(this, path, missing));
+
+    this->__by_path[canonical] = handle;
+
+    return handle;
+}
+
+void ResourceManager::set_budget(size_t budget) {
+    this->__budget = budget;
+
+    this->__enforce_budget();
+}
+
+size_t ResourceManager::budget() {
+    return this->__budget;
+}
+
+size_t ResourceManager::resident_bytes() {
+    return this->__resident_bytes;
+}
+
+size_t ResourceManager::texture_count() {
+    return this->__by_path.size();
+}
+
+size_t ResourceManager::eviction_count() {
+    return this->__eviction_count;
+}
+
+std::shared_ptr<Texture> ResourceManager::placeholder() {
+    if(this->__placeholder_texture == nullptr) {
+        this->__placeholder_texture = pepng::make_texture();
+        this->__placeholder_texture->delayed_init();
+    }
+
+    return this->__placeholder_texture;
+}
+
+void ResourceManager::__loaded(TextureHandle* handle) {
+    this->__resident_bytes += handle->__bytes;
+
+    pepng::memory()->observe(handle->__texture, "resources", handle->__path.string());
+
+    this->__enforce_budget();
+}
+
+std::shared_ptr<Texture> ResourceManager::__shared_texture(TextureHandle* handle) {
+    if(handle->__hash == 0) {
+        return nullptr;
+    }
+
+    auto& other = this->__by_hash[handle->__hash];
+
+    if(other != nullptr && other != handle && other->resident()) {
+        return other->__texture;
+    }
+
+    // Nobody holds this content (or its Texture was evicted): handle loads it and is the one shared.
+    other = handle;
+
+    return nullptr;
+}
+
+void ResourceManager::__enforce_budget() {
+    if(this->__resident_bytes <= this->__budget) {
+        return;
+    }
+
+    size_t frame = pepng::commands()->frame();
+
+    // Unique handles: a handle is referenced by the manager once per path alias.
+    std::vector<std::pair<std::shared_ptr<TextureHandle>, long>> handles;
+
+    for(auto& [path, handle] : this->__by_path) {
+        auto found = std::find_if(handles.begin(), handles.end(), [&](auto& entry) {
+            return entry.first == handle;
+        });
+
+        if(found == handles.end()) {
+            handles.push_back({ handle, 1 });
+        } else {
+            found->second++;
+        }
+    }
+
+    // (handle, referenced outside the manager) for textures that may be evicted.
+    std::vector<std::pair<TextureHandle*, bool>> candidates;
+
+    for(auto& [handle, aliases] : handles) {
+        // Textures drawn this frame are already recorded, so they must stay alive.
+        if(handle->resident() && handle->__last_visible != frame) {
+            candidates.push_back({ handle.get(), handle.use_count() > aliases + 1 });
+        }
+    }
+
+    // Handles nobody else holds go first, then least recently visible.
+    std::stable_sort(candidates.begin(), candidates.end(), [](auto& a, auto& b) {
+        if(a.second != b.second) {
+            return !a.second;
+        }
+
+        return a.first->__last_visible < b.first->__last_visible;
+    });
+
+    for(auto [candidate, referenced] : candidates) {
+        if(this->__resident_bytes <= this->__budget) {
+            break;
+        }
+
+        if(candidate->__evict(this->placeholder())) {
+            this->__resident_bytes -= std::min(this->__resident_bytes, candidate->__bytes);
+            this->__eviction_count++;
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <pepng.h>
+
+#include <atomic>
+
+#include "command_list.hpp"
+
+class ResourceManager;
+
+/**
+ * Shared handle to a Texture owned by the ResourceManager.
+ *
+ * The Texture can be evicted while the handle lives: bound Materials then show the placeholder
+ * until the next acquire() reloads it.
+ */
+class TextureHandle {
+    public:
+        const std::filesystem::path& path();
+
+        /**
+         * The Texture (reloaded if evicted), marked as visible this frame.
+         *
+         * @param material Material to keep bound to the handle (its texture is swapped on eviction/reload).
+         */
+        std::shared_ptr<Texture> acquire(std::shared_ptr<Material> material = nullptr);
+
+        // Pinned textures are never evicted (e.g. always visible ones drawn without acquire()).
+        void pin();
+
+        bool resident();
+        size_t bytes();
+        // BlendMode of the texture's alpha, classified when it is loaded (NONE until then, see pepng::texture_blend_mode).
+        BlendMode blend_mode();
+
+        // Whether the file was read ahead (see AssetStreaming::prefetch), acquire() then does not wait on the disk.
+        bool read();
+
+    private:
+        friend class ResourceManager;
+        friend class AssetStreaming;
+
+        enum class ReadState { UNREAD, QUEUED, READ };
+
+        TextureHandle(ResourceManager* manager, const std::filesystem::path& path, bool missing);
+
+        bool __evict(std::shared_ptr<Texture> placeholder);
+        // Reads the file, its content hash and image size (on the loader thread).
+        void __read();
+
+        ResourceManager* __manager;
+        std::filesystem::path __path;
+        // Missing files load the engine's missing texture.
+        bool __missing;
+
+        std::shared_ptr<Texture> __texture;
+        std::vector<std::weak_ptr<Material>> __materials;
+
+        size_t __bytes;
+        BlendMode __blend_mode;
+
+        // Reset on eviction, the next load reads the file ahead again. __hash and __image_size are written before READ.
+        std::atomic<ReadState> __read_state;
+        // Content hash (0 until read).
+        uint64_t __hash;
+        glm::ivec2 __image_size;
+        size_t __last_visible;
+        bool __pinned;
+};
+
+/**
+ * Cache of file backed Textures, deduplicated by canonical path and content hash, under a memory budget.
+ *
+ * Files are hashed when they are read ahead (see AssetStreaming::prefetch), not when their handle is made.
+ * Handles read ahead share the Texture of a resident handle with the same content.
+ *
+ * When resident textures exceed the budget, textures without handles are released first.
+ * Then the least recently visible ones are evicted (LRU). Textures visible this frame are never evicted.
+ */
+class ResourceManager {
+    public:
+        static std::shared_ptr<ResourceManager> make_resource_manager(size_t budget);
+
+        /**
+         * Handle to the Texture of a file (loaded on first acquire).
+         */
+        std::shared_ptr<TextureHandle> texture(const std::filesystem::path& path);
+
+        void set_budget(size_t budget);
+        size_t budget();
+
+        size_t resident_bytes();
+        size_t texture_count();
+        size_t eviction_count();
+
+        // Texture shown by Materials whose texture is evicted or not loaded yet.
+        std::shared_ptr<Texture> placeholder();
+
+    private:
+        friend class TextureHandle;
+
+        ResourceManager(size_t budget);
+
+        // Called by handles after a (re)load.
+        void __loaded(TextureHandle* handle);
+        // The resident Texture with the same content as handle, nullptr if none (handle then becomes the one shared).
+        std::shared_ptr<Texture> __shared_texture(TextureHandle* handle);
+        void __enforce_budget();
+
+        size_t __budget;
+        size_t __resident_bytes;
+        size_t __eviction_count;
+
+        std::unordered_map<std::string, std::shared_ptr<TextureHandle>> __by_path;
+        // Handle that loaded each content. Handles live as long as the manager (never removed from __by_path).
+        std::unordered_map<uint64_t, TextureHandle*> __by_hash;
+
+        std::shared_ptr<Texture> __placeholder_texture;
+};
+
+namespace pepng {
+    std::shared_ptr<ResourceManager> make_resource_manager(size_t budget = 256 * 1024 * 1024);
+
+    /**
+     * The engine-wide ResourceManager.
+     */
+    std::shared_ptr<ResourceManager> resources();
+};
\ No newline at end of file
@@ -0,0 +1,534 @@
+#include "scene_tree.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <typeinfo>
+
+#include "command_list.hpp"
+#include "picking.hpp"
+
+#ifdef IMGUI
+#include <imgui_internal.h>
+#endif
+
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#endif
+
+namespace {
+    std::string lower(const std::string& text) {
+        std::string result(text);
+
+        std::transform(result.begin(), result.end(), result.begin(), [](unsigned char c) {
+            return (char) std::tolower(c);
+        });
+
+        return result;
+    }
+
+    #ifdef IMGUI
+    // Class name of a Component (the engine gives them no public name).
+    std::string component_name(Component& component) {
+        const char* name = typeid(component).name();
+
+        #if defined(__GNUG__)
+        int status = 0;
+        char* demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+
+        std::string result = status == 0 ? demangled : name;
+        std::free(demangled);
+
+        return result;
+        #else
+        std::string result = name;
+
+        return result.rfind("class ", 0) == 0 ? result.substr(6) : result;
+        #endif
+    }
+    #endif
+}
+
+SceneTree::SceneTree() :
+    hide_engine_windows(true),
+    __visible_dirty(true),
+    __index_dirty(true),
+    __rebuild(false),
+    __generation(0),
+    __scroll_to_selected(false),
+    __frame((size_t) -1)
+{}
+
+std::shared_ptr<SceneTree> SceneTree::make_scene_tree() {
+    std::shared_ptr<SceneTree> scene_tree(new SceneTree());
+
+    return scene_tree;
+}
+
+std::shared_ptr<SceneTree> pepng::make_scene_tree() {
+    return SceneTree::make_scene_tree();
+}
+
+std::shared_ptr<SceneTree> pepng::scene_tree() {
+    static auto scene_tree = pepng::make_scene_tree();
+
+    return scene_tree;
+}
+
+void SceneTree::add_root(std::shared_ptr<Object> root) {
+    for(auto& existing : this->__roots) {
+        if(existing.lock() == root) {
+            return;
+        }
+    }
+
+    this->__roots.push_back(root);
+
+    std::vector<Row> rows;
+    this->__flatten(root, 0, -1, this->__rows.size(), rows);
+
+    this->__rows.insert(this->__rows.end(), rows.begin(), rows.end());
+    this->__open.push_back(1);
+    this->__open.resize(this->__rows.size(), 0);
+
+    this->__visible_dirty = true;
+    this->__index_dirty = true;
+}
+
+void SceneTree::invalidate() {
+    this->__rebuild = true;
+}
+
+void SceneTree::changed(std::shared_ptr<Object> object) {
+    this->__changed[object.get()] = object;
+}
+
+size_t SceneTree::generation() {
+    return this->__generation;
+}
+
+const std::vector<SceneTree::Row>& SceneTree::rows() {
+    return this->__rows;
+}
+
+std::shared_ptr<Object> SceneTree::selected() {
+    return this->__selected.lock();
+}
+
+void SceneTree::__flatten(std::shared_ptr<Object> object, uint32_t depth, int32_t parent, size_t base, std::vector<Row>& out) {
+    size_t index = out.size();
+
+    out.push_back(Row {
+        object,
+        object.get(),
+        depth,
+        parent,
+        1
+    });
+
+    for(auto& child : object->children) {
+        this->__flatten(child, depth + 1, (int32_t) (base + index), base, out);
+    }
+
+    out[index].subtree_size = (uint32_t) (out.size() - index);
+}
+
+void SceneTree::__splice(size_t row) {
+    auto object = this->__rows[row].object.lock();
+
+    // A destroyed Object is removed by re-flattening its parent.
+    if(object == nullptr) {
+        if(this->__rows[row].parent < 0) {
+            this->__remove(row);
+        } else {
+            this->__splice(this->__rows[row].parent);
+        }
+
+        return;
+    }
+
+    auto& entry = this->__rows[row];
+    size_t old_size = entry.subtree_size;
+
+    std::vector<Row> fresh;
+    this->__flatten(object, entry.depth, entry.parent, row, fresh);
+
+    // Open state survives by identity.
+    std::unordered_map<Object*, uint8_t> open;
+
+    for(size_t i = row; i < row + old_size; i++) {
+        if(this->__open[i]) {
+            open[this->__rows[i].key] = 1;
+        }
+    }
+
+    std::vector<uint8_t> fresh_open(fresh.size(), 0);
+
+    for(size_t i = 0; i < fresh.size(); i++) {
+        fresh_open[i] = open.count(fresh[i].key) > 0 ? 1 : 0;
+    }
+
+    long delta = (long) fresh.size() - (long) old_size;
+
+    this->__rows.erase(this->__rows.begin() + row, this->__rows.begin() + row + old_size);
+    this->__rows.insert(this->__rows.begin() + row, fresh.begin(), fresh.end());
+    this->__open.erase(this->__open.begin() + row, this->__open.begin() + row + old_size);
+    this->__open.insert(this->__open.begin() + row, fresh_open.begin(), fresh_open.end());
+
+    // Parents after the subtree moved with it.
+    for(size_t i = row + fresh.size(); i < this->__rows.size(); i++) {
+        if(this->__rows[i].parent >= (int32_t) (row + old_size)) {
+            this->__rows[i].parent += (int32_t) delta;
+        }
+    }
+
+    for(int32_t parent = this->__rows[row].parent; parent >= 0; parent = this->__rows[parent].parent) {
+        this->__rows[parent].subtree_size += (int32_t) delta;
+    }
+
+    this->__generation++;
+    this->__visible_dirty = true;
+    this->__index_dirty = true;
+}
+
+void SceneTree::__remove(size_t row) {
+    size_t size = this->__rows[row].subtree_size;
+
+    this->__rows.erase(this->__rows.begin() + row, this->__rows.begin() + row + size);
+    this->__open.erase(this->__open.begin() + row, this->__open.begin() + row + size);
+
+    for(size_t i = row; i < this->__rows.size(); i++) {
+        if(this->__rows[i].parent >= (int32_t) row) {
+            this->__rows[i].parent -= (int32_t) size;
+        }
+    }
+
+    this->__roots.erase(std::remove_if(this->__roots.begin(), this->__roots.end(), [](const std::weak_ptr<Object>& root) {
+        return root.expired();
+    }), this->__roots.end());
+
+    this->__generation++;
+    this->__visible_dirty = true;
+    this->__index_dirty = true;
+}
+
+void SceneTree::__validate() {
+    if(this->__rebuild) {
+        this->__rebuild = false;
+
+        std::unordered_map<Object*, uint8_t> open;
+
+        for(size_t i = 0; i < this->__rows.size(); i++) {
+            open[this->__rows[i].key] = this->__open[i];
+        }
+
+        this->__rows.clear();
+
+        for(auto& root : this->__roots) {
+            if(auto object = root.lock()) {
+                this->__flatten(object, 0, -1, 0, this->__rows);
+            }
+        }
+
+        this->__open.assign(this->__rows.size(), 0);
+
+        for(size_t i = 0; i < this->__rows.size(); i++) {
+            auto it = open.find(this->__rows[i].key);
+            this->__open[i] = it != open.end() ? it->second : (this->__rows[i].depth == 0 ? 1 : 0);
+        }
+
+        this->__changed.clear();
+        this->__generation++;
+        this->__visible_dirty = true;
+        this->__index_dirty = true;
+    }
+
+    if(!this->__changed.empty()) {
+        for(size_t i = 0; i < this->__rows.size(); i++) {
+            auto it = this->__changed.find(this->__rows[i].key);
+
+            // The same address may belong to a destroyed Object whose row was not dropped yet.
+            if(it != this->__changed.end() && !it->second.expired() && it->second.lock() == this->__rows[i].object.lock()) {
+                this->__stale_rows.push_back((uint32_t) i);
+            }
+        }
+
+        this->__changed.clear();
+    }
+
+    // Spliced in descending order so earlier row indices stay valid (a changed child before its changed parent).
+    std::sort(this->__stale_rows.begin(), this->__stale_rows.end(), std::greater<uint32_t>());
+    this->__stale_rows.erase(std::unique(this->__stale_rows.begin(), this->__stale_rows.end()), this->__stale_rows.end());
+
+    for(auto row : this->__stale_rows) {
+        if(row < this->__rows.size()) {
+            this->__splice(row);
+        }
+    }
+
+    this->__stale_rows.clear();
+}
+
+void SceneTree::__build_visible() {
+    this->__visible_dirty = false;
+    this->__visible.clear();
+
+    // Collapsed rows skip their whole subtree.
+    for(size_t i = 0; i < this->__rows.size(); i += this->__open[i] ? 1 : this->__rows[i].subtree_size) {
+        this->__visible.push_back((uint32_t) i);
+    }
+}
+
+void SceneTree::__build_index() {
+    this->__index_dirty = false;
+    this->__index.clear();
+    this->__index.reserve(this->__rows.size());
+
+    for(size_t i = 0; i < this->__rows.size(); i++) {
+        if(auto object = this->__rows[i].object.lock()) {
+            this->__index.push_back({ lower(object->name), (uint32_t) i });
+        }
+    }
+
+    std::sort(this->__index.begin(), this->__index.end());
+}
+
+std::vector<uint32_t> SceneTree::search(const std::string& prefix, size_t limit) {
+    if(this->__index_dirty) {
+        this->__build_index();
+    }
+
+    auto key = lower(prefix);
+
+    std::vector<uint32_t> rows;
+
+    auto it = std::lower_bound(this->__index.begin(), this->__index.end(), std::make_pair(key, (uint32_t) 0));
+
+    for(; it != this->__index.end() && rows.size() < limit && it->first.compare(0, key.size(), key) == 0; it++) {
+        rows.push_back(it->second);
+    }
+
+    return rows;
+}
+
+void SceneTree::select(std::shared_ptr<Object> object) {
+    this->__selected = object;
+
+    for(size_t i = 0; i < this->__rows.size(); i++) {
+        if(this->__rows[i].key != object.get()) {
+            continue;
+        }
+
+        for(int32_t parent = this->__rows[i].parent; parent >= 0; parent = this->__rows[parent].parent) {
+            this->__open[parent] = 1;
+        }
+
+        this->__visible_dirty = true;
+        this->__scroll_to_selected = true;
+
+        return;
+    }
+}
+
+size_t SceneTree::__visible_position(uint32_t row) {
+    auto it = std::lower_bound(this->__visible.begin(), this->__visible.end(), row);
+
+    return (size_t) (it - this->__visible.begin());
+}
+
+void SceneTree::draw() {
+    size_t frame = pepng::commands()->frame();
+
+    if(frame == this->__frame) {
+        return;
+    }
+
+    this->__frame = frame;
+
+    #ifdef IMGUI
+    auto context = ImGui::GetCurrentContext();
+
+    if(context == nullptr || !context->WithinFrameScope) {
+        return;
+    }
+
+    // Picks in the viewport select in the tree.
+    auto picked = pepng::picking()->picked();
+
+    if(picked != nullptr && picked != this->__last_picked.lock()) {
+        this->select(picked);
+    }
+
+    this->__last_picked = picked;
+
+    if(this->hide_engine_windows) {
+        this->__hide_engine_windows();
+    }
+
+    this->__validate();
+
+    if(this->__visible_dirty) {
+        this->__build_visible();
+    }
+
+    this->__draw_tree();
+    this->__draw_inspector();
+    #endif
+}
+
+#ifdef IMGUI
+void SceneTree::__hide_engine_windows() {
+    // Hidden windows skip their items (Begin returns false), so the engine does not walk the scene for them.
+    for(auto name : { "Hierarchy", "Inspector" }) {
+        if(auto window = ImGui::FindWindowByName(name)) {
+            window->HiddenFramesCanSkipItems = 1;
+        }
+    }
+}
+
+void SceneTree::__draw_row(uint32_t row) {
+    auto& entry = this->__rows[row];
+    auto object = entry.object.lock();
+
+    if(object == nullptr) {
+        this->__stale_rows.push_back(row);
+
+        ImGui::TextDisabled("(destroyed)");
+
+        return;
+    }
+
+    ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_SpanAvailWidth | ImGuiTreeNodeFlags_NoTreePushOnOpen;
+
+    if(entry.subtree_size == 1) {
+        flags |= ImGuiTreeNodeFlags_Leaf;
+    }
+
+    if(object == this->__selected.lock()) {
+        flags |= ImGuiTreeNodeFlags_Selected;
+    }
+
+    // Rows are drawn flat, so the depth is an explicit indent (Indent(0) would use the default spacing).
+    float indent = entry.depth * ImGui::GetTreeNodeToLabelSpacing();
+
+    if(indent > 0.0f) {
+        ImGui::Indent(indent);
+    }
+
+    ImGui::SetNextItemOpen(this->__open[row] != 0);
+
+    bool open = ImGui::TreeNodeEx((void*) entry.key, flags, "%s", object->name.c_str());
+
+    if(ImGui::IsItemToggledOpen()) {
+        this->__open[row] = open ? 1 : 0;
+        this->__visible_dirty = true;
+    } else if(ImGui::IsItemClicked()) {
+        this->__selected = object;
+    }
+
+    if(indent > 0.0f) {
+        ImGui::Unindent(indent);
+    }
+}
+
+void SceneTree::__draw_tree() {
+    if(ImGui::Begin("Scene Tree")) {
+        char search[128];
+        std::snprintf(search, sizeof(search), "%s", this->__search.c_str());
+
+        if(ImGui::InputText("Search", search, sizeof(search))) {
+            this->__search = search;
+        }
+
+        ImGui::Text("Objects: %zu (%zu rows shown)", this->__rows.size(), this->__visible.size());
+        ImGui::Checkbox("Hide engine Hierarchy/Inspector", &this->hide_engine_windows);
+
+        ImGui::BeginChild("Rows");
+
+        if(!this->__search.empty()) {
+            auto matches = this->search(this->__search, 1000);
+
+            ImGuiListClipper clipper;
+            clipper.Begin((int) matches.size());
+
+            while(clipper.Step()) {
+                for(int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+                    auto object = this->__rows[matches[i]].object.lock();
+
+                    if(object == nullptr) {
+                        continue;
+                    }
+
+                    ImGui::PushID(i);
+
+                    if(ImGui::Selectable(object->name.c_str(), object == this->__selected.lock())) {
+                        this->select(object);
+                        this->__search.clear();
+                    }
+
+                    ImGui::PopID();
+                }
+            }
+
+            clipper.End();
+        } else {
+            if(this->__scroll_to_selected) {
+                this->__scroll_to_selected = false;
+
+                if(auto selected = this->__selected.lock()) {
+                    for(size_t i = 0; i < this->__rows.size(); i++) {
+                        if(this->__rows[i].key == selected.get()) {
+                            ImGui::SetScrollY(this->__visible_position((uint32_t) i) * ImGui::GetTextLineHeightWithSpacing());
+
+                            break;
+                        }
+                    }
+                }
+            }
+
+            ImGuiListClipper clipper;
+            clipper.Begin((int) this->__visible.size(), ImGui::GetTextLineHeightWithSpacing());
+
+            while(clipper.Step()) {
+                for(int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+                    this->__draw_row(this->__visible[i]);
+                }
+            }
+
+            clipper.End();
+        }
+
+        ImGui::EndChild();
+    }
+
+    ImGui::End();
+}
+
+void SceneTree::__draw_inspector() {
+    if(ImGui::Begin("Scene Inspector")) {
+        auto object = this->__selected.lock();
+
+        if(object == nullptr) {
+            ImGui::TextDisabled("Nothing selected.");
+        } else {
+            ImGui::Text("%s", object->name.c_str());
+            ImGui::Text("Children: %zu", object->children.size());
+            ImGui::Separator();
+
+            // Only expanded components are drawn.
+            for(size_t i = 0; i < object->components.size(); i++) {
+                auto& component = object->components[i];
+
+                ImGui::PushID((int) i);
+
+                if(ImGui::CollapsingHeader(component_name(*component).c_str())) {
+                    component->imgui();
+                }
+
+                ImGui::PopID();
+            }
+        }
+    }
+
+    ImGui::End();
+}
+#endif
\ No newline at end of file
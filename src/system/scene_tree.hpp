@@ -0,0 +1,120 @@
+#pragma once
+
+#include <pepng.h>
+
+/**
+ * Flattened, incrementally maintained view of Object hierarchies for the editor windows.
+ *
+ * Objects are stored in pre-order with their subtree size, so collapsed subtrees are skipped
+ * without visiting them and only the rows on screen are submitted to ImGui. Code changing the
+ * children of an outlined Object reports it with changed, and only that subtree is re-flattened
+ * and spliced in. Destroyed Objects are dropped when their row is drawn. Names are indexed
+ * (sorted, lower case) for prefix search.
+ *
+ * The engine's Hierarchy and Inspector windows walk every Object each frame, so they are hidden
+ * while these are drawn (hide_engine_windows).
+ */
+class SceneTree {
+    public:
+        static std::shared_ptr<SceneTree> make_scene_tree();
+
+        struct Row {
+            std::weak_ptr<Object> object;
+            // Identity of the Object (not dereferenced).
+            Object* key;
+            uint32_t depth;
+            // Row of the parent or -1 for roots.
+            int32_t parent;
+            // Rows in the subtree, this one included.
+            uint32_t subtree_size;
+        };
+
+        bool hide_engine_windows;
+
+        /**
+         * Adds a hierarchy to the tree (appended after the other roots).
+         */
+        void add_root(std::shared_ptr<Object> root);
+
+        // Forces a full rebuild.
+        void invalidate();
+
+        /**
+         * Reports that the children of an Object changed (attached, removed or reordered).
+         * Its subtree is re-flattened on the next draw.
+         */
+        void changed(std::shared_ptr<Object> object);
+
+        // Incremented by every structure change applied to the rows.
+        size_t generation();
+
+        /**
+         * Draws the Scene Tree and Scene Inspector windows. Runs once per frame however often it is called.
+         */
+        void draw();
+
+        std::shared_ptr<Object> selected();
+
+        /**
+         * Selects an Object of the tree, expands its ancestors and scrolls to it.
+         */
+        void select(std::shared_ptr<Object> object);
+
+        const std::vector<Row>& rows();
+
+        /**
+         * Rows whose name starts with prefix (case insensitive).
+         */
+        std::vector<uint32_t> search(const std::string& prefix, size_t limit);
+
+    private:
+        SceneTree();
+
+        void __flatten(std::shared_ptr<Object> object, uint32_t depth, int32_t parent, size_t base, std::vector<Row>& out);
+        void __splice(size_t row);
+        void __remove(size_t row);
+        void __validate();
+        void __build_visible();
+        void __build_index();
+        size_t __visible_position(uint32_t row);
+
+        #ifdef IMGUI
+        void __hide_engine_windows();
+        void __draw_row(uint32_t row);
+        void __draw_tree();
+        void __draw_inspector();
+        #endif
+
+        std::vector<std::weak_ptr<Object>> __roots;
+        std::vector<Row> __rows;
+        // Open state per row (parallel to __rows).
+        std::vector<uint8_t> __open;
+
+        // Rows not hidden by a collapsed ancestor, in order.
+        std::vector<uint32_t> __visible;
+        bool __visible_dirty;
+
+        // (lower case name, row), sorted.
+        std::vector<std::pair<std::string, uint32_t>> __index;
+        bool __index_dirty;
+
+        bool __rebuild;
+        size_t __generation;
+        // Objects reported by changed (dirty until spliced).
+        std::unordered_map<Object*, std::weak_ptr<Object>> __changed;
+        // Rows of destroyed Objects found while drawing (spliced after the draw).
+        std::vector<uint32_t> __stale_rows;
+
+        std::weak_ptr<Object> __selected;
+        std::weak_ptr<Object> __last_picked;
+        bool __scroll_to_selected;
+
+        std::string __search;
+        size_t __frame;
+};
+
+namespace pepng {
+    std::shared_ptr<SceneTree> make_scene_tree();
+
+    std::shared_ptr<SceneTree> scene_tree();
+};
\ No newline at end of file
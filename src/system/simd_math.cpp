@@ -0,0 +1,970 @@
+#include "simd_math.hpp"
+
+#include <chrono>
+#include <limits>
+#include <random>
+
+#include "view.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define PEPNG_SSE2
+#include <emmintrin.h>
+#endif
+
+// AVX2 kernels are compiled for their own target and only called after the CPU check.
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define PEPNG_AVX2
+#define PEPNG_AVX2_TARGET __attribute__((target("avx2,fma")))
+#include <immintrin.h>
+#elif defined(_M_X64) && defined(_MSC_VER)
+#define PEPNG_AVX2
+#define PEPNG_AVX2_TARGET
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#endif
+
+void AabbArray::resize(size_t count) {
+    size_t padded = (count + 7) & ~(size_t) 7;
+
+    for(auto array : { &this->min_x, &this->min_y, &this->min_z }) {
+        array->resize(padded, std::numeric_limits<float>::max());
+    }
+
+    for(auto array : { &this->max_x, &this->max_y, &this->max_z }) {
+        array->resize(padded, std::numeric_limits<float>::lowest());
+    }
+
+    // Boxes dropped by shrinking become padding.
+    for(size_t i = count; i < std::min(this->count, padded); i++) {
+        this->set(i, glm::vec3(std::numeric_limits<float>::max()), glm::vec3(std::numeric_limits<float>::lowest()));
+    }
+
+    this->count = count;
+}
+
+void AabbArray::set(size_t i, const glm::vec3& min, const glm::vec3& max) {
+    this->min_x[i] = min.x;
+    this->min_y[i] = min.y;
+    this->min_z[i] = min.z;
+    this->max_x[i] = max.x;
+    this->max_y[i] = max.y;
+    this->max_z[i] = max.z;
+}
+
+glm::vec3 AabbArray::min(size_t i) const {
+    return glm::vec3(this->min_x[i], this->min_y[i], this->min_z[i]);
+}
+
+glm::vec3 AabbArray::max(size_t i) const {
+    return glm::vec3(this->max_x[i], this->max_y[i], this->max_z[i]);
+}
+
+namespace {
+    struct Kernels {
+        void (*multiply)(const glm::mat4*, const glm::mat4*, glm::mat4*, size_t);
+        void (*transform)(const glm::mat4*, const AabbArray&, AabbArray&);
+        void (*merge)(const AabbArray&, glm::vec3&, glm::vec3&);
+        void (*frustum)(const glm::vec4*, const AabbArray&, uint8_t*);
+        void (*integrate)(const ParticleSpan&, const glm::vec3&, float, float, uint8_t*);
+    };
+
+    // Near corner selection: the array of the coordinate furthest along the plane normal.
+    struct PlaneCorner {
+        const float* x;
+        const float* y;
+        const float* z;
+    };
+
+    PlaneCorner plane_corner(const glm::vec4& plane, const AabbArray& boxes) {
+        return PlaneCorner {
+            plane.x >= 0.0f ? boxes.max_x.data() : boxes.min_x.data(),
+            plane.y >= 0.0f ? boxes.max_y.data() : boxes.min_y.data(),
+            plane.z >= 0.0f ? boxes.max_z.data() : boxes.min_z.data()
+        };
+    }
+
+    /**
+     * SCALAR
+     */
+
+    void multiply_scalar(const glm::mat4* a, const glm::mat4* b, glm::mat4* out, size_t count) {
+        for(size_t i = 0; i < count; i++) {
+            out[i] = a[i] * b[i];
+        }
+    }
+
+    void transform_scalar(const glm::mat4* worlds, const AabbArray& local, AabbArray& out) {
+        out.resize(local.count);
+
+        for(size_t i = 0; i < local.count; i++) {
+            auto& world = worlds[i];
+
+            glm::vec3 center = glm::vec3(world * glm::vec4((local.min(i) + local.max(i)) * 0.5f, 1.0f));
+            glm::vec3 half = (local.max(i) - local.min(i)) * 0.5f;
+            glm::vec3 extent(0.0f);
+
+            for(int column = 0; column < 3; column++) {
+                extent += glm::abs(glm::vec3(world[column])) * half[column];
+            }
+
+            out.set(i, center - extent, center + extent);
+        }
+    }
+
+    void merge_scalar(const AabbArray& boxes, glm::vec3& min, glm::vec3& max) {
+        min = glm::vec3(std::numeric_limits<float>::max());
+        max = glm::vec3(std::numeric_limits<float>::lowest());
+
+        for(size_t i = 0; i < boxes.count; i++) {
+            min = glm::min(min, boxes.min(i));
+            max = glm::max(max, boxes.max(i));
+        }
+    }
+
+    void frustum_scalar(const glm::vec4* planes, const AabbArray& boxes, uint8_t* visible) {
+        for(size_t i = 0; i < boxes.count; i++) {
+            visible[i] = 1;
+        }
+
+        for(int p = 0; p < 6; p++) {
+            auto& plane = planes[p];
+            auto corner = plane_corner(plane, boxes);
+
+            for(size_t i = 0; i < boxes.count; i++) {
+                if(corner.x[i] * plane.x + corner.y[i] * plane.y + corner.z[i] * plane.z + plane.w < 0.0f) {
+                    visible[i] = 0;
+                }
+            }
+        }
+    }
+
+    void integrate_scalar(const ParticleSpan& particles, const glm::vec3& gravity, float damping, float dt, uint8_t* dead) {
+        for(size_t i = 0; i < particles.count; i++) {
+            particles.vx[i] = (particles.vx[i] + gravity.x * dt) * damping;
+            particles.vy[i] = (particles.vy[i] + gravity.y * dt) * damping;
+            particles.vz[i] = (particles.vz[i] + gravity.z * dt) * damping;
+
+            particles.x[i] += particles.vx[i] * dt;
+            particles.y[i] += particles.vy[i] * dt;
+            particles.z[i] += particles.vz[i] * dt;
+
+            particles.age[i] += dt;
+            dead[i] = particles.age[i] >= particles.life[i];
+        }
+    }
+
+    /**
+     * SSE2
+     */
+
+    #ifdef PEPNG_SSE2
+    void multiply_sse2(const glm::mat4* a, const glm::mat4* b, glm::mat4* out, size_t count) {
+        for(size_t i = 0; i < count; i++) {
+            const float* pa = glm::value_ptr(a[i]);
+            const float* pb = glm::value_ptr(b[i]);
+
+            __m128 a0 = _mm_loadu_ps(pa), a1 = _mm_loadu_ps(pa + 4), a2 = _mm_loadu_ps(pa + 8), a3 = _mm_loadu_ps(pa + 12);
+            __m128 columns[4];
+
+            // Column j of the product is a * b[j].
+            for(int j = 0; j < 4; j++) {
+                const float* column = pb + 4 * j;
+
+                columns[j] = _mm_add_ps(
+                    _mm_add_ps(_mm_mul_ps(a0, _mm_set1_ps(column[0])), _mm_mul_ps(a1, _mm_set1_ps(column[1]))),
+                    _mm_add_ps(_mm_mul_ps(a2, _mm_set1_ps(column[2])), _mm_mul_ps(a3, _mm_set1_ps(column[3]))));
+            }
+
+            float* po = glm::value_ptr(out[i]);
+
+            for(int j = 0; j < 4; j++) {
+                _mm_storeu_ps(po + 4 * j, columns[j]);
+            }
+        }
+    }
+
+    void transform_sse2(const glm::mat4* worlds, const AabbArray& local, AabbArray& out) {
+        out.resize(local.count);
+
+        __m128 sign = _mm_set1_ps(-0.0f);
+        __m128 half = _mm_set1_ps(0.5f);
+        alignas(16) float lo[4], hi[4];
+
+        for(size_t i = 0; i < local.count; i++) {
+            const float* m = glm::value_ptr(worlds[i]);
+
+            __m128 m0 = _mm_loadu_ps(m), m1 = _mm_loadu_ps(m + 4), m2 = _mm_loadu_ps(m + 8), m3 = _mm_loadu_ps(m + 12);
+
+            __m128 min = _mm_setr_ps(local.min_x[i], local.min_y[i], local.min_z[i], 0.0f);
+            __m128 max = _mm_setr_ps(local.max_x[i], local.max_y[i], local.max_z[i], 0.0f);
+            alignas(16) float c[4], e[4];
+            _mm_store_ps(c, _mm_mul_ps(_mm_add_ps(min, max), half));
+            _mm_store_ps(e, _mm_mul_ps(_mm_sub_ps(max, min), half));
+
+            __m128 center = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(m0, _mm_set1_ps(c[0])), _mm_mul_ps(m1, _mm_set1_ps(c[1]))),
+                _mm_add_ps(_mm_mul_ps(m2, _mm_set1_ps(c[2])), m3));
+
+            __m128 extent = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(_mm_andnot_ps(sign, m0), _mm_set1_ps(e[0])), _mm_mul_ps(_mm_andnot_ps(sign, m1), _mm_set1_ps(e[1]))),
+                _mm_mul_ps(_mm_andnot_ps(sign, m2), _mm_set1_ps(e[2])));
+
+            _mm_store_ps(lo, _mm_sub_ps(center, extent));
+            _mm_store_ps(hi, _mm_add_ps(center, extent));
+
+            out.set(i, glm::vec3(lo[0], lo[1], lo[2]), glm::vec3(hi[0], hi[1], hi[2]));
+        }
+    }
+
+    float horizontal_min_sse2(__m128 v) {
+        v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+        v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+
+        return _mm_cvtss_f32(v);
+    }
+
+    float horizontal_max_sse2(__m128 v) {
+        v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+        v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+
+        return _mm_cvtss_f32(v);
+    }
+
+    void merge_sse2(const AabbArray& boxes, glm::vec3& min, glm::vec3& max) {
+        __m128 min_x = _mm_set1_ps(std::numeric_limits<float>::max()), min_y = min_x, min_z = min_x;
+        __m128 max_x = _mm_set1_ps(std::numeric_limits<float>::lowest()), max_y = max_x, max_z = max_x;
+
+        // Padding boxes are empty, so whole vectors are merged.
+        for(size_t i = 0; i < boxes.min_x.size(); i += 4) {
+            min_x = _mm_min_ps(min_x, _mm_loadu_ps(boxes.min_x.data() + i));
+            min_y = _mm_min_ps(min_y, _mm_loadu_ps(boxes.min_y.data() + i));
+            min_z = _mm_min_ps(min_z, _mm_loadu_ps(boxes.min_z.data() + i));
+            max_x = _mm_max_ps(max_x, _mm_loadu_ps(boxes.max_x.data() + i));
+            max_y = _mm_max_ps(max_y, _mm_loadu_ps(boxes.max_y.data() + i));
+            max_z = _mm_max_ps(max_z, _mm_loadu_ps(boxes.max_z.data() + i));
+        }
+
+        min = glm::vec3(horizontal_min_sse2(min_x), horizontal_min_sse2(min_y), horizontal_min_sse2(min_z));
+        max = glm::vec3(horizontal_max_sse2(max_x), horizontal_max_sse2(max_y), horizontal_max_sse2(max_z));
+    }
+
+    void frustum_sse2(const glm::vec4* planes, const AabbArray& boxes, uint8_t* visible) {
+        PlaneCorner corners[6];
+
+        for(int p = 0; p < 6; p++) {
+            corners[p] = plane_corner(planes[p], boxes);
+        }
+
+        __m128 zero = _mm_setzero_ps();
+
+        for(size_t i = 0; i < boxes.count; i += 4) {
+            __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+            for(int p = 0; p < 6; p++) {
+                auto& plane = planes[p];
+                auto& corner = corners[p];
+
+                __m128 distance = _mm_add_ps(
+                    _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(corner.x + i), _mm_set1_ps(plane.x)), _mm_mul_ps(_mm_loadu_ps(corner.y + i), _mm_set1_ps(plane.y))),
+                    _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(corner.z + i), _mm_set1_ps(plane.z)), _mm_set1_ps(plane.w)));
+
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, zero));
+            }
+
+            int mask = _mm_movemask_ps(inside);
+
+            for(size_t lane = 0; lane < 4 && i + lane < boxes.count; lane++) {
+                visible[i + lane] = (mask >> lane) & 1;
+            }
+        }
+    }
+
+    void integrate_sse2(const ParticleSpan& particles, const glm::vec3& gravity, float damping, float dt, uint8_t* dead) {
+        __m128 step = _mm_set1_ps(dt);
+        __m128 scale = _mm_set1_ps(damping);
+        __m128 gx = _mm_set1_ps(gravity.x * dt), gy = _mm_set1_ps(gravity.y * dt), gz = _mm_set1_ps(gravity.z * dt);
+
+        for(size_t i = 0; i < particles.count; i += 4) {
+            __m128 vx = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(particles.vx + i), gx), scale);
+            __m128 vy = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(particles.vy + i), gy), scale);
+            __m128 vz = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(particles.vz + i), gz), scale);
+
+            _mm_storeu_ps(particles.vx + i, vx);
+            _mm_storeu_ps(particles.vy + i, vy);
+            _mm_storeu_ps(particles.vz + i, vz);
+
+            _mm_storeu_ps(particles.x + i, _mm_add_ps(_mm_loadu_ps(particles.x + i), _mm_mul_ps(vx, step)));
+            _mm_storeu_ps(particles.y + i, _mm_add_ps(_mm_loadu_ps(particles.y + i), _mm_mul_ps(vy, step)));
+            _mm_storeu_ps(particles.z + i, _mm_add_ps(_mm_loadu_ps(particles.z + i), _mm_mul_ps(vz, step)));
+
+            __m128 age = _mm_add_ps(_mm_loadu_ps(particles.age + i), step);
+
+            _mm_storeu_ps(particles.age + i, age);
+
+            int mask = _mm_movemask_ps(_mm_cmpge_ps(age, _mm_loadu_ps(particles.life + i)));
+
+            for(size_t lane = 0; lane < 4 && i + lane < particles.count; lane++) {
+                dead[i + lane] = (mask >> lane) & 1;
+            }
+        }
+    }
+    #endif
+
+    /**
+     * AVX2
+     */
+
+    #ifdef PEPNG_AVX2
+    PEPNG_AVX2_TARGET void multiply_avx2(const glm::mat4* a, const glm::mat4* b, glm::mat4* out, size_t count) {
+        for(size_t i = 0; i < count; i++) {
+            const float* pa = glm::value_ptr(a[i]);
+            const float* pb = glm::value_ptr(b[i]);
+
+            // Columns of a repeated in both halves, two columns of the product per iteration.
+            __m256 a0 = _mm256_broadcast_ps((const __m128*) pa);
+            __m256 a1 = _mm256_broadcast_ps((const __m128*) (pa + 4));
+            __m256 a2 = _mm256_broadcast_ps((const __m128*) (pa + 8));
+            __m256 a3 = _mm256_broadcast_ps((const __m128*) (pa + 12));
+
+            __m256 b01 = _mm256_loadu_ps(pb);
+            __m256 b23 = _mm256_loadu_ps(pb + 8);
+
+            __m256 columns[2];
+
+            for(int j = 0; j < 2; j++) {
+                __m256 columns_b = j == 0 ? b01 : b23;
+
+                __m256 result = _mm256_mul_ps(a0, _mm256_shuffle_ps(columns_b, columns_b, _MM_SHUFFLE(0, 0, 0, 0)));
+                result = _mm256_fmadd_ps(a1, _mm256_shuffle_ps(columns_b, columns_b, _MM_SHUFFLE(1, 1, 1, 1)), result);
+                result = _mm256_fmadd_ps(a2, _mm256_shuffle_ps(columns_b, columns_b, _MM_SHUFFLE(2, 2, 2, 2)), result);
+                columns[j] = _mm256_fmadd_ps(a3, _mm256_shuffle_ps(columns_b, columns_b, _MM_SHUFFLE(3, 3, 3, 3)), result);
+            }
+
+            float* po = glm::value_ptr(out[i]);
+
+            _mm256_storeu_ps(po, columns[0]);
+            _mm256_storeu_ps(po + 8, columns[1]);
+        }
+    }
+
+    PEPNG_AVX2_TARGET __m256 pair_avx2(const float* low, const float* high) {
+        return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(low)), _mm_loadu_ps(high), 1);
+    }
+
+    PEPNG_AVX2_TARGET __m256 splat_pair_avx2(float low, float high) {
+        return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_set1_ps(low)), _mm_set1_ps(high), 1);
+    }
+
+    PEPNG_AVX2_TARGET void transform_avx2(const glm::mat4* worlds, const AabbArray& local, AabbArray& out) {
+        out.resize(local.count);
+
+        __m256 sign = _mm256_set1_ps(-0.0f);
+        alignas(32) float lo[8], hi[8];
+
+        size_t i = 0;
+
+        // Two boxes per iteration (one per 128 bit half).
+        for(; i + 1 < local.count; i += 2) {
+            const float* m = glm::value_ptr(worlds[i]);
+            const float* n = glm::value_ptr(worlds[i + 1]);
+
+            __m256 m0 = pair_avx2(m, n), m1 = pair_avx2(m + 4, n + 4), m2 = pair_avx2(m + 8, n + 8), m3 = pair_avx2(m + 12, n + 12);
+
+            // Centers and half extents of both boxes, x y z per row.
+            float c[3][2], e[3][2];
+            const std::vector<float>* mins[3] = { &local.min_x, &local.min_y, &local.min_z };
+            const std::vector<float>* maxs[3] = { &local.max_x, &local.max_y, &local.max_z };
+
+            for(int axis = 0; axis < 3; axis++) {
+                for(size_t k = 0; k < 2; k++) {
+                    c[axis][k] = ((*mins[axis])[i + k] + (*maxs[axis])[i + k]) * 0.5f;
+                    e[axis][k] = ((*maxs[axis])[i + k] - (*mins[axis])[i + k]) * 0.5f;
+                }
+            }
+
+            __m256 center = _mm256_fmadd_ps(m0, splat_pair_avx2(c[0][0], c[0][1]), m3);
+            center = _mm256_fmadd_ps(m1, splat_pair_avx2(c[1][0], c[1][1]), center);
+            center = _mm256_fmadd_ps(m2, splat_pair_avx2(c[2][0], c[2][1]), center);
+
+            __m256 extent = _mm256_mul_ps(_mm256_andnot_ps(sign, m0), splat_pair_avx2(e[0][0], e[0][1]));
+            extent = _mm256_fmadd_ps(_mm256_andnot_ps(sign, m1), splat_pair_avx2(e[1][0], e[1][1]), extent);
+            extent = _mm256_fmadd_ps(_mm256_andnot_ps(sign, m2), splat_pair_avx2(e[2][0], e[2][1]), extent);
+
+            _mm256_store_ps(lo, _mm256_sub_ps(center, extent));
+            _mm256_store_ps(hi, _mm256_add_ps(center, extent));
+
+            out.set(i, glm::vec3(lo[0], lo[1], lo[2]), glm::vec3(hi[0], hi[1], hi[2]));
+            out.set(i + 1, glm::vec3(lo[4], lo[5], lo[6]), glm::vec3(hi[4], hi[5], hi[6]));
+        }
+
+        for(; i < local.count; i++) {
+            auto& world = worlds[i];
+
+            glm::vec3 center = glm::vec3(world * glm::vec4((local.min(i) + local.max(i)) * 0.5f, 1.0f));
+            glm::vec3 half = (local.max(i) - local.min(i)) * 0.5f;
+            glm::vec3 extent = glm::abs(glm::vec3(world[0])) * half.x + glm::abs(glm::vec3(world[1])) * half.y + glm::abs(glm::vec3(world[2])) * half.z;
+
+            out.set(i, center - extent, center + extent);
+        }
+    }
+
+    PEPNG_AVX2_TARGET void merge_avx2(const AabbArray& boxes, glm::vec3& min, glm::vec3& max) {
+        __m256 min_x = _mm256_set1_ps(std::numeric_limits<float>::max()), min_y = min_x, min_z = min_x;
+        __m256 max_x = _mm256_set1_ps(std::numeric_limits<float>::lowest()), max_y = max_x, max_z = max_x;
+
+        for(size_t i = 0; i < boxes.min_x.size(); i += 8) {
+            min_x = _mm256_min_ps(min_x, _mm256_loadu_ps(boxes.min_x.data() + i));
+            min_y = _mm256_min_ps(min_y, _mm256_loadu_ps(boxes.min_y.data() + i));
+            min_z = _mm256_min_ps(min_z, _mm256_loadu_ps(boxes.min_z.data() + i));
+            max_x = _mm256_max_ps(max_x, _mm256_loadu_ps(boxes.max_x.data() + i));
+            max_y = _mm256_max_ps(max_y, _mm256_loadu_ps(boxes.max_y.data() + i));
+            max_z = _mm256_max_ps(max_z, _mm256_loadu_ps(boxes.max_z.data() + i));
+        }
+
+        alignas(32) float values[6][8];
+
+        _mm256_store_ps(values[0], min_x);
+        _mm256_store_ps(values[1], min_y);
+        _mm256_store_ps(values[2], min_z);
+        _mm256_store_ps(values[3], max_x);
+        _mm256_store_ps(values[4], max_y);
+        _mm256_store_ps(values[5], max_z);
+
+        min = glm::vec3(std::numeric_limits<float>::max());
+        max = glm::vec3(std::numeric_limits<float>::lowest());
+
+        for(int lane = 0; lane < 8; lane++) {
+            min = glm::min(min, glm::vec3(values[0][lane], values[1][lane], values[2][lane]));
+            max = glm::max(max, glm::vec3(values[3][lane], values[4][lane], values[5][lane]));
+        }
+    }
+
+    PEPNG_AVX2_TARGET void frustum_avx2(const glm::vec4* planes, const AabbArray& boxes, uint8_t* visible) {
+        PlaneCorner corners[6];
+
+        for(int p = 0; p < 6; p++) {
+            corners[p] = plane_corner(planes[p], boxes);
+        }
+
+        __m256 zero = _mm256_setzero_ps();
+
+        // 8 boxes against a plane per step.
+        for(size_t i = 0; i < boxes.count; i += 8) {
+            __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+            for(int p = 0; p < 6; p++) {
+                auto& plane = planes[p];
+                auto& corner = corners[p];
+
+                __m256 distance = _mm256_fmadd_ps(_mm256_loadu_ps(corner.x + i), _mm256_set1_ps(plane.x), _mm256_set1_ps(plane.w));
+                distance = _mm256_fmadd_ps(_mm256_loadu_ps(corner.y + i), _mm256_set1_ps(plane.y), distance);
+                distance = _mm256_fmadd_ps(_mm256_loadu_ps(corner.z + i), _mm256_set1_ps(plane.z), distance);
+
+                inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, zero, _CMP_GE_OQ));
+            }
+
+            int mask = _mm256_movemask_ps(inside);
+
+            for(size_t lane = 0; lane < 8 && i + lane < boxes.count; lane++) {
+                visible[i + lane] = (mask >> lane) & 1;
+            }
+        }
+    }
+
+    PEPNG_AVX2_TARGET void integrate_avx2(const ParticleSpan& particles, const glm::vec3& gravity, float damping, float dt, uint8_t* dead) {
+        __m256 step = _mm256_set1_ps(dt);
+        __m256 scale = _mm256_set1_ps(damping);
+        __m256 gx = _mm256_set1_ps(gravity.x * dt), gy = _mm256_set1_ps(gravity.y * dt), gz = _mm256_set1_ps(gravity.z * dt);
+
+        // 8 particles per step.
+        for(size_t i = 0; i < particles.count; i += 8) {
+            __m256 vx = _mm256_mul_ps(_mm256_add_ps(_mm256_loadu_ps(particles.vx + i), gx), scale);
+            __m256 vy = _mm256_mul_ps(_mm256_add_ps(_mm256_loadu_ps(particles.vy + i), gy), scale);
+            __m256 vz = _mm256_mul_ps(_mm256_add_ps(_mm256_loadu_ps(particles.vz + i), gz), scale);
+
+            _mm256_storeu_ps(particles.vx + i, vx);
+            _mm256_storeu_ps(particles.vy + i, vy);
+            _mm256_storeu_ps(particles.vz + i, vz);
+
+            _mm256_storeu_ps(particles.x + i, _mm256_fmadd_ps(vx, step, _mm256_loadu_ps(particles.x + i)));
+            _mm256_storeu_ps(particles.y + i, _mm256_fmadd_ps(vy, step, _mm256_loadu_ps(particles.y + i)));
+            _mm256_storeu_ps(particles.z + i, _mm256_fmadd_ps(vz, step, _mm256_loadu_ps(particles.z + i)));
+
+            __m256 age = _mm256_add_ps(_mm256_loadu_ps(particles.age + i), step);
+
+            _mm256_storeu_ps(particles.age + i, age);
+
+            int mask = _mm256_movemask_ps(_mm256_cmp_ps(age, _mm256_loadu_ps(particles.life + i), _CMP_GE_OQ));
+
+            for(size_t lane = 0; lane < 8 && i + lane < particles.count; lane++) {
+                dead[i + lane] = (mask >> lane) & 1;
+            }
+        }
+    }
+
+    bool cpu_has_avx2() {
+        #ifdef _MSC_VER
+        int info[4];
+
+        __cpuid(info, 1);
+
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        bool avx = (info[2] & (1 << 28)) != 0;
+        bool fma = (info[2] & (1 << 12)) != 0;
+
+        // The OS must also save the YMM registers.
+        if(!osxsave || !avx || !fma || (_xgetbv(0) & 6) != 6) {
+            return false;
+        }
+
+        __cpuidex(info, 7, 0);
+
+        return (info[1] & (1 << 5)) != 0;
+        #else
+        __builtin_cpu_init();
+
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+        #endif
+    }
+    #endif
+
+    /**
+     * WASM SIMD128
+     */
+
+    #ifdef __wasm_simd128__
+    void multiply_wasm(const glm::mat4* a, const glm::mat4* b, glm::mat4* out, size_t count) {
+        for(size_t i = 0; i < count; i++) {
+            const float* pa = glm::value_ptr(a[i]);
+            const float* pb = glm::value_ptr(b[i]);
+
+            v128_t a0 = wasm_v128_load(pa), a1 = wasm_v128_load(pa + 4), a2 = wasm_v128_load(pa + 8), a3 = wasm_v128_load(pa + 12);
+            v128_t columns[4];
+
+            for(int j = 0; j < 4; j++) {
+                const float* column = pb + 4 * j;
+
+                columns[j] = wasm_f32x4_add(
+                    wasm_f32x4_add(wasm_f32x4_mul(a0, wasm_f32x4_splat(column[0])), wasm_f32x4_mul(a1, wasm_f32x4_splat(column[1]))),
+                    wasm_f32x4_add(wasm_f32x4_mul(a2, wasm_f32x4_splat(column[2])), wasm_f32x4_mul(a3, wasm_f32x4_splat(column[3]))));
+            }
+
+            float* po = glm::value_ptr(out[i]);
+
+            for(int j = 0; j < 4; j++) {
+                wasm_v128_store(po + 4 * j, columns[j]);
+            }
+        }
+    }
+
+    void transform_wasm(const glm::mat4* worlds, const AabbArray& local, AabbArray& out) {
+        out.resize(local.count);
+
+        float lo[4], hi[4];
+
+        for(size_t i = 0; i < local.count; i++) {
+            const float* m = glm::value_ptr(worlds[i]);
+
+            v128_t m0 = wasm_v128_load(m), m1 = wasm_v128_load(m + 4), m2 = wasm_v128_load(m + 8), m3 = wasm_v128_load(m + 12);
+
+            glm::vec3 c = (local.min(i) + local.max(i)) * 0.5f;
+            glm::vec3 e = (local.max(i) - local.min(i)) * 0.5f;
+
+            v128_t center = wasm_f32x4_add(
+                wasm_f32x4_add(wasm_f32x4_mul(m0, wasm_f32x4_splat(c.x)), wasm_f32x4_mul(m1, wasm_f32x4_splat(c.y))),
+                wasm_f32x4_add(wasm_f32x4_mul(m2, wasm_f32x4_splat(c.z)), m3));
+
+            v128_t extent = wasm_f32x4_add(
+                wasm_f32x4_add(wasm_f32x4_mul(wasm_f32x4_abs(m0), wasm_f32x4_splat(e.x)), wasm_f32x4_mul(wasm_f32x4_abs(m1), wasm_f32x4_splat(e.y))),
+                wasm_f32x4_mul(wasm_f32x4_abs(m2), wasm_f32x4_splat(e.z)));
+
+            wasm_v128_store(lo, wasm_f32x4_sub(center, extent));
+            wasm_v128_store(hi, wasm_f32x4_add(center, extent));
+
+            out.set(i, glm::vec3(lo[0], lo[1], lo[2]), glm::vec3(hi[0], hi[1], hi[2]));
+        }
+    }
+
+    void merge_wasm(const AabbArray& boxes, glm::vec3& min, glm::vec3& max) {
+        v128_t min_x = wasm_f32x4_splat(std::numeric_limits<float>::max()), min_y = min_x, min_z = min_x;
+        v128_t max_x = wasm_f32x4_splat(std::numeric_limits<float>::lowest()), max_y = max_x, max_z = max_x;
+
+        for(size_t i = 0; i < boxes.min_x.size(); i += 4) {
+            min_x = wasm_f32x4_min(min_x, wasm_v128_load(boxes.min_x.data() + i));
+            min_y = wasm_f32x4_min(min_y, wasm_v128_load(boxes.min_y.data() + i));
+            min_z = wasm_f32x4_min(min_z, wasm_v128_load(boxes.min_z.data() + i));
+            max_x = wasm_f32x4_max(max_x, wasm_v128_load(boxes.max_x.data() + i));
+            max_y = wasm_f32x4_max(max_y, wasm_v128_load(boxes.max_y.data() + i));
+            max_z = wasm_f32x4_max(max_z, wasm_v128_load(boxes.max_z.data() + i));
+        }
+
+        float values[6][4];
+
+        wasm_v128_store(values[0], min_x);
+        wasm_v128_store(values[1], min_y);
+        wasm_v128_store(values[2], min_z);
+        wasm_v128_store(values[3], max_x);
+        wasm_v128_store(values[4], max_y);
+        wasm_v128_store(values[5], max_z);
+
+        min = glm::vec3(std::numeric_limits<float>::max());
+        max = glm::vec3(std::numeric_limits<float>::lowest());
+
+        for(int lane = 0; lane < 4; lane++) {
+            min = glm::min(min, glm::vec3(values[0][lane], values[1][lane], values[2][lane]));
+            max = glm::max(max, glm::vec3(values[3][lane], values[4][lane], values[5][lane]));
+        }
+    }
+
+    void frustum_wasm(const glm::vec4* planes, const AabbArray& boxes, uint8_t* visible) {
+        PlaneCorner corners[6];
+
+        for(int p = 0; p < 6; p++) {
+            corners[p] = plane_corner(planes[p], boxes);
+        }
+
+        v128_t zero = wasm_f32x4_splat(0.0f);
+
+        for(size_t i = 0; i < boxes.count; i += 4) {
+            v128_t inside = wasm_i32x4_splat(-1);
+
+            for(int p = 0; p < 6; p++) {
+                auto& plane = planes[p];
+                auto& corner = corners[p];
+
+                v128_t distance = wasm_f32x4_add(
+                    wasm_f32x4_add(wasm_f32x4_mul(wasm_v128_load(corner.x + i), wasm_f32x4_splat(plane.x)), wasm_f32x4_mul(wasm_v128_load(corner.y + i), wasm_f32x4_splat(plane.y))),
+                    wasm_f32x4_add(wasm_f32x4_mul(wasm_v128_load(corner.z + i), wasm_f32x4_splat(plane.z)), wasm_f32x4_splat(plane.w)));
+
+                inside = wasm_v128_and(inside, wasm_f32x4_ge(distance, zero));
+            }
+
+            int mask = wasm_i32x4_bitmask(inside);
+
+            for(size_t lane = 0; lane < 4 && i + lane < boxes.count; lane++) {
+                visible[i + lane] = (mask >> lane) & 1;
+            }
+        }
+    }
+
+    void integrate_wasm(const ParticleSpan& particles, const glm::vec3& gravity, float damping, float dt, uint8_t* dead) {
+        v128_t step = wasm_f32x4_splat(dt);
+        v128_t scale = wasm_f32x4_splat(damping);
+        v128_t gx = wasm_f32x4_splat(gravity.x * dt), gy = wasm_f32x4_splat(gravity.y * dt), gz = wasm_f32x4_splat(gravity.z * dt);
+
+        for(size_t i = 0; i < particles.count; i += 4) {
+            v128_t vx = wasm_f32x4_mul(wasm_f32x4_add(wasm_v128_load(particles.vx + i), gx), scale);
+            v128_t vy = wasm_f32x4_mul(wasm_f32x4_add(wasm_v128_load(particles.vy + i), gy), scale);
+            v128_t vz = wasm_f32x4_mul(wasm_f32x4_add(wasm_v128_load(particles.vz + i), gz), scale);
+
+            wasm_v128_store(particles.vx + i, vx);
+            wasm_v128_store(particles.vy + i, vy);
+            wasm_v128_store(particles.vz + i, vz);
+
+            wasm_v128_store(particles.x + i, wasm_f32x4_add(wasm_v128_load(particles.x + i), wasm_f32x4_mul(vx, step)));
+            wasm_v128_store(particles.y + i, wasm_f32x4_add(wasm_v128_load(particles.y + i), wasm_f32x4_mul(vy, step)));
+            wasm_v128_store(particles.z + i, wasm_f32x4_add(wasm_v128_load(particles.z + i), wasm_f32x4_mul(vz, step)));
+
+            v128_t age = wasm_f32x4_add(wasm_v128_load(particles.age + i), step);
+
+            wasm_v128_store(particles.age + i, age);
+
+            int mask = wasm_i32x4_bitmask(wasm_f32x4_ge(age, wasm_v128_load(particles.life + i)));
+
+            for(size_t lane = 0; lane < 4 && i + lane < particles.count; lane++) {
+                dead[i + lane] = (mask >> lane) & 1;
+            }
+        }
+    }
+    #endif
+
+    /**
+     * DISPATCH
+     */
+
+    std::vector<SimdLevel> supported_levels() {
+        std::vector<SimdLevel> levels { SimdLevel::SCALAR };
+
+        #ifdef PEPNG_SSE2
+        levels.push_back(SimdLevel::SSE2);
+        #endif
+
+        #ifdef PEPNG_AVX2
+        if(cpu_has_avx2()) {
+            levels.push_back(SimdLevel::AVX2);
+        }
+        #endif
+
+        #ifdef __wasm_simd128__
+        levels.push_back(SimdLevel::WASM_SIMD128);
+        #endif
+
+        return levels;
+    }
+
+    Kernels kernels_for(SimdLevel level) {
+        switch(level) {
+            #ifdef PEPNG_SSE2
+            case SimdLevel::SSE2:
+                return Kernels { multiply_sse2, transform_sse2, merge_sse2, frustum_sse2, integrate_sse2 };
+            #endif
+            #ifdef PEPNG_AVX2
+            case SimdLevel::AVX2:
+                return Kernels { multiply_avx2, transform_avx2, merge_avx2, frustum_avx2, integrate_avx2 };
+            #endif
+            #ifdef __wasm_simd128__
+            case SimdLevel::WASM_SIMD128:
+                return Kernels { multiply_wasm, transform_wasm, merge_wasm, frustum_wasm, integrate_wasm };
+            #endif
+            default:
+                return Kernels { multiply_scalar, transform_scalar, merge_scalar, frustum_scalar, integrate_scalar };
+        }
+    }
+
+    struct Dispatch {
+        SimdLevel level;
+        Kernels kernels;
+    };
+
+    Dispatch& dispatch() {
+        static Dispatch dispatch { pepng::simd_supported(), kernels_for(pepng::simd_supported()) };
+
+        return dispatch;
+    }
+}
+
+const std::vector<SimdLevel>& pepng::simd_levels() {
+    static auto levels = supported_levels();
+
+    return levels;
+}
+
+SimdLevel pepng::simd_supported() {
+    return pepng::simd_levels().back();
+}
+
+SimdLevel pepng::simd_level() {
+    return dispatch().level;
+}
+
+void pepng::set_simd_level(SimdLevel level) {
+    auto& supported = pepng::simd_levels();
+
+    if(std::find(supported.begin(), supported.end(), level) == supported.end()) {
+        level = pepng::simd_supported();
+    }
+
+    dispatch() = Dispatch { level, kernels_for(level) };
+}
+
+const char* pepng::simd_level_name(SimdLevel level) {
+    switch(level) {
+        case SimdLevel::SSE2:
+            return "SSE2";
+        case SimdLevel::AVX2:
+            return "AVX2";
+        case SimdLevel::WASM_SIMD128:
+            return "WASM SIMD128";
+        default:
+            return "Scalar";
+    }
+}
+
+void pepng::multiply_matrices(const glm::mat4* a, const glm::mat4* b, glm::mat4* out, size_t count) {
+    dispatch().kernels.multiply(a, b, out, count);
+}
+
+void pepng::transform_aabbs(const glm::mat4* worlds, const AabbArray& local, AabbArray& out) {
+    dispatch().kernels.transform(worlds, local, out);
+}
+
+void pepng::merge_aabbs(const AabbArray& boxes, glm::vec3& min, glm::vec3& max) {
+    dispatch().kernels.merge(boxes, min, max);
+}
+
+void pepng::frustum_test(const glm::vec4 planes[6], const AabbArray& boxes, uint8_t* visible) {
+    dispatch().kernels.frustum(planes, boxes, visible);
+}
+
+void pepng::integrate_particles(const ParticleSpan& particles, const glm::vec3& gravity, float damping, float dt, uint8_t* dead) {
+    dispatch().kernels.integrate(particles, gravity, damping, dt, dead);
+}
+
+std::vector<SimdTiming> pepng::benchmark_simd(size_t count, size_t iterations) {
+    std::mt19937 random(0);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+    std::vector<glm::mat4> a(count), b(count), out(count);
+    std::vector<glm::vec3> local_min(count), local_max(count), world_min(count), world_max(count);
+    AabbArray local, world;
+    local.resize(count);
+
+    for(size_t i = 0; i < count; i++) {
+        for(int c = 0; c < 4; c++) {
+            a[i][c] = glm::vec4(unit(random), unit(random), unit(random), c == 3 ? 1.0f : 0.0f);
+            b[i][c] = glm::vec4(unit(random), unit(random), unit(random), c == 3 ? 1.0f : 0.0f);
+        }
+
+        glm::vec3 center = glm::vec3(unit(random), unit(random), unit(random)) * 50.0f;
+        glm::vec3 half = glm::abs(glm::vec3(unit(random), unit(random), unit(random))) + 0.1f;
+
+        local_min[i] = center - half;
+        local_max[i] = center + half;
+        local.set(i, local_min[i], local_max[i]);
+    }
+
+    auto view = pepng::make_view(glm::mat4(1.0f), glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f), glm::ivec4(0, 0, 1920, 1080));
+    std::vector<uint8_t> visible(count);
+
+    // Particles as the AoS structs the kernel replaces and as padded arrays. Lives are long enough to stay alive.
+    struct Particle {
+        glm::vec3 position;
+        glm::vec3 velocity;
+        float age;
+        float life;
+    };
+
+    size_t padded = (count + 7) & ~(size_t) 7;
+    std::vector<Particle> particles(count);
+    std::vector<float> particle_arrays[8];
+    std::vector<uint8_t> dead(padded);
+
+    for(auto& array : particle_arrays) {
+        array.assign(padded, 0.0f);
+    }
+
+    for(size_t i = 0; i < count; i++) {
+        particles[i] = Particle { glm::vec3(a[i][3]), glm::vec3(b[i][3]), 0.0f, 1e9f };
+
+        for(int k = 0; k < 3; k++) {
+            particle_arrays[k][i] = particles[i].position[k];
+            particle_arrays[3 + k][i] = particles[i].velocity[k];
+        }
+
+        particle_arrays[7][i] = 1e9f;
+    }
+
+    ParticleSpan span {
+        particle_arrays[0].data(), particle_arrays[1].data(), particle_arrays[2].data(),
+        particle_arrays[3].data(), particle_arrays[4].data(), particle_arrays[5].data(),
+        particle_arrays[6].data(), particle_arrays[7].data(), count
+    };
+    glm::vec3 gravity(0.0f, -9.81f, 0.0f);
+
+    // Keeps the glm loops from being optimized away.
+    volatile float sink = 0.0f;
+
+    auto time = [iterations](const std::function<void()>& run) {
+        run();
+
+        auto start = std::chrono::steady_clock::now();
+
+        for(size_t i = 0; i < iterations; i++) {
+            run();
+        }
+
+        return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+    };
+
+    std::vector<SimdTiming> timings;
+
+    // The per-object glm code each kernel replaces.
+    timings.push_back(SimdTiming { "multiply_matrices", "glm", time([&]() {
+        for(size_t i = 0; i < count; i++) {
+            out[i] = a[i] * b[i];
+        }
+
+        sink = sink + out[count / 2][3][0];
+    }) });
+
+    timings.push_back(SimdTiming { "transform_aabbs", "glm", time([&]() {
+        for(size_t i = 0; i < count; i++) {
+            glm::vec3 center = glm::vec3(a[i] * glm::vec4((local_min[i] + local_max[i]) * 0.5f, 1.0f));
+            glm::vec3 half = (local_max[i] - local_min[i]) * 0.5f;
+            glm::vec3 extent = glm::abs(glm::vec3(a[i][0])) * half.x + glm::abs(glm::vec3(a[i][1])) * half.y + glm::abs(glm::vec3(a[i][2])) * half.z;
+
+            world_min[i] = center - extent;
+            world_max[i] = center + extent;
+        }
+
+        sink = sink + world_min[count / 2].x;
+    }) });
+
+    timings.push_back(SimdTiming { "merge_aabbs", "glm", time([&]() {
+        glm::vec3 min(std::numeric_limits<float>::max()), max(std::numeric_limits<float>::lowest());
+
+        for(size_t i = 0; i < count; i++) {
+            min = glm::min(min, local_min[i]);
+            max = glm::max(max, local_max[i]);
+        }
+
+        sink = sink + min.x + max.x;
+    }) });
+
+    timings.push_back(SimdTiming { "frustum_test", "glm", time([&]() {
+        for(size_t i = 0; i < count; i++) {
+            visible[i] = view.aabb_visible(local_min[i], local_max[i]);
+        }
+
+        sink = sink + visible[count / 2];
+    }) });
+
+    timings.push_back(SimdTiming { "integrate_particles", "glm", time([&]() {
+        for(size_t i = 0; i < count; i++) {
+            auto& particle = particles[i];
+
+            particle.velocity = (particle.velocity + gravity * 0.001f) * 0.999f;
+            particle.position += particle.velocity * 0.001f;
+            particle.age += 0.001f;
+
+            dead[i] = particle.age >= particle.life;
+        }
+
+        sink = sink + particles[count / 2].position.x;
+    }) });
+
+    auto current = pepng::simd_level();
+
+    for(auto level : pepng::simd_levels()) {
+        pepng::set_simd_level(level);
+
+        std::string path = pepng::simd_level_name(level);
+
+        timings.push_back(SimdTiming { "multiply_matrices", path, time([&]() {
+            pepng::multiply_matrices(a.data(), b.data(), out.data(), count);
+        }) });
+
+        timings.push_back(SimdTiming { "transform_aabbs", path, time([&]() {
+            pepng::transform_aabbs(a.data(), local, world);
+        }) });
+
+        timings.push_back(SimdTiming { "merge_aabbs", path, time([&]() {
+            glm::vec3 min, max;
+
+            pepng::merge_aabbs(local, min, max);
+
+            sink = sink + min.x + max.x;
+        }) });
+
+        timings.push_back(SimdTiming { "frustum_test", path, time([&]() {
+            pepng::frustum_test(view.planes, local, visible.data());
+        }) });
+
+        timings.push_back(SimdTiming { "integrate_particles", path, time([&]() {
+            pepng::integrate_particles(span, gravity, 0.999f, 0.001f, dead.data());
+        }) });
+    }
+
+    pepng::set_simd_level(current);
+
+    // Grouped by kernel.
+    std::stable_sort(timings.begin(), timings.end(), [](const SimdTiming& a, const SimdTiming& b) {
+        return a.kernel < b.kernel;
+    });
+
+    return timings;
+}
\ No newline at end of file
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <pepng.h>
+
+enum class SimdLevel {
+    SCALAR,
+    SSE2,
+    // 8 wide, selected at runtime when the CPU supports AVX2 and FMA.
+    AVX2,
+    // WebAssembly SIMD128 (compile time, enabled by -msimd128).
+    WASM_SIMD128
+};
+
+/**
+ * Axis aligned boxes as a structure of arrays.
+ *
+ * Every array is padded to a multiple of 8 with empty boxes (min > max), so kernels always load full vectors.
+ */
+struct AabbArray {
+    std::vector<float> min_x, min_y, min_z;
+    std::vector<float> max_x, max_y, max_z;
+    size_t count = 0;
+
+    void resize(size_t count);
+    void set(size_t i, const glm::vec3& min, const glm::vec3& max);
+    glm::vec3 min(size_t i) const;
+    glm::vec3 max(size_t i) const;
+};
+
+/**
+ * A range of particles stored as a structure of arrays (see ParticlePool).
+ *
+ * The arrays must be readable and writable up to count rounded up to 8, so kernels always load full vectors.
+ */
+struct ParticleSpan {
+    float* x;
+    float* y;
+    float* z;
+    float* vx;
+    float* vy;
+    float* vz;
+    float* age;
+    const float* life;
+    size_t count;
+};
+
+struct SimdTiming {
+    std::string kernel;
+    // "glm" for the per-object glm loop the kernel replaces.
+    std::string path;
+    float ms;
+};
+
+namespace pepng {
+    /**
+     * The levels this build and CPU support, from SCALAR to the best one.
+     */
+    const std::vector<SimdLevel>& simd_levels();
+
+    /**
+     * The best level this build and CPU support.
+     */
+    SimdLevel simd_supported();
+
+    /**
+     * The level the kernels dispatch to (simd_supported() by default).
+     */
+    SimdLevel simd_level();
+
+    /**
+     * Forces a level for benchmarks and debugging. An unsupported level falls back to simd_supported().
+     */
+    void set_simd_level(SimdLevel level);
+
+    const char* simd_level_name(SimdLevel level);
+
+    /**
+     * out[i] = a[i] * b[i] for count matrices. out may alias a or b.
+     */
+    void multiply_matrices(const glm::mat4* a, const glm::mat4* b, glm::mat4* out, size_t count);
+
+    /**
+     * World boxes of local boxes (Arvo: transformed center, extents through the absolute matrix).
+     *
+     * @param worlds One matrix per box.
+     */
+    void transform_aabbs(const glm::mat4* worlds, const AabbArray& local, AabbArray& out);
+
+    /**
+     * Union of all boxes. min > max if there are none.
+     */
+    void merge_aabbs(const AabbArray& boxes, glm::vec3& min, glm::vec3& max);
+
+    /**
+     * Frustum test of every box (same test as View::aabb_visible).
+     *
+     * @param planes Inward facing planes (xyz normal, w distance).
+     * @param visible One byte per box, 1 if the box intersects the frustum.
+     */
+    void frustum_test(const glm::vec4 planes[6], const AabbArray& boxes, uint8_t* visible);
+
+    /**
+     * Semi-implicit Euler step of every particle: v = (v + gravity * dt) * damping, p += v * dt, age += dt.
+     *
+     * @param dead One byte per particle, 1 once its age reached its life.
+     */
+    void integrate_particles(const ParticleSpan& particles, const glm::vec3& gravity, float damping, float dt, uint8_t* dead);
+
+    /**
+     * Times every kernel at every supported level against the equivalent glm loop.
+     *
+     * @param count Number of matrices/boxes per call.
+     * @param iterations Calls per measurement (the average is reported).
+     */
+    std::vector<SimdTiming> benchmark_simd(size_t count = 4096, size_t iterations = 50);
+};
\ No newline at end of file
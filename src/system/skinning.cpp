@@ -0,0 +1,779 @@
+#include "skinning.hpp"
+
+#include "memory.hpp"
+#include "simd_math.hpp"
+#include "view.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <tuple>
+#include <unordered_map>
+
+namespace {
+    // Translation, rotation and scale of a local transform.
+    struct Trs {
+        glm::vec3 translation;
+        glm::vec4 rotation;
+        glm::vec3 scale;
+    };
+
+    Trs decompose(const glm::mat4& matrix) {
+        Trs trs;
+
+        trs.translation = glm::vec3(matrix[3]);
+        trs.scale = glm::vec3(glm::length(glm::vec3(matrix[0])), glm::length(glm::vec3(matrix[1])), glm::length(glm::vec3(matrix[2])));
+
+        // Mirrored matrices flip one axis.
+        if(glm::dot(glm::cross(glm::vec3(matrix[0]), glm::vec3(matrix[1])), glm::vec3(matrix[2])) < 0.0f) {
+            trs.scale.x = -trs.scale.x;
+        }
+
+        glm::vec3 x = glm::vec3(matrix[0]) / (trs.scale.x != 0.0f ? trs.scale.x : 1.0f);
+        glm::vec3 y = glm::vec3(matrix[1]) / (trs.scale.y != 0.0f ? trs.scale.y : 1.0f);
+        glm::vec3 z = glm::vec3(matrix[2]) / (trs.scale.z != 0.0f ? trs.scale.z : 1.0f);
+
+        // Rotation matrix to quaternion (x, y, z, w), branching on the largest diagonal term for precision.
+        float trace = x.x + y.y + z.z;
+        glm::vec4 q;
+
+        if(trace > 0.0f) {
+            float s = 0.5f / std::sqrt(trace + 1.0f);
+
+            q = glm::vec4((y.z - z.y) * s, (z.x - x.z) * s, (x.y - y.x) * s, 0.25f / s);
+        } else if(x.x > y.y && x.x > z.z) {
+            float s = 2.0f * std::sqrt(1.0f + x.x - y.y - z.z);
+
+            q = glm::vec4(0.25f * s, (y.x + x.y) / s, (z.x + x.z) / s, (y.z - z.y) / s);
+        } else if(y.y > z.z) {
+            float s = 2.0f * std::sqrt(1.0f + y.y - x.x - z.z);
+
+            q = glm::vec4((y.x + x.y) / s, 0.25f * s, (z.y + y.z) / s, (z.x - x.z) / s);
+        } else {
+            float s = 2.0f * std::sqrt(1.0f + z.z - x.x - y.y);
+
+            q = glm::vec4((z.x + x.z) / s, (z.y + y.z) / s, 0.25f * s, (x.y - y.x) / s);
+        }
+
+        trs.rotation = q / glm::length(q);
+
+        return trs;
+    }
+
+    glm::mat4 compose(const glm::vec3& t, const glm::vec4& q, const glm::vec3& s) {
+        float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+        float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+        float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+        glm::mat4 matrix(1.0f);
+
+        matrix[0] = glm::vec4(1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy), 0.0f) * s.x;
+        matrix[1] = glm::vec4(2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx), 0.0f) * s.y;
+        matrix[2] = glm::vec4(2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy), 0.0f) * s.z;
+        matrix[3] = glm::vec4(t, 1.0f);
+
+        return matrix;
+    }
+
+    // COLLADA matrices are row-major.
+    glm::mat4 channel_matrix(const ColladaChannel& channel, size_t key) {
+        const float* values = channel.values.data() + key * channel.stride;
+        glm::mat4 matrix;
+
+        for(int column = 0; column < 4; column++) {
+            for(int row = 0; row < 4; row++) {
+                matrix[column][row] = values[row * 4 + column];
+            }
+        }
+
+        return matrix;
+    }
+
+    Trs interpolate(const Trs& a, const Trs& b, float alpha) {
+        glm::vec4 rotation = glm::dot(a.rotation, b.rotation) < 0.0f ? -b.rotation : b.rotation;
+
+        return Trs {
+            a.translation + (b.translation - a.translation) * alpha,
+            glm::normalize(a.rotation + (rotation - a.rotation) * alpha),
+            a.scale + (b.scale - a.scale) * alpha
+        };
+    }
+
+    // Largest scale of a matrix's axes (bounding spheres under non-uniform scale).
+    float max_scale(const glm::mat4& matrix) {
+        return std::sqrt(std::max({
+            glm::dot(glm::vec3(matrix[0]), glm::vec3(matrix[0])),
+            glm::dot(glm::vec3(matrix[1]), glm::vec3(matrix[1])),
+            glm::dot(glm::vec3(matrix[2]), glm::vec3(matrix[2]))
+        }));
+    }
+}
+
+size_t AnimationClip::frame_size() const {
+    return AnimationClip::TRACKS * this->joint_stride;
+}
+
+void AnimationClip::sample(float time, bool loop, float* out) const {
+    size_t size = this->frame_size();
+
+    if(this->frame_count == 0) {
+        return;
+    }
+
+    if(loop && this->duration > 0.0f) {
+        time = std::fmod(time, this->duration);
+
+        if(time < 0.0f) {
+            time += this->duration;
+        }
+    } else {
+        time = std::clamp(time, 0.0f, this->duration);
+    }
+
+    float position = time * this->rate;
+    size_t frame = std::min((size_t) position, this->frame_count - 1);
+    size_t next = std::min(frame + 1, this->frame_count - 1);
+    float alpha = std::clamp(position - (float) frame, 0.0f, 1.0f);
+
+    const float* a = this->keys.data() + frame * size;
+    const float* b = this->keys.data() + next * size;
+
+    for(size_t i = 0; i < size; i++) {
+        out[i] = a[i] + (b[i] - a[i]) * alpha;
+    }
+
+    // Neighbouring keys share a hemisphere (see make_rig), so the lerp only needs renormalizing.
+    size_t stride = this->joint_stride;
+    float* x = out + 3 * stride;
+    float* y = out + 4 * stride;
+    float* z = out + 5 * stride;
+    float* w = out + 6 * stride;
+
+    for(size_t j = 0; j < stride; j++) {
+        float length_squared = x[j] * x[j] + y[j] * y[j] + z[j] * z[j] + w[j] * w[j];
+        float scale = length_squared > 0.0f ? 1.0f / std::sqrt(length_squared) : 0.0f;
+
+        x[j] *= scale;
+        y[j] *= scale;
+        z[j] *= scale;
+        w[j] *= scale;
+    }
+}
+
+Rig::Rig() :
+    min(0.0f),
+    max(0.0f),
+    __vao(0),
+    __buffers { 0, 0 }
+{}
+
+Rig::~Rig() {
+    if(this->__vao != 0) {
+        glDeleteVertexArrays(1, &this->__vao);
+        glDeleteBuffers(2, this->__buffers);
+
+        pepng::memory()->untrack(this);
+    }
+}
+
+std::shared_ptr<Rig> Rig::make_rig(std::shared_ptr<ColladaScene> scene, size_t skin_index, float rate) {
+    if(skin_index >= scene->skins.size()) {
+        std::stringstream ss;
+
+        ss << "Skin " << skin_index << " is out of range (" << scene->skins.size() << " skins)." << std::endl;
+
+        throw std::runtime_error(ss.str());
+    }
+
+    auto& skin = scene->skins[skin_index];
+    auto& nodes = scene->nodes;
+
+    if(skin.geometry < 0) {
+        std::stringstream ss;
+
+        ss << "Skin " << skin.id << " has no geometry." << std::endl;
+
+        throw std::runtime_error(ss.str());
+    }
+
+    std::shared_ptr<Rig> rig(new Rig());
+
+    rig->name = skin.name.empty() ? skin.id : skin.name;
+    rig->mesh = scene->meshes[skin.geometry];
+    rig->__vertex_joints = skin.vertex_joints;
+    rig->__vertex_weights = skin.vertex_weights;
+
+    // Controller joints are named by sid (id or name in some exporters).
+    auto find_node = [&nodes](const std::string& joint) -> int {
+        for(auto field : { &ColladaNode::sid, &ColladaNode::id, &ColladaNode::name }) {
+            for(size_t i = 0; i < nodes.size(); i++) {
+                if(nodes[i].*field == joint) {
+                    return (int) i;
+                }
+            }
+        }
+
+        return -1;
+    };
+
+    std::vector<int> skin_nodes(skin.joints.size());
+    std::vector<bool> in_skeleton(nodes.size(), false);
+
+    for(size_t j = 0; j < skin.joints.size(); j++) {
+        skin_nodes[j] = find_node(skin.joints[j]);
+
+        if(skin_nodes[j] < 0) {
+            std::stringstream ss;
+
+            ss << "Skin " << skin.id << " names a missing joint " << skin.joints[j] << "." << std::endl;
+
+            throw std::runtime_error(ss.str());
+        }
+
+        // The joint and its JOINT ancestors (a skin may skip the root bone).
+        for(int node = skin_nodes[j]; node >= 0 && (node == skin_nodes[j] || nodes[node].joint); node = nodes[node].parent) {
+            in_skeleton[node] = true;
+        }
+    }
+
+    // Nodes are stored parents first, so the skeleton is too.
+    std::vector<int> joint_of_node(nodes.size(), -1);
+
+    for(size_t i = 0; i < nodes.size(); i++) {
+        if(!in_skeleton[i]) {
+            continue;
+        }
+
+        glm::mat4 offset(1.0f);
+        int parent = nodes[i].parent;
+
+        while(parent >= 0 && !in_skeleton[parent]) {
+            offset = nodes[parent].matrix * offset;
+            parent = nodes[parent].parent;
+        }
+
+        joint_of_node[i] = (int) rig->joint_names.size();
+
+        rig->joint_names.push_back(nodes[i].sid.empty() ? nodes[i].name : nodes[i].sid);
+        rig->parents.push_back(parent >= 0 ? joint_of_node[parent] : -1);
+        rig->rest.push_back(nodes[i].matrix);
+        rig->offsets.push_back(offset);
+    }
+
+    for(size_t j = 0; j < skin.joints.size(); j++) {
+        rig->palette_joints.push_back((size_t) joint_of_node[skin_nodes[j]]);
+        rig->inverse_binds.push_back(skin.inverse_binds[j] * skin.bind_shape);
+    }
+
+    // Baked matrix channels, by animated joint.
+    size_t joint_count = rig->joint_names.size();
+    std::vector<const ColladaChannel*> channels(joint_count, nullptr);
+    std::unordered_map<std::string, size_t> joint_by_id;
+
+    for(size_t i = 0; i < nodes.size(); i++) {
+        if(joint_of_node[i] >= 0 && !nodes[i].id.empty()) {
+            joint_by_id[nodes[i].id] = (size_t) joint_of_node[i];
+        }
+    }
+
+    float start = 0.0f;
+    float end = 0.0f;
+    bool animated = false;
+
+    for(auto& channel : scene->channels) {
+        auto it = joint_by_id.find(channel.node);
+
+        if(it == joint_by_id.end() || channel.stride != 16 || channel.times.empty()
+            || (channel.target != "transform" && channel.target != "matrix")) {
+            continue;
+        }
+
+        start = animated ? std::min(start, channel.times.front()) : channel.times.front();
+        end = animated ? std::max(end, channel.times.back()) : channel.times.back();
+        animated = true;
+
+        channels[it->second] = &channel;
+    }
+
+    if(animated) {
+        AnimationClip clip;
+
+        clip.name = "default";
+        clip.duration = end - start;
+        clip.frame_count = (size_t) std::round(clip.duration * rate) + 1;
+        // Evenly spaced frames spanning the channels exactly.
+        clip.rate = clip.duration > 0.0f ? (clip.frame_count - 1) / clip.duration : rate;
+        clip.joint_stride = (joint_count + 7) / 8 * 8;
+        clip.keys.assign(clip.frame_count * clip.frame_size(), 0.0f);
+
+        std::vector<Trs> rest(joint_count);
+        std::vector<size_t> cursors(joint_count, 0);
+        std::vector<glm::vec4> previous(joint_count);
+
+        for(size_t j = 0; j < joint_count; j++) {
+            rest[j] = decompose(rig->rest[j]);
+        }
+
+        for(size_t frame = 0; frame < clip.frame_count; frame++) {
+            float time = std::min(start + frame / clip.rate, end);
+            float* keys = clip.keys.data() + frame * clip.frame_size();
+            size_t stride = clip.joint_stride;
+
+            for(size_t j = 0; j < joint_count; j++) {
+                Trs trs = rest[j];
+
+                if(auto channel = channels[j]) {
+                    auto& times = channel->times;
+                    size_t& key = cursors[j];
+
+                    while(key + 1 < times.size() && times[key + 1] <= time) {
+                        key++;
+                    }
+
+                    if(key + 1 < times.size() && time > times[key]) {
+                        float alpha = (time - times[key]) / (times[key + 1] - times[key]);
+
+                        trs = interpolate(decompose(channel_matrix(*channel, key)), decompose(channel_matrix(*channel, key + 1)), alpha);
+                    } else {
+                        trs = decompose(channel_matrix(*channel, key));
+                    }
+                }
+
+                // Keeps consecutive frames in one hemisphere, so sampling can lerp them.
+                if(frame > 0 && glm::dot(trs.rotation, previous[j]) < 0.0f) {
+                    trs.rotation = -trs.rotation;
+                }
+
+                previous[j] = trs.rotation;
+
+                for(int k = 0; k < 3; k++) {
+                    keys[k * stride + j] = trs.translation[k];
+                    keys[(7 + k) * stride + j] = trs.scale[k];
+                }
+
+                for(int k = 0; k < 4; k++) {
+                    keys[(3 + k) * stride + j] = trs.rotation[k];
+                }
+            }
+        }
+
+        rig->clips.push_back(std::move(clip));
+    }
+
+    rig->__compute_bounds();
+
+    return rig;
+}
+
+std::shared_ptr<Rig> pepng::make_rig(std::shared_ptr<ColladaScene> scene, size_t skin, float rate) {
+    return Rig::make_rig(scene, skin, rate);
+}
+
+int Rig::clip(const std::string& name) const {
+    for(size_t i = 0; i < this->clips.size(); i++) {
+        if(this->clips[i].name == name) {
+            return (int) i;
+        }
+    }
+
+    return -1;
+}
+
+void Rig::evaluate(const AnimationClip* clip, float time, bool loop, SkinPose& pose) const {
+    size_t joint_count = this->joint_names.size();
+    size_t palette_count = this->palette_joints.size();
+
+    pose.globals.resize(joint_count);
+    pose.skins.resize(palette_count);
+    pose.palette.resize(palette_count * 3);
+
+    if(clip != nullptr) {
+        pose.locals.resize(clip->frame_size());
+        clip->sample(time, loop, pose.locals.data());
+    }
+
+    for(size_t j = 0; j < joint_count; j++) {
+        glm::mat4 local = this->rest[j];
+
+        if(clip != nullptr) {
+            const float* keys = pose.locals.data();
+            size_t stride = clip->joint_stride;
+
+            local = compose(
+                glm::vec3(keys[j], keys[stride + j], keys[2 * stride + j]),
+                glm::vec4(keys[3 * stride + j], keys[4 * stride + j], keys[5 * stride + j], keys[6 * stride + j]),
+                glm::vec3(keys[7 * stride + j], keys[8 * stride + j], keys[9 * stride + j]));
+        }
+
+        int parent = this->parents[j];
+
+        pose.globals[j] = (parent >= 0 ? pose.globals[parent] * this->offsets[j] : this->offsets[j]) * local;
+    }
+
+    for(size_t i = 0; i < palette_count; i++) {
+        pose.skins[i] = pose.globals[this->palette_joints[i]];
+    }
+
+    pepng::multiply_matrices(pose.skins.data(), this->inverse_binds.data(), pose.skins.data(), palette_count);
+
+    // The last row is always (0, 0, 0, 1), so 3 rows are enough.
+    for(size_t i = 0; i < palette_count; i++) {
+        auto& skin = pose.skins[i];
+
+        for(int row = 0; row < 3; row++) {
+            pose.palette[i * 3 + row] = glm::vec4(skin[0][row], skin[1][row], skin[2][row], skin[3][row]);
+        }
+    }
+}
+
+void Rig::__compute_bounds() {
+    auto& positions = this->mesh->positions;
+    size_t palette_count = this->palette_joints.size();
+
+    // Bind space sphere of the vertices each joint moves.
+    std::vector<glm::vec3> mins(palette_count, glm::vec3(1e30f));
+    std::vector<glm::vec3> maxs(palette_count, glm::vec3(-1e30f));
+
+    for(size_t v = 0; v < positions.size() && v < this->__vertex_joints.size(); v++) {
+        for(int k = 0; k < 4; k++) {
+            size_t joint = this->__vertex_joints[v][k];
+
+            if(this->__vertex_weights[v][k] == 0 || joint >= palette_count) {
+                continue;
+            }
+
+            mins[joint] = glm::min(mins[joint], positions[v]);
+            maxs[joint] = glm::max(maxs[joint], positions[v]);
+        }
+    }
+
+    std::vector<glm::vec3> centers(palette_count);
+    std::vector<float> radii(palette_count, -1.0f);
+
+    for(size_t i = 0; i < palette_count; i++) {
+        if(mins[i].x <= maxs[i].x) {
+            centers[i] = (mins[i] + maxs[i]) * 0.5f;
+            radii[i] = glm::length(maxs[i] - mins[i]) * 0.5f;
+        }
+    }
+
+    // A blended vertex stays inside the spheres of its joints, so the union over every frame bounds the animation.
+    this->min = glm::vec3(1e30f);
+    this->max = glm::vec3(-1e30f);
+
+    SkinPose pose;
+
+    auto expand = [&]() {
+        for(size_t i = 0; i < palette_count; i++) {
+            if(radii[i] < 0.0f) {
+                continue;
+            }
+
+            glm::vec3 center = glm::vec3(pose.skins[i] * glm::vec4(centers[i], 1.0f));
+            float radius = radii[i] * max_scale(pose.skins[i]);
+
+            this->min = glm::min(this->min, center - radius);
+            this->max = glm::max(this->max, center + radius);
+        }
+    };
+
+    this->evaluate(nullptr, 0.0f, false, pose);
+    expand();
+
+    for(auto& clip : this->clips) {
+        for(size_t frame = 0; frame < clip.frame_count; frame++) {
+            this->evaluate(&clip, frame / clip.rate, false, pose);
+            expand();
+        }
+    }
+
+    if(this->min.x > this->max.x) {
+        this->min = this->max = glm::vec3(0.0f);
+    }
+}
+
+GLuint Rig::vao() {
+    if(this->__vao != 0) {
+        return this->__vao;
+    }
+
+    auto& mesh = *this->mesh;
+    std::vector<Vertex> vertices(mesh.positions.size());
+
+    for(size_t v = 0; v < vertices.size(); v++) {
+        auto& vertex = vertices[v];
+
+        vertex.position = mesh.positions[v];
+        vertex.normal = v < mesh.normals.size() ? mesh.normals[v] : glm::vec3(0.0f, 1.0f, 0.0f);
+        vertex.uv = v < mesh.uvs.size() ? mesh.uvs[v] : glm::vec2(0.0f);
+
+        for(int k = 0; k < 4; k++) {
+            vertex.joints[k] = v < this->__vertex_joints.size() ? this->__vertex_joints[v][k] : 0;
+            vertex.weights[k] = v < this->__vertex_weights.size() ? this->__vertex_weights[v][k] : (k == 0 ? 255 : 0);
+        }
+    }
+
+    glGenVertexArrays(1, &this->__vao);
+    glGenBuffers(2, this->__buffers);
+
+    glBindVertexArray(this->__vao);
+
+    glBindBuffer(GL_ARRAY_BUFFER, this->__buffers[0]);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->__buffers[1]);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.indices.size() * sizeof(unsigned int), mesh.indices.data(), GL_STATIC_DRAW);
+
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*) offsetof(Vertex, position));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*) offsetof(Vertex, normal));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*) offsetof(Vertex, uv));
+    // Integer attribute: the shader reads uvec4 joint indices.
+    glEnableVertexAttribArray(3);
+    glVertexAttribIPointer(3, 4, GL_UNSIGNED_BYTE, sizeof(Vertex), (const void*) offsetof(Vertex, joints));
+    glEnableVertexAttribArray(4);
+    glVertexAttribPointer(4, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex), (const void*) offsetof(Vertex, weights));
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    pepng::memory()->track(this, MemoryRecord {
+        "model", this->name, "skinned mesh", 1,
+        vertices.size() * sizeof(Vertex) + mesh.indices.size() * sizeof(unsigned int),
+        pepng::mesh_bytes(this->mesh) + this->__vertex_joints.size() * 8
+    });
+
+    return this->__vao;
+}
+
+GLsizei Rig::count() {
+    return (GLsizei) this->mesh->indices.size();
+}
+
+Skinning::Skinning() :
+    enabled(true),
+    program(0),
+    __initialized(false),
+    __texture(0)
+{}
+
+std::shared_ptr<Skinning> Skinning::make_skinning() {
+    std::shared_ptr<Skinning> skinning(new Skinning());
+
+    return skinning;
+}
+
+std::shared_ptr<Skinning> pepng::make_skinning() {
+    return Skinning::make_skinning();
+}
+
+std::shared_ptr<Skinning> pepng::skinning() {
+    static auto skinning = pepng::make_skinning();
+
+    return skinning;
+}
+
+const Skinning::Stats& Skinning::stats() {
+    return this->__stats;
+}
+
+void Skinning::submit(std::shared_ptr<Rig> rig, GLuint texture, const glm::vec3& color, const glm::mat4& world, const SkinPose& pose) {
+    if(!this->enabled) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(this->__mutex);
+
+    this->__instances.push_back(Instance { rig, texture, color, world, this->__palettes.size() });
+    this->__palettes.insert(this->__palettes.end(), pose.palette.begin(), pose.palette.end());
+}
+
+void Skinning::record(CommandList& list) {
+    {
+        std::lock_guard<std::mutex> lock(this->__mutex);
+
+        this->__recorded.swap(this->__instances);
+        this->__recorded_palettes.swap(this->__palettes);
+
+        this->__instances.clear();
+        this->__palettes.clear();
+    }
+
+    auto& instances = this->__recorded;
+
+    this->__stats = Stats();
+    this->__stats.instances = instances.size();
+
+    if(instances.empty() || this->program == 0 || Camera::current_camera == nullptr) {
+        return;
+    }
+
+    auto& view = pepng::current_view();
+
+    // Sphere culling against the Rig's animated bounds.
+    this->__order.clear();
+
+    for(size_t i = 0; i < instances.size(); i++) {
+        auto& instance = instances[i];
+        auto& rig = *instance.rig;
+
+        glm::vec3 center = glm::vec3(instance.world * glm::vec4((rig.min + rig.max) * 0.5f, 1.0f));
+        float radius = glm::length(rig.max - rig.min) * 0.5f * max_scale(instance.world);
+
+        if(view.sphere_visible(center, radius)) {
+            this->__order.push_back((uint32_t) i);
+        }
+    }
+
+    this->__stats.visible = this->__order.size();
+
+    if(this->__order.size() > Skinning::MAX_INSTANCES) {
+        this->__stats.dropped = this->__order.size() - Skinning::MAX_INSTANCES;
+        this->__order.resize(Skinning::MAX_INSTANCES);
+    }
+
+    if(this->__order.empty()) {
+        return;
+    }
+
+    // Instances sharing a Rig and material become one draw.
+    std::sort(this->__order.begin(), this->__order.end(), [&instances](uint32_t a, uint32_t b) {
+        auto& x = instances[a];
+        auto& y = instances[b];
+
+        if(x.rig != y.rig) {
+            return x.rig < y.rig;
+        }
+
+        if(x.texture != y.texture) {
+            return x.texture < y.texture;
+        }
+
+        return std::tie(x.color.x, x.color.y, x.color.z) < std::tie(y.color.x, y.color.y, y.color.z);
+    });
+
+    // One row per instance: the world matrix, then the palette (3 texels per matrix).
+    size_t width = 0;
+
+    for(auto i : this->__order) {
+        width = std::max(width, 3 * (instances[i].rig->palette_joints.size() + 1));
+    }
+
+    size_t height = this->__order.size();
+
+    this->__upload.assign(width * height, glm::vec4(0.0f));
+
+    for(size_t row = 0; row < height; row++) {
+        auto& instance = instances[this->__order[row]];
+        glm::vec4* texels = this->__upload.data() + row * width;
+
+        for(int r = 0; r < 3; r++) {
+            texels[r] = glm::vec4(instance.world[0][r], instance.world[1][r], instance.world[2][r], instance.world[3][r]);
+        }
+
+        size_t count = instance.rig->palette_joints.size() * 3;
+
+        std::copy(
+            this->__recorded_palettes.begin() + instance.palette,
+            this->__recorded_palettes.begin() + instance.palette + count,
+            texels + 3);
+    }
+
+    if(!this->__initialized) {
+        this->__initialized = true;
+
+        glGenTextures(BUFFER_COUNT, this->__textures);
+
+        for(size_t i = 0; i < BUFFER_COUNT; i++) {
+            this->__sizes[i] = glm::ivec2(0);
+
+            glBindTexture(GL_TEXTURE_2D, this->__textures[i]);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        }
+    }
+
+    // Unchanged palettes (paused or off screen motion) reuse the last texture, which also keeps the list hash stable for redraw-on-demand.
+    bool unchanged = this->__last_upload.size() == this->__upload.size()
+        && this->__sizes[this->__texture].x == (int) width
+        && std::memcmp(this->__last_upload.data(), this->__upload.data(), this->__upload.size() * sizeof(glm::vec4)) == 0;
+
+    if(!unchanged) {
+        this->__texture = (this->__texture + 1) % BUFFER_COUNT;
+
+        auto& size = this->__sizes[this->__texture];
+
+        glBindTexture(GL_TEXTURE_2D, this->__textures[this->__texture]);
+
+        // Grows to fit, then only the used rows are rewritten.
+        if(size.x != (int) width || size.y < (int) height) {
+            size = glm::ivec2((int) width, std::max((int) height, size.y));
+
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, size.x, size.y, 0, GL_RGBA, GL_FLOAT, nullptr);
+
+            size_t bytes = 0;
+
+            for(auto& texture_size : this->__sizes) {
+                bytes += (size_t) texture_size.x * texture_size.y * sizeof(glm::vec4);
+            }
+
+            pepng::memory()->track(&this->__textures, MemoryRecord { "texture", "", "skinning palettes", 1, bytes, 0 });
+        }
+
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, (GLsizei) width, (GLsizei) height, GL_RGBA, GL_FLOAT, this->__upload.data());
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        this->__last_upload.swap(this->__upload);
+    }
+
+    this->__stats.palette_bytes = width * height * sizeof(glm::vec4);
+
+    GLuint program = this->program;
+
+    list.use_program(program);
+    list.uniform(pepng::uniform_location(program, "u_projection"), view.projection);
+    list.uniform(pepng::uniform_location(program, "u_view"), view.view);
+    pepng::lighting()->record(list, program, view);
+
+    list.bind_texture(Skinning::TEXTURE_UNIT, GL_TEXTURE_2D, this->__textures[this->__texture]);
+    list.uniform(pepng::uniform_location(program, "u_palette"), Skinning::TEXTURE_UNIT);
+
+    GLint u_has_color = pepng::uniform_location(program, "u_has_color");
+    GLint u_color = pepng::uniform_location(program, "u_color");
+    GLint u_first_instance = pepng::uniform_location(program, "u_first_instance");
+
+    for(size_t first = 0; first < height;) {
+        auto& instance = instances[this->__order[first]];
+        size_t last = first + 1;
+
+        while(last < height) {
+            auto& next = instances[this->__order[last]];
+
+            if(next.rig != instance.rig || next.texture != instance.texture || next.color != instance.color) {
+                break;
+            }
+
+            last++;
+        }
+
+        if(instance.color.x >= 0) {
+            list.uniform(u_has_color, (float) GL_TRUE);
+            list.uniform(u_color, instance.color);
+        } else {
+            list.uniform(u_has_color, (float) GL_FALSE);
+        }
+
+        list.bind_texture(0, GL_TEXTURE_2D, instance.texture);
+        list.bind_vertex_array(instance.rig->vao());
+        list.uniform(u_first_instance, (int) first);
+        list.draw_elements_instanced(GL_TRIANGLES, instance.rig->count(), GL_UNSIGNED_INT, 0, (GLsizei) (last - first));
+
+        this->__stats.draws++;
+
+        first = last;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,218 @@
+#pragma once
+
+#include <pepng.h>
+
+#include <mutex>
+
+#include "collada.hpp"
+#include "command_list.hpp"
+#include "lighting.hpp"
+#include "mesh.hpp"
+
+/**
+ * Animation of a Rig's skeleton, resampled at a fixed rate into a structure of arrays.
+ *
+ * Every frame holds TRACKS tracks (translation xyz, rotation quaternion xyzw, scale xyz) of joint_stride
+ * floats (joint count padded to 8), so sampling is one lerp over contiguous floats the compiler vectorizes.
+ */
+struct AnimationClip {
+    std::string name;
+    float duration = 0.0f;
+    // Frames per second of the resampled keys.
+    float rate = 0.0f;
+    size_t frame_count = 0;
+    size_t joint_stride = 0;
+    // frame_count * TRACKS * joint_stride floats.
+    std::vector<float> keys;
+
+    static constexpr size_t TRACKS = 10;
+
+    // Floats of one frame.
+    size_t frame_size() const;
+
+    /**
+     * Local poses at a time (quaternions renormalized).
+     *
+     * @param out frame_size() floats, laid out as one frame.
+     */
+    void sample(float time, bool loop, float* out) const;
+};
+
+/**
+ * Result and scratch memory of Rig::evaluate.
+ *
+ * Owned by whoever animates a character, so characters evaluate in parallel without sharing anything.
+ */
+struct SkinPose {
+    std::vector<float> locals;
+    std::vector<glm::mat4> globals;
+    std::vector<glm::mat4> skins;
+    // 3 rows per palette joint (the skinning matrices transposed to 3x4).
+    std::vector<glm::vec4> palette;
+};
+
+/**
+ * Skinned Mesh of a COLLADA controller, its skeleton and clips.
+ *
+ * The skeleton is the controller's joints and their JOINT ancestors, parents first. Identical characters
+ * share a Rig (and its vertex buffers), only their SkinPose differs.
+ */
+class Rig {
+    public:
+        /**
+         * Builds a Rig from a loaded skin.
+         *
+         * Only baked matrix channels ("transform" or "matrix" targets) are animated, other joints keep their rest pose.
+         *
+         * @param skin Index in ColladaScene::skins.
+         * @param rate Frames per second the channels are resampled at.
+         */
+        static std::shared_ptr<Rig> make_rig(std::shared_ptr<ColladaScene> scene, size_t skin, float rate = 30.0f);
+
+        std::string name;
+        std::shared_ptr<Mesh> mesh;
+
+        // Skeleton joints, parents first.
+        std::vector<std::string> joint_names;
+        // Index in joint_names or -1.
+        std::vector<int> parents;
+        // Local rest pose of each joint.
+        std::vector<glm::mat4> rest;
+        // Non-joint nodes between a joint and its parent joint (the scene root for roots), usually identity.
+        std::vector<glm::mat4> offsets;
+
+        // Skeleton joint of every palette entry (the controller's joint order, which the vertices index).
+        std::vector<size_t> palette_joints;
+        // Inverse bind matrices times the bind shape matrix.
+        std::vector<glm::mat4> inverse_binds;
+
+        std::vector<AnimationClip> clips;
+
+        // Object space bounds over every frame of every clip.
+        glm::vec3 min;
+        glm::vec3 max;
+
+        /**
+         * Poses the skeleton and computes the skinning palette.
+         *
+         * @param clip nullptr for the rest pose.
+         */
+        void evaluate(const AnimationClip* clip, float time, bool loop, SkinPose& pose) const;
+
+        // Index of a clip by name, or -1.
+        int clip(const std::string& name) const;
+
+        // Uploads the vertex buffers on first use (must be called on the GL thread).
+        GLuint vao();
+        GLsizei count();
+
+        ~Rig();
+
+    private:
+        Rig();
+
+        void __compute_bounds();
+
+        // Packed vertex: position 0, normal 1, UV 2, joints 3 (4 bytes), weights 4 (4 normalized bytes).
+        struct Vertex {
+            glm::vec3 position;
+            glm::vec3 normal;
+            glm::vec2 uv;
+            uint8_t joints[4];
+            uint8_t weights[4];
+        };
+
+        std::vector<std::array<uint8_t, 4>> __vertex_joints;
+        std::vector<std::array<uint8_t, 4>> __vertex_weights;
+
+        GLuint __vao;
+        GLuint __buffers[2];
+};
+
+/**
+ * Draws every animated character with one instanced draw per Rig and material.
+ *
+ * Characters submit their world matrix and palette during render. Before the list is submitted, they are
+ * sphere culled, grouped, and the palettes of the visible ones are uploaded in one RGBA32F texture (one
+ * row per instance: the world matrix, then the palette, 3 texels per matrix) the skinned vertex shader fetches by gl_InstanceID.
+ */
+class Skinning {
+    public:
+        static std::shared_ptr<Skinning> make_skinning();
+
+        bool enabled;
+        // The skinned shader (nothing is drawn while 0).
+        GLuint program;
+
+        struct Stats {
+            size_t instances = 0;
+            size_t visible = 0;
+            size_t dropped = 0;
+            size_t draws = 0;
+            size_t palette_bytes = 0;
+        };
+
+        /**
+         * Queues a character for this frame (locked, so any thread can submit).
+         *
+         * @param texture Material texture, used when color.x < 0.
+         */
+        void submit(std::shared_ptr<Rig> rig, GLuint texture, const glm::vec3& color, const glm::mat4& world, const SkinPose& pose);
+
+        /**
+         * Culls the queued characters, uploads their palettes and records their draws (called before the list is submitted).
+         */
+        void record(CommandList& list);
+
+        // Statistics of the last recorded frame.
+        const Stats& stats();
+
+        // Palette textures in flight, so an upload never overwrites one a pending replay still reads.
+        static constexpr size_t BUFFER_COUNT = 3;
+        // Rows of the palette texture (WebGL 2 guarantees 2048 texels), more instances are dropped.
+        static constexpr size_t MAX_INSTANCES = 2048;
+        // After the lighting units.
+        static constexpr int TEXTURE_UNIT = Lighting::TEXTURE_UNIT + 3;
+
+    private:
+        Skinning();
+
+        struct Instance {
+            std::shared_ptr<Rig> rig;
+            GLuint texture;
+            glm::vec3 color;
+            glm::mat4 world;
+            // Offset of the palette in __palettes.
+            size_t palette;
+        };
+
+        std::mutex __mutex;
+        std::vector<Instance> __instances;
+        std::vector<glm::vec4> __palettes;
+
+        // What record() works on, swapped with the queues above.
+        std::vector<Instance> __recorded;
+        std::vector<glm::vec4> __recorded_palettes;
+
+        std::vector<uint32_t> __order;
+        std::vector<glm::vec4> __upload;
+        std::vector<glm::vec4> __last_upload;
+
+        bool __initialized;
+        GLuint __textures[BUFFER_COUNT];
+        glm::ivec2 __sizes[BUFFER_COUNT];
+        size_t __texture;
+
+        Stats __stats;
+};
+
+namespace pepng {
+    std::shared_ptr<Rig> make_rig(std::shared_ptr<ColladaScene> scene, size_t skin, float rate = 30.0f);
+
+    std::shared_ptr<Skinning> make_skinning();
+
+    /**
+     * The engine-wide Skinning flushed by CommandFlush.
+     */
+    std::shared_ptr<Skinning> skinning();
+};
\ No newline at end of file
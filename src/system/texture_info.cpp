@@ -0,0 +1,150 @@
+#include "texture_info.hpp"
+
+#include <fstream>
+
+namespace {
+    struct Entry {
+        std::weak_ptr<Texture> texture;
+        BlendMode blend_mode;
+    };
+
+    std::unordered_map<Texture*, Entry>& cache() {
+        static std::unordered_map<Texture*, Entry> cache;
+
+        return cache;
+    }
+};
+
+BlendMode pepng::texture_blend_mode(std::shared_ptr<Texture> texture) {
+    auto& cache = ::cache();
+    auto it = cache.find(texture.get());
+
+    // An expired entry is a destroyed Texture whose address was reused.
+    if(it != cache.end() && !it->second.texture.expired()) {
+        return it->second.blend_mode;
+    }
+
+    BlendMode blend_mode = BlendMode::NONE;
+
+    if(texture->gl_index() == 0) {
+        return blend_mode;
+    }
+
+    #ifndef __EMSCRIPTEN__
+    glBindTexture(GL_TEXTURE_2D, texture->gl_index());
+
+    GLint width = 0, height = 0, alpha_size = 0;
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_ALPHA_SIZE, &alpha_size);
+
+    // Formats without alpha (e.g. JPEGs) need no read back.
+    if(alpha_size > 0 && width > 0 && height > 0) {
+        std::vector<uint8_t> texels((size_t) width * height * 4);
+
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, texels.data());
+
+        size_t transparent = 0;
+        size_t partial = 0;
+
+        for(size_t i = 3; i < texels.size(); i += 4) {
+            if(texels[i] <= 8) {
+                transparent++;
+            } else if(texels[i] < 247) {
+                partial++;
+            }
+        }
+
+        // Anti-aliased cutout edges leave a few partial texels.
+        if(partial > texels.size() / 4 / 100) {
+            blend_mode = BlendMode::ALPHA_BLEND;
+        } else if(transparent > 0 || partial > 0) {
+            blend_mode = BlendMode::ALPHA_TEST;
+        }
+    }
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    #endif
+
+    // Textures released without forget_texture_blend_mode do not pile up.
+    for(auto entry = cache.begin(); entry != cache.end();) {
+        entry = entry->second.texture.expired() ? cache.erase(entry) : std::next(entry);
+    }
+
+    cache[texture.get()] = Entry { texture, blend_mode };
+
+    return blend_mode;
+}
+
+void pepng::forget_texture_blend_mode(std::shared_ptr<Texture> texture) {
+    ::cache().erase(texture.get());
+}
+
+bool pepng::read_image_size(const std::filesystem::path& path, glm::ivec2& size) {
+    std::ifstream stream(path, std::ios::binary);
+
+    auto byte = [&stream]() {
+        return stream.get();
+    };
+
+    auto word = [&byte]() {
+        int high = byte();
+
+        return (high << 8) | byte();
+    };
+
+    int first = byte(), second = byte();
+
+    if(first == 0x89 && second == 'P') {
+        // Signature (8 bytes), chunk length and type (8 bytes), then width and height (big endian).
+        stream.seekg(16);
+
+        int width = (word() << 16) | word();
+        int height = (word() << 16) | word();
+
+        size = glm::ivec2(width, height);
+
+        return (bool) stream && size.x > 0 && size.y > 0;
+    }
+
+    if(first != 0xFF || second != 0xD8) {
+        return false;
+    }
+
+    while(stream) {
+        if(byte() != 0xFF) {
+            return false;
+        }
+
+        int marker = byte();
+
+        // Fill bytes.
+        while(marker == 0xFF) {
+            marker = byte();
+        }
+
+        // Markers without a segment.
+        if(marker == 0x01 || (marker >= 0xD0 && marker <= 0xD9)) {
+            continue;
+        }
+
+        int length = word();
+
+        // Start of frame (0xC4, 0xC8 and 0xCC share the range but are other segments).
+        if(marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC) {
+            byte();
+
+            int height = word();
+            int width = word();
+
+            size = glm::ivec2(width, height);
+
+            return (bool) stream && size.x > 0 && size.y > 0;
+        }
+
+        stream.seekg(length - 2, std::ios::cur);
+    }
+
+    return false;
+}
\ No newline at end of file
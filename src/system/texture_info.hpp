@@ -0,0 +1,22 @@
+#pragma once
+
+#include <pepng.h>
+
+#include "command_list.hpp"
+
+namespace pepng {
+    /**
+     * BlendMode a texture's alpha calls for (cached per Texture while it lives): NONE if every texel is opaque,
+     * ALPHA_TEST if nearly every texel is either opaque or fully transparent (cutouts), ALPHA_BLEND otherwise.
+     *
+     * Reads the texture back (a GPU stall), so call it when the texture is loaded, not while rendering.
+     * WebGL cannot read textures back (NONE there), and textures not uploaded yet are NONE and not cached.
+     */
+    BlendMode texture_blend_mode(std::shared_ptr<Texture> texture);
+
+    // Size of a JPEG (first SOF segment) or PNG (IHDR) from its header, without decoding it. WebGL cannot query texture sizes.
+    bool read_image_size(const std::filesystem::path& path, glm::ivec2& size);
+
+    // Drops the cached BlendMode of a released texture (its GL name may be reused by another).
+    void forget_texture_blend_mode(std::shared_ptr<Texture> texture);
+};
\ No newline at end of file
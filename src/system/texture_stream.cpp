@@ -0,0 +1,614 @@
+#include "texture_stream.hpp"
+
+#include "texture_info.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <limits>
+
+// Browsers without shared memory have no threads, frames are decoded by advance() there.
+#if !defined(__EMSCRIPTEN__) || defined(__EMSCRIPTEN_PTHREADS__)
+#define PEPNG_DECODE_THREAD 1
+#endif
+
+namespace {
+    // Reads "P6 width height maxval" (comments allowed) up to the single whitespace before the pixels.
+    bool read_ppm_header(std::istream& stream, glm::ivec2& size, int& max_value) {
+        std::string magic;
+        int values[3];
+
+        stream >> magic;
+
+        if(magic != "P6") {
+            return false;
+        }
+
+        for(int i = 0; i < 3; i++) {
+            stream >> std::ws;
+
+            while(stream.peek() == '#') {
+                stream.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                stream >> std::ws;
+            }
+
+            if(!(stream >> values[i])) {
+                return false;
+            }
+        }
+
+        stream.get();
+
+        size = glm::ivec2(values[0], values[1]);
+        max_value = values[2];
+
+        return size.x > 0 && size.y > 0;
+    }
+
+    // RGBA8 copy of a texture scaled to size (linear blit into a renderbuffer, read back).
+    std::vector<uint8_t> read_scaled(GLuint texture, const glm::ivec2& texture_size, const glm::ivec2& size) {
+        GLint previous_read = 0, previous_draw = 0, previous_renderbuffer = 0;
+        glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previous_read);
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previous_draw);
+        glGetIntegerv(GL_RENDERBUFFER_BINDING, &previous_renderbuffer);
+
+        GLuint framebuffers[2], target;
+        glGenFramebuffers(2, framebuffers);
+        glGenRenderbuffers(1, &target);
+
+        glBindRenderbuffer(GL_RENDERBUFFER, target);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, size.x, size.y);
+
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffers[0]);
+        glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffers[1]);
+        glFramebufferRenderbuffer(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, target);
+
+        glBlitFramebuffer(0, 0, texture_size.x, texture_size.y, 0, 0, size.x, size.y, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+
+        std::vector<uint8_t> pixels((size_t) size.x * size.y * 4);
+
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffers[1]);
+        glReadPixels(0, 0, size.x, size.y, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, previous_read);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, previous_draw);
+        glBindRenderbuffer(GL_RENDERBUFFER, previous_renderbuffer);
+
+        glDeleteRenderbuffers(1, &target);
+        glDeleteFramebuffers(2, framebuffers);
+
+        return pixels;
+    }
+
+    // Exponential moving average of a duration.
+    void smooth(float& average, float ms) {
+        average = average == 0.0f ? ms : average * 0.9f + ms * 0.1f;
+    }
+}
+
+PpmSequence::PpmSequence(const std::filesystem::path& directory, float fps) :
+    __size(0),
+    __fps(fps)
+{
+    if(std::filesystem::is_directory(directory)) {
+        for(auto& entry : std::filesystem::directory_iterator(directory)) {
+            if(entry.is_regular_file() && entry.path().extension() == ".ppm") {
+                this->__files.push_back(entry.path());
+            }
+        }
+    }
+
+    std::sort(this->__files.begin(), this->__files.end());
+
+    if(this->__files.empty()) {
+        std::stringstream ss;
+
+        ss << "No .ppm frames in " << directory << "." << std::endl;
+
+        throw std::runtime_error(ss.str());
+    }
+
+    std::ifstream stream(this->__files.front(), std::ios::binary);
+    int max_value = 0;
+
+    if(!read_ppm_header(stream, this->__size, max_value)) {
+        std::stringstream ss;
+
+        ss << this->__files.front() << " is not a binary PPM (P6)." << std::endl;
+
+        throw std::runtime_error(ss.str());
+    }
+}
+
+std::shared_ptr<PpmSequence> PpmSequence::make_ppm_sequence(const std::filesystem::path& directory, float fps) {
+    std::shared_ptr<PpmSequence> sequence(new PpmSequence(directory, fps));
+
+    return sequence;
+}
+
+std::shared_ptr<PpmSequence> pepng::make_ppm_sequence(const std::filesystem::path& directory, float fps) {
+    return PpmSequence::make_ppm_sequence(directory, fps);
+}
+
+glm::ivec2 PpmSequence::size() {
+    return this->__size;
+}
+
+size_t PpmSequence::frame_count() {
+    return this->__files.size();
+}
+
+float PpmSequence::fps() {
+    return this->__fps;
+}
+
+bool PpmSequence::decode(size_t index, uint8_t* rgba) {
+    std::ifstream stream(this->__files[index % this->__files.size()], std::ios::binary);
+
+    glm::ivec2 size;
+    int max_value = 0;
+
+    // Every frame must match the first one (8 bits per channel).
+    if(!read_ppm_header(stream, size, max_value) || size != this->__size || max_value != 255) {
+        return false;
+    }
+
+    size_t row = (size_t) size.x * 3;
+
+    this->__rgb.resize(row * size.y);
+
+    if(!stream.read((char*) this->__rgb.data(), this->__rgb.size())) {
+        return false;
+    }
+
+    // PPM rows go top down, GL textures bottom up.
+    for(int y = 0; y < size.y; y++) {
+        const uint8_t* source = this->__rgb.data() + (size_t) (size.y - 1 - y) * row;
+        uint8_t* target = rgba + (size_t) y * size.x * 4;
+
+        for(int x = 0; x < size.x; x++) {
+            target[x * 4] = source[x * 3];
+            target[x * 4 + 1] = source[x * 3 + 1];
+            target[x * 4 + 2] = source[x * 3 + 2];
+            target[x * 4 + 3] = 255;
+        }
+    }
+
+    return true;
+}
+
+ImageSequence::ImageSequence(const std::filesystem::path& directory, const glm::ivec2& size, float fps) :
+    __size(size),
+    __fps(fps)
+{
+    std::vector<std::filesystem::path> files;
+
+    if(std::filesystem::is_directory(directory)) {
+        for(auto& entry : std::filesystem::directory_iterator(directory)) {
+            auto extension = entry.path().extension();
+
+            if(entry.is_regular_file() && (extension == ".jpg" || extension == ".jpeg" || extension == ".png")) {
+                files.push_back(entry.path());
+            }
+        }
+    }
+
+    std::sort(files.begin(), files.end());
+
+    for(auto& file : files) {
+        glm::ivec2 image_size;
+
+        if(!pepng::read_image_size(file, image_size)) {
+            continue;
+        }
+
+        auto texture = pepng::make_texture(file);
+        texture->delayed_init();
+
+        if(texture->gl_index() != 0) {
+            this->__frames.push_back(read_scaled(texture->gl_index(), image_size, size));
+        }
+    }
+
+    if(this->__frames.empty()) {
+        std::stringstream ss;
+
+        ss << "No .jpg/.png images in " << directory << "." << std::endl;
+
+        throw std::runtime_error(ss.str());
+    }
+}
+
+std::shared_ptr<ImageSequence> ImageSequence::make_image_sequence(const std::filesystem::path& directory, const glm::ivec2& size, float fps) {
+    std::shared_ptr<ImageSequence> sequence(new ImageSequence(directory, size, fps));
+
+    return sequence;
+}
+
+std::shared_ptr<ImageSequence> pepng::make_image_sequence(const std::filesystem::path& directory, const glm::ivec2& size, float fps) {
+    return ImageSequence::make_image_sequence(directory, size, fps);
+}
+
+glm::ivec2 ImageSequence::size() {
+    return this->__size;
+}
+
+size_t ImageSequence::frame_count() {
+    return this->__frames.size();
+}
+
+float ImageSequence::fps() {
+    return this->__fps;
+}
+
+bool ImageSequence::decode(size_t index, uint8_t* rgba) {
+    auto& frame = this->__frames[index % this->__frames.size()];
+
+    std::copy(frame.begin(), frame.end(), rgba);
+
+    return true;
+}
+
+ProceduralFrames::ProceduralFrames(const glm::ivec2& size, float fps) :
+    __size(size),
+    __fps(fps)
+{}
+
+std::shared_ptr<ProceduralFrames> ProceduralFrames::make_procedural_frames(const glm::ivec2& size, float fps) {
+    std::shared_ptr<ProceduralFrames> frames(new ProceduralFrames(size, fps));
+
+    return frames;
+}
+
+std::shared_ptr<ProceduralFrames> pepng::make_procedural_frames(const glm::ivec2& size, float fps) {
+    return ProceduralFrames::make_procedural_frames(size, fps);
+}
+
+glm::ivec2 ProceduralFrames::size() {
+    return this->__size;
+}
+
+size_t ProceduralFrames::frame_count() {
+    return 0;
+}
+
+float ProceduralFrames::fps() {
+    return this->__fps;
+}
+
+bool ProceduralFrames::decode(size_t index, uint8_t* rgba) {
+    float time = index / this->__fps;
+
+    for(int y = 0; y < this->__size.y; y++) {
+        float v = (float) y / this->__size.y;
+
+        for(int x = 0; x < this->__size.x; x++) {
+            float u = (float) x / this->__size.x;
+
+            float value = std::sin(u * 10.0f + time)
+                + std::sin((v * 10.0f + time) * 0.5f)
+                + std::sin((u * 10.0f + v * 10.0f + time) * 0.5f)
+                + std::sin(std::sqrt(u * u + v * v) * 12.0f - time * 2.0f);
+
+            uint8_t* pixel = rgba + ((size_t) y * this->__size.x + x) * 4;
+
+            pixel[0] = (uint8_t) (127.5f + 127.5f * std::sin(value * 3.1415927f));
+            pixel[1] = (uint8_t) (127.5f + 127.5f * std::sin(value * 3.1415927f + 2.0943951f));
+            pixel[2] = (uint8_t) (127.5f + 127.5f * std::sin(value * 3.1415927f + 4.1887902f));
+            pixel[3] = 255;
+        }
+    }
+
+    return true;
+}
+
+TextureStream::TextureStream(std::shared_ptr<FrameSource> source, size_t decode_slots) :
+    speed(1.0f),
+    paused(false),
+    __source(source),
+    __size(source->size()),
+    __slots(std::max<size_t>(decode_slots, 2)),
+    __read(0),
+    __write(0),
+    __filled(0),
+    __next_decode(0),
+    __loop(true),
+    __stop(false),
+    __clock(0.0),
+    __frame(0),
+    __presented_index(0),
+    __presented(false),
+    __initialized(false),
+    __texture(0),
+    __pixel_buffer(0)
+{
+    for(auto& slot : this->__slots) {
+        slot.pixels.resize((size_t) this->__size.x * this->__size.y * 4);
+    }
+
+    #ifdef PEPNG_DECODE_THREAD
+    this->__decoder = std::thread([this]() {
+        this->__decode_loop();
+    });
+    #endif
+}
+
+TextureStream::~TextureStream() {
+    {
+        std::lock_guard<std::mutex> lock(this->__mutex);
+
+        this->__stop = true;
+    }
+
+    this->__wake.notify_all();
+
+    if(this->__decoder.joinable()) {
+        this->__decoder.join();
+    }
+
+    if(this->__initialized) {
+        glDeleteTextures(TEXTURE_COUNT, this->__textures);
+        glDeleteBuffers(PIXEL_BUFFER_COUNT, this->__pixel_buffers);
+
+        if(auto memory = this->__memory.lock()) {
+            memory->untrack(this);
+        }
+    }
+}
+
+std::shared_ptr<TextureStream> TextureStream::make_texture_stream(std::shared_ptr<FrameSource> source, size_t decode_slots) {
+    auto size = source->size();
+
+    if(size.x <= 0 || size.y <= 0 || source->fps() <= 0.0f) {
+        throw std::runtime_error("A FrameSource needs a size and a frame rate to be streamed.");
+    }
+
+    std::shared_ptr<TextureStream> stream(new TextureStream(source, decode_slots));
+
+    return stream;
+}
+
+std::shared_ptr<TextureStream> pepng::make_texture_stream(std::shared_ptr<FrameSource> source, size_t decode_slots) {
+    return TextureStream::make_texture_stream(source, decode_slots);
+}
+
+std::shared_ptr<FrameSource> TextureStream::source() {
+    return this->__source;
+}
+
+void TextureStream::set_loop(bool loop) {
+    {
+        std::lock_guard<std::mutex> lock(this->__mutex);
+
+        this->__loop = loop;
+    }
+
+    this->__wake.notify_all();
+}
+
+bool TextureStream::loop() {
+    std::lock_guard<std::mutex> lock(this->__mutex);
+
+    return this->__loop;
+}
+
+GLuint TextureStream::texture() {
+    return this->__presented ? this->__textures[this->__texture] : 0;
+}
+
+size_t TextureStream::frame() {
+    return this->__frame;
+}
+
+TextureStream::Stats TextureStream::stats() {
+    std::lock_guard<std::mutex> lock(this->__mutex);
+
+    return this->__stats;
+}
+
+bool TextureStream::__has_work() {
+    size_t count = this->__source->frame_count();
+
+    // Without looping, decoding stops at the end of the pass being shown.
+    return this->__filled < this->__slots.size()
+        && (this->__loop || count == 0 || this->__next_decode < (this->__presented_index / count + 1) * count);
+}
+
+bool TextureStream::__decode_next() {
+    size_t index;
+    Slot* slot;
+
+    {
+        std::lock_guard<std::mutex> lock(this->__mutex);
+
+        if(!this->__has_work()) {
+            return false;
+        }
+
+        index = this->__next_decode++;
+        slot = &this->__slots[this->__write];
+    }
+
+    // The slot at __write is outside the filled range, so it is decoded without the lock.
+    auto start = std::chrono::steady_clock::now();
+
+    size_t count = this->__source->frame_count();
+    bool valid = this->__source->decode(count > 0 ? index % count : index, slot->pixels.data());
+
+    float ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::lock_guard<std::mutex> lock(this->__mutex);
+
+    slot->index = index;
+    slot->valid = valid;
+
+    this->__write = (this->__write + 1) % this->__slots.size();
+    this->__filled++;
+
+    if(valid) {
+        this->__stats.decoded++;
+    } else {
+        this->__stats.failed++;
+    }
+
+    smooth(this->__stats.decode_ms, ms);
+
+    return true;
+}
+
+void TextureStream::__decode_loop() {
+    while(true) {
+        {
+            std::unique_lock<std::mutex> lock(this->__mutex);
+
+            this->__wake.wait(lock, [this]() {
+                return this->__stop || this->__has_work();
+            });
+
+            if(this->__stop) {
+                return;
+            }
+        }
+
+        this->__decode_next();
+    }
+}
+
+void TextureStream::__pop() {
+    this->__read = (this->__read + 1) % this->__slots.size();
+    this->__filled--;
+}
+
+void TextureStream::__init() {
+    this->__initialized = true;
+
+    glGenTextures(TEXTURE_COUNT, this->__textures);
+
+    for(auto texture : this->__textures) {
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, this->__size.x, this->__size.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glGenBuffers(PIXEL_BUFFER_COUNT, this->__pixel_buffers);
+
+    size_t frame_bytes = (size_t) this->__size.x * this->__size.y * 4;
+
+    std::lock_guard<std::mutex> lock(this->__mutex);
+
+    this->__stats.bytes = frame_bytes * (this->__slots.size() + TEXTURE_COUNT + PIXEL_BUFFER_COUNT);
+
+    this->__memory = pepng::memory();
+    pepng::memory()->track(this, MemoryRecord { "texture", "", "texture stream", 1, frame_bytes * (TEXTURE_COUNT + PIXEL_BUFFER_COUNT), frame_bytes * this->__slots.size() });
+}
+
+void TextureStream::__upload(Slot& slot) {
+    auto start = std::chrono::steady_clock::now();
+
+    size_t bytes = slot.pixels.size();
+
+    this->__pixel_buffer = (this->__pixel_buffer + 1) % PIXEL_BUFFER_COUNT;
+    this->__texture = (this->__texture + 1) % TEXTURE_COUNT;
+
+    // Orphaning gives fresh storage, so the copy never waits on the previous transfer.
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, this->__pixel_buffers[this->__pixel_buffer]);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_PIXEL_UNPACK_BUFFER, 0, bytes, slot.pixels.data());
+
+    // Sources from the bound pixel buffer (offset 0), the transfer runs asynchronously.
+    glBindTexture(GL_TEXTURE_2D, this->__textures[this->__texture]);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, this->__size.x, this->__size.y, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    float ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::lock_guard<std::mutex> lock(this->__mutex);
+
+    this->__stats.presented++;
+
+    smooth(this->__stats.upload_ms, ms);
+}
+
+void TextureStream::advance(float delta_time) {
+    if(!this->__initialized) {
+        this->__init();
+    }
+
+    #ifndef PEPNG_DECODE_THREAD
+    // Bounded, so a slow source costs frame rate rather than stalls.
+    for(int i = 0; i < 2 && this->__decode_next(); i++) {}
+    #endif
+
+    if(!this->paused) {
+        this->__clock += delta_time * this->speed;
+    }
+
+    size_t count = this->__source->frame_count();
+    size_t target = (size_t) (this->__clock * this->__source->fps());
+
+    Slot* due = nullptr;
+
+    {
+        std::lock_guard<std::mutex> lock(this->__mutex);
+
+        // Holds the last frame of the pass being shown (the clock stops there too).
+        if(count > 0 && !this->__loop) {
+            size_t last = (this->__presented_index / count + 1) * count - 1;
+
+            if(target > last) {
+                target = last;
+                this->__clock = (last + 0.5) / this->__source->fps();
+            }
+        }
+
+        // Drops the frames the clock passed while a newer due frame is decoded.
+        while(this->__filled >= 2
+            && this->__slots[(this->__read + 1) % this->__slots.size()].index <= target) {
+            this->__pop();
+            this->__stats.dropped++;
+        }
+
+        if(this->__filled > 0 && this->__slots[this->__read].index <= target) {
+            due = &this->__slots[this->__read];
+        } else if(this->__presented_index < target) {
+            this->__stats.late++;
+        }
+
+        // A whole ring behind: the decoder jumps to the clock instead of catching up.
+        if(this->__next_decode + this->__slots.size() < target) {
+            this->__stats.skipped += target - this->__next_decode;
+            this->__next_decode = target;
+        }
+    }
+
+    this->__wake.notify_all();
+
+    if(due == nullptr) {
+        return;
+    }
+
+    // The decoder never writes filled slots, so the due frame is uploaded without the lock.
+    if(due->valid) {
+        this->__upload(*due);
+
+        this->__presented = true;
+        this->__frame = count > 0 ? due->index % count : due->index;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(this->__mutex);
+
+        this->__presented_index = due->index;
+        this->__pop();
+    }
+
+    this->__wake.notify_all();
+}
\ No newline at end of file
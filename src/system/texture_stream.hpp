@@ -0,0 +1,216 @@
+#pragma once
+
+#include <pepng.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "memory.hpp"
+
+/**
+ * Decodes the frames of a sequence as RGBA8, from the decode thread.
+ */
+class FrameSource {
+    public:
+        virtual ~FrameSource() = default;
+
+        virtual glm::ivec2 size() = 0;
+        // Frames in the sequence, 0 if endless.
+        virtual size_t frame_count() = 0;
+        // Frames per second the sequence is authored at.
+        virtual float fps() = 0;
+
+        /**
+         * Decodes a frame (size().x * size().y * 4 bytes). False if the frame could not be decoded.
+         */
+        virtual bool decode(size_t index, uint8_t* rgba) = 0;
+};
+
+/**
+ * Sequence of binary PPM (P6) files, played in file name order.
+ *
+ * PPM needs no decoder library, and converters write it (e.g. ffmpeg -i video.mp4 frames/%05d.ppm).
+ */
+class PpmSequence : public FrameSource {
+    public:
+        static std::shared_ptr<PpmSequence> make_ppm_sequence(const std::filesystem::path& directory, float fps);
+
+        virtual glm::ivec2 size() override;
+        virtual size_t frame_count() override;
+        virtual float fps() override;
+        virtual bool decode(size_t index, uint8_t* rgba) override;
+
+    private:
+        PpmSequence(const std::filesystem::path& directory, float fps);
+
+        std::vector<std::filesystem::path> __files;
+        glm::ivec2 __size;
+        float __fps;
+        // Read buffer of the decode thread.
+        std::vector<uint8_t> __rgb;
+};
+
+/**
+ * Still images of a directory (.jpg/.png, in file name order) played as a slideshow, all scaled to one size.
+ *
+ * There is no image decoder in this code base: the images are loaded by the engine when the sequence is
+ * made (on the GL thread), scaled by a blit and read back. decode only copies them, so CPU memory holds
+ * every frame.
+ */
+class ImageSequence : public FrameSource {
+    public:
+        static std::shared_ptr<ImageSequence> make_image_sequence(const std::filesystem::path& directory, const glm::ivec2& size, float fps);
+
+        virtual glm::ivec2 size() override;
+        virtual size_t frame_count() override;
+        virtual float fps() override;
+        virtual bool decode(size_t index, uint8_t* rgba) override;
+
+    private:
+        ImageSequence(const std::filesystem::path& directory, const glm::ivec2& size, float fps);
+
+        glm::ivec2 __size;
+        float __fps;
+        std::vector<std::vector<uint8_t>> __frames;
+};
+
+/**
+ * Endless generated frames (animated plasma), for screens without a sequence on disk.
+ */
+class ProceduralFrames : public FrameSource {
+    public:
+        static std::shared_ptr<ProceduralFrames> make_procedural_frames(const glm::ivec2& size, float fps);
+
+        virtual glm::ivec2 size() override;
+        virtual size_t frame_count() override;
+        virtual float fps() override;
+        virtual bool decode(size_t index, uint8_t* rgba) override;
+
+    private:
+        ProceduralFrames(const glm::ivec2& size, float fps);
+
+        glm::ivec2 __size;
+        float __fps;
+};
+
+/**
+ * Plays a FrameSource into a texture with constant memory however long the sequence is.
+ *
+ * A background thread decodes ahead into a bounded ring of frames. advance() moves a frame clock:
+ * frames it passed are dropped, the newest due one is copied into a pixel buffer (orphaned, so the copy
+ * never waits on the GPU) and transferred with glTexSubImage2D into the next of a small ring of textures.
+ * Draws recorded last frame still reference the previous texture, so an upload never races them.
+ * When the decoder falls a whole ring behind, it skips ahead to the clock. Without threads (WebGL)
+ * frames are decoded by advance().
+ */
+class TextureStream {
+    public:
+        /**
+         * @param decode_slots Frames decoded ahead (CPU memory is decode_slots frames).
+         */
+        static std::shared_ptr<TextureStream> make_texture_stream(std::shared_ptr<FrameSource> source, size_t decode_slots);
+
+        ~TextureStream();
+
+        float speed;
+        bool paused;
+
+        struct Stats {
+            size_t decoded = 0;
+            size_t presented = 0;
+            // Decoded frames the clock passed before they were shown.
+            size_t dropped = 0;
+            // Frames never decoded because the decoder jumped ahead.
+            size_t skipped = 0;
+            // Frames the clock reached before they were decoded (the last one stayed on screen).
+            size_t late = 0;
+            size_t failed = 0;
+            float decode_ms = 0.0f;
+            float upload_ms = 0.0f;
+            // Frame ring, pixel buffers and textures.
+            size_t bytes = 0;
+        };
+
+        /**
+         * Moves the clock and presents the due frame. Must run on the GL thread.
+         */
+        void advance(float delta_time);
+
+        // The texture of the presented frame (0 before the first one).
+        GLuint texture();
+
+        // Index of the presented frame (in the sequence).
+        size_t frame();
+
+        std::shared_ptr<FrameSource> source();
+
+        // Restarts finite sequences at the end (holds the last frame otherwise). On by default.
+        void set_loop(bool loop);
+        bool loop();
+
+        Stats stats();
+
+        static constexpr size_t TEXTURE_COUNT = 3;
+        static constexpr size_t PIXEL_BUFFER_COUNT = 2;
+
+    private:
+        TextureStream(std::shared_ptr<FrameSource> source, size_t decode_slots);
+
+        struct Slot {
+            // Position on the clock (keeps counting across loops).
+            size_t index;
+            bool valid;
+            std::vector<uint8_t> pixels;
+        };
+
+        // Callers hold __mutex.
+        bool __has_work();
+        // Decodes into the free slot at __write. False if the ring is full or the sequence ended.
+        bool __decode_next();
+        void __decode_loop();
+        void __init();
+        void __upload(Slot& slot);
+        void __pop();
+
+        std::shared_ptr<FrameSource> __source;
+        glm::ivec2 __size;
+
+        std::vector<Slot> __slots;
+        size_t __read;
+        size_t __write;
+        size_t __filled;
+        size_t __next_decode;
+        bool __loop;
+
+        std::mutex __mutex;
+        std::condition_variable __wake;
+        bool __stop;
+        std::thread __decoder;
+
+        double __clock;
+        size_t __frame;
+        size_t __presented_index;
+        bool __presented;
+
+        bool __initialized;
+        GLuint __textures[TEXTURE_COUNT];
+        GLuint __pixel_buffers[PIXEL_BUFFER_COUNT];
+        size_t __texture;
+        size_t __pixel_buffer;
+
+        Stats __stats;
+        // Where the GL objects were reported (see __init).
+        std::weak_ptr<MemoryTracker> __memory;
+};
+
+namespace pepng {
+    std::shared_ptr<PpmSequence> make_ppm_sequence(const std::filesystem::path& directory, float fps = 30.0f);
+
+    // Must run on the GL thread.
+    std::shared_ptr<ImageSequence> make_image_sequence(const std::filesystem::path& directory, const glm::ivec2& size = glm::ivec2(512, 256), float fps = 0.5f);
+
+    std::shared_ptr<ProceduralFrames> make_procedural_frames(const glm::ivec2& size = glm::ivec2(256), float fps = 30.0f);
+
+    std::shared_ptr<TextureStream> make_texture_stream(std::shared_ptr<FrameSource> source, size_t decode_slots = 6);
+};
\ No newline at end of file
@@ -0,0 +1,111 @@
+#include "view.hpp"
+
+#include "command_list.hpp"
+#include "offscreen_capture.hpp"
+
+bool View::sphere_visible(const glm::vec3& center, float radius) const {
+    for(auto& plane : this->planes) {
+        if(glm::dot(glm::vec3(plane), center) + plane.w < -radius) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool View::aabb_visible(const glm::vec3& min, const glm::vec3& max) const {
+    for(auto& plane : this->planes) {
+        // Corner furthest along the plane normal.
+        glm::vec3 corner(
+            plane.x >= 0.0f ? max.x : min.x,
+            plane.y >= 0.0f ? max.y : min.y,
+            plane.z >= 0.0f ? max.z : min.z
+        );
+
+        if(glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+View pepng::make_view(const glm::mat4& view_matrix, const glm::mat4& projection, const glm::ivec4& viewport) {
+    View view;
+
+    view.view = view_matrix;
+    view.projection = projection;
+    view.view_projection = projection * view_matrix;
+    view.position = glm::vec3(glm::inverse(view_matrix)[3]);
+    view.viewport = viewport;
+
+    auto& m = view.view_projection;
+
+    glm::vec4 rows[4];
+
+    for(int i = 0; i < 4; i++) {
+        rows[i] = glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]);
+    }
+
+    // Gribb-Hartmann extraction: left, right, bottom, top, near, far.
+    view.planes[0] = rows[3] + rows[0];
+    view.planes[1] = rows[3] - rows[0];
+    view.planes[2] = rows[3] + rows[1];
+    view.planes[3] = rows[3] - rows[1];
+    view.planes[4] = rows[3] + rows[2];
+    view.planes[5] = rows[3] - rows[2];
+
+    for(auto& plane : view.planes) {
+        plane /= glm::length(glm::vec3(plane));
+    }
+
+    return view;
+}
+
+namespace {
+    View frame_view;
+    bool has_frame_view = false;
+}
+
+void pepng::read_view(GLuint program) {
+    if(Camera::current_camera == nullptr) {
+        throw std::runtime_error("No current camera set.");
+    }
+
+    GLint u_view = pepng::uniform_location(program, "u_view");
+    GLint u_projection = pepng::uniform_location(program, "u_projection");
+
+    if(u_view < 0 || u_projection < 0) {
+        std::stringstream ss;
+
+        ss << "Program " << program << " has no u_view/u_projection to read the camera from." << std::endl;
+
+        throw std::runtime_error(ss.str());
+    }
+
+    glUseProgram(program);
+
+    Camera::current_camera->render(program);
+
+    glm::mat4 view_matrix;
+    glm::mat4 projection;
+    glm::ivec4 viewport;
+
+    glGetUniformfv(program, u_view, glm::value_ptr(view_matrix));
+    glGetUniformfv(program, u_projection, glm::value_ptr(projection));
+    glGetIntegerv(GL_VIEWPORT, glm::value_ptr(viewport));
+
+    frame_view = pepng::make_view(view_matrix, projection, viewport);
+    // Shots are recorded for the capture target, whatever the window size.
+    pepng::capture()->adjust(frame_view);
+
+    has_frame_view = true;
+}
+
+const View& pepng::current_view() {
+    if(!has_frame_view) {
+        throw std::runtime_error("No View was read yet (attach FrameStart to the first instantiated Object).");
+    }
+
+    return frame_view;
+}
\ No newline at end of file
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <pepng.h>
+
+/**
+ * Snapshot of the current camera (matrices, position, frustum and viewport).
+ */
+struct View {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::mat4 view_projection;
+    glm::vec3 position;
+    // Frustum planes (xyz normal pointing inside, w distance) in world space.
+    glm::vec4 planes[6];
+    // x, y, width, height in pixels.
+    glm::ivec4 viewport;
+
+    bool sphere_visible(const glm::vec3& center, float radius) const;
+    bool aabb_visible(const glm::vec3& min, const glm::vec3& max) const;
+};
+
+namespace pepng {
+    /**
+     * Builds a View from matrices (frustum planes are derived).
+     */
+    View make_view(const glm::mat4& view, const glm::mat4& projection, const glm::ivec4& viewport);
+
+    /**
+     * Reads the View of Camera::current_camera for this frame.
+     *
+     * The camera only exposes its matrices through uniforms, so they are read back from the program (the only GL
+     * work of a View). FrameStart calls it once at the start of the render pass, before anything records.
+     *
+     * @param program A shader program declaring u_view and u_projection.
+     */
+    void read_view(GLuint program);
+
+    /**
+     * The View read by read_view (no GL calls, so recording stays GL free).
+     */
+    const View& current_view();
+};
\ No newline at end of file